@@ -27,5 +27,70 @@ namespace Core
 		void InternalDeallocate(void* mem, index_type /*size*/) { delete[] static_cast<u8*>(mem); }
 	};
 
+	/**
+	 * Stateful allocator interface.
+	 * See LinearAllocator, PoolAllocator, TLSFAllocator and ThreadCacheAllocator.
+	 * Containers use one through ContainerAllocator.
+	 */
+	class IAllocator
+	{
+	public:
+		virtual ~IAllocator() {}
+
+		/**
+		 * Allocate memory.
+		 * @param size Size in bytes.
+		 * @param align Alignment in bytes. Must be a power of two.
+		 * @return Memory, or nullptr if unable to allocate.
+		 */
+		virtual void* Allocate(i64 size, i64 align) = 0;
+
+		/**
+		 * Deallocate memory.
+		 * @param mem Memory returned by Allocate, or nullptr.
+		 * @param size Size passed to Allocate.
+		 */
+		virtual void Deallocate(void* mem, i64 size) = 0;
+	};
+
+	/**
+	 * Container allocator that forwards to an IAllocator.
+	 * Default constructed, it allocates from the heap as Allocator does.
+	 * Containers take it with them when copied, moved or swapped, so the IAllocator must outlive any
+	 * container using it.
+	 */
+	class ContainerAllocator
+	{
+	public:
+		using index_type = i32;
+
+		ContainerAllocator() = default;
+		ContainerAllocator(IAllocator& allocator)
+		    : allocator_(&allocator)
+		{
+		}
+
+		void* allocate(index_type count, index_type size)
+		{
+			const i64 bytes = (i64)count * (i64)size;
+			if(allocator_)
+				return allocator_->Allocate(bytes, PLATFORM_ALIGNMENT);
+			return ::new u8[bytes];
+		}
+
+		void deallocate(void* mem, index_type count, index_type size)
+		{
+			if(allocator_)
+				allocator_->Deallocate(mem, (i64)count * (i64)size);
+			else
+				delete[] static_cast<u8*>(mem);
+		}
+
+		/// @return Allocator forwarded to, nullptr if the heap.
+		IAllocator* GetAllocator() const { return allocator_; }
+
+	private:
+		IAllocator* allocator_ = nullptr;
+	};
 
 } // namespace Core
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/types.h"
+
+namespace Core
+{
+	/**
+	 * Compression codecs. Values are stored in files, so must not change.
+	 */
+	enum class CompressionCodec : u32
+	{
+		/// Stored as is.
+		NONE = 0,
+		/// LZ4 block format. Fast to decompress, for data that's read often.
+		LZ4 = 1,
+	};
+
+	/// Fastest compression level. Finds fewer matches, but compresses many times faster than the others.
+	static const i32 COMPRESSION_LEVEL_FAST = 0;
+	/// Default level for data compressed once and read many times, i.e. converted resources.
+	static const i32 COMPRESSION_LEVEL_DEFAULT = 6;
+	/// Smallest output, slowest compression.
+	static const i32 COMPRESSION_LEVEL_MAX = 9;
+
+	/**
+	 * @return Largest size compressing @a srcSize bytes with @a codec can produce.
+	 */
+	CORE_DLL i64 CompressionBound(CompressionCodec codec, i64 srcSize);
+
+	/**
+	 * Compress a block of data. Blocks are independent: each can be decompressed without any other.
+	 * @param codec Codec to compress with.
+	 * @param dest Buffer to compress into.
+	 * @param destSize Size of @a dest. CompressionBound is always enough.
+	 * @param src Data to compress.
+	 * @param srcSize Size of @a src.
+	 * @param level Compression level. Higher levels search harder for matches. Doesn't affect decompression speed.
+	 * @return Compressed size, or 0 if it doesn't fit in @a destSize.
+	 * @pre srcSize >= 0.
+	 * @pre level is in [COMPRESSION_LEVEL_FAST, COMPRESSION_LEVEL_MAX].
+	 */
+	CORE_DLL i64 Compress(CompressionCodec codec, void* dest, i64 destSize, const void* src, i64 srcSize,
+	    i32 level = COMPRESSION_LEVEL_FAST);
+
+	/**
+	 * Decompress a block of data written by Compress.
+	 * Checks every length and offset against the buffers, so corrupt data fails rather than overruns.
+	 * @param codec Codec @a src was compressed with.
+	 * @param dest Buffer to decompress into.
+	 * @param destSize Size of @a dest.
+	 * @param src Compressed data.
+	 * @param srcSize Size of @a src.
+	 * @return Decompressed size, or -1 if @a src is corrupt or doesn't fit in @a destSize.
+	 */
+	CORE_DLL i64 Decompress(CompressionCodec codec, void* dest, i64 destSize, const void* src, i64 srcSize);
+} // namespace Core
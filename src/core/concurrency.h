@@ -77,6 +77,20 @@ namespace Core
 	CORE_DLL_INLINE i64 AtomicCmpExchgAcq(volatile i64* dest, i64 exchg, i64 comp);
 	CORE_DLL_INLINE i64 AtomicCmpExchgRel(volatile i64* dest, i64 exchg, i64 comp);
 
+	/// @return Value of @a src. Cheaper than an atomic operation, as it only prevents reordering.
+	CORE_DLL_INLINE i32 AtomicLoadAcq(const volatile i32* src);
+	CORE_DLL_INLINE i64 AtomicLoadAcq(const volatile i64* src);
+	CORE_DLL_INLINE void* AtomicLoadAcq(void* const volatile* src);
+	/// Set @a dest to @a value. Cheaper than an atomic operation, as it only prevents reordering.
+	CORE_DLL_INLINE void AtomicStoreRel(volatile i32* dest, i32 value);
+	CORE_DLL_INLINE void AtomicStoreRel(volatile i64* dest, i64 value);
+	CORE_DLL_INLINE void AtomicStoreRel(void* volatile* dest, void* value);
+
+	/// @return Original value of dest, and set @dest to @exchg.
+	CORE_DLL_INLINE void* AtomicExchg(void* volatile* dest, void* exchg);
+	/// @return Original value of dest, and if original value matches @a comp, set @dest to @exchg.
+	CORE_DLL_INLINE void* AtomicCmpExchg(void* volatile* dest, void* exchg, void* comp);
+
 	/**
 	 * Utility.
 	 */
@@ -244,6 +258,44 @@ namespace Core
 		struct EventImpl* impl_;
 	};
 
+	/**
+	 * Counting semaphore.
+	 * Unlike Event, each Signal releases a specific number of waiters, which allows waking only as many
+	 * threads as there is work for.
+	 */
+	class CORE_DLL Semaphore final
+	{
+	public:
+		/**
+		 * Create semaphore.
+		 * @param initialCount Initial count.
+		 * @param maximumCount Maximum count.
+		 * @param debugName Debug name for semaphore.
+		 */
+		Semaphore(i32 initialCount = 0, i32 maximumCount = 0x7fffffff, const char* debugName = nullptr);
+		~Semaphore();
+
+		/**
+		 * Wait for semaphore count to be non-zero, and decrement it.
+		 * @param timeout Timeout in milliseconds.
+		 * @return True if acquired, false if timed out.
+		 */
+		bool Wait(i32 timeout = -1);
+
+		/**
+		 * Signal.
+		 * @param count Amount to increment count by, releasing up to @a count waiters.
+		 * @return Success.
+		 */
+		bool Signal(i32 count = 1);
+
+	private:
+		Semaphore(const Semaphore&) = delete;
+		Semaphore(Semaphore&&) = delete;
+
+		struct SemaphoreImpl* impl_;
+	};
+
 	/**
 	 * Mutex lock. Can be used recursively.
 	 */
@@ -20,6 +20,15 @@ namespace Core
 	 */
 	CORE_DLL bool IsDebuggerAttached();
 
+	/**
+	 * Capture return addresses on the calling thread's stack.
+	 * @param skipFrames Number of frames to skip, not counting this function.
+	 * @param outFrames Array to fill.
+	 * @param maxFrames Size of @a outFrames.
+	 * @return Number of frames captured. 0 if unsupported on this platform.
+	 */
+	CORE_DLL i32 GetCallstack(i32 skipFrames, void** outFrames, i32 maxFrames);
+
 } // namespace Core
 
 //////////////////////////////////////////////////////////////////////////
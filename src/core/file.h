@@ -8,6 +8,9 @@ namespace Core
 	/// Maximum path length supported. Platform may vary.
 	static const i32 MAX_PATH_LENGTH = 512;
 
+	/// Alignment of buffer, offset and size for reads from a FileFlags::DIRECT file to avoid a copy.
+	static const i32 FILE_DIRECT_ALIGNMENT = 4096;
+
 	/**
 	 * Timestamp.
 	 */
@@ -183,6 +186,17 @@ namespace Core
 		WRITE = 0x2,
 		APPEND = 0x4,
 		CREATE = 0x8,
+		/// Map whole file into memory on open, so Read copies from the mapping and Map doesn't need a
+		/// system call. Only valid with READ. Falls back to normal reads if the file can't be mapped.
+		MMAP = 0x10,
+		/// Bypass the OS file cache, for large reads that won't be reread. Reads aligned to
+		/// FILE_DIRECT_ALIGNMENT go straight to the buffer, others through a bounce buffer.
+		/// Only valid with READ. Falls back to cached reads if the file system doesn't support it.
+		DIRECT = 0x20,
+		/// Hint that the file will be read sequentially, so the OS reads further ahead. Only valid with READ.
+		SEQUENTIAL = 0x40,
+		/// Hint that the file will be read randomly, so the OS doesn't read ahead. Only valid with READ.
+		RANDOM = 0x80,
 	};
 
 	DEFINE_ENUM_CLASS_FLAG_OPERATOR(FileFlags, |);
@@ -222,6 +236,8 @@ namespace Core
 		 * @param resolver Path resolver to use. Can be nullptr.
 		 * @pre @a flags only contains READ or WRITE, but not both.
 		 * @pre If @a flags contains READ, it doesn't contain APPEND or CREATE.
+		 * @pre If @a flags contains MMAP, DIRECT, SEQUENTIAL or RANDOM, it contains READ.
+		 * @pre @a flags doesn't contain both MMAP and DIRECT, or both SEQUENTIAL and RANDOM.
 		 */
 		File(const char* path, FileFlags flags, IFilePathResolver* resolver = nullptr);
 
@@ -260,6 +276,20 @@ namespace Core
 		 */
 		i64 Read(void* buffer, i64 bytes);
 
+		/**
+		 * Read bytes from offset in file, without using or moving the read position.
+		 * Safe to call from multiple threads at once, unlike the other methods.
+		 * @param offset Offset in bytes.
+		 * @param buffer Buffer to read into.
+		 * @param bytes Bytes to read.
+		 * @return Bytes read, fewer than @a bytes if reading past end of file.
+		 * @pre GetFlags contains FileFlags::READ.
+		 * @pre offset >= 0.
+		 * @pre buffer != nullptr.
+		 * @pre bytes > 0.
+		 */
+		i64 ReadAt(i64 offset, void* buffer, i64 bytes) const;
+
 		/**
 		 * Write bytes to end of file.
 		 * @param buffer Buffer to write.
@@ -292,6 +322,39 @@ namespace Core
 		 */
 		i64 Size() const;
 
+		/**
+		 * Map read-only view of part of the file into memory.
+		 * Data is read from the OS file cache as it's accessed, rather than copied into a buffer first.
+		 * Views remain valid until passed to Unmap or the file is destroyed. Doesn't move the read position.
+		 * @param offset Offset in bytes.
+		 * @param size Size in bytes.
+		 * @return View of data, or nullptr if range is outside of the file or it can't be mapped.
+		 * @pre GetFlags contains FileFlags::READ.
+		 * @pre size > 0.
+		 */
+		const void* Map(i64 offset, i64 size);
+
+		/**
+		 * Unmap view returned by Map.
+		 * @param data View returned by Map.
+		 */
+		void Unmap(const void* data);
+
+		/**
+		 * Hint that part of the file will be read soon, so the OS can start reading it into its cache.
+		 * @param offset Offset in bytes.
+		 * @param size Size in bytes.
+		 * @return Hint was given. Not supported by all platforms, or by DIRECT and MMAP files.
+		 * @pre GetFlags contains FileFlags::READ.
+		 */
+		bool Prefetch(i64 offset, i64 size);
+
+		/**
+		 * Get OS file descriptor, for use with platform async IO APIs. File retains ownership of it.
+		 * @return Descriptor, or -1 if file is in memory.
+		 */
+		i32 GetDescriptor() const;
+
 		/**
 		 * @return flags.
 		 */
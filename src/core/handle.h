@@ -49,6 +49,8 @@ namespace Core
 
 	private:
 		friend class HandleAllocator;
+		template<typename, typename>
+		friend class SlotMap;
 
 		union
 		{
@@ -67,7 +69,11 @@ namespace Core
 	 * Handle allocator.
 	 * Provides a mechanism for allocating and validating handles for use in
 	 * various scenarios.
-	 * This is not thread safe, so this needs to be managed at the higher level.
+	 * Thread safe and lock free. Each thread keeps a small cache of free indices per type, backed by a
+	 * shared lock free free list, so threads allocating and freeing at the same time rarely contend.
+	 * Free indices in other threads' caches aren't available to a thread, so Alloc can fail slightly
+	 * before Handle::MAX_INDEX handles of a type are live. A thread's cache is returned to the free list
+	 * when the thread exits.
 	 */
 	class CORE_DLL HandleAllocator
 	{
@@ -88,6 +94,7 @@ namespace Core
 		{
 		}
 
+		HandleAllocator(HandleAllocator&& other);
 		~HandleAllocator();
 
 		/**
@@ -106,23 +113,40 @@ namespace Core
 			return HANDLE_TYPE(Alloc((i32)type));
 		}
 
+		/**
+		 * Allocate several handles of the same type.
+		 * Cheaper than allocating one at a time, as the shared free list is only touched once.
+		 * @param type Type of handles.
+		 * @param outHandles Array to fill.
+		 * @param count Number of handles to allocate.
+		 * @return Number of handles allocated. Less than @a count if the type ran out of indices.
+		 */
+		i32 Alloc(i32 type, Handle* outHandles, i32 count);
+
 		/**
 		 * Free handle.
+		 * Only the handle's owner may free it, and only once. Freeing the same handle from several threads at
+		 * once is not safe.
 		 */
 		void Free(Handle handle);
 
+		/**
+		 * Free several handles.
+		 * @param handles Handles to free. May be of different types.
+		 * @param count Number of handles.
+		 */
+		void Free(const Handle* handles, i32 count);
+
 		/**
 		 * Get total number of allocated handles for type.
-		 * SLOW: Iterates internally to check.
 		 */
 		i32 GetTotalHandles(i32 type) const;
 
 		/**
 		 * Get total number of allocated handles using enum type type.
-		 * SLOW: Iterates internally to check.
 		 */
 		template<typename TYPE_ENUM>
-		Handle GetTotalHandles(TYPE_ENUM type) const
+		i32 GetTotalHandles(TYPE_ENUM type) const
 		{
 			return GetTotalHandles((i32)type);
 		}
@@ -132,12 +156,17 @@ namespace Core
 		 */
 		bool IsValid(Handle handle) const
 		{
-			return magicIDs_[handle.index_ + (handle.type_ * Handle::MAX_MAGIC)] == handle.magic_;
+			return (i32)handle.type_ < numTypes_ &&
+			       magicIDs_[handle.index_ + (handle.type_ * Handle::MAX_INDEX)] == handle.magic_;
 		}
 
 	private:
+		HandleAllocator(const HandleAllocator&) = delete;
+		HandleAllocator& operator=(const HandleAllocator&) = delete;
+
 		/// Magic IDs array used to validate handles for types.
-		u16* magicIDs_ = nullptr;
+		volatile u16* magicIDs_ = nullptr;
+		i32 numTypes_ = 0;
 		struct HandleAllocatorImpl* impl_ = nullptr;
 	};
 
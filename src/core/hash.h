@@ -3,6 +3,8 @@
 #include "core/dll.h"
 #include "core/types.h"
 
+#include <type_traits>
+
 namespace Core
 {
 	/**
@@ -21,6 +23,62 @@ namespace Core
 
 	CORE_DLL HashMD5Digest HashMD5(const void* data, size_t size);
 
+	/**
+	 * Streaming MD5, for hashing data as it arrives, i.e. a block at a time while reading a file.
+	 */
+	class CORE_DLL HashMD5Context final
+	{
+	public:
+		HashMD5Context() { Init(); }
+
+		/// Reset to start a new hash.
+		void Init();
+
+		/// Hash more data.
+		void Update(const void* data, size_t size);
+
+		/// @return Digest of data since Init. Call Init before reusing.
+		HashMD5Digest Final();
+
+	private:
+		friend class HashMD5MultiContext;
+
+		u32 state_[4];
+		u64 size_;
+		u32 dataLen_;
+		u8 data_[64];
+	};
+
+	/**
+	 * MD5 of NUM_LANES independent streams at once, i.e. a block from each of several files per Update.
+	 * Whole blocks present in more than one lane are hashed together with SIMD. Lanes can be fed different
+	 * amounts; anything that can't be hashed alongside another lane is hashed as HashMD5Context would.
+	 */
+	class CORE_DLL HashMD5MultiContext final
+	{
+	public:
+		static const i32 NUM_LANES = 4;
+
+		/// Reset all lanes to start new hashes.
+		void Init();
+
+		/**
+		 * Hash more data.
+		 * @param data Data for each lane.
+		 * @param sizes Size of data for each lane. 0 to leave a lane as is.
+		 */
+		void Update(const void* const* data, const size_t* sizes);
+
+		/**
+		 * Get digests of data since Init. Call Init before reusing.
+		 * @param outDigests Digest for each lane.
+		 */
+		void Final(HashMD5Digest* outDigests);
+
+	private:
+		HashMD5Context lanes_[NUM_LANES];
+	};
+
 	/**
 	 * SHA-1.
 	 */
@@ -36,12 +94,84 @@ namespace Core
 
 	CORE_DLL HashSHA1Digest HashSHA1(const void* data, size_t size);
 
+	/**
+	 * Streaming SHA-1, for hashing data as it arrives, i.e. a block at a time while reading a file.
+	 */
+	class CORE_DLL HashSHA1Context final
+	{
+	public:
+		HashSHA1Context() { Init(); }
+
+		/// Reset to start a new hash.
+		void Init();
+
+		/// Hash more data.
+		void Update(const void* data, size_t size);
+
+		/// @return Digest of data since Init. Call Init before reusing.
+		HashSHA1Digest Final();
+
+	private:
+		friend class HashSHA1MultiContext;
+
+		u32 state_[5];
+		u64 size_;
+		u32 dataLen_;
+		u8 data_[64];
+	};
+
+	/**
+	 * SHA-1 of NUM_LANES independent streams at once. See HashMD5MultiContext.
+	 */
+	class CORE_DLL HashSHA1MultiContext final
+	{
+	public:
+		static const i32 NUM_LANES = 4;
+
+		/// Reset all lanes to start new hashes.
+		void Init();
+
+		/**
+		 * Hash more data.
+		 * @param data Data for each lane.
+		 * @param sizes Size of data for each lane. 0 to leave a lane as is.
+		 */
+		void Update(const void* const* data, const size_t* sizes);
+
+		/**
+		 * Get digests of data since Init. Call Init before reusing.
+		 * @param outDigests Digest for each lane.
+		 */
+		void Final(HashSHA1Digest* outDigests);
+
+	private:
+		HashSHA1Context lanes_[NUM_LANES];
+	};
+
 	/**
 	 * Core hashing algorithms.
 	 */
 	CORE_DLL u32 HashCRC32(u32 Input, const void* pInData, size_t Size);
 	CORE_DLL u32 HashSDBM(u32 Input, const void* pInData, size_t Size);
 
+	/**
+	 * CRC32C (Castagnoli).
+	 * Uses SSE4.2 or ARMv8 CRC instructions when available, selected at runtime on first use, otherwise
+	 * slice-by-8 tables. Fastest hash for small keys; used by Hasher for trivially hashable types.
+	 */
+	CORE_DLL u32 HashCRC32C(u32 input, const void* data, size_t size);
+
+	/**
+	 * @return Does HashCRC32C use hardware instructions on this CPU?
+	 */
+	CORE_DLL bool HashHasHardwareCRC32C();
+
+	/**
+	 * xxHash64.
+	 * Fast 64-bit non-cryptographic hash for bulk data, such as checking converted asset content.
+	 */
+	CORE_DLL u64 HashXX64(u64 seed, const void* data, size_t size);
+
 	/**
 	 * Templated hash function to ensure users define their own.
 	 */
@@ -59,11 +189,21 @@ namespace Core
 	inline u32 Hash(u32 Input, u8 Data) { return Input ^ Data; }
 	inline u32 Hash(u32 Input, u16 Data) { return Input ^ Data; }
 	inline u32 Hash(u32 Input, u32 Data) { return Input ^ Data; }
-	inline u32 Hash(u32 Input, u64 Data) { return HashCRC32(Input, &Data, sizeof(Data)); }
+	inline u32 Hash(u32 Input, u64 Data) { return HashCRC32C(Input, &Data, sizeof(Data)); }
 	inline u32 Hash(u32 Input, i8 Data) { return Input ^ Data; }
 	inline u32 Hash(u32 Input, i16 Data) { return Input ^ Data; }
 	inline u32 Hash(u32 Input, i32 Data) { return Input ^ Data; }
-	inline u32 Hash(u32 Input, i64 Data) { return HashCRC32(Input, &Data, sizeof(Data)); }
+	inline u32 Hash(u32 Input, i64 Data) { return HashCRC32C(Input, &Data, sizeof(Data)); }
+
+	/**
+	 * Types that can be hashed as their bytes: no padding, and equal values have equal bytes.
+	 * Specialize for other types to have Hasher use HashCRC32C on them instead of Hash.
+	 */
+	template<typename TYPE>
+	struct IsTriviallyHashable
+	{
+		static const bool value = std::is_enum<TYPE>::value || std::is_pointer<TYPE>::value;
+	};
 
 	/**
 	 * Default hasher.
@@ -72,7 +212,17 @@ namespace Core
 	class Hasher
 	{
 	public:
-		u32 operator()(u32 input, const TYPE& data) const { return Hash(input, data); }
+		u32 operator()(u32 input, const TYPE& data) const
+		{
+			return hash(input, data, std::integral_constant<bool, IsTriviallyHashable<TYPE>::value>());
+		}
+
+	private:
+		static u32 hash(u32 input, const TYPE& data, std::true_type)
+		{
+			return HashCRC32C(input, &data, sizeof(data));
+		}
+		static u32 hash(u32 input, const TYPE& data, std::false_type) { return Hash(input, data); }
 	};
 
 } // namespace Core
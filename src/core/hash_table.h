@@ -0,0 +1,376 @@
+#pragma once
+
+#include "core/hash.h"
+#include "core/pair.h"
+#include "core/vector.h"
+
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Key extractor for tables that store keys directly.
+	 */
+	template<typename KEY_TYPE>
+	struct HashTableKeyIdentity
+	{
+		const KEY_TYPE& operator()(const KEY_TYPE& value) const { return value; }
+	};
+
+	/**
+	 * Key extractor for tables that store key/value pairs.
+	 */
+	template<typename KEY_TYPE, typename VALUE_TYPE>
+	struct HashTableKeyFirst
+	{
+		const KEY_TYPE& operator()(const Pair<KEY_TYPE, VALUE_TYPE>& value) const { return value.first; }
+	};
+
+	/**
+	 * Hash table using robin hood hashing.
+	 * Values are stored densely so iteration is linear over memory, and are indexed by an
+	 * open addressed table of buckets. Each bucket stores the full hash of its value, which
+	 * avoids recalculating hashes when probing or rehashing.
+	 * Erase moves the last value into the erased slot, so it is O(1) but does not preserve order.
+	 * @param KEY_TYPE Type of key.
+	 * @param VALUE_TYPE Type of value stored.
+	 * @param KEY_OF Functor to get key from a stored value.
+	 */
+	template<typename KEY_TYPE, typename VALUE_TYPE, typename KEY_OF, typename HASHER = Hasher<KEY_TYPE>,
+	    typename ALLOCATOR = Allocator>
+	class HashTable
+	{
+	public:
+		using index_type = i32;
+		using key_type = KEY_TYPE;
+		using value_type = VALUE_TYPE;
+		using iterator = value_type*;
+		using const_iterator = const value_type*;
+
+		static const index_type INVALID_INDEX = (index_type)-1;
+		static const index_type MIN_BUCKETS = 8;
+
+		HashTable() = default;
+		explicit HashTable(const ALLOCATOR& allocator)
+		    : values_(allocator)
+		    , hashes_(allocator)
+		    , buckets_(allocator)
+		{
+		}
+		HashTable(const HashTable& other) = default;
+		HashTable(HashTable&& other) { swap(other); }
+		~HashTable() = default;
+
+		HashTable& operator=(const HashTable& other) = default;
+
+		HashTable& operator=(HashTable&& other)
+		{
+			swap(other);
+			return *this;
+		}
+
+		void swap(HashTable& other)
+		{
+			std::swap(values_, other.values_);
+			std::swap(hashes_, other.hashes_);
+			std::swap(buckets_, other.buckets_);
+			std::swap(mask_, other.mask_);
+			std::swap(maxSize_, other.maxSize_);
+			std::swap(maxLoadFactor_, other.maxLoadFactor_);
+		}
+
+		void clear()
+		{
+			values_.clear();
+			hashes_.clear();
+			for(auto& bucket : buckets_)
+				bucket.idx_ = INVALID_INDEX;
+		}
+
+		/**
+		 * Insert value.
+		 * If a value with the same key exists, it will be replaced.
+		 * @return Iterator to inserted value.
+		 */
+		iterator insert(const value_type& value)
+		{
+			const u32 hash = hashKey(keyOf_(value));
+			const index_type bucketIdx = findBucket(keyOf_(value), hash);
+			if(bucketIdx != INVALID_INDEX)
+			{
+				const index_type idx = buckets_[bucketIdx].idx_;
+				values_[idx] = value;
+				return values_.data() + idx;
+			}
+			return internalInsert(hash, value);
+		}
+
+		/**
+		 * Insert value.
+		 * If a value with the same key exists, it will be replaced.
+		 * @return Iterator to inserted value.
+		 */
+		iterator insert(value_type&& value)
+		{
+			const u32 hash = hashKey(keyOf_(value));
+			const index_type bucketIdx = findBucket(keyOf_(value), hash);
+			if(bucketIdx != INVALID_INDEX)
+			{
+				const index_type idx = buckets_[bucketIdx].idx_;
+				values_[idx] = std::move(value);
+				return values_.data() + idx;
+			}
+			return internalInsert(hash, std::move(value));
+		}
+
+		/**
+		 * Erase value.
+		 * The last value is moved into the erased position.
+		 * @return Iterator to the value now in the erased position, or end().
+		 */
+		iterator erase(iterator it)
+		{
+			DBG_ASSERT_MSG(it >= begin() && it < end(), "Invalid iterator.");
+			const index_type idx = (index_type)(it - begin());
+			const index_type lastIdx = values_.size() - 1;
+
+			removeBucket(findBucketForIndex(hashes_[idx], idx));
+
+			if(idx != lastIdx)
+			{
+				buckets_[findBucketForIndex(hashes_[lastIdx], lastIdx)].idx_ = idx;
+				values_[idx] = std::move(values_[lastIdx]);
+				hashes_[idx] = hashes_[lastIdx];
+			}
+			values_.pop_back();
+			hashes_.pop_back();
+			return values_.data() + idx;
+		}
+
+		/**
+		 * Erase value by key.
+		 * @return true if value was found and erased.
+		 */
+		bool erase(const KEY_TYPE& key)
+		{
+			iterator it = find(key);
+			if(it != end())
+			{
+				erase(it);
+				return true;
+			}
+			return false;
+		}
+
+		iterator find(const KEY_TYPE& key)
+		{
+			const index_type bucketIdx = findBucket(key, hashKey(key));
+			if(bucketIdx != INVALID_INDEX)
+				return values_.data() + buckets_[bucketIdx].idx_;
+			return end();
+		}
+
+		const_iterator find(const KEY_TYPE& key) const
+		{
+			const index_type bucketIdx = findBucket(key, hashKey(key));
+			if(bucketIdx != INVALID_INDEX)
+				return values_.data() + buckets_[bucketIdx].idx_;
+			return end();
+		}
+
+		/**
+		 * Reserve space for @a size values without rehashing.
+		 */
+		void reserve(index_type size)
+		{
+			values_.reserve(size);
+			hashes_.reserve(size);
+			if(size > maxSize_)
+				rehash(getBucketCountForSize(size));
+		}
+
+		/**
+		 * Rebuild buckets.
+		 * @param numBuckets Number of buckets. Will be rounded up to a power of two large enough to hold size().
+		 */
+		void rehash(index_type numBuckets)
+		{
+			const index_type minBuckets = getBucketCountForSize(values_.size());
+			index_type newNumBuckets = MIN_BUCKETS;
+			while(newNumBuckets < numBuckets || newNumBuckets < minBuckets)
+				newNumBuckets *= 2;
+
+			buckets_.clear();
+			buckets_.resize(newNumBuckets, Bucket());
+			mask_ = newNumBuckets - 1;
+			maxSize_ = getMaxSizeForBucketCount(newNumBuckets);
+
+			for(index_type idx = 0; idx < hashes_.size(); ++idx)
+				insertBucket(hashes_[idx], idx);
+		}
+
+		/**
+		 * Set maximum load factor before buckets are grown.
+		 * @pre maxLoadFactor > 0.0f && maxLoadFactor < 1.0f.
+		 */
+		void max_load_factor(f32 maxLoadFactor)
+		{
+			DBG_ASSERT(maxLoadFactor > 0.0f && maxLoadFactor < 1.0f);
+			maxLoadFactor_ = maxLoadFactor;
+			if(buckets_.size() > 0)
+				rehash(buckets_.size());
+		}
+
+		f32 max_load_factor() const { return maxLoadFactor_; }
+		f32 load_factor() const { return buckets_.size() > 0 ? (f32)values_.size() / (f32)buckets_.size() : 0.0f; }
+		index_type bucket_count() const { return buckets_.size(); }
+
+		iterator begin() { return values_.data(); }
+		const_iterator begin() const { return values_.data(); }
+		iterator end() { return values_.data() + values_.size(); }
+		const_iterator end() const { return values_.data() + values_.size(); }
+
+		index_type size() const { return values_.size(); }
+		bool empty() const { return values_.size() == 0; }
+
+	private:
+		struct Bucket
+		{
+			u32 hash_ = 0;
+			index_type idx_ = INVALID_INDEX;
+		};
+
+		/**
+		 * Hash key and mix, so weak hashes (i.e. integers hashing to themselves) still spread across buckets.
+		 */
+		u32 hashKey(const KEY_TYPE& key) const
+		{
+			u32 hash = hasher_(0, key);
+			hash ^= hash >> 16;
+			hash *= 0x85ebca6b;
+			hash ^= hash >> 13;
+			hash *= 0xc2b2ae35;
+			hash ^= hash >> 16;
+			return hash;
+		}
+
+		index_type getProbeDistance(u32 hash, index_type bucketIdx) const
+		{
+			return (bucketIdx - (index_type)(hash & mask_)) & mask_;
+		}
+
+		index_type getMaxSizeForBucketCount(index_type numBuckets) const
+		{
+			index_type maxSize = (index_type)((f32)numBuckets * maxLoadFactor_);
+			// Always leave at least one bucket empty so probing terminates.
+			return maxSize < numBuckets ? maxSize : numBuckets - 1;
+		}
+
+		index_type getBucketCountForSize(index_type size) const
+		{
+			index_type numBuckets = MIN_BUCKETS;
+			while(getMaxSizeForBucketCount(numBuckets) < size)
+				numBuckets *= 2;
+			return numBuckets;
+		}
+
+		index_type findBucket(const KEY_TYPE& key, u32 hash) const
+		{
+			if(values_.size() == 0)
+				return INVALID_INDEX;
+
+			index_type bucketIdx = hash & mask_;
+			for(index_type dist = 0;; ++dist)
+			{
+				const Bucket& bucket = buckets_[bucketIdx];
+				// Robin hood invariant: if we've probed further than this bucket's value did, key isn't present.
+				if(bucket.idx_ == INVALID_INDEX || dist > getProbeDistance(bucket.hash_, bucketIdx))
+					return INVALID_INDEX;
+				if(bucket.hash_ == hash && keyOf_(values_[bucket.idx_]) == key)
+					return bucketIdx;
+				bucketIdx = (bucketIdx + 1) & mask_;
+			}
+		}
+
+		index_type findBucketForIndex(u32 hash, index_type idx) const
+		{
+			index_type bucketIdx = hash & mask_;
+			while(buckets_[bucketIdx].idx_ != idx)
+			{
+				DBG_ASSERT(buckets_[bucketIdx].idx_ != INVALID_INDEX);
+				bucketIdx = (bucketIdx + 1) & mask_;
+			}
+			return bucketIdx;
+		}
+
+		void insertBucket(u32 hash, index_type idx)
+		{
+			Bucket inserting;
+			inserting.hash_ = hash;
+			inserting.idx_ = idx;
+
+			index_type bucketIdx = hash & mask_;
+			index_type dist = 0;
+			for(;;)
+			{
+				Bucket& bucket = buckets_[bucketIdx];
+				if(bucket.idx_ == INVALID_INDEX)
+				{
+					bucket = inserting;
+					return;
+				}
+
+				// Take from the rich: swap out any value closer to its ideal bucket than we are.
+				const index_type existingDist = getProbeDistance(bucket.hash_, bucketIdx);
+				if(existingDist < dist)
+				{
+					std::swap(bucket, inserting);
+					dist = existingDist;
+				}
+
+				bucketIdx = (bucketIdx + 1) & mask_;
+				++dist;
+			}
+		}
+
+		void removeBucket(index_type bucketIdx)
+		{
+			// Backward shift deletion, avoids the need for tombstones.
+			for(;;)
+			{
+				const index_type nextIdx = (bucketIdx + 1) & mask_;
+				const Bucket& next = buckets_[nextIdx];
+				if(next.idx_ == INVALID_INDEX || getProbeDistance(next.hash_, nextIdx) == 0)
+				{
+					buckets_[bucketIdx].idx_ = INVALID_INDEX;
+					return;
+				}
+				buckets_[bucketIdx] = next;
+				bucketIdx = nextIdx;
+			}
+		}
+
+		template<typename VAL_TYPE>
+		iterator internalInsert(u32 hash, VAL_TYPE&& value)
+		{
+			if(values_.size() >= maxSize_)
+				rehash(buckets_.size() * 2);
+
+			const index_type idx = values_.size();
+			values_.push_back(std::forward<VAL_TYPE>(value));
+			hashes_.push_back(hash);
+			insertBucket(hash, idx);
+			return values_.data() + idx;
+		}
+
+		Vector<value_type, ALLOCATOR> values_;
+		Vector<u32, ALLOCATOR> hashes_;
+		Vector<Bucket, ALLOCATOR> buckets_;
+		index_type mask_ = 0;
+		index_type maxSize_ = 0;
+		f32 maxLoadFactor_ = 0.8f;
+
+		HASHER hasher_;
+		KEY_OF keyOf_;
+	};
+} // namespace Core
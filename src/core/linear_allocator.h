@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/allocator.h"
+
+namespace Core
+{
+	/**
+	 * Linear allocator.
+	 * Bump allocates from a fixed block of memory, and frees everything at once with Reset. Suited to
+	 * per-frame containers: allocation is a few instructions, and freeing them is free.
+	 * Allocate and Deallocate are thread safe. Reset and GetMarker must not be called while
+	 * other threads are allocating.
+	 */
+	class CORE_DLL LinearAllocator final : public IAllocator
+	{
+	public:
+		/// Position to reset back to.
+		using Marker = i64;
+
+		/**
+		 * @param capacity Size of memory block in bytes.
+		 */
+		LinearAllocator(i64 capacity);
+		~LinearAllocator();
+
+		/**
+		 * Allocate memory.
+		 * @return Memory, or nullptr if there isn't enough left.
+		 */
+		void* Allocate(i64 size, i64 align) override;
+
+		/**
+		 * Deallocate memory. Only the most recent allocation is reclaimed, the rest waits for Reset.
+		 */
+		void Deallocate(void* mem, i64 size) override;
+
+		/**
+		 * @return Marker for the current position.
+		 */
+		Marker GetMarker() const { return offset_; }
+
+		/**
+		 * Free everything allocated since @a marker was taken.
+		 */
+		void Reset(Marker marker = 0);
+
+		/// @return Bytes in use, including alignment padding.
+		i64 GetUsage() const { return offset_; }
+		/// @return Size of memory block in bytes.
+		i64 GetCapacity() const { return capacity_; }
+
+	private:
+		LinearAllocator(const LinearAllocator&) = delete;
+		LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+		u8* base_ = nullptr;
+		i64 capacity_ = 0;
+		volatile i64 offset_ = 0;
+	};
+
+} // namespace Core
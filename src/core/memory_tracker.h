@@ -0,0 +1,194 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/types.h"
+#include "core/allocator.h"
+
+namespace Core
+{
+	/**
+	 * Subsystem an allocation is made on behalf of.
+	 */
+	enum class MemoryTag : i32
+	{
+		UNTAGGED = 0,
+		CORE,
+		JOB,
+		RESOURCE,
+		GPU,
+		GRAPHICS,
+		IMGUI,
+		SERIALIZATION,
+
+		MAX
+	};
+
+	CORE_DLL const char* EnumToString(MemoryTag val);
+
+	/**
+	 * Snapshot of counters for a tag.
+	 */
+	struct MemoryTagStats
+	{
+		/// Bytes currently allocated.
+		i64 liveBytes_ = 0;
+		/// Highest liveBytes_ since start, or the last ResetPeak.
+		i64 peakBytes_ = 0;
+		/// Allocations currently live.
+		i64 numLiveAllocs_ = 0;
+		/// Allocations made in total.
+		i64 numTotalAllocs_ = 0;
+		/// Budget in bytes. 0 if none.
+		i64 budgetBytes_ = 0;
+	};
+
+	/**
+	 * Allocation with a sampled callstack, for leak hunting.
+	 */
+	struct MemorySample
+	{
+		static const i32 MAX_FRAMES = 16;
+
+		MemoryTag tag_ = MemoryTag::UNTAGGED;
+		const void* mem_ = nullptr;
+		i64 bytes_ = 0;
+		i32 numFrames_ = 0;
+		void* frames_[MAX_FRAMES] = {};
+	};
+
+	/**
+	 * Counts live and peak bytes per MemoryTag, with budgets and optional callstack sampling.
+	 * Allocators report to it with TrackAlloc/TrackDealloc. Use TaggedAllocator for containers, and
+	 * TrackedAllocator to tag an IAllocator.
+	 * Each thread counts into its own counters, which are added to the global ones every 64KB of change,
+	 * so tracking doesn't add atomics to most allocations. GetStats sums them, so is exact once threads
+	 * are idle. Peak may be overestimated by up to 64KB per thread allocating with the tag.
+	 * Callstack sampling is off by default, and takes a lock for sampled allocations when enabled.
+	 * Thread safe.
+	 */
+	class CORE_DLL MemoryTracker final
+	{
+	public:
+		/**
+		 * Record an allocation.
+		 * @param tag Tag to count against.
+		 * @param mem Allocated memory. Only used for callstack sampling.
+		 * @param bytes Size in bytes.
+		 */
+		static void TrackAlloc(MemoryTag tag, const void* mem, i64 bytes);
+
+		/**
+		 * Record a deallocation.
+		 * @param tag Tag passed to TrackAlloc.
+		 * @param mem Memory passed to TrackAlloc.
+		 * @param bytes Size passed to TrackAlloc.
+		 */
+		static void TrackDealloc(MemoryTag tag, const void* mem, i64 bytes);
+
+		/**
+		 * @return Counters for @a tag.
+		 */
+		static MemoryTagStats GetStats(MemoryTag tag);
+
+		/**
+		 * Reset peak bytes for @a tag to its current live bytes.
+		 */
+		static void ResetPeak(MemoryTag tag);
+
+		/**
+		 * Set budget for @a tag.
+		 * @param bytes Budget in bytes, 0 for none.
+		 */
+		static void SetBudget(MemoryTag tag, i64 bytes);
+
+		/**
+		 * @return Is @a tag over its budget?
+		 */
+		static bool IsOverBudget(MemoryTag tag);
+
+		/**
+		 * Get tags over budget.
+		 * @param outTags Array to fill. Can be nullptr to just count.
+		 * @param maxTags Size of @a outTags.
+		 * @return Number of tags over budget.
+		 */
+		static i32 GetOverBudget(MemoryTag* outTags, i32 maxTags);
+
+		/**
+		 * Set how often allocations have their callstack captured.
+		 * Changing it clears existing samples.
+		 * @param sampleRate Capture every Nth allocation, per tag and thread. 0 to disable.
+		 */
+		static void SetCallstackSampleRate(i32 sampleRate);
+
+		/**
+		 * Get live allocations that had their callstack captured.
+		 * @param tag Tag to get samples for, or MemoryTag::MAX for all.
+		 * @param outSamples Array to fill. Can be nullptr to just count.
+		 * @param maxSamples Size of @a outSamples.
+		 * @return Number of live samples.
+		 */
+		static i32 GetSamples(MemoryTag tag, MemorySample* outSamples, i32 maxSamples);
+
+	private:
+		MemoryTracker() = delete;
+		~MemoryTracker() = delete;
+	};
+
+	/**
+	 * Container allocator that allocates from the heap, as Allocator does, and tracks against TAG.
+	 */
+	template<MemoryTag TAG>
+	class TaggedAllocator
+	{
+	public:
+		using index_type = i32;
+
+		void* allocate(index_type count, index_type size)
+		{
+			const i64 bytes = (i64)count * (i64)size;
+			void* mem = ::new u8[bytes];
+			MemoryTracker::TrackAlloc(TAG, mem, bytes);
+			return mem;
+		}
+
+		void deallocate(void* mem, index_type count, index_type size)
+		{
+			if(mem == nullptr)
+				return;
+			MemoryTracker::TrackDealloc(TAG, mem, (i64)count * (i64)size);
+			delete[] static_cast<u8*>(mem);
+		}
+	};
+
+	/**
+	 * Tracks allocations from another allocator against a tag.
+	 * Thread safe if the backing allocator is.
+	 */
+	class CORE_DLL TrackedAllocator final : public IAllocator
+	{
+	public:
+		/**
+		 * @param tag Tag to track against.
+		 * @param backing Allocator to allocate from. Must outlive this.
+		 */
+		TrackedAllocator(MemoryTag tag, IAllocator& backing)
+		    : tag_(tag)
+		    , backing_(backing)
+		{
+		}
+
+		void* Allocate(i64 size, i64 align) override;
+		void Deallocate(void* mem, i64 size) override;
+
+		MemoryTag GetTag() const { return tag_; }
+
+	private:
+		TrackedAllocator(const TrackedAllocator&) = delete;
+		TrackedAllocator& operator=(const TrackedAllocator&) = delete;
+
+		MemoryTag tag_;
+		IAllocator& backing_;
+	};
+
+} // namespace Core
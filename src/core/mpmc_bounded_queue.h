@@ -64,58 +64,90 @@ namespace Core
 		 * Enqueue data.
 		 * @return Successfully queued.
 		 */
-		bool Enqueue(const TYPE& data)
+		bool Enqueue(const TYPE& data) { return Enqueue(&data, 1) == 1; }
+
+		/**
+		 * Enqueue several.
+		 * Claims as many consecutive cells as are free with a single atomic operation.
+		 * @return Number queued, less than @a count if the queue filled.
+		 */
+		i32 Enqueue(const TYPE* data, i32 count)
 		{
-			Cell* cell = nullptr;
-			i32 pos = Core::AtomicCmpExchg(&enqueuePos_, 0, 0);
-			for(;;)
+			i32 pos = Core::AtomicLoadAcq(&enqueuePos_);
+			i32 numClaimed = 0;
+			while(count > 0)
 			{
-				cell = &buffer_[pos & bufferMask_];
-				i32 seq = Core::AtomicCmpExchgAcq(&cell->sequence_, 0, 0);
-				i32 dif = seq - pos;
-				if(dif == 0)
+				i32 dif = 0;
+				for(numClaimed = 0; numClaimed < count; ++numClaimed)
 				{
-					if(Core::AtomicCmpExchg(&enqueuePos_, pos + 1, pos) == pos)
+					const i32 cellPos = pos + numClaimed;
+					dif = Core::AtomicLoadAcq(&buffer_[cellPos & bufferMask_].sequence_) - cellPos;
+					if(dif != 0)
+						break;
+				}
+
+				if(numClaimed > 0)
+				{
+					if(Core::AtomicCmpExchg(&enqueuePos_, pos + numClaimed, pos) == pos)
 						break;
 				}
 				else if(dif < 0)
-					return false;
-				else
-					pos = Core::AtomicCmpExchg(&enqueuePos_, 0, 0);
+					return 0;
+				pos = Core::AtomicLoadAcq(&enqueuePos_);
 			}
-			cell->data_ = data;
-			Core::Barrier();
-			cell->sequence_ = pos + 1;
-			return true;
+
+			for(i32 i = 0; i < numClaimed; ++i)
+			{
+				Cell& cell = buffer_[(pos + i) & bufferMask_];
+				cell.data_ = data[i];
+				Core::AtomicStoreRel(&cell.sequence_, pos + i + 1);
+			}
+			return numClaimed;
 		}
 
 		/**
 		 * Dequeue data.
 		 * @return Successfully dequeued.
 		 */
-		bool Dequeue(TYPE& data)
+		bool Dequeue(TYPE& data) { return Dequeue(&data, 1) == 1; }
+
+		/**
+		 * Dequeue several.
+		 * Claims as many consecutive cells as are ready with a single atomic operation.
+		 * @return Number dequeued.
+		 */
+		i32 Dequeue(TYPE* data, i32 maxCount)
 		{
-			Cell* cell = nullptr;
-			i32 pos = Core::AtomicCmpExchg(&dequeuePos_, 0, 0);
-			for(;;)
+			i32 pos = Core::AtomicLoadAcq(&dequeuePos_);
+			i32 numClaimed = 0;
+			while(maxCount > 0)
 			{
-				cell = &buffer_[pos & bufferMask_];
-				i32 seq = Core::AtomicCmpExchgAcq(&cell->sequence_, 0, 0);
-				i32 dif = seq - (pos + 1);
-				if(dif == 0)
+				i32 dif = 0;
+				for(numClaimed = 0; numClaimed < maxCount; ++numClaimed)
 				{
-					if(Core::AtomicCmpExchg(&dequeuePos_, pos + 1, pos) == pos)
+					const i32 cellPos = pos + numClaimed;
+					dif = Core::AtomicLoadAcq(&buffer_[cellPos & bufferMask_].sequence_) - (cellPos + 1);
+					if(dif != 0)
+						break;
+				}
+
+				if(numClaimed > 0)
+				{
+					if(Core::AtomicCmpExchg(&dequeuePos_, pos + numClaimed, pos) == pos)
 						break;
 				}
 				else if(dif < 0)
-					return false;
-				else
-					pos = Core::AtomicCmpExchg(&dequeuePos_, 0, 0);
+					return 0;
+				pos = Core::AtomicLoadAcq(&dequeuePos_);
 			}
-			data = cell->data_;
-			Core::Barrier();
-			cell->sequence_ = pos + bufferMask_ + 1;
-			return true;
+
+			for(i32 i = 0; i < numClaimed; ++i)
+			{
+				Cell& cell = buffer_[(pos + i) & bufferMask_];
+				data[i] = cell.data_;
+				Core::AtomicStoreRel(&cell.sequence_, pos + i + bufferMask_ + 1);
+			}
+			return numClaimed;
 		}
 
 	private:
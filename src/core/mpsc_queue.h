@@ -0,0 +1,198 @@
+#pragma once
+
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/misc.h"
+#include "core/mpmc_bounded_queue.h"
+
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Multi-producer/single-consumer unbounded queue.
+	 * Enqueue is lock free and never fails. Dequeue must only be called from one thread at a time.
+	 * Values are stored in segments of up to SEGMENT_SIZE, linked with Dmitry Vyukov's intrusive MPSC
+	 * queue, so publishing a segment is a single atomic exchange however many values it holds. Batch
+	 * Enqueue fills whole segments; single Enqueue uses a segment per value. Consumed segments are
+	 * pooled for reuse by producers, so steady state use doesn't allocate.
+	 * http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+	 */
+	template<typename TYPE>
+	class MPSCQueue
+	{
+	public:
+		static const i32 SEGMENT_SIZE = 32;
+		static const i32 MAX_POOLED_SEGMENTS = 64;
+
+		MPSCQueue()
+		    : pool_(MAX_POOLED_SEGMENTS)
+		{
+			head_ = &stub_;
+			tail_ = &stub_;
+		}
+
+		~MPSCQueue()
+		{
+			TYPE data;
+			while(Dequeue(data))
+				;
+			Segment* segment = nullptr;
+			while(pool_.Dequeue(segment))
+				delete segment;
+			delete current_;
+		}
+
+		/**
+		 * Enqueue data.
+		 */
+		void Enqueue(const TYPE& data)
+		{
+			Segment* segment = AllocSegment();
+			segment->data_[0] = data;
+			segment->size_ = 1;
+			Push(segment, segment);
+		}
+
+		/**
+		 * Enqueue several, publishing them all with one atomic operation.
+		 */
+		void Enqueue(const TYPE* data, i32 count)
+		{
+			if(count <= 0)
+				return;
+
+			// Link segments privately, then publish the chain.
+			Segment* first = nullptr;
+			Segment* last = nullptr;
+			for(i32 i = 0; i < count; i += SEGMENT_SIZE)
+			{
+				Segment* segment = AllocSegment();
+				const i32 size = Core::Min(count - i, SEGMENT_SIZE);
+				for(i32 j = 0; j < size; ++j)
+					segment->data_[j] = data[i + j];
+				segment->size_ = size;
+				if(last)
+					last->next_ = segment;
+				else
+					first = segment;
+				last = segment;
+			}
+			Push(first, last);
+		}
+
+		/**
+		 * Dequeue data. Consumer thread only.
+		 * @return Successfully dequeued. May fail while a producer is part way through Enqueue.
+		 */
+		bool Dequeue(TYPE& data) { return Dequeue(&data, 1) == 1; }
+
+		/**
+		 * Dequeue several. Consumer thread only.
+		 * @return Number dequeued.
+		 */
+		i32 Dequeue(TYPE* data, i32 maxCount)
+		{
+			i32 numDequeued = 0;
+			while(numDequeued < maxCount)
+			{
+				if(current_ == nullptr || currentPos_ == current_->size_)
+				{
+					if(current_)
+						FreeSegment(current_);
+					currentPos_ = 0;
+					current_ = Pop();
+					if(current_ == nullptr)
+						break;
+				}
+				while(numDequeued < maxCount && currentPos_ < current_->size_)
+					data[numDequeued++] = std::move(current_->data_[currentPos_++]);
+			}
+			return numDequeued;
+		}
+
+	private:
+		MPSCQueue(const MPSCQueue&) = delete;
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+		struct Segment
+		{
+			Segment* volatile next_ = nullptr;
+			i32 size_ = 0;
+			TYPE data_[SEGMENT_SIZE];
+		};
+
+		Segment* AllocSegment()
+		{
+			Segment* segment = nullptr;
+			if(!pool_.Dequeue(segment))
+				segment = new Segment();
+			segment->next_ = nullptr;
+			return segment;
+		}
+
+		void FreeSegment(Segment* segment)
+		{
+			if(!pool_.Enqueue(segment))
+				delete segment;
+		}
+
+		/// Publish a privately linked chain of segments.
+		void Push(Segment* first, Segment* last)
+		{
+			last->next_ = nullptr;
+			auto* prev = (Segment*)Core::AtomicExchg((void* volatile*)&head_, last);
+			// Consumer can't see first until this, so a Pop in between returns nullptr.
+			Core::AtomicStoreRel((void* volatile*)&prev->next_, first);
+		}
+
+		/// @return Oldest segment, or nullptr.
+		Segment* Pop()
+		{
+			Segment* tail = tail_;
+			Segment* next = (Segment*)Core::AtomicLoadAcq((void* const volatile*)&tail->next_);
+			if(tail == &stub_)
+			{
+				if(next == nullptr)
+					return nullptr;
+				tail_ = next;
+				tail = next;
+				next = (Segment*)Core::AtomicLoadAcq((void* const volatile*)&tail->next_);
+			}
+			if(next)
+			{
+				tail_ = next;
+				return tail;
+			}
+
+			// tail is the last segment, unless a producer is part way through Push.
+			if(tail != (Segment*)Core::AtomicLoadAcq((void* const volatile*)&head_))
+				return nullptr;
+
+			// Push the stub so tail gets a successor and can be removed.
+			Push(&stub_, &stub_);
+			next = (Segment*)Core::AtomicLoadAcq((void* const volatile*)&tail->next_);
+			if(next)
+			{
+				tail_ = next;
+				return tail;
+			}
+			return nullptr;
+		}
+
+		typedef char CacheLinePad[CACHE_LINE_SIZE];
+
+		CacheLinePad pad0_ = {0};
+		/// Most recently pushed segment. Written by producers.
+		Segment* volatile head_ = nullptr;
+		CacheLinePad pad1_ = {0};
+		/// Oldest segment not yet popped. Consumer owned, as are current_ and currentPos_.
+		Segment* tail_ = nullptr;
+		Segment* current_ = nullptr;
+		i32 currentPos_ = 0;
+		CacheLinePad pad2_ = {0};
+		Segment stub_;
+		/// Consumed segments, for reuse.
+		MPMCBoundedQueue<Segment*> pool_;
+	};
+} // namespace Core
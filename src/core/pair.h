@@ -18,6 +18,9 @@ namespace Core
 		{
 		}
 
+		bool operator==(const Pair& other) const { return first == other.first && second == other.second; }
+		bool operator!=(const Pair& other) const { return first != other.first || second != other.second; }
+
 		FIRST_TYPE first;
 		SECOND_TYPE second;
 	};
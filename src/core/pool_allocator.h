@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/allocator.h"
+
+namespace Core
+{
+	/**
+	 * Pool allocator.
+	 * Allocates fixed size blocks from a preallocated pool using an intrusive free list, so allocate and
+	 * deallocate are O(1) and never fragment.
+	 * Not thread safe.
+	 */
+	class CORE_DLL PoolAllocator final : public IAllocator
+	{
+	public:
+		/**
+		 * @param blockSize Size of each block in bytes.
+		 * @param numBlocks Number of blocks in pool.
+		 * @param blockAlign Alignment of each block. Must be a power of two.
+		 */
+		PoolAllocator(i32 blockSize, i32 numBlocks, i32 blockAlign = PLATFORM_ALIGNMENT);
+		~PoolAllocator();
+
+		/**
+		 * Allocate a block.
+		 * @return Block, or nullptr if the pool is empty, or @a size or @a align are larger than a block's.
+		 */
+		void* Allocate(i64 size, i64 align) override;
+
+		/**
+		 * Return block to pool.
+		 */
+		void Deallocate(void* mem, i64 size) override;
+
+		/// @return Does @a mem belong to this pool?
+		bool Owns(const void* mem) const { return mem >= base_ && mem < base_ + (i64)blockSize_ * numBlocks_; }
+
+		/// @return Size of each block in bytes.
+		i32 GetBlockSize() const { return blockSize_; }
+		/// @return Number of free blocks.
+		i32 GetNumFree() const { return numFree_; }
+
+	private:
+		PoolAllocator(const PoolAllocator&) = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+		struct FreeBlock
+		{
+			FreeBlock* next_;
+		};
+
+		u8* memory_ = nullptr;
+		u8* base_ = nullptr;
+		i32 blockSize_ = 0;
+		i32 blockAlign_ = 0;
+		i32 numBlocks_ = 0;
+		i32 numFree_ = 0;
+		FreeBlock* freeList_ = nullptr;
+	};
+
+} // namespace Core
@@ -72,6 +72,14 @@
 #define CACHE_LINE_SIZE 64
 #define PLATFORM_ALIGNMENT 16
 
+// ARM64
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ARCH_ARM64 1
+#define ENDIAN_LITTLE 1
+#define ENDIAN_BIG 0
+#define CACHE_LINE_SIZE 64
+#define PLATFORM_ALIGNMENT 16
+
 // ARM
 #elif defined(__arm__) || defined(__ARM_ARCH_7A__) || defined(__ARM_ARCH_7S__) || defined(TARGET_OS_IPHONE) ||         \
     defined(_M_ARM)
@@ -0,0 +1,409 @@
+#include "core/compression.h"
+#include "core/debug.h"
+#include "core/misc.h"
+#include "core/vector.h"
+
+#if COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+#include <cstring>
+
+namespace Core
+{
+	namespace
+	{
+		/**
+		 * LZ4 block format: a run of sequences, each a token byte (literal count in the high nibble, match
+		 * length - MIN_MATCH in the low), literals, a 2 byte offset back into the output, then the match.
+		 * Counts of 15 or more continue in following bytes. The last sequence is literals only.
+		 */
+		const i32 LZ4_MIN_MATCH = 4;
+		/// Last bytes of a block are always literals.
+		const i32 LZ4_LAST_LITERALS = 5;
+		/// Last match must start at least this far from the end of a block.
+		const i32 LZ4_MF_LIMIT = 12;
+		const i32 LZ4_MAX_OFFSET = 65535;
+		const i32 LZ4_HASH_BITS = 12;
+		const i32 LZ4_CHAIN_HASH_BITS = 15;
+		const u32 LZ4_CHAIN_INVALID = 0xffffffff;
+
+		inline u32 LZ4Read32(const u8* src)
+		{
+			u32 value;
+			memcpy(&value, src, sizeof(value));
+			return value;
+		}
+
+		inline u32 LZ4Hash(u32 value) { return (value * 2654435761U) >> (32 - LZ4_HASH_BITS); }
+
+		/// Write a count continued past the token: 255s, then the remainder.
+		inline u8* LZ4WriteLength(u8* dest, i64 length)
+		{
+			for(; length >= 255; length -= 255)
+				*dest++ = 255;
+			*dest++ = (u8)length;
+			return dest;
+		}
+
+		/// Write sequence, or literals only if @a matchLength is 0. @return End of sequence, or nullptr if full.
+		u8* LZ4WriteSequence(u8* dest, const u8* destEnd, const u8* literals, i64 numLiterals, i64 offset,
+		    i64 matchLength)
+		{
+			const i64 maxSize = 1 + (numLiterals / 255 + 1) + numLiterals + 2 + (matchLength / 255 + 1);
+			if(maxSize > destEnd - dest)
+				return nullptr;
+
+			u8* token = dest++;
+			*token = (u8)(Min(numLiterals, 15) << 4);
+			if(numLiterals >= 15)
+				dest = LZ4WriteLength(dest, numLiterals - 15);
+			if(numLiterals > 0)
+				memcpy(dest, literals, numLiterals);
+			dest += numLiterals;
+
+			if(matchLength > 0)
+			{
+				*dest++ = (u8)(offset & 0xff);
+				*dest++ = (u8)(offset >> 8);
+				const i64 matchCode = matchLength - LZ4_MIN_MATCH;
+				*token |= (u8)Min(matchCode, 15);
+				if(matchCode >= 15)
+					dest = LZ4WriteLength(dest, matchCode - 15);
+			}
+			return dest;
+		}
+
+		/// @return Index of the first non-zero byte of @a diff, in memory order (little endian).
+		inline i32 LZ4FirstDifferentByte(u64 diff)
+		{
+#if COMPILER_MSVC
+			unsigned long idx = 0;
+			if(_BitScanForward(&idx, (u32)diff))
+				return (i32)idx >> 3;
+			_BitScanForward(&idx, (u32)(diff >> 32));
+			return ((i32)idx + 32) >> 3;
+#else
+			return __builtin_ctzll(diff) >> 3;
+#endif
+		}
+
+		/// @return Number of bytes that match from @a a and @a b, stopping at @a aLimit. 8 bytes at a time.
+		inline i64 LZ4Count(const u8* a, const u8* b, const u8* aLimit)
+		{
+			const u8* aStart = a;
+			for(; (aLimit - a) >= 8; a += 8, b += 8)
+			{
+				u64 aValue, bValue;
+				memcpy(&aValue, a, sizeof(aValue));
+				memcpy(&bValue, b, sizeof(bValue));
+				if(aValue != bValue)
+					return (a - aStart) + LZ4FirstDifferentByte(aValue ^ bValue);
+			}
+			for(; a < aLimit && *a == *b; ++a, ++b)
+			{
+			}
+			return a - aStart;
+		}
+
+		/// Greedy compression, taking the first match found in a single entry hash table.
+		i64 CompressLZ4Fast(u8* dest, i64 destSize, const u8* src, i64 srcSize)
+		{
+			u8* destPos = dest;
+			const u8* destEnd = dest + destSize;
+			i64 anchor = 0;
+
+			if(srcSize > LZ4_MF_LIMIT)
+			{
+				// Last position seen for each hash of 4 bytes. Colliding entries are rejected by comparing the bytes.
+				// On the heap rather than the stack, as compression is often run from jobs.
+				Vector<u32> table;
+				table.resize(1 << LZ4_HASH_BITS, 0);
+				const i64 matchStartLimit = srcSize - LZ4_MF_LIMIT;
+				const i64 matchEndLimit = srcSize - LZ4_LAST_LITERALS;
+
+				i64 pos = 1;
+				while(pos < matchStartLimit)
+				{
+					const u32 value = LZ4Read32(src + pos);
+					const u32 hash = LZ4Hash(value);
+					i64 candidate = table[hash];
+					table[hash] = (u32)pos;
+
+					if((pos - candidate) > LZ4_MAX_OFFSET || LZ4Read32(src + candidate) != value)
+					{
+						// Step further the longer we go without a match, so incompressible data is skipped quickly.
+						pos += 1 + ((pos - anchor) >> 6);
+						continue;
+					}
+
+					// Extend match backwards over literals, then forwards.
+					while(pos > anchor && candidate > 0 && src[pos - 1] == src[candidate - 1])
+					{
+						--pos;
+						--candidate;
+					}
+					const i64 matchLength = LZ4_MIN_MATCH + LZ4Count(src + pos + LZ4_MIN_MATCH,
+					                                            src + candidate + LZ4_MIN_MATCH, src + matchEndLimit);
+
+					destPos =
+					    LZ4WriteSequence(destPos, destEnd, src + anchor, pos - anchor, pos - candidate, matchLength);
+					if(!destPos)
+						return 0;
+
+					pos += matchLength;
+					anchor = pos;
+					if(pos < matchStartLimit)
+						table[LZ4Hash(LZ4Read32(src + pos - 2))] = (u32)(pos - 2);
+				}
+			}
+
+			destPos = LZ4WriteSequence(destPos, destEnd, src + anchor, srcSize - anchor, 0, 0);
+			if(!destPos)
+				return 0;
+			return destPos - dest;
+		}
+
+		/**
+		 * Hash chains: the most recent position for each hash, and for each position the distance back to the
+		 * previous one with the same hash, so every earlier match within LZ4_MAX_OFFSET can be visited.
+		 */
+		struct LZ4ChainTable
+		{
+			LZ4ChainTable()
+			{
+				head_.resize(1 << LZ4_CHAIN_HASH_BITS, LZ4_CHAIN_INVALID);
+				chain_.resize(LZ4_MAX_OFFSET + 1, 0);
+			}
+
+			/// Add positions before @a pos.
+			void InsertUpTo(const u8* src, i64 pos)
+			{
+				for(; next_ < pos; ++next_)
+				{
+					const u32 hash = (LZ4Read32(src + next_) * 2654435761U) >> (32 - LZ4_CHAIN_HASH_BITS);
+					const u32 prev = head_[hash];
+					const i64 distance = prev == LZ4_CHAIN_INVALID ? 0 : next_ - prev;
+					chain_[(i32)(next_ & LZ4_MAX_OFFSET)] = distance > LZ4_MAX_OFFSET ? 0 : (u16)distance;
+					head_[hash] = (u32)next_;
+				}
+			}
+
+			/// @return Length of longest match for @a pos, trying up to @a maxAttempts earlier positions.
+			i64 FindMatch(const u8* src, i64 pos, i64 matchEndLimit, i32 maxAttempts, i64& outMatchPos)
+			{
+				InsertUpTo(src, pos);
+
+				i64 bestLength = 0;
+				const u32 hash = (LZ4Read32(src + pos) * 2654435761U) >> (32 - LZ4_CHAIN_HASH_BITS);
+				const u32 head = head_[hash];
+				i64 candidate = head == LZ4_CHAIN_INVALID ? -1 : (i64)head;
+				for(i32 attempt = 0; attempt < maxAttempts && candidate >= 0 && (pos - candidate) <= LZ4_MAX_OFFSET;
+				    ++attempt)
+				{
+					// Only count if it could beat the best so far.
+					if(src[candidate + bestLength] == src[pos + bestLength])
+					{
+						const i64 length = LZ4Count(src + pos, src + candidate, src + matchEndLimit);
+						if(length > bestLength)
+						{
+							bestLength = length;
+							outMatchPos = candidate;
+							if((pos + length) == matchEndLimit)
+								break;
+						}
+					}
+
+					const u16 distance = chain_[(i32)(candidate & LZ4_MAX_OFFSET)];
+					if(distance == 0)
+						break;
+					candidate -= distance;
+				}
+				return bestLength >= LZ4_MIN_MATCH ? bestLength : 0;
+			}
+
+			Vector<u32> head_;
+			Vector<u16> chain_;
+			i64 next_ = 0;
+		};
+
+		/// Searches hash chains for the longest match, then looks ahead for a longer one. Higher levels search further.
+		i64 CompressLZ4Chain(u8* dest, i64 destSize, const u8* src, i64 srcSize, i32 level)
+		{
+			u8* destPos = dest;
+			const u8* destEnd = dest + destSize;
+			i64 anchor = 0;
+
+			if(srcSize > LZ4_MF_LIMIT)
+			{
+				LZ4ChainTable table;
+				const i32 maxAttempts = 1 << level;
+				const i64 matchStartLimit = srcSize - LZ4_MF_LIMIT;
+				const i64 matchEndLimit = srcSize - LZ4_LAST_LITERALS;
+
+				i64 pos = 0;
+				while(pos < matchStartLimit)
+				{
+					i64 matchPos = 0;
+					i64 matchLength = table.FindMatch(src, pos, matchEndLimit, maxAttempts, matchPos);
+					if(matchLength == 0)
+					{
+						++pos;
+						continue;
+					}
+
+					// Emit a literal instead if the next position starts a longer match.
+					while((pos + 1) < matchStartLimit)
+					{
+						i64 nextMatchPos = 0;
+						const i64 nextMatchLength =
+						    table.FindMatch(src, pos + 1, matchEndLimit, maxAttempts, nextMatchPos);
+						if(nextMatchLength <= matchLength)
+							break;
+						++pos;
+						matchLength = nextMatchLength;
+						matchPos = nextMatchPos;
+					}
+
+					destPos =
+					    LZ4WriteSequence(destPos, destEnd, src + anchor, pos - anchor, pos - matchPos, matchLength);
+					if(!destPos)
+						return 0;
+
+					pos += matchLength;
+					anchor = pos;
+				}
+			}
+
+			destPos = LZ4WriteSequence(destPos, destEnd, src + anchor, srcSize - anchor, 0, 0);
+			if(!destPos)
+				return 0;
+			return destPos - dest;
+		}
+
+		/// Read a count continued past the token. @return false if it runs off the end of @a src.
+		inline bool LZ4ReadLength(const u8*& src, const u8* srcEnd, i64& length)
+		{
+			u8 byte;
+			do
+			{
+				if(src >= srcEnd)
+					return false;
+				byte = *src++;
+				length += byte;
+			} while(byte == 255);
+			return true;
+		}
+
+		i64 DecompressLZ4(u8* dest, i64 destSize, const u8* src, i64 srcSize)
+		{
+			u8* destPos = dest;
+			const u8* srcEnd = src + srcSize;
+
+			while(src < srcEnd)
+			{
+				const u8 token = *src++;
+
+				i64 numLiterals = token >> 4;
+				if(numLiterals == 15 && !LZ4ReadLength(src, srcEnd, numLiterals))
+					return -1;
+				if(numLiterals > (srcEnd - src) || numLiterals > (destSize - (destPos - dest)))
+					return -1;
+				memcpy(destPos, src, numLiterals);
+				src += numLiterals;
+				destPos += numLiterals;
+
+				// Last sequence has no match.
+				if(src == srcEnd)
+					break;
+
+				if((srcEnd - src) < 2)
+					return -1;
+				const i64 offset = (i64)src[0] | ((i64)src[1] << 8);
+				src += 2;
+				if(offset == 0 || offset > (destPos - dest))
+					return -1;
+
+				i64 matchLength = token & 15;
+				if(matchLength == 15 && !LZ4ReadLength(src, srcEnd, matchLength))
+					return -1;
+				matchLength += LZ4_MIN_MATCH;
+				if(matchLength > (destSize - (destPos - dest)))
+					return -1;
+
+				// Matches can overlap the bytes they produce, i.e. an offset of 1 repeats the last byte.
+				const u8* match = destPos - offset;
+				if(offset >= matchLength)
+				{
+					memcpy(destPos, match, matchLength);
+					destPos += matchLength;
+				}
+				else if(offset >= 8)
+				{
+					u8* matchEnd = destPos + matchLength;
+					for(; (matchEnd - destPos) >= 8; destPos += 8, match += 8)
+						memcpy(destPos, match, 8);
+					while(destPos < matchEnd)
+						*destPos++ = *match++;
+				}
+				else
+				{
+					for(i64 idx = 0; idx < matchLength; ++idx)
+						*destPos++ = *match++;
+				}
+			}
+			return destPos - dest;
+		}
+	} // namespace
+
+	i64 CompressionBound(CompressionCodec codec, i64 srcSize)
+	{
+		switch(codec)
+		{
+		case CompressionCodec::NONE:
+			return srcSize;
+		case CompressionCodec::LZ4:
+			return srcSize + (srcSize / 255) + 16;
+		}
+		DBG_ASSERT_MSG(false, "Invalid codec %u.", (u32)codec);
+		return 0;
+	}
+
+	i64 Compress(CompressionCodec codec, void* dest, i64 destSize, const void* src, i64 srcSize, i32 level)
+	{
+		DBG_ASSERT(srcSize >= 0);
+		DBG_ASSERT(level >= COMPRESSION_LEVEL_FAST && level <= COMPRESSION_LEVEL_MAX);
+		switch(codec)
+		{
+		case CompressionCodec::NONE:
+			if(srcSize > destSize)
+				return 0;
+			if(srcSize > 0)
+				memcpy(dest, src, srcSize);
+			return srcSize;
+		case CompressionCodec::LZ4:
+			// Hash chains store positions as u32, so larger blocks use the fast level.
+			if(level == COMPRESSION_LEVEL_FAST || srcSize > 0xffffffffLL)
+				return CompressLZ4Fast((u8*)dest, destSize, (const u8*)src, srcSize);
+			return CompressLZ4Chain((u8*)dest, destSize, (const u8*)src, srcSize, level);
+		}
+		DBG_ASSERT_MSG(false, "Invalid codec %u.", (u32)codec);
+		return 0;
+	}
+
+	i64 Decompress(CompressionCodec codec, void* dest, i64 destSize, const void* src, i64 srcSize)
+	{
+		switch(codec)
+		{
+		case CompressionCodec::NONE:
+			if(srcSize > destSize)
+				return -1;
+			if(srcSize > 0)
+				memcpy(dest, src, srcSize);
+			return srcSize;
+		case CompressionCodec::LZ4:
+			return DecompressLZ4((u8*)dest, destSize, (const u8*)src, srcSize);
+		}
+		return -1;
+	}
+} // namespace Core
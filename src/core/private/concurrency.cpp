@@ -108,6 +108,9 @@ namespace Core
 
 	/// Use Fiber Local Storage to store current fiber.
 	static FLS thisFiber_;
+	/// Fiber stack initially committed. The rest of the requested size is only reserved, and committed as
+	/// the stack grows into it.
+	static const i32 FIBER_STACK_COMMIT_SIZE = 16 * 1024;
 
 	struct FiberImpl
 	{
@@ -143,7 +146,8 @@ namespace Core
 		impl_->parent_ = this;
 		impl_->entryPointFunc_ = entryPointFunc;
 		impl_->userData_ = userData;
-		impl_->fiber_ = ::CreateFiber(stackSize, FiberEntryPoint, impl_);
+		const SIZE_T commitSize = stackSize < FIBER_STACK_COMMIT_SIZE ? stackSize : FIBER_STACK_COMMIT_SIZE;
+		impl_->fiber_ = ::CreateFiberEx(commitSize, stackSize, 0, FiberEntryPoint, impl_);
 #ifdef DEBUG
 		impl_->debugName_ = debugName_;
 #endif
@@ -285,6 +289,45 @@ namespace Core
 		return !!::ResetEvent(impl_->handle_);
 	}
 
+	struct SemaphoreImpl
+	{
+		HANDLE handle_;
+#ifdef DEBUG
+		const char* debugName_ = nullptr;
+#endif
+	};
+
+	Semaphore::Semaphore(i32 initialCount, i32 maximumCount, const char* debugName)
+	{
+		DBG_ASSERT(initialCount >= 0);
+		DBG_ASSERT(maximumCount > 0);
+		impl_ = new SemaphoreImpl();
+		// NOTE: Don't set debug name on semaphore. If 2 names are the same, they'll reference the same semaphore.
+		impl_->handle_ = ::CreateSemaphore(nullptr, initialCount, maximumCount, nullptr);
+#ifdef DEBUG
+		impl_->debugName_ = debugName;
+#endif
+	}
+
+	Semaphore::~Semaphore()
+	{
+		::CloseHandle(impl_->handle_);
+		delete impl_;
+	}
+
+	bool Semaphore::Wait(i32 timeout)
+	{
+		DBG_ASSERT(impl_);
+		return (::WaitForSingleObject(impl_->handle_, timeout) == WAIT_OBJECT_0);
+	}
+
+	bool Semaphore::Signal(i32 count)
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(count > 0);
+		return !!::ReleaseSemaphore(impl_->handle_, count, nullptr);
+	}
+
 	struct MutexImpl
 	{
 		CRITICAL_SECTION critSec_;
@@ -333,117 +376,984 @@ namespace Core
 		::LeaveCriticalSection(&impl_->critSec_);
 	}
 
-	RWLock::RWLock() {}
+	struct TLSImpl
+	{
+		DWORD handle_ = 0;
+	};
 
-	RWLock::~RWLock()
+	TLS::TLS()
 	{
-		DBG_ASSERT(readCount_ == 0);
+		impl_ = new TLSImpl();
+		impl_->handle_ = TlsAlloc();
+	}
+
+	TLS::~TLS()
+	{
+		::TlsFree(impl_->handle_);
+		delete impl_;
+	}
+
+	bool TLS::Set(void* data)
+	{
+		DBG_ASSERT(impl_);
+		return !!::TlsSetValue(impl_->handle_, data);
+	}
+
+	void* TLS::Get() const
+	{
+		DBG_ASSERT(impl_);
+		return ::TlsGetValue(impl_->handle_);
+	}
+
+
+	struct FLSImpl
+	{
+		DWORD handle_ = 0;
+	};
+
+	FLS::FLS()
+	{
+		impl_ = new FLSImpl();
+		impl_->handle_ = FlsAlloc(nullptr);
+	}
+
+	FLS::~FLS()
+	{
+		::FlsFree(impl_->handle_);
+		delete impl_;
+	}
+
+	bool FLS::Set(void* data)
+	{
+		DBG_ASSERT(impl_);
+		return !!::FlsSetValue(impl_->handle_, data);
+	}
+
+	void* FLS::Get() const
+	{
+		DBG_ASSERT(impl_);
+		return ::FlsGetValue(impl_->handle_);
+	}
+
+} // namespace Core
+
+#elif PLATFORM_LINUX
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Fiber context switching.
+// CoreFiberSwitchContext(void** oldStackPointer, void* newStackPointer) pushes all callee saved registers
+// onto the current stack, stores the stack pointer to oldStackPointer, then pops the same set from
+// newStackPointer and returns into the new context.
+// CoreFiberTrampoline is the initial return address of a new fiber, and calls the entry point stored in
+// a callee saved register with the fiber passed in another.
+#if ARCH_X86_64
+// clang-format off
+asm(".text\n"
+    ".globl CoreFiberSwitchContext\n"
+    ".hidden CoreFiberSwitchContext\n"
+    ".type CoreFiberSwitchContext, @function\n"
+    ".align 16\n"
+    "CoreFiberSwitchContext:\n"
+    "	pushq %rbp\n"
+    "	pushq %rbx\n"
+    "	pushq %r12\n"
+    "	pushq %r13\n"
+    "	pushq %r14\n"
+    "	pushq %r15\n"
+    "	subq $8, %rsp\n"
+    "	stmxcsr (%rsp)\n"
+    "	fnstcw 4(%rsp)\n"
+    "	movq %rsp, (%rdi)\n"
+    "	movq %rsi, %rsp\n"
+    "	ldmxcsr (%rsp)\n"
+    "	fldcw 4(%rsp)\n"
+    "	addq $8, %rsp\n"
+    "	popq %r15\n"
+    "	popq %r14\n"
+    "	popq %r13\n"
+    "	popq %r12\n"
+    "	popq %rbx\n"
+    "	popq %rbp\n"
+    "	ret\n"
+    ".size CoreFiberSwitchContext, .-CoreFiberSwitchContext\n"
+    ".globl CoreFiberTrampoline\n"
+    ".hidden CoreFiberTrampoline\n"
+    ".type CoreFiberTrampoline, @function\n"
+    ".align 16\n"
+    "CoreFiberTrampoline:\n"
+    "	movq %r12, %rdi\n"
+    "	callq *%r13\n"
+    "	ud2\n"
+    ".size CoreFiberTrampoline, .-CoreFiberTrampoline\n");
+// clang-format on
+#elif ARCH_ARM64
+// clang-format off
+asm(".text\n"
+    ".globl CoreFiberSwitchContext\n"
+    ".hidden CoreFiberSwitchContext\n"
+    ".type CoreFiberSwitchContext, %function\n"
+    ".align 4\n"
+    "CoreFiberSwitchContext:\n"
+    "	sub sp, sp, #160\n"
+    "	stp x19, x20, [sp, #0]\n"
+    "	stp x21, x22, [sp, #16]\n"
+    "	stp x23, x24, [sp, #32]\n"
+    "	stp x25, x26, [sp, #48]\n"
+    "	stp x27, x28, [sp, #64]\n"
+    "	stp x29, x30, [sp, #80]\n"
+    "	stp d8, d9, [sp, #96]\n"
+    "	stp d10, d11, [sp, #112]\n"
+    "	stp d12, d13, [sp, #128]\n"
+    "	stp d14, d15, [sp, #144]\n"
+    "	mov x2, sp\n"
+    "	str x2, [x0]\n"
+    "	mov sp, x1\n"
+    "	ldp x19, x20, [sp, #0]\n"
+    "	ldp x21, x22, [sp, #16]\n"
+    "	ldp x23, x24, [sp, #32]\n"
+    "	ldp x25, x26, [sp, #48]\n"
+    "	ldp x27, x28, [sp, #64]\n"
+    "	ldp x29, x30, [sp, #80]\n"
+    "	ldp d8, d9, [sp, #96]\n"
+    "	ldp d10, d11, [sp, #112]\n"
+    "	ldp d12, d13, [sp, #128]\n"
+    "	ldp d14, d15, [sp, #144]\n"
+    "	add sp, sp, #160\n"
+    "	ret\n"
+    ".size CoreFiberSwitchContext, .-CoreFiberSwitchContext\n"
+    ".globl CoreFiberTrampoline\n"
+    ".hidden CoreFiberTrampoline\n"
+    ".type CoreFiberTrampoline, %function\n"
+    ".align 4\n"
+    "CoreFiberTrampoline:\n"
+    "	mov x0, x19\n"
+    "	blr x20\n"
+    "	brk #0\n"
+    ".size CoreFiberTrampoline, .-CoreFiberTrampoline\n");
+// clang-format on
+#else
+#error "Fiber context switch not implemented for architecture!"
+#endif
+
+extern "C" void CoreFiberSwitchContext(void** oldStackPointer, void* newStackPointer);
+extern "C" void CoreFiberTrampoline();
+
+namespace Core
+{
+	namespace
+	{
+		/// @return Monotonic time in nanoseconds.
+		i64 GetMonotonicTime()
+		{
+			timespec time;
+			::clock_gettime(CLOCK_MONOTONIC, &time);
+			return (i64)time.tv_sec * 1000000000LL + (i64)time.tv_nsec;
+		}
+
+		/// @return Deadline in nanoseconds for @a timeout in milliseconds. -1 if infinite.
+		i64 GetDeadline(i32 timeout) { return timeout < 0 ? -1 : GetMonotonicTime() + (i64)timeout * 1000000LL; }
+
+		/// @return Time remaining in nanoseconds until @a deadline. -1 if infinite.
+		i64 GetRemaining(i64 deadline)
+		{
+			if(deadline < 0)
+				return -1;
+			const i64 remaining = deadline - GetMonotonicTime();
+			return remaining > 0 ? remaining : 0;
+		}
+
+		/**
+		 * Wait on futex while *addr == expected.
+		 * @param timeout Timeout in nanoseconds, -1 for infinite.
+		 */
+		void FutexWait(volatile i32* addr, i32 expected, i64 timeout)
+		{
+			timespec time;
+			timespec* timePtr = nullptr;
+			if(timeout >= 0)
+			{
+				time.tv_sec = (time_t)(timeout / 1000000000LL);
+				time.tv_nsec = (long)(timeout % 1000000000LL);
+				timePtr = &time;
+			}
+			::syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, timePtr, nullptr, 0);
+		}
+
+		/// Wake up to @a count waiters on futex.
+		void FutexWake(volatile i32* addr, i32 count)
+		{
+			::syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+		}
+
+		/// Set in an Event or Semaphore state while threads may be blocked on it, so signalling only needs to
+		/// update the state then wake on its address. Nothing else is touched after the update, so a waiter can
+		/// destroy the object as soon as Wait returns. A wake that arrives after that is at worst spurious, and
+		/// every futex wait here rechecks its state when woken.
+		static const i32 WAITERS_FLAG = INT_MIN;
+
+		/**
+		 * Acquire the state at @a state, blocking until @a acquire succeeds or @a deadline passes.
+		 * @param numWaiters Threads blocked on @a state. Only used by waiters, to clear WAITERS_FLAG after the last.
+		 * @param acquire Called as bool acquire(i32 value, i32& newValue). Returns false if @a value can't be
+		 * acquired, else true with the state to acquire it with in newValue.
+		 * @return true if acquired, false if timed out.
+		 */
+		template<typename ACQUIRE>
+		bool FutexAcquire(volatile i32* state, volatile i32* numWaiters, i64 deadline, ACQUIRE&& acquire)
+		{
+			bool acquired = false;
+			bool waiting = false;
+			i32 value = AtomicLoadAcq(state);
+			for(;;)
+			{
+				i32 newValue = 0;
+				if(acquire(value, newValue))
+				{
+					const i32 prevValue = AtomicCmpExchgAcq(state, newValue, value);
+					if(prevValue == value)
+					{
+						acquired = true;
+						break;
+					}
+					value = prevValue;
+					continue;
+				}
+
+				const i64 remaining = GetRemaining(deadline);
+				if(remaining == 0)
+					break;
+
+				if(!waiting)
+				{
+					AtomicInc(numWaiters);
+					waiting = true;
+				}
+
+				// Flag waiters before sleeping, so any signal after this wakes us, or changes the state first.
+				if((value & WAITERS_FLAG) == 0)
+				{
+					const i32 prevValue = AtomicCmpExchg(state, value | WAITERS_FLAG, value);
+					if(prevValue != value)
+					{
+						value = prevValue;
+						continue;
+					}
+					value |= WAITERS_FLAG;
+				}
+				FutexWait(state, value, remaining);
+				value = AtomicLoadAcq(state);
+			}
+
+			if(waiting)
+			{
+				// Last waiter out clears the flag. If another thread started waiting in the meantime it may be
+				// asleep expecting the flag, so set it again, and wake it if there's now something to acquire.
+				const bool clearFlag = AtomicLoadAcq(numWaiters) == 1;
+				if(clearFlag)
+					AtomicAnd(state, ~WAITERS_FLAG);
+				if(AtomicDec(numWaiters) > 0 && clearFlag)
+				{
+					i32 newValue = 0;
+					if(acquire(AtomicOr(state, WAITERS_FLAG), newValue))
+						FutexWake(state, INT_MAX);
+				}
+			}
+			return acquired;
+		}
+
+		/// @return Current thread's id.
+		i32 GetCurrentThreadId()
+		{
+			static thread_local i32 threadId = 0;
+			if(threadId == 0)
+				threadId = (i32)::syscall(SYS_gettid);
+			return threadId;
+		}
+	} // namespace
+
+	struct ThreadImpl
+	{
+		pthread_t thread_;
+		Thread::EntryPointFunc entryPointFunc_ = nullptr;
+		void* userData_ = nullptr;
+		i32 exitCode_ = 0;
 #ifdef DEBUG
-		if(gMutex_.TryLock() == false)
-			DBG_BREAK;
-		gMutex_.Unlock();
+		const char* debugName_ = nullptr;
+#endif
+	};
+
+	static void* ThreadEntryPoint(void* param)
+	{
+		auto* impl = reinterpret_cast<ThreadImpl*>(param);
+
+#ifdef DEBUG
+		if(impl->debugName_)
+		{
+			// Names are limited to 16 characters, including the terminator.
+			char name[16] = {0};
+			strncpy(name, impl->debugName_, sizeof(name) - 1);
+			::pthread_setname_np(::pthread_self(), name);
+		}
 #endif
+		impl->exitCode_ = impl->entryPointFunc_(impl->userData_);
+		return nullptr;
 	}
 
-	RWLock::RWLock(RWLock&& other)
+	Thread::Thread(EntryPointFunc entryPointFunc, void* userData, i32 stackSize, const char* debugName)
+	{
+		DBG_ASSERT(entryPointFunc);
+		impl_ = new ThreadImpl();
+		impl_->entryPointFunc_ = entryPointFunc;
+		impl_->userData_ = userData;
+#ifdef DEBUG
+		impl_->debugName_ = debugName;
+#else
+		(void)debugName;
+#endif
+
+		pthread_attr_t attr;
+		::pthread_attr_init(&attr);
+		const size_t pageSize = (size_t)::sysconf(_SC_PAGESIZE);
+		size_t size = (size_t)stackSize < (size_t)PTHREAD_STACK_MIN ? (size_t)PTHREAD_STACK_MIN : (size_t)stackSize;
+		size = (size + pageSize - 1) & ~(pageSize - 1);
+		::pthread_attr_setstacksize(&attr, size);
+		const i32 retVal = ::pthread_create(&impl_->thread_, &attr, ThreadEntryPoint, impl_);
+		::pthread_attr_destroy(&attr);
+
+		DBG_ASSERT_MSG(retVal == 0, "Unable to create thread.");
+		if(retVal != 0)
+		{
+			delete impl_;
+			impl_ = nullptr;
+		}
+	}
+
+	Thread::~Thread()
+	{
+		if(impl_)
+		{
+			Join();
+		}
+	}
+
+	Thread::Thread(Thread&& other)
 	{
 		using std::swap;
-		std::swap(rMutex_, other.rMutex_);
-		std::swap(gMutex_, other.gMutex_);
-		std::swap(readCount_, other.readCount_);
+		swap(impl_, other.impl_);
 	}
 
-	RWLock& RWLock::operator=(RWLock&& other)
+	Thread& Thread::operator=(Thread&& other)
 	{
 		using std::swap;
-		std::swap(rMutex_, other.rMutex_);
-		std::swap(gMutex_, other.gMutex_);
-		std::swap(readCount_, other.readCount_);
+		swap(impl_, other.impl_);
 		return *this;
 	}
 
-	void RWLock::BeginRead()
+	u64 Thread::SetAffinity(u64 mask)
 	{
-		ScopedMutex lock(rMutex_);
-		if(AtomicInc(&readCount_) == 1)
+		DBG_ASSERT(impl_);
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		if(::pthread_getaffinity_np(impl_->thread_, sizeof(cpuSet), &cpuSet) != 0)
+			return 0;
+
+		u64 oldMask = 0;
+		for(i32 i = 0; i < 64; ++i)
+			if(CPU_ISSET(i, &cpuSet))
+				oldMask |= 1ULL << i;
+
+		CPU_ZERO(&cpuSet);
+		for(i32 i = 0; i < 64; ++i)
+			if(mask & (1ULL << i))
+				CPU_SET(i, &cpuSet);
+		if(::pthread_setaffinity_np(impl_->thread_, sizeof(cpuSet), &cpuSet) != 0)
+			return 0;
+		return oldMask;
+	}
+
+	i32 Thread::Join()
+	{
+		if(impl_)
 		{
-			gMutex_.Lock();
+			const i32 retVal = ::pthread_join(impl_->thread_, nullptr);
+			DBG_ASSERT(retVal == 0);
+			(void)retVal;
+			const i32 exitCode = impl_->exitCode_;
+			delete impl_;
+			impl_ = nullptr;
+			return exitCode;
 		}
+		return 0;
 	}
 
-	void RWLock::EndRead()
+	/// Maximum number of FLS slots.
+	static const i32 MAX_FLS_SLOTS = 64;
+	/// Minimum fiber stack size. Pages are only committed on first touch, so small requested sizes are
+	/// raised to this to leave headroom for libc calls made from fibers.
+	static const i32 MIN_FIBER_STACK_SIZE = 64 * 1024;
+
+	struct FiberImpl
 	{
-		ScopedMutex lock(rMutex_);
-		if(AtomicDec(&readCount_) == 0)
+		static const u64 SENTINAL = 0x11207CE82F00AA5ALL;
+		u64 sentinal_ = SENTINAL;
+		Fiber* parent_ = nullptr;
+		void* stackPointer_ = nullptr;
+		u8* stack_ = nullptr;
+		size_t stackSize_ = 0;
+		FiberImpl* exitFiber_ = nullptr;
+		Fiber::EntryPointFunc entryPointFunc_ = nullptr;
+		void* userData_ = nullptr;
+		void* fls_[MAX_FLS_SLOTS] = {nullptr};
+#ifdef DEBUG
+		const char* debugName_ = nullptr;
+#endif
+	};
+
+	/// Currently executing fiber.
+	static thread_local FiberImpl* thisFiber_ = nullptr;
+	/// FLS for threads that aren't running a fiber.
+	static thread_local void* thisThreadFls_[MAX_FLS_SLOTS] = {nullptr};
+
+	// NOTE: Fibers can resume on a different thread, so thread locals must not be cached across a context
+	// switch. Keeping accesses behind calls the compiler can't see through prevents that.
+	static __attribute__((noinline)) FiberImpl* GetThisFiber() { return thisFiber_; }
+	static __attribute__((noinline)) void SetThisFiber(FiberImpl* impl) { thisFiber_ = impl; }
+
+	static void FiberEntryPoint(FiberImpl* impl)
+	{
+		impl->entryPointFunc_(impl->userData_);
+		DBG_ASSERT(impl->exitFiber_);
+		FiberImpl* exitFiber = impl->exitFiber_;
+		SetThisFiber(exitFiber);
+		CoreFiberSwitchContext(&impl->stackPointer_, exitFiber->stackPointer_);
+		DBG_ASSERT_MSG(false, "Fiber resumed after exiting.");
+	}
+
+	Fiber::Fiber(EntryPointFunc entryPointFunc, void* userData, i32 stackSize, const char* debugName)
+#ifdef DEBUG
+	    : debugName_(debugName)
+#endif
+	{
+		DBG_ASSERT(entryPointFunc);
+		impl_ = new FiberImpl();
+		impl_->parent_ = this;
+		impl_->entryPointFunc_ = entryPointFunc;
+		impl_->userData_ = userData;
+#ifdef DEBUG
+		impl_->debugName_ = debugName_;
+#else
+		(void)debugName;
+#endif
+
+		// Allocate stack, with a guard page at the bottom to catch overflows.
+		const size_t pageSize = (size_t)::sysconf(_SC_PAGESIZE);
+		size_t size = stackSize < MIN_FIBER_STACK_SIZE ? MIN_FIBER_STACK_SIZE : stackSize;
+		size = ((size + pageSize - 1) & ~(pageSize - 1)) + pageSize;
+		void* stack =
+		    ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE, -1, 0);
+		DBG_ASSERT_MSG(stack != MAP_FAILED, "Unable to create fiber.");
+		if(stack == MAP_FAILED)
 		{
-			gMutex_.Unlock();
+			delete impl_;
+			impl_ = nullptr;
+			return;
 		}
+		::mprotect(stack, pageSize, PROT_NONE);
+		impl_->stack_ = (u8*)stack;
+		impl_->stackSize_ = size;
+
+		// Setup initial context so the first switch returns into the trampoline.
+		u8* stackTop = impl_->stack_ + size;
+#if ARCH_X86_64
+		// mxcsr & x87 control word, r15, r14, r13, r12, rbx, rbp, return address.
+		u64* context = (u64*)(stackTop - 64);
+		u32 mxcsr = 0;
+		u16 fpucw = 0;
+		asm volatile("stmxcsr %0" : "=m"(mxcsr));
+		asm volatile("fnstcw %0" : "=m"(fpucw));
+		memset(context, 0, 64);
+		memcpy((u8*)context + 0, &mxcsr, sizeof(mxcsr));
+		memcpy((u8*)context + 4, &fpucw, sizeof(fpucw));
+		context[3] = (u64)&FiberEntryPoint;
+		context[4] = (u64)impl_;
+		context[7] = (u64)&CoreFiberTrampoline;
+#elif ARCH_ARM64
+		// x19-x30, d8-d15.
+		u64* context = (u64*)(stackTop - 160);
+		memset(context, 0, 160);
+		context[0] = (u64)impl_;
+		context[1] = (u64)&FiberEntryPoint;
+		context[11] = (u64)&CoreFiberTrampoline;
+#endif
+		impl_->stackPointer_ = context;
 	}
 
-	void RWLock::BeginWrite() { gMutex_.Lock(); }
+	Fiber::Fiber(ThisThread, const char* debugName)
+#ifdef DEBUG
+	    : debugName_(debugName)
+#endif
+	{
+		DBG_ASSERT_MSG(GetThisFiber() == nullptr, "Unable to create fiber. Is there already one for this thread?");
+		if(GetThisFiber() != nullptr)
+			return;
 
-	void RWLock::EndWrite() { gMutex_.Unlock(); }
+		impl_ = new FiberImpl();
+		impl_->parent_ = this;
+		impl_->entryPointFunc_ = nullptr;
+		impl_->userData_ = nullptr;
+#ifdef DEBUG
+		impl_->debugName_ = debugName_;
+#else
+		(void)debugName;
+#endif
+		SetThisFiber(impl_);
+	}
+
+	Fiber::~Fiber()
+	{
+		if(impl_)
+		{
+			if(impl_->entryPointFunc_)
+			{
+				DBG_ASSERT(GetThisFiber() != impl_);
+				::munmap(impl_->stack_, impl_->stackSize_);
+			}
+			else if(GetThisFiber() == impl_)
+			{
+				SetThisFiber(nullptr);
+			}
+			delete impl_;
+		}
+	}
+
+	Fiber::Fiber(Fiber&& other)
+	{
+		using std::swap;
+		swap(impl_, other.impl_);
+#ifdef DEBUG
+		swap(debugName_, other.debugName_);
+#endif
+		impl_->parent_ = this;
+	}
+
+	Fiber& Fiber::operator=(Fiber&& other)
+	{
+		using std::swap;
+		swap(impl_, other.impl_);
+#ifdef DEBUG
+		swap(debugName_, other.debugName_);
+#endif
+		impl_->parent_ = this;
+		return *this;
+	}
+
+	void Fiber::SwitchTo()
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(impl_->parent_ == this);
+		FiberImpl* thisFiber = GetThisFiber();
+		DBG_ASSERT(thisFiber != nullptr);
+		if(impl_)
+		{
+			DBG_ASSERT(thisFiber != impl_);
+			FiberImpl* lastExitFiber = impl_->exitFiber_;
+			impl_->exitFiber_ = impl_->entryPointFunc_ ? thisFiber : nullptr;
+			SetThisFiber(impl_);
+			CoreFiberSwitchContext(&thisFiber->stackPointer_, impl_->stackPointer_);
+			SetThisFiber(thisFiber);
+			impl_->exitFiber_ = lastExitFiber;
+		}
+	}
+
+	void* Fiber::GetUserData() const
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(impl_->parent_ == this);
+		return impl_->userData_;
+	}
+
+	Fiber* Fiber::GetCurrentFiber()
+	{
+		// Matches Windows, where only fibers with an entry point set their FLS.
+		auto* impl = GetThisFiber();
+		if(impl && impl->entryPointFunc_)
+			return impl->parent_;
+		return nullptr;
+	}
+
+	/// Event state_ flag set while signalled.
+	static const i32 EVENT_SIGNALLED = 1;
+
+	struct EventImpl
+	{
+		/// EVENT_SIGNALLED, and WAITERS_FLAG.
+		volatile i32 state_ = 0;
+		volatile i32 numWaiters_ = 0;
+		bool manualReset_ = false;
+#ifdef DEBUG
+		const char* debugName_ = nullptr;
+#endif
+	};
+
+	Event::Event(bool manualReset, bool initialState, const char* debugName)
+	{
+		impl_ = new EventImpl();
+		impl_->state_ = initialState ? EVENT_SIGNALLED : 0;
+		impl_->manualReset_ = manualReset;
+#ifdef DEBUG
+		impl_->debugName_ = debugName;
+#else
+		(void)debugName;
+#endif
+	}
+
+	Event::~Event() { delete impl_; }
+
+	bool Event::Wait(i32 timeout)
+	{
+		DBG_ASSERT(impl_);
+		const bool manualReset = impl_->manualReset_;
+		auto acquire = [manualReset](i32 value, i32& newValue) {
+			newValue = manualReset ? value : (value & ~EVENT_SIGNALLED);
+			return (value & EVENT_SIGNALLED) != 0;
+		};
+		return FutexAcquire(&impl_->state_, &impl_->numWaiters_, GetDeadline(timeout), acquire);
+	}
+
+	bool Event::Signal()
+	{
+		DBG_ASSERT(impl_);
+		volatile i32* state = &impl_->state_;
+		const i32 numToWake = impl_->manualReset_ ? INT_MAX : 1;
+		if(AtomicOr(state, EVENT_SIGNALLED) & WAITERS_FLAG)
+			FutexWake(state, numToWake);
+		return true;
+	}
+
+	bool Event::Reset()
+	{
+		DBG_ASSERT(impl_);
+		AtomicAnd(&impl_->state_, ~EVENT_SIGNALLED);
+		return true;
+	}
+
+	struct SemaphoreImpl
+	{
+		/// Count, and WAITERS_FLAG.
+		volatile i32 state_ = 0;
+		volatile i32 numWaiters_ = 0;
+		i32 maximumCount_ = 0;
+#ifdef DEBUG
+		const char* debugName_ = nullptr;
+#endif
+	};
+
+	Semaphore::Semaphore(i32 initialCount, i32 maximumCount, const char* debugName)
+	{
+		DBG_ASSERT(initialCount >= 0);
+		DBG_ASSERT(maximumCount > 0);
+		impl_ = new SemaphoreImpl();
+		impl_->state_ = initialCount;
+		impl_->maximumCount_ = maximumCount;
+#ifdef DEBUG
+		impl_->debugName_ = debugName;
+#else
+		(void)debugName;
+#endif
+	}
+
+	Semaphore::~Semaphore() { delete impl_; }
+
+	bool Semaphore::Wait(i32 timeout)
+	{
+		DBG_ASSERT(impl_);
+		auto acquire = [](i32 value, i32& newValue) {
+			if((value & ~WAITERS_FLAG) <= 0)
+				return false;
+			newValue = value - 1;
+			return true;
+		};
+		return FutexAcquire(&impl_->state_, &impl_->numWaiters_, GetDeadline(timeout), acquire);
+	}
+
+	bool Semaphore::Signal(i32 count)
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(count > 0);
+		volatile i32* state = &impl_->state_;
+		const i32 maximumCount = impl_->maximumCount_;
+		i32 value = AtomicLoadAcq(state);
+		for(;;)
+		{
+			if(count > (maximumCount - (value & ~WAITERS_FLAG)))
+				return false;
+			const i32 prevValue = AtomicCmpExchg(state, value + count, value);
+			if(prevValue == value)
+				break;
+			value = prevValue;
+		}
+		if(value & WAITERS_FLAG)
+			FutexWake(state, count);
+		return true;
+	}
+
+	/// Number of times to spin trying to acquire a mutex before sleeping.
+	static const i32 MUTEX_SPIN_COUNT = 64;
+
+	struct MutexImpl
+	{
+		/// 0 = unlocked, 1 = locked, 2 = locked with waiters.
+		volatile i32 state_ = 0;
+		volatile i32 owner_ = 0;
+		i32 recursion_ = 0;
+	};
+
+	Mutex::Mutex() { impl_ = new MutexImpl(); }
+
+	Mutex::~Mutex()
+	{
+		DBG_ASSERT(impl_ == nullptr || impl_->state_ == 0);
+		delete impl_;
+	}
+
+	Mutex::Mutex(Mutex&& other)
+	{
+		using std::swap;
+		std::swap(impl_, other.impl_);
+	}
+
+	Mutex& Mutex::operator=(Mutex&& other)
+	{
+		using std::swap;
+		std::swap(impl_, other.impl_);
+		return *this;
+	}
+
+	void Mutex::Lock()
+	{
+		DBG_ASSERT(impl_);
+		const i32 threadId = GetCurrentThreadId();
+		if(AtomicLoadAcq(&impl_->owner_) == threadId)
+		{
+			++impl_->recursion_;
+			return;
+		}
+
+		// Spin briefly first, most locks are held for a short time.
+		i32 state = AtomicCmpExchgAcq(&impl_->state_, 1, 0);
+		for(i32 i = 0; state != 0 && i < MUTEX_SPIN_COUNT; ++i)
+		{
+			YieldCPU();
+			state = AtomicCmpExchgAcq(&impl_->state_, 1, 0);
+		}
+
+		// Mark as contended and sleep until unlocked.
+		if(state != 0)
+		{
+			if(state != 2)
+				state = AtomicExchgAcq(&impl_->state_, 2);
+			while(state != 0)
+			{
+				FutexWait(&impl_->state_, 2, -1);
+				state = AtomicExchgAcq(&impl_->state_, 2);
+			}
+		}
+
+		AtomicStoreRel(&impl_->owner_, threadId);
+		impl_->recursion_ = 1;
+	}
+
+	bool Mutex::TryLock()
+	{
+		DBG_ASSERT(impl_);
+		const i32 threadId = GetCurrentThreadId();
+		if(AtomicLoadAcq(&impl_->owner_) == threadId)
+		{
+			++impl_->recursion_;
+			return true;
+		}
+
+		if(AtomicCmpExchgAcq(&impl_->state_, 1, 0) == 0)
+		{
+			AtomicStoreRel(&impl_->owner_, threadId);
+			impl_->recursion_ = 1;
+			return true;
+		}
+		return false;
+	}
+
+	void Mutex::Unlock()
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(impl_->owner_ == GetCurrentThreadId());
+		if(--impl_->recursion_ > 0)
+			return;
+
+		AtomicStoreRel(&impl_->owner_, 0);
+		if(AtomicDec(&impl_->state_) != 0)
+		{
+			// There were waiters, release fully and wake one.
+			AtomicExchg(&impl_->state_, 0);
+			FutexWake(&impl_->state_, 1);
+		}
+	}
 
 	struct TLSImpl
 	{
-		DWORD handle_ = 0;
+		pthread_key_t handle_;
 	};
 
 	TLS::TLS()
 	{
 		impl_ = new TLSImpl();
-		impl_->handle_ = TlsAlloc();
+		if(::pthread_key_create(&impl_->handle_, nullptr) != 0)
+		{
+			delete impl_;
+			impl_ = nullptr;
+		}
 	}
 
 	TLS::~TLS()
 	{
-		::TlsFree(impl_->handle_);
+		if(impl_)
+			::pthread_key_delete(impl_->handle_);
 		delete impl_;
 	}
 
 	bool TLS::Set(void* data)
 	{
 		DBG_ASSERT(impl_);
-		return !!::TlsSetValue(impl_->handle_, data);
+		return ::pthread_setspecific(impl_->handle_, data) == 0;
 	}
 
 	void* TLS::Get() const
 	{
 		DBG_ASSERT(impl_);
-		return ::TlsGetValue(impl_->handle_);
+		return ::pthread_getspecific(impl_->handle_);
 	}
 
+	/// Allocated FLS slots.
+	static volatile i64 flsSlots_ = 0;
 
 	struct FLSImpl
 	{
-		DWORD handle_ = 0;
+		i32 slot_ = 0;
 	};
 
 	FLS::FLS()
 	{
-		impl_ = new FLSImpl();
-		impl_->handle_ = FlsAlloc(nullptr);
+		i64 slots = flsSlots_;
+		for(i32 slot = 0; slot < MAX_FLS_SLOTS; ++slot)
+		{
+			const i64 bit = 1LL << slot;
+			if((slots & bit) == 0)
+			{
+				const i64 oldSlots = AtomicCmpExchg(&flsSlots_, slots | bit, slots);
+				if(oldSlots == slots)
+				{
+					impl_ = new FLSImpl();
+					impl_->slot_ = slot;
+					return;
+				}
+				// Lost race, start over.
+				slots = oldSlots;
+				slot = -1;
+			}
+		}
+		DBG_ASSERT_MSG(false, "Out of FLS slots.");
 	}
 
 	FLS::~FLS()
 	{
-		::FlsFree(impl_->handle_);
+		if(impl_)
+			AtomicAnd(&flsSlots_, ~(1LL << impl_->slot_));
 		delete impl_;
 	}
 
 	bool FLS::Set(void* data)
 	{
 		DBG_ASSERT(impl_);
-		return !!::FlsSetValue(impl_->handle_, data);
+		FiberImpl* fiber = GetThisFiber();
+		if(fiber && fiber->entryPointFunc_)
+			fiber->fls_[impl_->slot_] = data;
+		else
+			thisThreadFls_[impl_->slot_] = data;
+		return true;
 	}
 
 	void* FLS::Get() const
 	{
 		DBG_ASSERT(impl_);
-		return ::FlsGetValue(impl_->handle_);
+		FiberImpl* fiber = GetThisFiber();
+		if(fiber && fiber->entryPointFunc_)
+			return fiber->fls_[impl_->slot_];
+		return thisThreadFls_[impl_->slot_];
 	}
 
 } // namespace Core
 #else
 #error "Not implemented for platform!""
 #endif
+
+namespace Core
+{
+	RWLock::RWLock() {}
+
+	RWLock::~RWLock()
+	{
+		DBG_ASSERT(readCount_ == 0);
+#ifdef DEBUG
+		if(gMutex_.TryLock() == false)
+			DBG_BREAK;
+		gMutex_.Unlock();
+#endif
+	}
+
+	RWLock::RWLock(RWLock&& other)
+	{
+		using std::swap;
+		std::swap(rMutex_, other.rMutex_);
+		std::swap(gMutex_, other.gMutex_);
+		std::swap(readCount_, other.readCount_);
+	}
+
+	RWLock& RWLock::operator=(RWLock&& other)
+	{
+		using std::swap;
+		std::swap(rMutex_, other.rMutex_);
+		std::swap(gMutex_, other.gMutex_);
+		std::swap(readCount_, other.readCount_);
+		return *this;
+	}
+
+	void RWLock::BeginRead()
+	{
+		ScopedMutex lock(rMutex_);
+		if(AtomicInc(&readCount_) == 1)
+		{
+			gMutex_.Lock();
+		}
+	}
+
+	void RWLock::EndRead()
+	{
+		ScopedMutex lock(rMutex_);
+		if(AtomicDec(&readCount_) == 0)
+		{
+			gMutex_.Unlock();
+		}
+	}
+
+	void RWLock::BeginWrite() { gMutex_.Lock(); }
+
+	void RWLock::EndWrite() { gMutex_.Unlock(); }
+} // namespace Core
@@ -70,6 +70,16 @@ namespace Core
 	CORE_DLL_INLINE i64 AtomicCmpExchg(volatile i64* dest, i64 exchg, i64 comp) { return ::InterlockedCompareExchange64(dest, exchg, comp); }
 	CORE_DLL_INLINE i64 AtomicCmpExchgAcq(volatile i64* dest, i64 exchg, i64 comp) { return ::InterlockedCompareExchangeAcquire64(dest, exchg, comp); }
 	CORE_DLL_INLINE i64 AtomicCmpExchgRel(volatile i64* dest, i64 exchg, i64 comp) { return ::InterlockedCompareExchangeRelease64(dest, exchg, comp); }
+
+	CORE_DLL_INLINE i32 AtomicLoadAcq(const volatile i32* src) { return ::ReadAcquire((const volatile LONG*)src); }
+	CORE_DLL_INLINE i64 AtomicLoadAcq(const volatile i64* src) { return ::ReadAcquire64(src); }
+	CORE_DLL_INLINE void* AtomicLoadAcq(void* const volatile* src) { return ::ReadPointerAcquire(src); }
+	CORE_DLL_INLINE void AtomicStoreRel(volatile i32* dest, i32 value) { ::WriteRelease((volatile LONG*)dest, value); }
+	CORE_DLL_INLINE void AtomicStoreRel(volatile i64* dest, i64 value) { ::WriteRelease64(dest, value); }
+	CORE_DLL_INLINE void AtomicStoreRel(void* volatile* dest, void* value) { ::WritePointerRelease(dest, value); }
+
+	CORE_DLL_INLINE void* AtomicExchg(void* volatile* dest, void* exchg) { return ::InterlockedExchangePointer(dest, exchg); }
+	CORE_DLL_INLINE void* AtomicCmpExchg(void* volatile* dest, void* exchg, void* comp) { return ::InterlockedCompareExchangePointer(dest, exchg, comp); }
 	
 	CORE_DLL_INLINE void YieldCPU() { ::YieldProcessor(); }
 	CORE_DLL_INLINE void Sleep(double seconds) { ::Sleep((DWORD)(1000 * seconds)); }
@@ -78,5 +88,107 @@ namespace Core
 	// clang-format on
 } // namespace Core
 
+#elif PLATFORM_LINUX
+#include <sched.h>
+#include <time.h>
+#if ARCH_X86_64 || ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace Core
+{
+	// NOTE: Plain variants use the __sync builtins, as they are full barriers like the Interlocked functions.
+	// clang-format off
+	CORE_DLL_INLINE i32 AtomicInc(volatile i32* dest) { return __sync_add_and_fetch(dest, 1); }
+	CORE_DLL_INLINE i32 AtomicIncAcq(volatile i32* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicIncRel(volatile i32* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicDec(volatile i32* dest) { return __sync_sub_and_fetch(dest, 1); }
+	CORE_DLL_INLINE i32 AtomicDecAcq(volatile i32* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicDecRel(volatile i32* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicAdd(volatile i32* dest, i32 value) { return __sync_add_and_fetch(dest, value); }
+	CORE_DLL_INLINE i32 AtomicAddAcq(volatile i32* dest, i32 value) { return __atomic_add_fetch(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicAddRel(volatile i32* dest, i32 value) { return __atomic_add_fetch(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicAnd(volatile i32* dest, i32 value) { return __sync_fetch_and_and(dest, value); }
+	CORE_DLL_INLINE i32 AtomicAndAcq(volatile i32* dest, i32 value) { return __atomic_fetch_and(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicAndRel(volatile i32* dest, i32 value) { return __atomic_fetch_and(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicOr(volatile i32* dest, i32 value) { return __sync_fetch_and_or(dest, value); }
+	CORE_DLL_INLINE i32 AtomicOrAcq(volatile i32* dest, i32 value) { return __atomic_fetch_or(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicOrRel(volatile i32* dest, i32 value) { return __atomic_fetch_or(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicXor(volatile i32* dest, i32 value) { return __sync_fetch_and_xor(dest, value); }
+	CORE_DLL_INLINE i32 AtomicXorAcq(volatile i32* dest, i32 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicXorRel(volatile i32* dest, i32 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicExchg(volatile i32* dest, i32 exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i32 AtomicExchgAcq(volatile i32* dest, i32 exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_ACQUIRE); }
+
+	CORE_DLL_INLINE i32 AtomicCmpExchg(volatile i32* dest, i32 exchg, i32 comp) { return __sync_val_compare_and_swap(dest, comp, exchg); }
+	CORE_DLL_INLINE i32 AtomicCmpExchgAcq(volatile i32* dest, i32 exchg, i32 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return comp; }
+	CORE_DLL_INLINE i32 AtomicCmpExchgRel(volatile i32* dest, i32 exchg, i32 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED); return comp; }
+
+	CORE_DLL_INLINE i64 AtomicInc(volatile i64* dest) { return __sync_add_and_fetch(dest, 1); }
+	CORE_DLL_INLINE i64 AtomicIncAcq(volatile i64* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicIncRel(volatile i64* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicDec(volatile i64* dest) { return __sync_sub_and_fetch(dest, 1); }
+	CORE_DLL_INLINE i64 AtomicDecAcq(volatile i64* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicDecRel(volatile i64* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicAdd(volatile i64* dest, i64 value) { return __sync_add_and_fetch(dest, value); }
+	CORE_DLL_INLINE i64 AtomicAddAcq(volatile i64* dest, i64 value) { return __atomic_add_fetch(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicAddRel(volatile i64* dest, i64 value) { return __atomic_add_fetch(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicAnd(volatile i64* dest, i64 value) { return __sync_fetch_and_and(dest, value); }
+	CORE_DLL_INLINE i64 AtomicAndAcq(volatile i64* dest, i64 value) { return __atomic_fetch_and(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicAndRel(volatile i64* dest, i64 value) { return __atomic_fetch_and(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicOr(volatile i64* dest, i64 value) { return __sync_fetch_and_or(dest, value); }
+	CORE_DLL_INLINE i64 AtomicOrAcq(volatile i64* dest, i64 value) { return __atomic_fetch_or(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicOrRel(volatile i64* dest, i64 value) { return __atomic_fetch_or(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicXor(volatile i64* dest, i64 value) { return __sync_fetch_and_xor(dest, value); }
+	CORE_DLL_INLINE i64 AtomicXorAcq(volatile i64* dest, i64 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicXorRel(volatile i64* dest, i64 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicExchg(volatile i64* dest, i64 exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i64 AtomicExchgAcq(volatile i64* dest, i64 exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_ACQUIRE); }
+
+	CORE_DLL_INLINE i64 AtomicCmpExchg(volatile i64* dest, i64 exchg, i64 comp) { return __sync_val_compare_and_swap(dest, comp, exchg); }
+	CORE_DLL_INLINE i64 AtomicCmpExchgAcq(volatile i64* dest, i64 exchg, i64 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return comp; }
+	CORE_DLL_INLINE i64 AtomicCmpExchgRel(volatile i64* dest, i64 exchg, i64 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED); return comp; }
+
+	CORE_DLL_INLINE i32 AtomicLoadAcq(const volatile i32* src) { return __atomic_load_n(src, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicLoadAcq(const volatile i64* src) { return __atomic_load_n(src, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE void* AtomicLoadAcq(void* const volatile* src) { return __atomic_load_n(src, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE void AtomicStoreRel(volatile i32* dest, i32 value) { __atomic_store_n(dest, value, __ATOMIC_RELEASE); }
+	CORE_DLL_INLINE void AtomicStoreRel(volatile i64* dest, i64 value) { __atomic_store_n(dest, value, __ATOMIC_RELEASE); }
+	CORE_DLL_INLINE void AtomicStoreRel(void* volatile* dest, void* value) { __atomic_store_n(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE void* AtomicExchg(void* volatile* dest, void* exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE void* AtomicCmpExchg(void* volatile* dest, void* exchg, void* comp) { return __sync_val_compare_and_swap(dest, comp, exchg); }
+
+#if ARCH_X86_64 || ARCH_X86
+	CORE_DLL_INLINE void YieldCPU() { _mm_pause(); }
+#elif ARCH_ARM64 || ARCH_ARM
+	CORE_DLL_INLINE void YieldCPU() { __asm__ __volatile__("yield"); }
+#else
+	CORE_DLL_INLINE void YieldCPU() {}
+#endif
+	CORE_DLL_INLINE void Sleep(double seconds)
+	{
+		timespec time;
+		time.tv_sec = (time_t)seconds;
+		time.tv_nsec = (long)((seconds - (double)time.tv_sec) * 1000000000.0);
+		while(nanosleep(&time, &time) != 0)
+			;
+	}
+	CORE_DLL_INLINE void Barrier() { __sync_synchronize(); }
+	CORE_DLL_INLINE void SwitchThread() { ::sched_yield(); };
+	// clang-format on
+} // namespace Core
 
 #endif
@@ -1,10 +1,13 @@
 #include "core/debug.h"
 #include "core/concurrency.h"
+#include "core/misc.h"
 
 #include <cstdio>
 
 #if PLATFORM_WINDOWS
 #include <windows.h>
+#elif PLATFORM_LINUX
+#include <execinfo.h>
 #endif
 
 namespace Core
@@ -75,6 +78,27 @@ namespace Core
 		return !!::IsDebuggerPresent();
 #else
 		return false;
+#endif
+	}
+
+	i32 GetCallstack(i32 skipFrames, void** outFrames, i32 maxFrames)
+	{
+		DBG_ASSERT(skipFrames >= 0);
+		DBG_ASSERT(outFrames || maxFrames == 0);
+#if PLATFORM_WINDOWS
+		return (i32)::RtlCaptureStackBackTrace((DWORD)skipFrames + 1, (DWORD)maxFrames, outFrames, nullptr);
+#elif PLATFORM_LINUX
+		// backtrace can't skip, so capture into a larger buffer and copy out.
+		static const i32 MAX_CAPTURED = 128;
+		void* frames[MAX_CAPTURED];
+		const i32 numToCapture = Core::Min(skipFrames + 1 + maxFrames, MAX_CAPTURED);
+		const i32 numCaptured = ::backtrace(frames, numToCapture);
+		const i32 numFrames = Core::Max(0, numCaptured - (skipFrames + 1));
+		for(i32 i = 0; i < numFrames; ++i)
+			outFrames[i] = frames[skipFrames + 1 + i];
+		return numFrames;
+#else
+		return 0;
 #endif
 	}
 } // namespace Core
@@ -1,6 +1,7 @@
 #include "core/file.h"
 #include "core/array.h"
 #include "core/misc.h"
+#include "core/vector.h"
 
 #include <utility>
 
@@ -15,7 +16,9 @@
 #endif
 
 #include <io.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <string.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -33,6 +36,7 @@
 #define lowLevelPermissionFlags (_S_IREAD | _S_IWRITE)
 
 #elif PLATFORM_LINUX || PLATFORM_OSX
+#include <sys/mman.h>
 #include <unistd.h>
 
 #define lowLevelOpen ::open
@@ -446,18 +450,33 @@ namespace Core
 	public:
 		virtual ~FileImpl() {}
 		virtual i64 Read(void* buffer, i64 bytes) = 0;
+		virtual i64 ReadAt(i64 offset, void* buffer, i64 bytes) const = 0;
 		virtual i64 Write(const void* buffer, i64 bytes) = 0;
 		virtual bool Seek(i64 offset) = 0;
 		virtual i64 Tell() const = 0;
 		virtual i64 Size() const = 0;
 		virtual FileFlags GetFlags() const = 0;
 		virtual bool IsValid() const = 0;
+		virtual const void* Map(i64 offset, i64 size) = 0;
+		virtual void Unmap(const void* data) = 0;
+		virtual bool Prefetch(i64 offset, i64 size) = 0;
+		virtual i32 GetDescriptor() const = 0;
 	};
 
-	/// Native file implementation.
+	/**
+	 * Native file implementation.
+	 * Reads and writes are positional (pread/pwrite, or ReadFile/WriteFile with an offset), so there's no
+	 * shared OS file position or libc buffer: Read and Write track offset_ themselves, and ReadAt can be
+	 * used from several threads at once.
+	 */
 	class FileImplNative : public FileImpl
 	{
 	public:
+		/// Largest single read or write passed to the OS.
+		static const i64 MAX_IO_SIZE = 1024 * 1024 * 1024;
+		/// Size of bounce buffer for unaligned reads from a file opened with FileFlags::DIRECT.
+		static const i64 DIRECT_BOUNCE_SIZE = 256 * 1024;
+
 		FileImplNative(const char* path, FileFlags flags, IFilePathResolver* resolver)
 		{
 			char resolvedPath[MAX_PATH_LENGTH];
@@ -470,66 +489,134 @@ namespace Core
 			}
 
 			// Setup flags.
-			char openString[8] = {0};
-			int openStringIdx = 0;
 			int openPermissions = 0;
 			int lowLevelFlags = 0;
 			if(ContainsAllFlags(flags, FileFlags::READ))
-			{
 				lowLevelFlags |= lowLevelReadFlags;
-				openString[openStringIdx++] = 'r';
-				openString[openStringIdx++] = 'b';
-			}
 			if(ContainsAllFlags(flags, FileFlags::WRITE))
-			{
 				lowLevelFlags |= lowLevelWriteFlags;
-				openString[openStringIdx++] = 'w';
-				openString[openStringIdx++] = 'b';
-			}
 			if(ContainsAllFlags(flags, FileFlags::APPEND))
-			{
 				lowLevelFlags |= lowLevelAppendFlags;
-				openString[openStringIdx++] = 'a';
-			}
 			if(ContainsAllFlags(flags, FileFlags::CREATE))
 			{
 				lowLevelFlags |= lowLevelCreateFlags;
-				openString[openStringIdx++] = '+';
 				openPermissions = lowLevelPermissionFlags;
 			}
 
 			// Load as descriptor.
-			int desc = lowLevelOpen(path, lowLevelFlags, openPermissions);
+			const bool direct = ContainsAllFlags(flags, FileFlags::DIRECT);
+			int desc = -1;
+#if PLATFORM_WINDOWS
+			if(ContainsAnyFlags(flags, FileFlags::DIRECT | FileFlags::SEQUENTIAL | FileFlags::RANDOM))
+			{
+				// Cache flags are only available through CreateFile. These are read only, see File::File.
+				DWORD attribs = FILE_ATTRIBUTE_NORMAL;
+				if(direct)
+					attribs |= FILE_FLAG_NO_BUFFERING;
+				if(ContainsAllFlags(flags, FileFlags::SEQUENTIAL))
+					attribs |= FILE_FLAG_SEQUENTIAL_SCAN;
+				if(ContainsAllFlags(flags, FileFlags::RANDOM))
+					attribs |= FILE_FLAG_RANDOM_ACCESS;
+				HANDLE handle = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+				    OPEN_EXISTING, attribs, nullptr);
+				if(handle != INVALID_HANDLE_VALUE)
+				{
+					desc = ::_open_osfhandle((intptr_t)handle, _O_RDONLY);
+					if(-1 == desc)
+						::CloseHandle(handle);
+				}
+			}
+			else
+#endif
+			{
+#if defined(O_DIRECT)
+				if(direct)
+				{
+					desc = lowLevelOpen(path, lowLevelFlags | O_DIRECT, openPermissions);
+					direct_ = desc != -1;
+				}
+#endif
+				if(-1 == desc)
+					desc = lowLevelOpen(path, lowLevelFlags, openPermissions);
+			}
 			if(-1 == desc)
 			{
 				return;
 			}
 			fileDescriptor_ = desc;
+			flags_ = flags;
 
-			// Load as file handle.
-			fileHandle_ = ::fdopen(desc, openString);
-			if(nullptr == fileHandle_)
+#if PLATFORM_WINDOWS
+			direct_ = direct;
+#elif PLATFORM_OSX
+			if(direct)
+				::fcntl(fileDescriptor_, F_NOCACHE, 1);
+			if(ContainsAllFlags(flags, FileFlags::RANDOM))
+				::fcntl(fileDescriptor_, F_RDAHEAD, 0);
+#elif PLATFORM_LINUX
+			if(ContainsAllFlags(flags, FileFlags::SEQUENTIAL))
+				::posix_fadvise(fileDescriptor_, 0, 0, POSIX_FADV_SEQUENTIAL);
+			if(ContainsAllFlags(flags, FileFlags::RANDOM))
+				::posix_fadvise(fileDescriptor_, 0, 0, POSIX_FADV_RANDOM);
+#endif
+
+			// Appends start at the end, and the OS keeps them there.
+			if(ContainsAllFlags(flags, FileFlags::APPEND))
+				offset_ = Size();
+
+			// Map whole file if requested. Empty files can't be mapped, but there's nothing to read anyway.
+			if(ContainsAllFlags(flags, FileFlags::MMAP | FileFlags::READ))
 			{
-				lowLevelClose(fileDescriptor_);
-				fileDescriptor_ = -1;
+				const i64 size = Size();
+				if(size > 0)
+				{
+					mappedData_ = static_cast<const u8*>(MapView(0, size));
+					mappedSize_ = mappedData_ ? size : 0;
+				}
 			}
-
-			flags_ = flags;
 		}
 
 		virtual ~FileImplNative()
 		{
-			if(fileHandle_)
-				::fclose(fileHandle_);
+			for(const auto& view : views_)
+				UnmapView(view.base_, view.size_);
+			if(mappedData_)
+				UnmapView(mappedData_, mappedSize_);
+#if PLATFORM_WINDOWS
+			if(mappingHandle_)
+				::CloseHandle(mappingHandle_);
+#endif
+			if(fileDescriptor_ != -1)
+				lowLevelClose(fileDescriptor_);
 		}
 
 		i64 Read(void* buffer, i64 bytes) override
+		{
+			const i64 bytesRead = ReadAt(offset_, buffer, bytes);
+			offset_ += bytesRead;
+			return bytesRead;
+		}
+
+		i64 ReadAt(i64 offset, void* buffer, i64 bytes) const override
 		{
 			i64 bytesRead = 0;
+			if(offset < 0)
+				return bytesRead;
 			if(ContainsAllFlags(GetFlags(), FileFlags::READ))
 			{
-				DBG_ASSERT(bytes <= SIZE_MAX);
-				bytesRead = ::fread(buffer, 1, bytes, fileHandle_);
+				if(mappedData_)
+				{
+					bytesRead = Max((i64)0, Min(mappedSize_ - offset, bytes));
+					memcpy(buffer, mappedData_ + offset, bytesRead);
+				}
+				else if(direct_)
+				{
+					bytesRead = ReadDirect(offset, buffer, bytes);
+				}
+				else
+				{
+					bytesRead = ReadRaw(offset, buffer, bytes);
+				}
 			}
 			return bytesRead;
 		}
@@ -539,25 +626,32 @@ namespace Core
 			i64 bytesWritten = 0;
 			if(ContainsAllFlags(GetFlags(), FileFlags::WRITE))
 			{
-				DBG_ASSERT(bytes <= SIZE_MAX);
-				bytesWritten = ::fwrite(buffer, 1, bytes, fileHandle_);
+				bytesWritten = WriteRaw(offset_, buffer, bytes);
+				offset_ += bytesWritten;
 			}
 			return bytesWritten;
 		}
 
 		bool Seek(i64 offset) override
 		{
-			DBG_ASSERT(offset <= SIZE_MAX);
-			return 0 == ::fseek(fileHandle_, (long)offset, SEEK_SET);
+			if(offset < 0)
+				return false;
+			offset_ = offset;
+			return true;
 		}
 
-		i64 Tell() const override { return ::ftell(fileHandle_); }
+		i64 Tell() const override { return offset_; }
 
 		i64 Size() const override
 		{
 			i64 size = 0;
+#if PLATFORM_WINDOWS
+			struct _stat64 attrib;
+			if(0 == ::_fstat64(fileDescriptor_, &attrib))
+#else
 			struct stat attrib;
 			if(0 == ::fstat(fileDescriptor_, &attrib))
+#endif
 			{
 				size = attrib.st_size;
 			}
@@ -568,10 +662,225 @@ namespace Core
 
 		bool IsValid() const override { return fileDescriptor_ != -1; }
 
+		i32 GetDescriptor() const override { return fileDescriptor_; }
+
+		bool Prefetch(i64 offset, i64 size) override
+		{
+			if(mappedData_ || direct_)
+				return false;
+#if PLATFORM_LINUX
+			return 0 == ::posix_fadvise(fileDescriptor_, (off_t)offset, (off_t)size, POSIX_FADV_WILLNEED);
+#elif PLATFORM_OSX
+			struct radvisory advisory;
+			advisory.ra_offset = (off_t)offset;
+			advisory.ra_count = (int)Min(size, (i64)INT_MAX);
+			return -1 != ::fcntl(fileDescriptor_, F_RDADVISE, &advisory);
+#else
+			(void)offset;
+			(void)size;
+			return false;
+#endif
+		}
+
+		const void* Map(i64 offset, i64 size) override
+		{
+			if(offset < 0 || size <= 0)
+				return nullptr;
+			if(mappedData_)
+				return (offset + size) <= mappedSize_ ? mappedData_ + offset : nullptr;
+			if((offset + size) > Size())
+				return nullptr;
+
+			// Views must start on a granularity boundary, so map from the one before offset.
+			const i64 baseOffset = offset & ~(GetMapGranularity() - 1);
+			MappedView view;
+			view.size_ = size + (offset - baseOffset);
+			view.base_ = MapView(baseOffset, view.size_);
+			if(view.base_ == nullptr)
+				return nullptr;
+			view.data_ = static_cast<const u8*>(view.base_) + (offset - baseOffset);
+			views_.push_back(view);
+			return view.data_;
+		}
+
+		void Unmap(const void* data) override
+		{
+			if(mappedData_)
+			{
+				DBG_ASSERT_MSG(data >= mappedData_ && data < mappedData_ + mappedSize_, "Data not mapped from file.");
+				return;
+			}
+
+			for(auto it = views_.begin(); it != views_.end(); ++it)
+			{
+				if(it->data_ == data)
+				{
+					UnmapView(it->base_, it->size_);
+					views_.erase(it);
+					return;
+				}
+			}
+			DBG_ASSERT_MSG(false, "Data not mapped from file.");
+		}
+
 	private:
-		FILE* fileHandle_ = nullptr;
+		/// @return Bytes read at @a offset, fewer than @a bytes at end of file or on error.
+		i64 ReadRaw(i64 offset, void* buffer, i64 bytes) const
+		{
+			i64 bytesRead = 0;
+			while(bytesRead < bytes)
+			{
+				const i64 readSize = Min(bytes - bytesRead, MAX_IO_SIZE);
+#if PLATFORM_WINDOWS
+				OVERLAPPED overlapped = {};
+				overlapped.Offset = (DWORD)((offset + bytesRead) & 0xffffffff);
+				overlapped.OffsetHigh = (DWORD)((offset + bytesRead) >> 32);
+				DWORD numRead = 0;
+				HANDLE handle = (HANDLE)::_get_osfhandle(fileDescriptor_);
+				if(!::ReadFile(handle, (u8*)buffer + bytesRead, (DWORD)readSize, &numRead, &overlapped))
+					break;
+				const i64 result = numRead;
+#else
+				const i64 result =
+				    ::pread(fileDescriptor_, (u8*)buffer + bytesRead, (size_t)readSize, (off_t)(offset + bytesRead));
+				if(result < 0 && errno == EINTR)
+					continue;
+#endif
+				if(result <= 0)
+					break;
+				bytesRead += result;
+			}
+			return bytesRead;
+		}
+
+		/// @return Bytes written at @a offset, fewer than @a bytes on error.
+		i64 WriteRaw(i64 offset, const void* buffer, i64 bytes) const
+		{
+			i64 bytesWritten = 0;
+			while(bytesWritten < bytes)
+			{
+				const i64 writeSize = Min(bytes - bytesWritten, MAX_IO_SIZE);
+#if PLATFORM_WINDOWS
+				OVERLAPPED overlapped = {};
+				overlapped.Offset = (DWORD)((offset + bytesWritten) & 0xffffffff);
+				overlapped.OffsetHigh = (DWORD)((offset + bytesWritten) >> 32);
+				DWORD numWritten = 0;
+				HANDLE handle = (HANDLE)::_get_osfhandle(fileDescriptor_);
+				if(!::WriteFile(handle, (const u8*)buffer + bytesWritten, (DWORD)writeSize, &numWritten, &overlapped))
+					break;
+				const i64 result = numWritten;
+#else
+				const u8* src = (const u8*)buffer + bytesWritten;
+				const i64 result = ::pwrite(fileDescriptor_, src, (size_t)writeSize, (off_t)(offset + bytesWritten));
+				if(result < 0 && errno == EINTR)
+					continue;
+#endif
+				if(result <= 0)
+					break;
+				bytesWritten += result;
+			}
+			return bytesWritten;
+		}
+
+		/**
+		 * Read from a file opened with FileFlags::DIRECT.
+		 * Aligned reads go straight to @a buffer. Others read the aligned blocks around them into a bounce
+		 * buffer and copy out, as the OS rejects unaligned reads bypassing its cache.
+		 */
+		i64 ReadDirect(i64 offset, void* buffer, i64 bytes) const
+		{
+			const i64 mask = FILE_DIRECT_ALIGNMENT - 1;
+			if(((offset | bytes | (i64)(uintptr_t)buffer) & mask) == 0)
+				return ReadRaw(offset, buffer, bytes);
+
+			u8* bounceMem = ::new u8[DIRECT_BOUNCE_SIZE + FILE_DIRECT_ALIGNMENT];
+			u8* bounce = (u8*)PotRoundUp((uintptr_t)bounceMem, FILE_DIRECT_ALIGNMENT);
+			i64 bytesRead = 0;
+			while(bytesRead < bytes)
+			{
+				const i64 blockOffset = (offset + bytesRead) & ~mask;
+				const i64 skip = (offset + bytesRead) - blockOffset;
+				const i64 readSize =
+				    Min(PotRoundUp(skip + bytes - bytesRead, FILE_DIRECT_ALIGNMENT), DIRECT_BOUNCE_SIZE);
+				const i64 result = ReadRaw(blockOffset, bounce, readSize);
+				if(result <= skip)
+					break;
+				const i64 copySize = Min(result - skip, bytes - bytesRead);
+				memcpy((u8*)buffer + bytesRead, bounce + skip, copySize);
+				bytesRead += copySize;
+				if(result < readSize)
+					break;
+			}
+			delete[] bounceMem;
+			return bytesRead;
+		}
+
+		/// View returned by Map.
+		struct MappedView
+		{
+			const void* data_ = nullptr;
+			const void* base_ = nullptr;
+			i64 size_ = 0;
+		};
+
+		/// @return Alignment required for the offset of a view.
+		static i64 GetMapGranularity()
+		{
+#if PLATFORM_WINDOWS
+			static const i64 granularity = []() {
+				SYSTEM_INFO systemInfo;
+				::GetSystemInfo(&systemInfo);
+				return (i64)systemInfo.dwAllocationGranularity;
+			}();
+#else
+			static const i64 granularity = (i64)::sysconf(_SC_PAGESIZE);
+#endif
+			return granularity;
+		}
+
+		const void* MapView(i64 offset, i64 size)
+		{
+#if PLATFORM_WINDOWS
+			if(mappingHandle_ == nullptr)
+			{
+				HANDLE handle = (HANDLE)::_get_osfhandle(fileDescriptor_);
+				mappingHandle_ = ::CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if(mappingHandle_ == nullptr)
+					return nullptr;
+			}
+			return ::MapViewOfFile(
+			    mappingHandle_, FILE_MAP_READ, (DWORD)(offset >> 32), (DWORD)(offset & 0xffffffff), (SIZE_T)size);
+#else
+			void* data = ::mmap(nullptr, (size_t)size, PROT_READ, MAP_PRIVATE, fileDescriptor_, (off_t)offset);
+			return data != MAP_FAILED ? data : nullptr;
+#endif
+		}
+
+		static void UnmapView(const void* base, i64 size)
+		{
+#if PLATFORM_WINDOWS
+			(void)size;
+			::UnmapViewOfFile(base);
+#else
+			::munmap(const_cast<void*>(base), (size_t)size);
+#endif
+		}
+
 		int fileDescriptor_ = -1;
 		FileFlags flags_ = FileFlags::NONE;
+		/// Position for Read, Write, Seek and Tell.
+		i64 offset_ = 0;
+		/// Opened bypassing the OS file cache.
+		bool direct_ = false;
+
+		/// Whole file, if opened with FileFlags::MMAP.
+		const u8* mappedData_ = nullptr;
+		i64 mappedSize_ = 0;
+		/// Views from Map, when the whole file isn't mapped.
+		Vector<MappedView> views_;
+#if PLATFORM_WINDOWS
+		HANDLE mappingHandle_ = nullptr;
+#endif
 	};
 
 	class FileImplMem : public FileImpl
@@ -597,12 +906,18 @@ namespace Core
 
 		i64 Read(void* buffer, i64 bytes) override
 		{
-			if(ContainsAnyFlags(flags_, FileFlags::READ))
+			const i64 copyBytes = ReadAt(offset_, buffer, bytes);
+			offset_ += copyBytes;
+			return copyBytes;
+		}
+
+		i64 ReadAt(i64 offset, void* buffer, i64 bytes) const override
+		{
+			if(ContainsAnyFlags(flags_, FileFlags::READ) && offset >= 0)
 			{
-				const i64 remaining = size_ - offset_;
-				const i64 copyBytes = Min(remaining, bytes);
-				memcpy(buffer, (const u8*)constData_ + offset_, copyBytes);
-				offset_ += copyBytes;
+				const i64 remaining = size_ - offset;
+				const i64 copyBytes = Max((i64)0, Min(remaining, bytes));
+				memcpy(buffer, (const u8*)constData_ + offset, copyBytes);
 				return copyBytes;
 			}
 			return 0;
@@ -623,7 +938,7 @@ namespace Core
 
 		bool Seek(i64 offset) override
 		{
-			if(offset < size_)
+			if(offset >= 0 && offset <= size_)
 			{
 				offset_ = offset;
 				return true;
@@ -639,6 +954,19 @@ namespace Core
 
 		bool IsValid() const override { return !!constData_; }
 
+		const void* Map(i64 offset, i64 size) override
+		{
+			if(offset < 0 || size <= 0 || (offset + size) > size_)
+				return nullptr;
+			return (const u8*)constData_ + offset;
+		}
+
+		void Unmap(const void*) override {}
+
+		bool Prefetch(i64, i64) override { return false; }
+
+		i32 GetDescriptor() const override { return -1; }
+
 	private:
 		/// Choosing this over const_cast.
 		union
@@ -657,6 +985,11 @@ namespace Core
 		DBG_ASSERT(ContainsAnyFlags(flags, FileFlags::WRITE) ||
 		           (ContainsAnyFlags(flags, FileFlags::READ) &&
 		               !ContainsAnyFlags(flags, FileFlags::APPEND | FileFlags::CREATE)));
+		DBG_ASSERT(!ContainsAnyFlags(flags, FileFlags::MMAP | FileFlags::DIRECT | FileFlags::SEQUENTIAL |
+		                                        FileFlags::RANDOM) ||
+		           ContainsAnyFlags(flags, FileFlags::READ));
+		DBG_ASSERT(!ContainsAllFlags(flags, FileFlags::MMAP | FileFlags::DIRECT));
+		DBG_ASSERT(!ContainsAllFlags(flags, FileFlags::SEQUENTIAL | FileFlags::RANDOM));
 
 		impl_ = new FileImplNative(path, flags, resolver);
 		if(!impl_->IsValid())
@@ -705,6 +1038,13 @@ namespace Core
 		return impl_->Read(buffer, bytes);
 	}
 
+	i64 File::ReadAt(i64 offset, void* buffer, i64 bytes) const
+	{
+		DBG_ASSERT(ContainsAllFlags(GetFlags(), FileFlags::READ));
+		DBG_ASSERT(offset >= 0);
+		return impl_->ReadAt(offset, buffer, bytes);
+	}
+
 	i64 File::Write(const void* buffer, i64 bytes)
 	{
 		DBG_ASSERT(ContainsAllFlags(GetFlags(), FileFlags::WRITE));
@@ -731,6 +1071,33 @@ namespace Core
 		return impl_->Size();
 	}
 
+	const void* File::Map(i64 offset, i64 size)
+	{
+		DBG_ASSERT(ContainsAllFlags(GetFlags(), FileFlags::READ));
+		DBG_ASSERT(size > 0);
+		return impl_->Map(offset, size);
+	}
+
+	void File::Unmap(const void* data)
+	{
+		DBG_ASSERT(impl_);
+		if(data)
+			impl_->Unmap(data);
+	}
+
+	bool File::Prefetch(i64 offset, i64 size)
+	{
+		DBG_ASSERT(ContainsAllFlags(GetFlags(), FileFlags::READ));
+		DBG_ASSERT(offset >= 0 && size > 0);
+		return impl_->Prefetch(offset, size);
+	}
+
+	i32 File::GetDescriptor() const
+	{
+		DBG_ASSERT(impl_);
+		return impl_->GetDescriptor();
+	}
+
 	FileFlags File::GetFlags() const
 	{ //
 		return impl_ ? impl_->GetFlags() : FileFlags::NONE;
@@ -1,38 +1,258 @@
 #include "core/handle.h"
-#include "core/array.h"
+#include "core/concurrency.h"
 #include "core/debug.h"
+#include "core/misc.h"
 #include "core/vector.h"
 
 #include <utility>
 
 namespace Core
 {
-	struct HandleAllocatorImpl
+	struct HandleAllocatorImpl;
+
+	namespace
 	{
+		/// Free indices to keep per type in a thread's cache. When exceeded, half are returned to the free list.
+		static const i32 MAX_CACHED = 64;
+		/// Indices to take from the free list on a miss.
+		static const i32 REFILL_COUNT = 16;
+
+		/// Free list head. Low 32 bits are index + 1 (0 for empty), high 32 bits are a tag to avoid ABA.
+		inline i32 GetHeadIndex(i64 head) { return (i32)(u32)(head & 0xffffffff) - 1; }
+		inline i64 MakeHead(i64 prevHead, i32 index) { return (((prevHead >> 32) + 1) << 32) | (u32)(index + 1); }
+
+		/**
+		 * Shared state for a type, padded to a cache line to avoid false sharing between types.
+		 */
 		struct TypeData
 		{
-			Core::Vector<u32> freeList_;
-			Core::Vector<u8> allocated_;
+			/// Free list head, linked through nextFree_.
+			volatile i64 freeHead_ = 0;
+			/// Indices at and above this have never been allocated.
+			volatile i32 nextIndex_ = 0;
+			/// Live handles, updated once per Alloc or Free batch.
+			volatile i32 numAllocated_ = 0;
+			u8 padding_[CACHE_LINE_SIZE - sizeof(i64) - sizeof(i32) * 2];
+		};
+
+		struct ThreadCache
+		{
+			i32 indices_[Handle::MAX_TYPE][MAX_CACHED];
+			i32 numIndices_[Handle::MAX_TYPE] = {0};
+
+			/// Allocator the cache belongs to. nullptr once the allocator is destroyed, the thread then deletes it.
+			HandleAllocatorImpl* impl_ = nullptr;
+		};
+
+		/// Guards handing ownership of caches between allocators and exiting threads.
+		Mutex& GetCacheOwnerMutex()
+		{
+			static Mutex mutex;
+			return mutex;
+		}
+
+		/// Caches used by this thread, so their indices go back to the free lists when it exits.
+		struct ThreadCaches
+		{
+			Vector<ThreadCache*> caches_;
+
+			~ThreadCaches();
 		};
+		thread_local ThreadCaches threadCaches_;
+	} // namespace
+
+	struct HandleAllocatorImpl
+	{
+		HandleAllocatorImpl(i32 numTypes)
+		    : numTypes_(numTypes)
+		{
+			types_ = new TypeData[numTypes];
+			nextFree_ = new volatile i32[numTypes * Handle::MAX_INDEX];
+		}
+
+		~HandleAllocatorImpl()
+		{
+			ScopedMutex lock(GetCacheOwnerMutex());
+			for(ThreadCache* cache : caches_)
+				cache->impl_ = nullptr;
+			delete[] nextFree_;
+			delete[] types_;
+		}
+
+		i32 numTypes_ = 0;
+		TypeData* types_ = nullptr;
+		/// Free list links, indexed the same as magic IDs.
+		volatile i32* nextFree_ = nullptr;
+		TLS tls_;
+
+		/// Caches of live threads, so they can be detached on destruction. Guarded by GetCacheOwnerMutex().
+		Vector<ThreadCache*> caches_;
+
+		ThreadCache* GetCache()
+		{
+			auto* cache = (ThreadCache*)tls_.Get();
+			if(cache == nullptr)
+			{
+				cache = new ThreadCache();
+				cache->impl_ = this;
+				tls_.Set(cache);
+
+				ScopedMutex ownerLock(GetCacheOwnerMutex());
+				caches_.push_back(cache);
+
+				// Drop caches of allocators destroyed since, so long lived threads don't accumulate them.
+				Vector<ThreadCache*>& threadCaches = threadCaches_.caches_;
+				for(i32 i = 0; i < threadCaches.size();)
+				{
+					if(threadCaches[i]->impl_ == nullptr)
+					{
+						delete threadCaches[i];
+						threadCaches[i] = threadCaches.back();
+						threadCaches.pop_back();
+					}
+					else
+						++i;
+				}
+				threadCaches.push_back(cache);
+			}
+			return cache;
+		}
+
+		/**
+		 * Return all of @a cache's indices to the free lists.
+		 */
+		void Flush(ThreadCache* cache)
+		{
+			for(i32 type = 0; type < numTypes_; ++type)
+			{
+				Release(type, cache->indices_[type], cache->numIndices_[type]);
+				cache->numIndices_[type] = 0;
+			}
+		}
+
+		/**
+		 * Take up to @a count free indices of @a type, from the free list then never allocated indices.
+		 * @return Number of indices taken.
+		 */
+		i32 Acquire(i32 type, i32* outIndices, i32 count)
+		{
+			TypeData& typeData = types_[type];
+			volatile i32* nextFree = nextFree_ + (type * Handle::MAX_INDEX);
+
+			// Pop a chain of up to count with a single CAS. Links may change under us if another thread
+			// pops first, but they always stay in range, and the tag makes our CAS fail.
+			i32 numIndices = 0;
+			i64 head = AtomicLoadAcq(&typeData.freeHead_);
+			for(;;)
+			{
+				i32 index = GetHeadIndex(head);
+				if(index < 0)
+					break;
+				numIndices = 0;
+				outIndices[numIndices++] = index;
+				i32 next = nextFree[index];
+				while(next >= 0 && numIndices < count)
+				{
+					outIndices[numIndices++] = next;
+					next = nextFree[next];
+				}
+				const i64 prevHead = AtomicCmpExchgAcq(&typeData.freeHead_, MakeHead(head, next), head);
+				if(prevHead == head)
+					break;
+				head = prevHead;
+				numIndices = 0;
+			}
 
-		Core::Array<TypeData, Handle::MAX_TYPE> types_;
+			// Claim never allocated indices for the rest.
+			if(numIndices < count)
+			{
+				i32 nextIndex = AtomicLoadAcq(&typeData.nextIndex_);
+				for(;;)
+				{
+					i32 numNew = Core::Min(count - numIndices, Handle::MAX_INDEX - nextIndex);
+					if(numNew <= 0)
+						break;
+					const i32 prevIndex = AtomicCmpExchg(&typeData.nextIndex_, nextIndex + numNew, nextIndex);
+					if(prevIndex == nextIndex)
+					{
+						for(i32 i = 0; i < numNew; ++i)
+							outIndices[numIndices++] = nextIndex + i;
+						break;
+					}
+					nextIndex = prevIndex;
+				}
+			}
+			return numIndices;
+		}
+
+		/**
+		 * Push indices of @a type onto the free list with a single CAS.
+		 */
+		void Release(i32 type, const i32* indices, i32 count)
+		{
+			if(count == 0)
+				return;
+			TypeData& typeData = types_[type];
+			volatile i32* nextFree = nextFree_ + (type * Handle::MAX_INDEX);
+
+			for(i32 i = 0; i < (count - 1); ++i)
+				nextFree[indices[i]] = indices[i + 1];
+
+			const i32 last = indices[count - 1];
+			i64 head = AtomicLoadAcq(&typeData.freeHead_);
+			for(;;)
+			{
+				nextFree[last] = GetHeadIndex(head);
+				const i64 prevHead = AtomicCmpExchgRel(&typeData.freeHead_, MakeHead(head, indices[0]), head);
+				if(prevHead == head)
+					break;
+				head = prevHead;
+			}
+		}
 	};
 
 	namespace
 	{
-		inline u16& GetMagicID(u16* magicIds, u32 index, u32 type)
+		ThreadCaches::~ThreadCaches()
 		{
-			return magicIds[index + (type * Handle::MAX_MAGIC)];
+			ScopedMutex lock(GetCacheOwnerMutex());
+			for(ThreadCache* cache : caches_)
+			{
+				if(HandleAllocatorImpl* impl = cache->impl_)
+				{
+					impl->Flush(cache);
+					Vector<ThreadCache*>& implCaches = impl->caches_;
+					for(i32 i = 0; i < implCaches.size(); ++i)
+					{
+						if(implCaches[i] == cache)
+						{
+							implCaches[i] = implCaches.back();
+							implCaches.pop_back();
+							break;
+						}
+					}
+				}
+				delete cache;
+			}
 		}
-	}
+	} // namespace
 
 	HandleAllocator::HandleAllocator(i32 numTypes)
 	{
-		const i32 magicSize = Handle::MAX_TYPE * Handle::MAX_MAGIC;
-		magicIDs_ = new u16[magicSize];
+		DBG_ASSERT(numTypes > 0 && numTypes <= Handle::MAX_TYPE);
+		numTypes_ = numTypes;
+		const i32 magicSize = numTypes * Handle::MAX_INDEX;
+		magicIDs_ = new volatile u16[magicSize];
 		for(i32 i = 0; i < magicSize; ++i)
 			magicIDs_[i] = 1;
-		impl_ = new HandleAllocatorImpl();
+		impl_ = new HandleAllocatorImpl(numTypes);
+	}
+
+	HandleAllocator::HandleAllocator(HandleAllocator&& other)
+	{
+		std::swap(magicIDs_, other.magicIDs_);
+		std::swap(numTypes_, other.numTypes_);
+		std::swap(impl_, other.impl_);
 	}
 
 	HandleAllocator::~HandleAllocator()
@@ -43,78 +263,93 @@ namespace Core
 
 	Handle HandleAllocator::Alloc(i32 type)
 	{
-		DBG_ASSERT(type >= 0 && type < impl_->types_.size());
-		HandleAllocatorImpl::TypeData& typeData = impl_->types_[type];
-
 		Handle handle;
+		Alloc(type, &handle, 1);
+		return handle;
+	}
 
-		// Reuse index from freelist if we can.
-		bool validHandle = false;
-		if(typeData.freeList_.size() > 0)
-		{
-			handle.index_ = typeData.freeList_.back();
-			typeData.freeList_.pop_back();
-			handle.type_ = type;
-			validHandle = true;
-		}
-		else
-		{
-			// Nothing in the free list, push new one into allocated.
-			if(typeData.allocated_.size() < Handle::MAX_INDEX)
-			{
-				typeData.allocated_.push_back(0);
-				handle.index_ = typeData.allocated_.size() - 1;
-				handle.type_ = type;
-				validHandle = true;
-			}
-		}
+	i32 HandleAllocator::Alloc(i32 type, Handle* outHandles, i32 count)
+	{
+		DBG_ASSERT(type >= 0 && type < numTypes_);
+		DBG_ASSERT(count >= 0);
+		ThreadCache* cache = impl_->GetCache();
+		i32* cached = cache->indices_[type];
+		i32& numCached = cache->numIndices_[type];
 
-		if(validHandle)
+		i32 numAllocated = 0;
+		while(numAllocated < count)
 		{
-			if((i32)handle.index_ >= typeData.allocated_.size())
+			if(numCached == 0)
 			{
-				typeData.allocated_.resize((i32)handle.index_ + 1, 0);
+				// Take what is still needed plus some spare, without overflowing the cache.
+				const i32 numWanted = Core::Min(count - numAllocated + REFILL_COUNT, MAX_CACHED);
+				numCached = impl_->Acquire(type, cached, numWanted);
+				if(numCached == 0)
+					break;
 			}
-			DBG_ASSERT(typeData.allocated_[handle.index_] == 0);
-			typeData.allocated_[handle.index_] = 1;
-			handle.magic_ = GetMagicID(magicIDs_, handle.index_, handle.type_);
+
+			Handle& handle = outHandles[numAllocated++];
+			handle.index_ = cached[--numCached];
+			handle.type_ = type;
+			handle.magic_ = magicIDs_[handle.index_ + (type * Handle::MAX_INDEX)];
 		}
-		return handle;
+
+		if(numAllocated > 0)
+			AtomicAdd(&impl_->types_[type].numAllocated_, numAllocated);
+		return numAllocated;
 	}
 
-	void HandleAllocator::Free(Handle handle)
+	void HandleAllocator::Free(Handle handle) { Free(&handle, 1); }
+
+	void HandleAllocator::Free(const Handle* handles, i32 count)
 	{
-		DBG_ASSERT_MSG(IsValid(handle), "Attempting to free invalid handle.");
-		DBG_ASSERT((i32)handle.type_ < impl_->types_.size());
-		HandleAllocatorImpl::TypeData& typeData = impl_->types_[handle.type_];
+		ThreadCache* cache = impl_->GetCache();
 
-		// Increment magic, wrap if hit zero.
-		u16& magic = GetMagicID(magicIDs_, handle.index_, handle.type_);
-		if(++magic == 0)
+		// Counts are updated once per run of same typed handles, rather than once per handle.
+		i32 runType = -1;
+		i32 runCount = 0;
+		for(i32 i = 0; i < count; ++i)
 		{
-			++magic;
-		}
+			const Handle handle = handles[i];
+			DBG_ASSERT_MSG(IsValid(handle), "Attempting to free invalid handle.");
+			const i32 type = handle.type_;
+			if(type != runType)
+			{
+				if(runCount > 0)
+					AtomicAdd(&impl_->types_[runType].numAllocated_, -runCount);
+				runType = type;
+				runCount = 0;
+			}
+			++runCount;
 
-		// Mark unallocated.
-		typeData.allocated_[handle.index_] = 0;
+			// Increment magic, wrapping at MAX_MAGIC and skipping zero. Not atomic: only the handle's owner
+			// may free it, so no other thread writes this magic until the index is reallocated.
+			volatile u16& magic = magicIDs_[handle.index_ + (type * Handle::MAX_INDEX)];
+			const u16 oldMagic = magic;
+			DBG_ASSERT_MSG(oldMagic == handle.magic_, "Handle freed concurrently from multiple threads.");
+			u16 newMagic = (u16)((oldMagic + 1) & (Handle::MAX_MAGIC - 1));
+			if(newMagic == 0)
+				++newMagic;
+			magic = newMagic;
 
-		// Add to free list.
-		typeData.freeList_.push_back(handle.index_);
+			// Add to cache, returning half to the free list when full.
+			i32* cached = cache->indices_[type];
+			i32& numCached = cache->numIndices_[type];
+			if(numCached == MAX_CACHED)
+			{
+				numCached -= MAX_CACHED / 2;
+				impl_->Release(type, cached + numCached, MAX_CACHED / 2);
+			}
+			cached[numCached++] = handle.index_;
+		}
+		if(runCount > 0)
+			AtomicAdd(&impl_->types_[runType].numAllocated_, -runCount);
 	}
 
-
 	i32 HandleAllocator::GetTotalHandles(i32 type) const
 	{
-		DBG_ASSERT((i32)type < impl_->types_.size());
-		HandleAllocatorImpl::TypeData& typeData = impl_->types_[type];
-		i32 totalHandles = 0;
-		for(auto alloc : typeData.allocated_)
-		{
-			if(alloc)
-				++totalHandles;
-		}
-		return totalHandles;
+		DBG_ASSERT(type >= 0 && type < numTypes_);
+		return AtomicLoadAcq(&impl_->types_[type].numAllocated_);
 	}
 
-
 } // namespace Core
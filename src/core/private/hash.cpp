@@ -1,24 +1,187 @@
 #include "core/hash.h"
 
+#if ARCH_X86_64
+#include <emmintrin.h>
+#include <nmmintrin.h>
+#if COMPILER_MSVC
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif ARCH_ARM64 && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 #include <cstring>
 
 namespace Core
 {
+	namespace
+	{
+		/// Lanes hashed at once by the multi-buffer hashes.
+		const i32 NUM_LANES = 4;
+
+#if ARCH_X86_64
+		/// NUM_LANES u32s, so hashing code can be instanced for a single buffer or several at once.
+		struct U32x4
+		{
+			__m128i v_;
+		};
+
+		inline U32x4 operator+(U32x4 a, U32x4 b) { return {_mm_add_epi32(a.v_, b.v_)}; }
+		inline U32x4 operator+(U32x4 a, u32 b) { return {_mm_add_epi32(a.v_, _mm_set1_epi32((int)b))}; }
+		inline U32x4 operator&(U32x4 a, U32x4 b) { return {_mm_and_si128(a.v_, b.v_)}; }
+		inline U32x4 operator|(U32x4 a, U32x4 b) { return {_mm_or_si128(a.v_, b.v_)}; }
+		inline U32x4 operator^(U32x4 a, U32x4 b) { return {_mm_xor_si128(a.v_, b.v_)}; }
+		inline U32x4 operator~(U32x4 a) { return {_mm_xor_si128(a.v_, _mm_set1_epi32(-1))}; }
+		inline U32x4 operator<<(U32x4 a, i32 bits) { return {_mm_slli_epi32(a.v_, bits)}; }
+		inline U32x4 operator>>(U32x4 a, i32 bits) { return {_mm_srli_epi32(a.v_, bits)}; }
+		inline U32x4 U32x4Load(const u32* vals) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(vals))}; }
+		inline void U32x4Store(u32* outVals, U32x4 a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(outVals), a.v_); }
+#else
+		/// NUM_LANES u32s, so hashing code can be instanced for a single buffer or several at once.
+		struct U32x4
+		{
+			u32 v_[NUM_LANES];
+		};
+
+#define U32X4_OP(EXPR)                                                                                                 \
+	U32x4 r;                                                                                                           \
+	for(i32 lane = 0; lane < NUM_LANES; ++lane)                                                                        \
+		r.v_[lane] = EXPR;                                                                                             \
+	return r;
+		inline U32x4 operator+(U32x4 a, U32x4 b) { U32X4_OP(a.v_[lane] + b.v_[lane]) }
+		inline U32x4 operator+(U32x4 a, u32 b) { U32X4_OP(a.v_[lane] + b) }
+		inline U32x4 operator&(U32x4 a, U32x4 b) { U32X4_OP(a.v_[lane] & b.v_[lane]) }
+		inline U32x4 operator|(U32x4 a, U32x4 b) { U32X4_OP(a.v_[lane] | b.v_[lane]) }
+		inline U32x4 operator^(U32x4 a, U32x4 b) { U32X4_OP(a.v_[lane] ^ b.v_[lane]) }
+		inline U32x4 operator~(U32x4 a) { U32X4_OP(~a.v_[lane]) }
+		inline U32x4 operator<<(U32x4 a, i32 bits) { U32X4_OP(a.v_[lane] << bits) }
+		inline U32x4 operator>>(U32x4 a, i32 bits) { U32X4_OP(a.v_[lane] >> bits) }
+		inline U32x4 U32x4Load(const u32* vals) { U32X4_OP(vals[lane]) }
+		inline void U32x4Store(u32* outVals, U32x4 a) { memcpy(outVals, a.v_, sizeof(a.v_)); }
+#undef U32X4_OP
+#endif
+		inline U32x4& operator+=(U32x4& a, U32x4 b) { return a = a + b; }
+		inline U32x4& operator+=(U32x4& a, u32 b) { return a = a + b; }
+
+		inline u32 LoadLittleEndian(const u8* bytes)
+		{
+			return (u32)bytes[0] | ((u32)bytes[1] << 8) | ((u32)bytes[2] << 16) | ((u32)bytes[3] << 24);
+		}
+
+		inline u32 LoadBigEndian(const u8* bytes)
+		{
+			return ((u32)bytes[0] << 24) | ((u32)bytes[1] << 16) | ((u32)bytes[2] << 8) | (u32)bytes[3];
+		}
+
+		/// Load @a NUM_WORDS words of a block for a single buffer.
+		template<u32 (*LOAD)(const u8*)>
+		void LoadBlock(u32* outWords, i32 numWords, const u8* block)
+		{
+			for(i32 i = 0; i < numWords; ++i)
+				outWords[i] = LOAD(block + i * 4);
+		}
+
+		/// Load words of a block from each lane, transposed so each U32x4 holds the same word of every lane.
+		template<u32 (*LOAD)(const u8*)>
+		void LoadBlock(U32x4* outWords, i32 numWords, const u8* const* blocks)
+		{
+			for(i32 i = 0; i < numWords; ++i)
+			{
+				u32 words[NUM_LANES];
+				for(i32 lane = 0; lane < NUM_LANES; ++lane)
+					words[lane] = LOAD(blocks[lane] + i * 4);
+				outWords[i] = U32x4Load(words);
+			}
+		}
+
+		/**
+		 * Hash whole blocks for several lanes at once.
+		 * Lanes with less than a block to hash are left for the caller to hash one at a time; it isn't worth
+		 * SIMD for a single lane.
+		 * @param data Data for each lane. Advanced past whole blocks that were hashed.
+		 * @param sizes Size of data for each lane. Reduced by bytes hashed.
+		 * @param transform Function taking the first block for each lane, which lanes are active, and the
+		 * number of consecutive blocks to hash. Inactive lanes should reuse their block, and not be stored.
+		 */
+		template<typename TRANSFORM>
+		void TransformLanes(const u8** data, size_t* sizes, TRANSFORM&& transform)
+		{
+			static const u8 IDLE_BLOCK[64] = {};
+			for(;;)
+			{
+				const u8* blocks[NUM_LANES];
+				bool active[NUM_LANES];
+				i32 numActive = 0;
+				size_t numBlocks = 0;
+				for(i32 lane = 0; lane < NUM_LANES; ++lane)
+				{
+					const size_t laneBlocks = sizes[lane] / 64;
+					active[lane] = laneBlocks > 0;
+					blocks[lane] = active[lane] ? data[lane] : IDLE_BLOCK;
+					if(active[lane])
+					{
+						numBlocks = (numActive == 0 || laneBlocks < numBlocks) ? laneBlocks : numBlocks;
+						++numActive;
+					}
+				}
+				if(numActive < 2)
+					return;
+
+				transform(blocks, active, numBlocks);
+				for(i32 lane = 0; lane < NUM_LANES; ++lane)
+				{
+					if(active[lane])
+					{
+						data[lane] += numBlocks * 64;
+						sizes[lane] -= numBlocks * 64;
+					}
+				}
+			}
+		}
+
+		/// Load state word @a idx of each lane.
+		template<typename CONTEXT>
+		U32x4 LoadLaneState(const CONTEXT* lanes, i32 idx, u32 (*getState)(const CONTEXT&, i32))
+		{
+			u32 words[NUM_LANES];
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+				words[lane] = getState(lanes[lane], idx);
+			return U32x4Load(words);
+		}
+
+		/**
+		 * Top up any partial blocks in each lane, so the rest of the data can be hashed straight from the input.
+		 */
+		template<typename CONTEXT>
+		void PrepareLanes(CONTEXT* lanes, u32 (*getBuffered)(const CONTEXT&), const void* const* data,
+		    const size_t* sizes, const u8** outData, size_t* outSizes)
+		{
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			{
+				outData[lane] = static_cast<const u8*>(data[lane]);
+				outSizes[lane] = sizes[lane];
+				const u32 buffered = getBuffered(lanes[lane]);
+				if(buffered > 0 && outSizes[lane] > 0)
+				{
+					const size_t fill = outSizes[lane] < 64 - buffered ? outSizes[lane] : 64 - buffered;
+					lanes[lane].Update(outData[lane], fill);
+					outData[lane] += fill;
+					outSizes[lane] -= fill;
+				}
+			}
+		}
+	} // namespace
+
 // MD5: https://github.com/B-Con/crypto-algorithms
+// Transform is templated on word type, so it can hash a single buffer with u32, or NUM_LANES with U32x4.
 #if PLATFORM_WINDOWS
 #pragma warning(push)
 #pragma warning(disable : 4244)
 #endif
 	namespace
 	{
-		struct MD5_CTX
-		{
-			u8 data[64];
-			u16 datalen;
-			u64 bitlen;
-			u32 state[4];
-		};
-
 #define ROTLEFT(a, b) ((a << b) | (a >> (32 - b)))
 
 #define F(x, y, z) ((x & y) | (~x & z))
@@ -47,20 +210,13 @@ namespace Core
 		a = b + ROTLEFT(a, s);                                                                                         \
 	}
 
-		void md5_transform(MD5_CTX* ctx, const u8 data[])
+		template<typename WORD>
+		void md5_transform(WORD state[4], const WORD m[16])
 		{
-			u32 a, b, c, d, m[16], i, j;
-
-			// MD5 specifies big endian byte order, but this implementation assumes a little
-			// endian byte order CPU. Reverse all the bytes upon input, and re-reverse them
-			// on output (in md5_final()).
-			for(i = 0, j = 0; i < 16; ++i, j += 4)
-				m[i] = (data[j]) + (data[j + 1] << 8) + (data[j + 2] << 16) + (data[j + 3] << 24);
-
-			a = ctx->state[0];
-			b = ctx->state[1];
-			c = ctx->state[2];
-			d = ctx->state[3];
+			WORD a = state[0];
+			WORD b = state[1];
+			WORD c = state[2];
+			WORD d = state[3];
 
 			FF(a, b, c, d, m[0], 7, 0xd76aa478);
 			FF(d, a, b, c, m[1], 12, 0xe8c7b756);
@@ -130,98 +286,152 @@ namespace Core
 			II(c, d, a, b, m[2], 15, 0x2ad7d2bb);
 			II(b, c, d, a, m[9], 21, 0xeb86d391);
 
-			ctx->state[0] += a;
-			ctx->state[1] += b;
-			ctx->state[2] += c;
-			ctx->state[3] += d;
+			state[0] += a;
+			state[1] += b;
+			state[2] += c;
+			state[3] += d;
 		}
 
-		void md5_init(MD5_CTX* ctx)
+		void md5_transform_block(u32 state[4], const u8 block[64])
 		{
-			ctx->datalen = 0;
-			ctx->bitlen = 0;
-			ctx->state[0] = 0x67452301;
-			ctx->state[1] = 0xEFCDAB89;
-			ctx->state[2] = 0x98BADCFE;
-			ctx->state[3] = 0x10325476;
+			u32 m[16];
+			LoadBlock<LoadLittleEndian>(m, 16, block);
+			md5_transform(state, m);
 		}
+	} // namespace
+#if PLATFORM_WINDOWS
+#pragma warning(pop)
+#endif
+
+	void HashMD5Context::Init()
+	{
+		state_[0] = 0x67452301;
+		state_[1] = 0xEFCDAB89;
+		state_[2] = 0x98BADCFE;
+		state_[3] = 0x10325476;
+		size_ = 0;
+		dataLen_ = 0;
+	}
 
-		void md5_update(MD5_CTX* ctx, const u8* data, size_t len)
+	void HashMD5Context::Update(const void* data, size_t size)
+	{
+		if(size == 0)
+			return;
+		const u8* bytes = static_cast<const u8*>(data);
+		size_ += size;
+		if(dataLen_ > 0)
 		{
-			size_t i;
+			const u32 fill = size < 64 - dataLen_ ? (u32)size : 64 - dataLen_;
+			memcpy(data_ + dataLen_, bytes, fill);
+			dataLen_ += fill;
+			bytes += fill;
+			size -= fill;
+			if(dataLen_ < 64)
+				return;
+			md5_transform_block(state_, data_);
+			dataLen_ = 0;
+		}
 
-			for(i = 0; i < len; ++i)
-			{
-				ctx->data[ctx->datalen] = data[i];
-				ctx->datalen++;
-				if(ctx->datalen == 64)
-				{
-					md5_transform(ctx, ctx->data);
-					ctx->bitlen += 512;
-					ctx->datalen = 0;
-				}
-			}
+		// Hash whole blocks directly from the input.
+		for(; size >= 64; size -= 64, bytes += 64)
+			md5_transform_block(state_, bytes);
+
+		memcpy(data_, bytes, size);
+		dataLen_ = (u32)size;
+	}
+
+	HashMD5Digest HashMD5Context::Final()
+	{
+		const u64 bitLen = size_ * 8;
+
+		// Pad with a 1 bit, zeroes, then the length in bits.
+		u32 i = dataLen_;
+		data_[i++] = 0x80;
+		if(i > 56)
+		{
+			memset(data_ + i, 0, 64 - i);
+			md5_transform_block(state_, data_);
+			i = 0;
 		}
+		memset(data_ + i, 0, 56 - i);
+		for(i = 0; i < 8; ++i)
+			data_[56 + i] = (u8)(bitLen >> (i * 8));
+		md5_transform_block(state_, data_);
 
-		void md5_final(MD5_CTX* ctx, u8* hash)
+		HashMD5Digest digest;
+		for(i = 0; i < 4; ++i)
 		{
-			size_t i;
+			digest.data8_[i] = (state_[0] >> (i * 8)) & 0x000000ff;
+			digest.data8_[i + 4] = (state_[1] >> (i * 8)) & 0x000000ff;
+			digest.data8_[i + 8] = (state_[2] >> (i * 8)) & 0x000000ff;
+			digest.data8_[i + 12] = (state_[3] >> (i * 8)) & 0x000000ff;
+		}
+		return digest;
+	}
 
-			i = ctx->datalen;
+	void HashMD5MultiContext::Init()
+	{
+		for(auto& lane : lanes_)
+			lane.Init();
+	}
 
-			// Pad whatever data is left in the buffer.
-			if(ctx->datalen < 56)
-			{
-				ctx->data[i++] = 0x80;
-				while(i < 56)
-					ctx->data[i++] = 0x00;
-			}
-			else if(ctx->datalen >= 56)
+	void HashMD5MultiContext::Update(const void* const* data, const size_t* sizes)
+	{
+		static_assert(NUM_LANES == Core::NUM_LANES, "Lane count mismatch.");
+
+		const u8* laneData[NUM_LANES];
+		size_t laneSizes[NUM_LANES];
+		PrepareLanes<HashMD5Context>(
+		    lanes_, [](const HashMD5Context& lane) { return lane.dataLen_; }, data, sizes, laneData, laneSizes);
+
+		TransformLanes(laneData, laneSizes, [this](const u8* const* blocks, const bool* active, size_t numBlocks) {
+			auto getState = [](const HashMD5Context& lane, i32 idx) { return lane.state_[idx]; };
+			U32x4 state[4];
+			for(i32 i = 0; i < 4; ++i)
+				state[i] = LoadLaneState<HashMD5Context>(lanes_, i, getState);
+
+			const u8* laneBlocks[NUM_LANES];
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+				laneBlocks[lane] = blocks[lane];
+			for(size_t block = 0; block < numBlocks; ++block)
 			{
-				ctx->data[i++] = 0x80;
-				while(i < 64)
-					ctx->data[i++] = 0x00;
-				md5_transform(ctx, ctx->data);
-				memset(ctx->data, 0, 56);
+				U32x4 m[16];
+				LoadBlock<LoadLittleEndian>(m, 16, laneBlocks);
+				md5_transform(state, m);
+				for(i32 lane = 0; lane < NUM_LANES; ++lane)
+					laneBlocks[lane] += active[lane] ? 64 : 0;
 			}
 
-			// Append to the padding the total message's length in bits and transform.
-			ctx->bitlen += ctx->datalen * 8;
-			ctx->data[56] = ctx->bitlen;
-			ctx->data[57] = ctx->bitlen >> 8;
-			ctx->data[58] = ctx->bitlen >> 16;
-			ctx->data[59] = ctx->bitlen >> 24;
-			ctx->data[60] = ctx->bitlen >> 32;
-			ctx->data[61] = ctx->bitlen >> 40;
-			ctx->data[62] = ctx->bitlen >> 48;
-			ctx->data[63] = ctx->bitlen >> 56;
-			md5_transform(ctx, ctx->data);
-
-			// Since this implementation uses little endian byte ordering and MD uses big endian,
-			// reverse all the bytes when copying the final state to the output hash.
-			for(i = 0; i < 4; ++i)
+			for(i32 i = 0; i < 4; ++i)
 			{
-				hash[i] = (ctx->state[0] >> (i * 8)) & 0x000000ff;
-				hash[i + 4] = (ctx->state[1] >> (i * 8)) & 0x000000ff;
-				hash[i + 8] = (ctx->state[2] >> (i * 8)) & 0x000000ff;
-				hash[i + 12] = (ctx->state[3] >> (i * 8)) & 0x000000ff;
+				u32 words[NUM_LANES];
+				U32x4Store(words, state[i]);
+				for(i32 lane = 0; lane < NUM_LANES; ++lane)
+					if(active[lane])
+						lanes_[lane].state_[i] = words[lane];
 			}
-		}
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+				if(active[lane])
+					lanes_[lane].size_ += numBlocks * 64;
+		});
+
+		for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			if(laneSizes[lane] > 0)
+				lanes_[lane].Update(laneData[lane], laneSizes[lane]);
 	}
-#if PLATFORM_WINDOWS
-#pragma warning(pop)
-#endif
 
-	HashMD5Digest HashMD5(const void* data, size_t size)
+	void HashMD5MultiContext::Final(HashMD5Digest* outDigests)
 	{
-		HashMD5Digest digest;
-		MD5_CTX ctx;
-		md5_init(&ctx);
-		md5_update(&ctx, (const u8*)data, size);
-		md5_final(&ctx, digest.data8_);
-		return digest;
+		for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			outDigests[lane] = lanes_[lane].Final();
 	}
 
+	HashMD5Digest HashMD5(const void* data, size_t size)
+	{
+		HashMD5Context ctx;
+		ctx.Update(data, size);
+		return ctx.Final();
+	}
 
 // SHA-1: https://github.com/B-Con/crypto-algorithms
 #if PLATFORM_WINDOWS
@@ -230,38 +440,27 @@ namespace Core
 #endif
 	namespace
 	{
-		struct SHA1_CTX
-		{
-			u8 data[64];
-			u16 datalen;
-			u64 bitlen;
-			u32 state[5];
-			u32 k[4];
-		};
-#define ROTLEFT(a, b) ((a << b) | (a >> (32 - b)))
-
-		/*********************** FUNCTION DEFINITIONS ***********************/
-		void sha1_transform(SHA1_CTX* ctx, const u8 data[])
+		template<typename WORD>
+		void sha1_transform(WORD state[5], WORD m[80])
 		{
-			u32 a, b, c, d, e, i, j, t, m[80];
+			WORD a, b, c, d, e, t;
+			i32 i;
 
-			for(i = 0, j = 0; i < 16; ++i, j += 4)
-				m[i] = (data[j] << 24) + (data[j + 1] << 16) + (data[j + 2] << 8) + (data[j + 3]);
-			for(; i < 80; ++i)
+			for(i = 16; i < 80; ++i)
 			{
 				m[i] = (m[i - 3] ^ m[i - 8] ^ m[i - 14] ^ m[i - 16]);
 				m[i] = (m[i] << 1) | (m[i] >> 31);
 			}
 
-			a = ctx->state[0];
-			b = ctx->state[1];
-			c = ctx->state[2];
-			d = ctx->state[3];
-			e = ctx->state[4];
+			a = state[0];
+			b = state[1];
+			c = state[2];
+			d = state[3];
+			e = state[4];
 
 			for(i = 0; i < 20; ++i)
 			{
-				t = ROTLEFT(a, 5) + ((b & c) ^ (~b & d)) + e + ctx->k[0] + m[i];
+				t = ROTLEFT(a, 5) + ((b & c) ^ (~b & d)) + e + 0x5a827999u + m[i];
 				e = d;
 				d = c;
 				c = ROTLEFT(b, 30);
@@ -270,7 +469,7 @@ namespace Core
 			}
 			for(; i < 40; ++i)
 			{
-				t = ROTLEFT(a, 5) + (b ^ c ^ d) + e + ctx->k[1] + m[i];
+				t = ROTLEFT(a, 5) + (b ^ c ^ d) + e + 0x6ed9eba1u + m[i];
 				e = d;
 				d = c;
 				c = ROTLEFT(b, 30);
@@ -279,7 +478,7 @@ namespace Core
 			}
 			for(; i < 60; ++i)
 			{
-				t = ROTLEFT(a, 5) + ((b & c) ^ (b & d) ^ (c & d)) + e + ctx->k[2] + m[i];
+				t = ROTLEFT(a, 5) + ((b & c) ^ (b & d) ^ (c & d)) + e + 0x8f1bbcdcu + m[i];
 				e = d;
 				d = c;
 				c = ROTLEFT(b, 30);
@@ -288,7 +487,7 @@ namespace Core
 			}
 			for(; i < 80; ++i)
 			{
-				t = ROTLEFT(a, 5) + (b ^ c ^ d) + e + ctx->k[3] + m[i];
+				t = ROTLEFT(a, 5) + (b ^ c ^ d) + e + 0xca62c1d6u + m[i];
 				e = d;
 				d = c;
 				c = ROTLEFT(b, 30);
@@ -296,179 +495,396 @@ namespace Core
 				a = t;
 			}
 
-			ctx->state[0] += a;
-			ctx->state[1] += b;
-			ctx->state[2] += c;
-			ctx->state[3] += d;
-			ctx->state[4] += e;
+			state[0] += a;
+			state[1] += b;
+			state[2] += c;
+			state[3] += d;
+			state[4] += e;
+		}
+
+		void sha1_transform_block(u32 state[5], const u8 block[64])
+		{
+			u32 m[80];
+			LoadBlock<LoadBigEndian>(m, 16, block);
+			sha1_transform(state, m);
+		}
+	} // namespace
+#if PLATFORM_WINDOWS
+#pragma warning(pop)
+#endif
+
+	void HashSHA1Context::Init()
+	{
+		state_[0] = 0x67452301;
+		state_[1] = 0xEFCDAB89;
+		state_[2] = 0x98BADCFE;
+		state_[3] = 0x10325476;
+		state_[4] = 0xc3d2e1f0;
+		size_ = 0;
+		dataLen_ = 0;
+	}
+
+	void HashSHA1Context::Update(const void* data, size_t size)
+	{
+		if(size == 0)
+			return;
+		const u8* bytes = static_cast<const u8*>(data);
+		size_ += size;
+		if(dataLen_ > 0)
+		{
+			const u32 fill = size < 64 - dataLen_ ? (u32)size : 64 - dataLen_;
+			memcpy(data_ + dataLen_, bytes, fill);
+			dataLen_ += fill;
+			bytes += fill;
+			size -= fill;
+			if(dataLen_ < 64)
+				return;
+			sha1_transform_block(state_, data_);
+			dataLen_ = 0;
 		}
 
-		void sha1_init(SHA1_CTX* ctx)
+		// Hash whole blocks directly from the input.
+		for(; size >= 64; size -= 64, bytes += 64)
+			sha1_transform_block(state_, bytes);
+
+		memcpy(data_, bytes, size);
+		dataLen_ = (u32)size;
+	}
+
+	HashSHA1Digest HashSHA1Context::Final()
+	{
+		const u64 bitLen = size_ * 8;
+
+		// Pad with a 1 bit, zeroes, then the length in bits.
+		u32 i = dataLen_;
+		data_[i++] = 0x80;
+		if(i > 56)
 		{
-			ctx->datalen = 0;
-			ctx->bitlen = 0;
-			ctx->state[0] = 0x67452301;
-			ctx->state[1] = 0xEFCDAB89;
-			ctx->state[2] = 0x98BADCFE;
-			ctx->state[3] = 0x10325476;
-			ctx->state[4] = 0xc3d2e1f0;
-			ctx->k[0] = 0x5a827999;
-			ctx->k[1] = 0x6ed9eba1;
-			ctx->k[2] = 0x8f1bbcdc;
-			ctx->k[3] = 0xca62c1d6;
+			memset(data_ + i, 0, 64 - i);
+			sha1_transform_block(state_, data_);
+			i = 0;
 		}
+		memset(data_ + i, 0, 56 - i);
+		for(i = 0; i < 8; ++i)
+			data_[63 - i] = (u8)(bitLen >> (i * 8));
+		sha1_transform_block(state_, data_);
 
-		void sha1_update(SHA1_CTX* ctx, const u8 data[], size_t len)
+		HashSHA1Digest digest;
+		for(i = 0; i < 4; ++i)
 		{
-			size_t i;
+			digest.data8_[i] = (state_[0] >> (24 - i * 8)) & 0x000000ff;
+			digest.data8_[i + 4] = (state_[1] >> (24 - i * 8)) & 0x000000ff;
+			digest.data8_[i + 8] = (state_[2] >> (24 - i * 8)) & 0x000000ff;
+			digest.data8_[i + 12] = (state_[3] >> (24 - i * 8)) & 0x000000ff;
+			digest.data8_[i + 16] = (state_[4] >> (24 - i * 8)) & 0x000000ff;
+		}
+		return digest;
+	}
 
-			for(i = 0; i < len; ++i)
+	void HashSHA1MultiContext::Init()
+	{
+		for(auto& lane : lanes_)
+			lane.Init();
+	}
+
+	void HashSHA1MultiContext::Update(const void* const* data, const size_t* sizes)
+	{
+		static_assert(NUM_LANES == Core::NUM_LANES, "Lane count mismatch.");
+
+		const u8* laneData[NUM_LANES];
+		size_t laneSizes[NUM_LANES];
+		PrepareLanes<HashSHA1Context>(
+		    lanes_, [](const HashSHA1Context& lane) { return lane.dataLen_; }, data, sizes, laneData, laneSizes);
+
+		TransformLanes(laneData, laneSizes, [this](const u8* const* blocks, const bool* active, size_t numBlocks) {
+			auto getState = [](const HashSHA1Context& lane, i32 idx) { return lane.state_[idx]; };
+			U32x4 state[5];
+			for(i32 i = 0; i < 5; ++i)
+				state[i] = LoadLaneState<HashSHA1Context>(lanes_, i, getState);
+
+			const u8* laneBlocks[NUM_LANES];
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+				laneBlocks[lane] = blocks[lane];
+			for(size_t block = 0; block < numBlocks; ++block)
+			{
+				U32x4 m[80];
+				LoadBlock<LoadBigEndian>(m, 16, laneBlocks);
+				sha1_transform(state, m);
+				for(i32 lane = 0; lane < NUM_LANES; ++lane)
+					laneBlocks[lane] += active[lane] ? 64 : 0;
+			}
+
+			for(i32 i = 0; i < 5; ++i)
 			{
-				ctx->data[ctx->datalen] = data[i];
-				ctx->datalen++;
-				if(ctx->datalen == 64)
+				u32 words[NUM_LANES];
+				U32x4Store(words, state[i]);
+				for(i32 lane = 0; lane < NUM_LANES; ++lane)
+					if(active[lane])
+						lanes_[lane].state_[i] = words[lane];
+			}
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+				if(active[lane])
+					lanes_[lane].size_ += numBlocks * 64;
+		});
+
+		for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			if(laneSizes[lane] > 0)
+				lanes_[lane].Update(laneData[lane], laneSizes[lane]);
+	}
+
+	void HashSHA1MultiContext::Final(HashSHA1Digest* outDigests)
+	{
+		for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			outDigests[lane] = lanes_[lane].Final();
+	}
+
+	HashSHA1Digest HashSHA1(const void* data, size_t size)
+	{
+		HashSHA1Context ctx;
+		ctx.Update(data, size);
+		return ctx.Final();
+	}
+
+	namespace
+	{
+		/**
+		 * Tables for slice-by-8 CRC of a reflected polynomial.
+		 * table_[0] is the usual byte at a time table, table_[N] advances it by N further bytes of zeroes.
+		 */
+		struct CRCTables
+		{
+			u32 table_[8][256];
+
+			CRCTables(u32 poly)
+			{
+				for(u32 i = 0; i < 256; ++i)
 				{
-					sha1_transform(ctx, ctx->data);
-					ctx->bitlen += 512;
-					ctx->datalen = 0;
+					u32 crc = i;
+					for(i32 bit = 0; bit < 8; ++bit)
+						crc = (crc >> 1) ^ (poly & (0 - (crc & 1)));
+					table_[0][i] = crc;
 				}
+				for(u32 i = 0; i < 256; ++i)
+					for(i32 slice = 1; slice < 8; ++slice)
+						table_[slice][i] = (table_[slice - 1][i] >> 8) ^ table_[0][table_[slice - 1][i] & 0xff];
 			}
+		};
+
+		const CRCTables& GetCRC32Tables()
+		{
+			static const CRCTables tables(0xedb88320);
+			return tables;
 		}
 
-		void sha1_final(SHA1_CTX* ctx, u8 hash[])
+		const CRCTables& GetCRC32CTables()
 		{
-			u32 i;
+			static const CRCTables tables(0x82f63b78);
+			return tables;
+		}
 
-			i = ctx->datalen;
+		u32 HashCRCSliceBy8(const CRCTables& tables, u32 input, const void* data, size_t size)
+		{
+			const auto& t = tables.table_;
+			const u8* bytes = reinterpret_cast<const u8*>(data);
+			u32 crc = ~input;
 
-			// Pad whatever data is left in the buffer.
-			if(ctx->datalen < 56)
+#if ENDIAN_LITTLE
+			for(; size >= 8; size -= 8, bytes += 8)
 			{
-				ctx->data[i++] = 0x80;
-				while(i < 56)
-					ctx->data[i++] = 0x00;
+				u32 lo, hi;
+				memcpy(&lo, bytes, sizeof(lo));
+				memcpy(&hi, bytes + 4, sizeof(hi));
+				lo ^= crc;
+				crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+				      t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
 			}
-			else
+#endif
+			while(size--)
+				crc = t[0][(crc ^ *bytes++) & 0xff] ^ (crc >> 8);
+
+			return ~crc;
+		}
+
+		u32 HashCRC32CSoftware(u32 input, const void* data, size_t size)
+		{
+			return HashCRCSliceBy8(GetCRC32CTables(), input, data, size);
+		}
+
+#if ARCH_X86_64
+#if !COMPILER_MSVC
+		__attribute__((target("sse4.2")))
+#endif
+		u32 HashCRC32CSSE42(u32 input, const void* data, size_t size)
+		{
+			const u8* bytes = reinterpret_cast<const u8*>(data);
+			u64 crc = ~input;
+			for(; size >= 8; size -= 8, bytes += 8)
 			{
-				ctx->data[i++] = 0x80;
-				while(i < 64)
-					ctx->data[i++] = 0x00;
-				sha1_transform(ctx, ctx->data);
-				memset(ctx->data, 0, 56);
+				u64 val;
+				memcpy(&val, bytes, sizeof(val));
+				crc = _mm_crc32_u64(crc, val);
 			}
+			u32 crc32 = (u32)crc;
+			while(size--)
+				crc32 = _mm_crc32_u8(crc32, *bytes++);
+			return ~crc32;
+		}
 
-			// Append to the padding the total message's length in bits and transform.
-			ctx->bitlen += ctx->datalen * 8;
-			ctx->data[63] = ctx->bitlen;
-			ctx->data[62] = ctx->bitlen >> 8;
-			ctx->data[61] = ctx->bitlen >> 16;
-			ctx->data[60] = ctx->bitlen >> 24;
-			ctx->data[59] = ctx->bitlen >> 32;
-			ctx->data[58] = ctx->bitlen >> 40;
-			ctx->data[57] = ctx->bitlen >> 48;
-			ctx->data[56] = ctx->bitlen >> 56;
-			sha1_transform(ctx, ctx->data);
-
-			// Since this implementation uses little endian byte ordering and MD uses big endian,
-			// reverse all the bytes when copying the final state to the output hash.
-			for(i = 0; i < 4; ++i)
+		bool HasSSE42()
+		{
+#if COMPILER_MSVC
+			int info[4];
+			__cpuid(info, 1);
+			return (info[2] & (1 << 20)) != 0;
+#else
+			unsigned int eax, ebx, ecx, edx;
+			return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2) != 0;
+#endif
+		}
+#elif ARCH_ARM64 && defined(__ARM_FEATURE_CRC32)
+		u32 HashCRC32CARMv8(u32 input, const void* data, size_t size)
+		{
+			const u8* bytes = reinterpret_cast<const u8*>(data);
+			u32 crc = ~input;
+			for(; size >= 8; size -= 8, bytes += 8)
 			{
-				hash[i] = (ctx->state[0] >> (24 - i * 8)) & 0x000000ff;
-				hash[i + 4] = (ctx->state[1] >> (24 - i * 8)) & 0x000000ff;
-				hash[i + 8] = (ctx->state[2] >> (24 - i * 8)) & 0x000000ff;
-				hash[i + 12] = (ctx->state[3] >> (24 - i * 8)) & 0x000000ff;
-				hash[i + 16] = (ctx->state[4] >> (24 - i * 8)) & 0x000000ff;
+				u64 val;
+				memcpy(&val, bytes, sizeof(val));
+				crc = __crc32cd(crc, val);
 			}
+			while(size--)
+				crc = __crc32cb(crc, *bytes++);
+			return ~crc;
 		}
-	}
-#if PLATFORM_WINDOWS
-#pragma warning(pop)
 #endif
-	HashSHA1Digest HashSHA1(const void* data, size_t size)
-	{
-		HashSHA1Digest digest;
-		SHA1_CTX ctx;
-		sha1_init(&ctx);
-		sha1_update(&ctx, (const u8*)data, size);
-		sha1_final(&ctx, digest.data8_);
-		return digest;
-	}
 
+		using HashCRC32CFunc = u32 (*)(u32, const void*, size_t);
 
-	namespace
-	{
-		// clang-format off
-	const u32 gCRC32Table_[256] =
-	{
-		0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419,
-		0x706af48f, 0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4,
-		0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07,
-		0x90bf1d91, 0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de,
-		0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7, 0x136c9856,
-		0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
-		0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4,
-		0xa2677172, 0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
-		0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940, 0x32d86ce3,
-		0x45df5c75, 0xdcd60dcf, 0xabd13d59, 0x26d930ac, 0x51de003a,
-		0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423, 0xcfba9599,
-		0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-		0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190,
-		0x01db7106, 0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f,
-		0x9fbfe4a5, 0xe8b8d433, 0x7807c9a2, 0x0f00f934, 0x9609a88e,
-		0xe10e9818, 0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
-		0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e, 0x6c0695ed,
-		0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-		0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3,
-		0xfbd44c65, 0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2,
-		0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a,
-		0x346ed9fc, 0xad678846, 0xda60b8d0, 0x44042d73, 0x33031de5,
-		0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa, 0xbe0b1010,
-		0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-		0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17,
-		0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6,
-		0x03b6e20c, 0x74b1d29a, 0xead54739, 0x9dd277af, 0x04db2615,
-		0x73dc1683, 0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8,
-		0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1, 0xf00f9344,
-		0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
-		0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a,
-		0x67dd4acc, 0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
-		0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252, 0xd1bb67f1,
-		0xa6bc5767, 0x3fb506dd, 0x48b2364b, 0xd80d2bda, 0xaf0a1b4c,
-		0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55, 0x316e8eef,
-		0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-		0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe,
-		0xb2bd0b28, 0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31,
-		0x2cd99e8b, 0x5bdeae1d, 0x9b64c2b0, 0xec63f226, 0x756aa39c,
-		0x026d930a, 0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
-		0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38, 0x92d28e9b,
-		0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
-		0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1,
-		0x18b74777, 0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c,
-		0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45, 0xa00ae278,
-		0xd70dd2ee, 0x4e048354, 0x3903b3c2, 0xa7672661, 0xd06016f7,
-		0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc, 0x40df0b66,
-		0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-		0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605,
-		0xcdd70693, 0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8,
-		0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b,
-		0x2d02ef8d
-	};
-		// clang-format on
+		HashCRC32CFunc SelectHashCRC32C()
+		{
+#if ARCH_X86_64
+			if(HasSSE42())
+				return HashCRC32CSSE42;
+#elif ARCH_ARM64 && defined(__ARM_FEATURE_CRC32)
+			// Compiled for a target with the CRC extension, so always available.
+			return HashCRC32CARMv8;
+#endif
+			return HashCRC32CSoftware;
+		}
+
+		HashCRC32CFunc GetHashCRC32CFunc()
+		{
+			static const HashCRC32CFunc func = SelectHashCRC32C();
+			return func;
+		}
+
+		const u64 XX64_PRIME_1 = 0x9e3779b185ebca87ULL;
+		const u64 XX64_PRIME_2 = 0xc2b2ae3d27d4eb4fULL;
+		const u64 XX64_PRIME_3 = 0x165667b19e3779f9ULL;
+		const u64 XX64_PRIME_4 = 0x85ebca77c2b2ae63ULL;
+		const u64 XX64_PRIME_5 = 0x27d4eb2f165667c5ULL;
+
+		inline u64 XX64Rotl(u64 val, i32 bits) { return (val << bits) | (val >> (64 - bits)); }
+
+		inline u64 XX64Round(u64 acc, u64 val)
+		{
+			acc += val * XX64_PRIME_2;
+			acc = XX64Rotl(acc, 31);
+			return acc * XX64_PRIME_1;
+		}
+
+		inline u64 XX64MergeRound(u64 acc, u64 val)
+		{
+			acc ^= XX64Round(0, val);
+			return acc * XX64_PRIME_1 + XX64_PRIME_4;
+		}
+
+		inline u64 XX64Read64(const u8* bytes)
+		{
+			u64 val;
+			memcpy(&val, bytes, sizeof(val));
+			return val;
+		}
+
+		inline u64 XX64Read32(const u8* bytes)
+		{
+			u32 val;
+			memcpy(&val, bytes, sizeof(val));
+			return val;
+		}
 	} // namespace
 
 	u32 HashCRC32(u32 Input, const void* pInData, size_t Size)
 	{
-		const u8* Data = reinterpret_cast<const u8*>(pInData);
-		u32 Hash = Input;
+		return HashCRCSliceBy8(GetCRC32Tables(), Input, pInData, Size);
+	}
+
+	u32 HashCRC32C(u32 input, const void* data, size_t size)
+	{
+		return GetHashCRC32CFunc()(input, data, size);
+	}
 
-		Hash = ~Hash;
+	bool HashHasHardwareCRC32C() { return GetHashCRC32CFunc() != HashCRC32CSoftware; }
 
-		while(Size--)
+	u64 HashXX64(u64 seed, const void* data, size_t size)
+	{
+		const u8* bytes = reinterpret_cast<const u8*>(data);
+		const u8* end = bytes + size;
+		u64 hash;
+
+		if(size >= 32)
+		{
+			// 4 independent lanes, so the multiplies can overlap.
+			u64 v1 = seed + XX64_PRIME_1 + XX64_PRIME_2;
+			u64 v2 = seed + XX64_PRIME_2;
+			u64 v3 = seed;
+			u64 v4 = seed - XX64_PRIME_1;
+			const u8* limit = end - 32;
+			do
+			{
+				v1 = XX64Round(v1, XX64Read64(bytes));
+				v2 = XX64Round(v2, XX64Read64(bytes + 8));
+				v3 = XX64Round(v3, XX64Read64(bytes + 16));
+				v4 = XX64Round(v4, XX64Read64(bytes + 24));
+				bytes += 32;
+			} while(bytes <= limit);
+
+			hash = XX64Rotl(v1, 1) + XX64Rotl(v2, 7) + XX64Rotl(v3, 12) + XX64Rotl(v4, 18);
+			hash = XX64MergeRound(hash, v1);
+			hash = XX64MergeRound(hash, v2);
+			hash = XX64MergeRound(hash, v3);
+			hash = XX64MergeRound(hash, v4);
+		}
+		else
+		{
+			hash = seed + XX64_PRIME_5;
+		}
+
+		hash += (u64)size;
+
+		for(; bytes + 8 <= end; bytes += 8)
+		{
+			hash ^= XX64Round(0, XX64Read64(bytes));
+			hash = XX64Rotl(hash, 27) * XX64_PRIME_1 + XX64_PRIME_4;
+		}
+		if(bytes + 4 <= end)
+		{
+			hash ^= XX64Read32(bytes) * XX64_PRIME_1;
+			hash = XX64Rotl(hash, 23) * XX64_PRIME_2 + XX64_PRIME_3;
+			bytes += 4;
+		}
+		for(; bytes < end; ++bytes)
 		{
-			Hash = gCRC32Table_[(Hash ^ *Data++) & 0xff] ^ (Hash >> 8);
+			hash ^= (*bytes) * XX64_PRIME_5;
+			hash = XX64Rotl(hash, 11) * XX64_PRIME_1;
 		}
 
-		return ~Hash;
+		hash ^= hash >> 33;
+		hash *= XX64_PRIME_2;
+		hash ^= hash >> 29;
+		hash *= XX64_PRIME_3;
+		hash ^= hash >> 32;
+		return hash;
 	}
 
 	u32 HashSDBM(u32 Input, const void* pInData, size_t Size)
@@ -0,0 +1,54 @@
+#include "core/linear_allocator.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+
+namespace Core
+{
+	LinearAllocator::LinearAllocator(i64 capacity)
+	    : capacity_(capacity)
+	{
+		DBG_ASSERT(capacity > 0);
+		base_ = ::new u8[capacity];
+	}
+
+	LinearAllocator::~LinearAllocator() { delete[] base_; }
+
+	void* LinearAllocator::Allocate(i64 size, i64 align)
+	{
+		DBG_ASSERT(size >= 0);
+		DBG_ASSERT(align > 0 && (align & (align - 1)) == 0);
+
+		// Align the address rather than the offset, so the block itself needn't be aligned.
+		i64 offset = offset_;
+		for(;;)
+		{
+			const uintptr_t addr = ((uintptr_t)(base_ + offset) + (uintptr_t)(align - 1)) & ~(uintptr_t)(align - 1);
+			const i64 newOffset = (i64)(addr - (uintptr_t)base_) + size;
+			if(newOffset > capacity_)
+				return nullptr;
+
+			const i64 prevOffset = AtomicCmpExchg(&offset_, newOffset, offset);
+			if(prevOffset == offset)
+				return (void*)addr;
+			offset = prevOffset;
+		}
+	}
+
+	void LinearAllocator::Deallocate(void* mem, i64 size)
+	{
+		if(mem == nullptr)
+			return;
+		DBG_ASSERT((u8*)mem >= base_ && ((u8*)mem + size) <= (base_ + capacity_));
+
+		// Reclaim if it's the most recent allocation. Alignment padding before it stays used.
+		const i64 endOffset = (i64)((u8*)mem - base_) + size;
+		AtomicCmpExchg(&offset_, endOffset - size, endOffset);
+	}
+
+	void LinearAllocator::Reset(Marker marker)
+	{
+		DBG_ASSERT(marker >= 0 && marker <= offset_);
+		offset_ = marker;
+	}
+
+} // namespace Core
@@ -0,0 +1,340 @@
+#include "core/memory_tracker.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/map.h"
+#include "core/misc.h"
+
+namespace Core
+{
+	namespace
+	{
+		static const i32 NUM_TAGS = (i32)MemoryTag::MAX;
+
+		/// Threads count into their own counters, and only add to the global ones when their live bytes change by
+		/// this much. Keeps atomics off the allocation path.
+		static const i64 FLUSH_BYTES = 64 * 1024;
+
+		/// Global counters for a tag, on their own cache line so tags don't contend with each other.
+		struct TagCounters
+		{
+			volatile i64 liveBytes_;
+			volatile i64 peakBytes_;
+			volatile i64 numLiveAllocs_;
+			volatile i64 numTotalAllocs_;
+			volatile i64 budgetBytes_;
+			/// Incremented by ResetPeak, so threads know to discard their local peak.
+			volatile i32 peakEpoch_;
+			u8 padding_[CACHE_LINE_SIZE - sizeof(i64) * 5 - sizeof(i32)];
+		};
+
+		/// A thread's counters for a tag, not yet added to the global ones.
+		/// Only written by the owning thread, but read by any thread in GetStats.
+		struct ThreadTagCounters
+		{
+			volatile i64 liveBytes_;
+			/// Highest liveBytes_ since the last flush.
+			volatile i64 peakLiveBytes_;
+			volatile i64 numLiveAllocs_;
+			volatile i64 numTotalAllocs_;
+			volatile i32 peakEpoch_;
+			/// Allocations until the next callstack sample.
+			i32 sampleCountdown_;
+		};
+
+		/// Never freed, as they're still counted after their thread exits.
+		struct ThreadCounters
+		{
+			ThreadTagCounters tags_[NUM_TAGS];
+			ThreadCounters* next_;
+		};
+
+		TagCounters gCounters[NUM_TAGS] = {};
+
+		/// All threads' counters.
+		ThreadCounters* gThreadCounters = nullptr;
+		thread_local ThreadCounters* tThreadCounters = nullptr;
+
+		/// Sample every Nth allocation, per tag. 0 if disabled.
+		volatile i32 gSampleRate = 0;
+
+		/// Lock for gThreadCounters.
+		Mutex& GetThreadCountersMutex()
+		{
+			static Mutex mutex;
+			return mutex;
+		}
+
+		/// Live sampled allocations, keyed by address.
+		struct SampleStore
+		{
+			Mutex mutex_;
+			Map<u64, MemorySample> samples_;
+		};
+
+		SampleStore& GetSampleStore()
+		{
+			static SampleStore samples;
+			return samples;
+		}
+
+		/// Live samples per address bucket, so deallocations can skip the lock for unsampled memory.
+		static const i32 SAMPLE_BUCKET_BITS = 12;
+		volatile i32 gSampleBuckets[1 << SAMPLE_BUCKET_BITS] = {};
+
+		inline volatile i32& GetSampleBucket(const void* mem)
+		{
+			const u64 hash = ((u64)(uintptr_t)mem >> 4) * 0x9e3779b97f4a7c15ull;
+			return gSampleBuckets[hash >> (64 - SAMPLE_BUCKET_BITS)];
+		}
+
+		inline TagCounters& GetCounters(MemoryTag tag)
+		{
+			DBG_ASSERT(tag >= MemoryTag::UNTAGGED && tag < MemoryTag::MAX);
+			return gCounters[(i32)tag];
+		}
+
+		inline ThreadTagCounters& GetThreadCounters(MemoryTag tag)
+		{
+			if(tThreadCounters == nullptr)
+			{
+				auto* counters = new ThreadCounters();
+				for(i32 i = 0; i < NUM_TAGS; ++i)
+					counters->tags_[i].peakEpoch_ = gCounters[i].peakEpoch_;
+
+				ScopedMutex lock(GetThreadCountersMutex());
+				counters->next_ = gThreadCounters;
+				gThreadCounters = counters;
+				tThreadCounters = counters;
+			}
+			return tThreadCounters->tags_[(i32)tag];
+		}
+
+		void UpdatePeak(TagCounters& counters, i64 peakBytes)
+		{
+			i64 prevPeakBytes = counters.peakBytes_;
+			while(peakBytes > prevPeakBytes)
+			{
+				const i64 exchgPeakBytes = AtomicCmpExchg(&counters.peakBytes_, peakBytes, prevPeakBytes);
+				if(exchgPeakBytes == prevPeakBytes)
+					break;
+				prevPeakBytes = exchgPeakBytes;
+			}
+		}
+
+		/// Add a thread's counters to the global ones.
+		void Flush(TagCounters& counters, ThreadTagCounters& threadCounters)
+		{
+			const i64 liveBytes = threadCounters.liveBytes_;
+			const i64 globalLiveBytes = AtomicAdd(&counters.liveBytes_, liveBytes);
+			AtomicAdd(&counters.numLiveAllocs_, threadCounters.numLiveAllocs_);
+			AtomicAdd(&counters.numTotalAllocs_, threadCounters.numTotalAllocs_);
+			if(threadCounters.peakEpoch_ == counters.peakEpoch_)
+				UpdatePeak(counters, globalLiveBytes - liveBytes + threadCounters.peakLiveBytes_);
+
+			threadCounters.liveBytes_ = 0;
+			threadCounters.peakLiveBytes_ = 0;
+			threadCounters.numLiveAllocs_ = 0;
+			threadCounters.numTotalAllocs_ = 0;
+		}
+	} // namespace
+
+	const char* EnumToString(MemoryTag val)
+	{
+#define CASE_STRING(ENUM_VALUE)                                                                                        \
+	case MemoryTag::ENUM_VALUE:                                                                                        \
+		return #ENUM_VALUE;
+
+		switch(val)
+		{
+			CASE_STRING(UNTAGGED)
+			CASE_STRING(CORE)
+			CASE_STRING(JOB)
+			CASE_STRING(RESOURCE)
+			CASE_STRING(GPU)
+			CASE_STRING(GRAPHICS)
+			CASE_STRING(IMGUI)
+			CASE_STRING(SERIALIZATION)
+		default:
+			break;
+		}
+
+#undef CASE_STRING
+		return nullptr;
+	}
+
+	void MemoryTracker::TrackAlloc(MemoryTag tag, const void* mem, i64 bytes)
+	{
+		TagCounters& counters = GetCounters(tag);
+		ThreadTagCounters& threadCounters = GetThreadCounters(tag);
+
+		// Peak was reset, so start tracking the local peak from here.
+		const i32 peakEpoch = counters.peakEpoch_;
+		if(threadCounters.peakEpoch_ != peakEpoch)
+		{
+			threadCounters.peakLiveBytes_ = threadCounters.liveBytes_;
+			threadCounters.peakEpoch_ = peakEpoch;
+		}
+
+		const i64 liveBytes = threadCounters.liveBytes_ + bytes;
+		threadCounters.liveBytes_ = liveBytes;
+		threadCounters.numLiveAllocs_ = threadCounters.numLiveAllocs_ + 1;
+		threadCounters.numTotalAllocs_ = threadCounters.numTotalAllocs_ + 1;
+		if(liveBytes > threadCounters.peakLiveBytes_)
+			threadCounters.peakLiveBytes_ = liveBytes;
+		if(liveBytes >= FLUSH_BYTES)
+			Flush(counters, threadCounters);
+
+		const i32 sampleRate = gSampleRate;
+		if(sampleRate > 0 && --threadCounters.sampleCountdown_ <= 0)
+		{
+			threadCounters.sampleCountdown_ = sampleRate;
+
+			MemorySample sample;
+			sample.tag_ = tag;
+			sample.mem_ = mem;
+			sample.bytes_ = bytes;
+			sample.numFrames_ = GetCallstack(1, sample.frames_, MemorySample::MAX_FRAMES);
+
+			SampleStore& samples = GetSampleStore();
+			ScopedMutex lock(samples.mutex_);
+			const u64 key = (u64)(uintptr_t)mem;
+			if(samples.samples_.find(key) == samples.samples_.end())
+				AtomicInc(&GetSampleBucket(mem));
+			samples.samples_.insert(key, sample);
+		}
+	}
+
+	void MemoryTracker::TrackDealloc(MemoryTag tag, const void* mem, i64 bytes)
+	{
+		TagCounters& counters = GetCounters(tag);
+		ThreadTagCounters& threadCounters = GetThreadCounters(tag);
+
+		// Memory may be freed on a different thread to the one that allocated it, so this can go negative.
+		const i64 liveBytes = threadCounters.liveBytes_ - bytes;
+		threadCounters.liveBytes_ = liveBytes;
+		threadCounters.numLiveAllocs_ = threadCounters.numLiveAllocs_ - 1;
+		if(liveBytes <= -FLUSH_BYTES)
+			Flush(counters, threadCounters);
+
+		volatile i32& sampleBucket = GetSampleBucket(mem);
+		if(sampleBucket > 0)
+		{
+			SampleStore& samples = GetSampleStore();
+			ScopedMutex lock(samples.mutex_);
+			if(samples.samples_.erase((u64)(uintptr_t)mem))
+				AtomicDec(&sampleBucket);
+		}
+	}
+
+	MemoryTagStats MemoryTracker::GetStats(MemoryTag tag)
+	{
+		const TagCounters& counters = GetCounters(tag);
+		const i32 peakEpoch = counters.peakEpoch_;
+		MemoryTagStats stats;
+		stats.liveBytes_ = counters.liveBytes_;
+		stats.numLiveAllocs_ = counters.numLiveAllocs_;
+		stats.numTotalAllocs_ = counters.numTotalAllocs_;
+		stats.budgetBytes_ = counters.budgetBytes_;
+
+		// Add on what threads haven't flushed yet. Peak assumes every thread hit its local peak at once, so with
+		// several threads allocating it can overestimate by up to FLUSH_BYTES per thread.
+		i64 peakBytes = stats.liveBytes_;
+		{
+			ScopedMutex lock(GetThreadCountersMutex());
+			for(ThreadCounters* threadCounters = gThreadCounters; threadCounters;
+			    threadCounters = threadCounters->next_)
+			{
+				const ThreadTagCounters& threadTagCounters = threadCounters->tags_[(i32)tag];
+				const i64 liveBytes = threadTagCounters.liveBytes_;
+				stats.liveBytes_ += liveBytes;
+				stats.numLiveAllocs_ += threadTagCounters.numLiveAllocs_;
+				stats.numTotalAllocs_ += threadTagCounters.numTotalAllocs_;
+				if(threadTagCounters.peakEpoch_ == peakEpoch)
+					peakBytes += threadTagCounters.peakLiveBytes_;
+				else if(liveBytes > 0)
+					peakBytes += liveBytes;
+			}
+		}
+		stats.peakBytes_ = Core::Max(counters.peakBytes_, Core::Max(peakBytes, stats.liveBytes_));
+		return stats;
+	}
+
+	void MemoryTracker::ResetPeak(MemoryTag tag)
+	{
+		TagCounters& counters = GetCounters(tag);
+		AtomicInc(&counters.peakEpoch_);
+		AtomicExchg(&counters.peakBytes_, GetStats(tag).liveBytes_);
+	}
+
+	void MemoryTracker::SetBudget(MemoryTag tag, i64 bytes)
+	{
+		DBG_ASSERT(bytes >= 0);
+		AtomicExchg(&GetCounters(tag).budgetBytes_, bytes);
+	}
+
+	bool MemoryTracker::IsOverBudget(MemoryTag tag)
+	{
+		const MemoryTagStats stats = GetStats(tag);
+		return stats.budgetBytes_ > 0 && stats.liveBytes_ > stats.budgetBytes_;
+	}
+
+	i32 MemoryTracker::GetOverBudget(MemoryTag* outTags, i32 maxTags)
+	{
+		i32 numOverBudget = 0;
+		for(i32 i = 0; i < NUM_TAGS; ++i)
+		{
+			if(IsOverBudget((MemoryTag)i))
+			{
+				if(outTags && numOverBudget < maxTags)
+					outTags[numOverBudget] = (MemoryTag)i;
+				++numOverBudget;
+			}
+		}
+		return numOverBudget;
+	}
+
+	void MemoryTracker::SetCallstackSampleRate(i32 sampleRate)
+	{
+		DBG_ASSERT(sampleRate >= 0);
+		SampleStore& samples = GetSampleStore();
+		ScopedMutex lock(samples.mutex_);
+		samples.samples_.clear();
+		for(auto& sampleBucket : gSampleBuckets)
+			sampleBucket = 0;
+		AtomicExchg(&gSampleRate, sampleRate);
+	}
+
+	i32 MemoryTracker::GetSamples(MemoryTag tag, MemorySample* outSamples, i32 maxSamples)
+	{
+		SampleStore& samples = GetSampleStore();
+		ScopedMutex lock(samples.mutex_);
+		i32 numSamples = 0;
+		for(const auto& sample : samples.samples_)
+		{
+			if(tag == MemoryTag::MAX || sample.second.tag_ == tag)
+			{
+				if(outSamples && numSamples < maxSamples)
+					outSamples[numSamples] = sample.second;
+				++numSamples;
+			}
+		}
+		return numSamples;
+	}
+
+	void* TrackedAllocator::Allocate(i64 size, i64 align)
+	{
+		void* mem = backing_.Allocate(size, align);
+		if(mem)
+			MemoryTracker::TrackAlloc(tag_, mem, size);
+		return mem;
+	}
+
+	void TrackedAllocator::Deallocate(void* mem, i64 size)
+	{
+		if(mem == nullptr)
+			return;
+		MemoryTracker::TrackDealloc(tag_, mem, size);
+		backing_.Deallocate(mem, size);
+	}
+
+} // namespace Core
@@ -0,0 +1,64 @@
+#include "core/pool_allocator.h"
+#include "core/debug.h"
+
+namespace Core
+{
+	PoolAllocator::PoolAllocator(i32 blockSize, i32 numBlocks, i32 blockAlign)
+	    : blockAlign_(blockAlign)
+	    , numBlocks_(numBlocks)
+	    , numFree_(numBlocks)
+	{
+		DBG_ASSERT(blockSize > 0);
+		DBG_ASSERT(numBlocks > 0);
+		DBG_ASSERT(blockAlign > 0 && (blockAlign & (blockAlign - 1)) == 0);
+
+		// Blocks must hold a free list link, and be a multiple of alignment so every block is aligned.
+		if(blockSize < (i32)sizeof(FreeBlock))
+			blockSize = (i32)sizeof(FreeBlock);
+		blockSize_ = (blockSize + blockAlign - 1) & ~(blockAlign - 1);
+
+		memory_ = ::new u8[(i64)blockSize_ * numBlocks_ + blockAlign_];
+		base_ = (u8*)(((uintptr_t)memory_ + (uintptr_t)(blockAlign_ - 1)) & ~(uintptr_t)(blockAlign_ - 1));
+
+		// Link in address order, so a fresh pool hands out blocks sequentially.
+		for(i32 i = numBlocks_ - 1; i >= 0; --i)
+		{
+			auto* block = reinterpret_cast<FreeBlock*>(base_ + (i64)i * blockSize_);
+			block->next_ = freeList_;
+			freeList_ = block;
+		}
+	}
+
+	PoolAllocator::~PoolAllocator()
+	{
+		DBG_ASSERT_MSG(numFree_ == numBlocks_, "Pool destroyed with %i blocks still allocated.", numBlocks_ - numFree_);
+		delete[] memory_;
+	}
+
+	void* PoolAllocator::Allocate(i64 size, i64 align)
+	{
+		if(size > blockSize_ || align > blockAlign_ || freeList_ == nullptr)
+			return nullptr;
+
+		FreeBlock* block = freeList_;
+		freeList_ = block->next_;
+		--numFree_;
+		return block;
+	}
+
+	void PoolAllocator::Deallocate(void* mem, i64 size)
+	{
+		if(mem == nullptr)
+			return;
+		DBG_ASSERT(Owns(mem));
+		DBG_ASSERT((((u8*)mem - base_) % blockSize_) == 0);
+		DBG_ASSERT(size <= blockSize_);
+		(void)size;
+
+		auto* block = reinterpret_cast<FreeBlock*>(mem);
+		block->next_ = freeList_;
+		freeList_ = block;
+		++numFree_;
+	}
+
+} // namespace Core
@@ -0,0 +1,159 @@
+#include "core/profiler.h"
+#include "core/concurrency.h"
+#include "core/vector.h"
+
+#include <algorithm>
+
+namespace Core
+{
+	namespace
+	{
+		struct ScopeStats
+		{
+			const char* name_;
+			i32 callCount_;
+			u64 totalCycles_;
+			u64 maxCycles_;
+		};
+
+		/// Calling thread's scopes, hashed by name pointer.
+		struct ProfilerThreadData
+		{
+			ScopeStats scopes_[Profiler::MAX_SCOPES] = {};
+			i32 idx_ = 0;
+			/// Held by the owning thread while recording, and by EndFrame while gathering.
+			volatile i32 lock_ = 0;
+			/// Cleared when owning thread exits, data is freed on next EndFrame.
+			volatile i32 inUse_ = 1;
+
+			void Lock()
+			{
+				while(AtomicCmpExchgAcq(&lock_, 1, 0) != 0)
+					YieldCPU();
+			}
+
+			void Unlock() { AtomicExchg(&lock_, 0); }
+		};
+
+		/// Owns the calling thread's data.
+		struct ProfilerThread
+		{
+			ProfilerThreadData* data_ = nullptr;
+
+			~ProfilerThread()
+			{
+				if(data_)
+					AtomicExchg(&data_->inUse_, 0);
+			}
+		};
+
+		/// Every thread's data, and the last frame's report.
+		struct ProfilerState
+		{
+			Mutex mutex_;
+			Vector<ProfilerThreadData*> threads_;
+			Vector<ProfilerEntry> frameReport_;
+			i32 nextThreadIdx_ = 0;
+		};
+
+		/// Never destroyed, as threads exiting after static destruction still record and release their data.
+		ProfilerState& GetState()
+		{
+			static ProfilerState* state = new ProfilerState();
+			return *state;
+		}
+		thread_local ProfilerThread profilerThread_;
+
+		ProfilerThreadData* GetThreadData()
+		{
+			ProfilerThreadData* data = profilerThread_.data_;
+			if(data == nullptr)
+			{
+				data = new ProfilerThreadData();
+				ProfilerState& state = GetState();
+				ScopedMutex lock(state.mutex_);
+				data->idx_ = state.nextThreadIdx_++;
+				state.threads_.push_back(data);
+				profilerThread_.data_ = data;
+			}
+			return data;
+		}
+	} // namespace
+
+	void Profiler::Record(const char* name, u64 cycles)
+	{
+		ProfilerThreadData* data = GetThreadData();
+		const uintptr_t hash = ((uintptr_t)name >> 3) * 2654435761u;
+
+		data->Lock();
+		for(i32 probe = 0; probe < MAX_SCOPES; ++probe)
+		{
+			ScopeStats& scope = data->scopes_[(hash + probe) & (MAX_SCOPES - 1)];
+			if(scope.name_ == nullptr)
+				scope.name_ = name;
+			if(scope.name_ == name)
+			{
+				scope.callCount_++;
+				scope.totalCycles_ += cycles;
+				if(cycles > scope.maxCycles_)
+					scope.maxCycles_ = cycles;
+				break;
+			}
+		}
+		data->Unlock();
+	}
+
+	void Profiler::EndFrame()
+	{
+		const f64 secondsPerCycle = 1.0 / Timer::GetCycleFrequency();
+
+		ProfilerState& state = GetState();
+		ScopedMutex lock(state.mutex_);
+		state.frameReport_.clear();
+		for(i32 idx = 0; idx < state.threads_.size();)
+		{
+			ProfilerThreadData* data = state.threads_[idx];
+			data->Lock();
+			for(ScopeStats& scope : data->scopes_)
+			{
+				if(scope.name_ == nullptr)
+					continue;
+				ProfilerEntry entry;
+				entry.name_ = scope.name_;
+				entry.threadIdx_ = data->idx_;
+				entry.callCount_ = scope.callCount_;
+				entry.totalTime_ = (f64)scope.totalCycles_ * secondsPerCycle;
+				entry.maxTime_ = (f64)scope.maxCycles_ * secondsPerCycle;
+				state.frameReport_.push_back(entry);
+				scope = ScopeStats();
+			}
+			data->Unlock();
+
+			if(data->inUse_)
+			{
+				++idx;
+			}
+			else
+			{
+				delete data;
+				state.threads_.erase(state.threads_.begin() + idx);
+			}
+		}
+
+		std::sort(state.frameReport_.begin(), state.frameReport_.end(),
+		    [](const ProfilerEntry& a, const ProfilerEntry& b) { return a.totalTime_ > b.totalTime_; });
+	}
+
+	i32 Profiler::GetFrameReport(ProfilerEntry* outEntries, i32 maxEntries)
+	{
+		ProfilerState& state = GetState();
+		ScopedMutex lock(state.mutex_);
+		if(outEntries)
+		{
+			const i32 numEntries = state.frameReport_.size() < maxEntries ? state.frameReport_.size() : maxEntries;
+			for(i32 idx = 0; idx < numEntries; ++idx)
+				outEntries[idx] = state.frameReport_[idx];
+		}
+		return state.frameReport_.size();
+	}
+} // namespace Core
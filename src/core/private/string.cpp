@@ -74,37 +74,67 @@ namespace Core
 		internalAppend(buffer.data());
 	}
 
-	String& String::internalRemoveNullTerminator()
+	void String::internalGrow(i32 capacity)
 	{
-		if(data_.size() > 1)
-			data_.pop_back();
-		return *this;
+		DBG_ASSERT(capacity > capacity_);
+		// Grow geometrically so repeated appends are amortized.
+		if(capacity < capacity_ * 2)
+			capacity = capacity_ * 2;
+
+		char* newData = static_cast<char*>(allocator_.allocate(capacity + 1, 1));
+		memcpy(newData, c_str(), size_ + 1);
+		if(isHeap())
+			allocator_.deallocate(storage_.heap_, capacity_ + 1, 1);
+		storage_.heap_ = newData;
+		capacity_ = capacity;
 	}
 
 	String& String::internalSet(const char* str)
 	{
-		if(str)
-		{
-			i32 len = (i32)strlen(str) + 1;
-			data_.reserve(len);
-			data_.clear();
-			data_.insert(str, str + len);
-		}
-		else
+		return internalSet(str, str ? (i32)strlen(str) : 0);
+	}
+
+	String& String::internalSet(const char* str, i32 length)
+	{
+		if(length > capacity_)
 		{
-			data_.clear();
+			// Old contents aren't needed, so free before growing to avoid copying them.
+			clear();
+			internalGrow(length);
 		}
+		char* dst = data();
+		if(length > 0)
+			memmove(dst, str, length);
+		dst[length] = '\0';
+		size_ = length;
 		return *this;
 	}
 
 	String& String::internalAppend(const char* str)
 	{
 		if(str)
+			internalAppend(str, (i32)strlen(str));
+		return *this;
+	}
+
+	String& String::internalAppend(const char* str, i32 length)
+	{
+		const i32 newSize = size_ + length;
+		if(newSize > capacity_)
 		{
-			i32 len = (i32)strlen(str) + 1;
-			internalRemoveNullTerminator();
-			data_.insert(str, str + len);
+			// Appending to self, str will be freed by growing.
+			if(str >= c_str() && str < c_str() + size_ + 1)
+			{
+				String copy;
+				copy.internalSet(str, length);
+				return internalAppend(copy.c_str(), copy.size());
+			}
+			internalGrow(newSize);
 		}
+		char* dst = data();
+		memmove(dst + size_, str, length);
+		dst[newSize] = '\0';
+		size_ = newSize;
 		return *this;
 	}
 
@@ -112,19 +142,12 @@ namespace Core
 	{
 		if(!str)
 			str = "";
-		if(data_.size() > 0)
-		{
-			return strcmp(data_.data(), str);
-		}
-		return strcmp("", str);
+		return strcmp(c_str(), str);
 	}
 
 	u32 Hash(u32 input, const String& str)
 	{
-		if(str.size() > 0)
-			return Hash(input, str.c_str());
-		else
-			return Hash(input, "");
+		return Hash(input, str.c_str());
 	}
 
 } // end namespace
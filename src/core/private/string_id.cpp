@@ -0,0 +1,158 @@
+#include "core/string_id.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/memory_tracker.h"
+#include "core/vector.h"
+
+#include <cstring>
+#include <new>
+
+namespace Core
+{
+	namespace
+	{
+		using StringIdAllocator = TaggedAllocator<MemoryTag::CORE>;
+
+		/**
+		 * Hash table of interned strings, chained through StringIdEntry::next_.
+		 * Entries are allocated from chunks which are never freed, so StringIds stay valid while other
+		 * statics are being destroyed.
+		 */
+		struct StringTable
+		{
+			static const i32 CHUNK_SIZE = 64 * 1024;
+			static const i32 MIN_BUCKETS = 1024;
+
+			RWLock lock_;
+			Vector<const StringIdEntry*, StringIdAllocator> buckets_;
+			i32 numEntries_ = 0;
+
+			Vector<u8*, StringIdAllocator> chunks_;
+			u8* chunkPos_ = nullptr;
+			i32 chunkRemaining_ = 0;
+
+			const StringIdEntry* Find(const char* str, i32 length, u32 hash) const
+			{
+				if(buckets_.size() == 0)
+					return nullptr;
+				const StringIdEntry* entry = buckets_[hash & (buckets_.size() - 1)];
+				for(; entry != nullptr; entry = entry->next_)
+				{
+					if(entry->hash_ == hash && entry->length_ == length &&
+					    memcmp(entry + 1, str, length) == 0)
+						return entry;
+				}
+				return nullptr;
+			}
+
+			/// @pre Write lock held.
+			const StringIdEntry* Insert(const char* str, i32 length, u32 hash)
+			{
+				if(numEntries_ >= buckets_.size())
+					Rehash(buckets_.size() > 0 ? buckets_.size() * 2 : MIN_BUCKETS);
+
+				StringIdEntry* entry = new(AllocEntry(length)) StringIdEntry();
+				entry->hash_ = hash;
+				entry->length_ = length;
+				char* entryStr = reinterpret_cast<char*>(entry + 1);
+				memcpy(entryStr, str, length);
+				entryStr[length] = '\0';
+
+				const StringIdEntry*& bucket = buckets_[hash & (buckets_.size() - 1)];
+				entry->next_ = bucket;
+				bucket = entry;
+				++numEntries_;
+				return entry;
+			}
+
+			void* AllocEntry(i32 length)
+			{
+				i32 size = (i32)sizeof(StringIdEntry) + length + 1;
+				size = (size + (i32)alignof(StringIdEntry) - 1) & ~((i32)alignof(StringIdEntry) - 1);
+				if(size > chunkRemaining_)
+				{
+					// Strings larger than a chunk get a chunk of their own.
+					const i32 chunkSize = size > CHUNK_SIZE ? size : CHUNK_SIZE;
+					chunkPos_ = static_cast<u8*>(StringIdAllocator().allocate(chunkSize, 1));
+					chunkRemaining_ = chunkSize;
+					chunks_.push_back(chunkPos_);
+				}
+				void* mem = chunkPos_;
+				chunkPos_ += size;
+				chunkRemaining_ -= size;
+				return mem;
+			}
+
+			void Rehash(i32 numBuckets)
+			{
+				Vector<const StringIdEntry*, StringIdAllocator> buckets;
+				buckets.resize(numBuckets, nullptr);
+				for(const StringIdEntry* entry : buckets_)
+				{
+					while(entry != nullptr)
+					{
+						StringIdEntry* moving = const_cast<StringIdEntry*>(entry);
+						entry = entry->next_;
+						const StringIdEntry*& bucket = buckets[moving->hash_ & (numBuckets - 1)];
+						moving->next_ = bucket;
+						bucket = moving;
+					}
+				}
+				buckets_.swap(buckets);
+			}
+		};
+
+		StringTable& GetStringTable()
+		{
+			// Intentionally leaked, so StringIds in other statics outlive it safely.
+			static StringTable* table = new StringTable();
+			return *table;
+		}
+
+		const StringIdEntry* Intern(const char* str, i32 length)
+		{
+			if(str == nullptr || length == 0)
+				return nullptr;
+
+			const u32 hash = HashSDBM(0, str, length);
+			StringTable& table = GetStringTable();
+			{
+				ScopedReadLock lock(table.lock_);
+				if(const StringIdEntry* entry = table.Find(str, length, hash))
+					return entry;
+			}
+
+			ScopedWriteLock lock(table.lock_);
+			// May have been inserted between locks.
+			if(const StringIdEntry* entry = table.Find(str, length, hash))
+				return entry;
+			return table.Insert(str, length, hash);
+		}
+	} // namespace
+
+	StringId::StringId(const char* str)
+	    : entry_(Intern(str, str ? (i32)strlen(str) : 0))
+	{
+	}
+
+	StringId::StringId(const char* str, i32 length)
+	    : entry_(Intern(str, length))
+	{
+		DBG_ASSERT(length >= 0);
+	}
+
+	StringId StringId::Find(const char* str)
+	{
+		const i32 length = str ? (i32)strlen(str) : 0;
+		if(length == 0)
+			return StringId();
+
+		const u32 hash = HashSDBM(0, str, length);
+		StringTable& table = GetStringTable();
+		StringId stringId;
+		ScopedReadLock lock(table.lock_);
+		stringId.entry_ = table.Find(str, length, hash);
+		return stringId;
+	}
+
+} // namespace Core
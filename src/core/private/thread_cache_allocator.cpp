@@ -0,0 +1,162 @@
+#include "core/thread_cache_allocator.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/vector.h"
+
+namespace Core
+{
+	namespace
+	{
+		/// Size classes are powers of two from MIN_CACHED_SIZE to ThreadCacheAllocator::MAX_CACHED_SIZE.
+		static const i64 MIN_CACHED_SIZE = 16;
+		static const i32 NUM_SIZE_CLASSES = 8;
+		/// Blocks to keep per size class. When exceeded, half are returned to the backing allocator.
+		static const i32 MAX_BLOCKS_PER_CLASS = 64;
+		/// Blocks to allocate from the backing allocator on a miss.
+		static const i32 REFILL_BLOCKS = 8;
+
+		static_assert((MIN_CACHED_SIZE << (NUM_SIZE_CLASSES - 1)) == ThreadCacheAllocator::MAX_CACHED_SIZE,
+		    "Size classes must cover up to MAX_CACHED_SIZE.");
+
+		inline i32 GetSizeClass(i64 size)
+		{
+			i32 sizeClass = 0;
+			while((MIN_CACHED_SIZE << sizeClass) < size)
+				++sizeClass;
+			return sizeClass;
+		}
+
+		inline i64 GetClassSize(i32 sizeClass) { return MIN_CACHED_SIZE << sizeClass; }
+
+		struct CachedBlock
+		{
+			CachedBlock* next_;
+		};
+
+		struct ThreadCache
+		{
+			CachedBlock* blocks_[NUM_SIZE_CLASSES] = {nullptr};
+			i32 numBlocks_[NUM_SIZE_CLASSES] = {0};
+		};
+	} // namespace
+
+	struct ThreadCacheAllocatorImpl
+	{
+		ThreadCacheAllocatorImpl(IAllocator& backing)
+		    : backing_(backing)
+		{
+		}
+
+		IAllocator& backing_;
+		TLS tls_;
+
+		/// Every thread's cache, so they can be freed on destruction.
+		Mutex cachesMutex_;
+		Vector<ThreadCache*> caches_;
+
+		ThreadCache* GetCache()
+		{
+			auto* cache = (ThreadCache*)tls_.Get();
+			if(cache == nullptr)
+			{
+				cache = new ThreadCache();
+				tls_.Set(cache);
+				ScopedMutex lock(cachesMutex_);
+				caches_.push_back(cache);
+			}
+			return cache;
+		}
+
+		/// Return blocks of @a sizeClass to the backing allocator until @a numToKeep remain.
+		void Release(ThreadCache* cache, i32 sizeClass, i32 numToKeep)
+		{
+			const i64 classSize = GetClassSize(sizeClass);
+			while(cache->numBlocks_[sizeClass] > numToKeep)
+			{
+				CachedBlock* block = cache->blocks_[sizeClass];
+				cache->blocks_[sizeClass] = block->next_;
+				--cache->numBlocks_[sizeClass];
+				backing_.Deallocate(block, classSize);
+			}
+		}
+	};
+
+	ThreadCacheAllocator::ThreadCacheAllocator(IAllocator& backing)
+	{
+		impl_ = new ThreadCacheAllocatorImpl(backing);
+	}
+
+	ThreadCacheAllocator::~ThreadCacheAllocator()
+	{
+		for(ThreadCache* cache : impl_->caches_)
+		{
+			for(i32 sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+				impl_->Release(cache, sizeClass, 0);
+			delete cache;
+		}
+		delete impl_;
+	}
+
+	void* ThreadCacheAllocator::Allocate(i64 size, i64 align)
+	{
+		if(size > MAX_CACHED_SIZE)
+			return impl_->backing_.Allocate(size, align);
+
+		// Cached blocks are only guaranteed default alignment, so over-aligned requests skip the cache.
+		// They're still allocated at their class size, so they can be cached once freed.
+		const i32 sizeClass = GetSizeClass(size);
+		const i64 classSize = GetClassSize(sizeClass);
+		if(align > PLATFORM_ALIGNMENT)
+			return impl_->backing_.Allocate(classSize, align);
+
+		ThreadCache* cache = impl_->GetCache();
+		if(CachedBlock* block = cache->blocks_[sizeClass])
+		{
+			cache->blocks_[sizeClass] = block->next_;
+			--cache->numBlocks_[sizeClass];
+			return block;
+		}
+
+		// Miss, so take a few to save going back to the backing allocator for the next ones.
+		void* mem = impl_->backing_.Allocate(classSize, PLATFORM_ALIGNMENT);
+		if(mem == nullptr)
+			return nullptr;
+		for(i32 i = 1; i < REFILL_BLOCKS; ++i)
+		{
+			auto* block = (CachedBlock*)impl_->backing_.Allocate(classSize, PLATFORM_ALIGNMENT);
+			if(block == nullptr)
+				break;
+			block->next_ = cache->blocks_[sizeClass];
+			cache->blocks_[sizeClass] = block;
+			++cache->numBlocks_[sizeClass];
+		}
+		return mem;
+	}
+
+	void ThreadCacheAllocator::Deallocate(void* mem, i64 size)
+	{
+		if(mem == nullptr)
+			return;
+		if(size > MAX_CACHED_SIZE)
+		{
+			impl_->backing_.Deallocate(mem, size);
+			return;
+		}
+
+		const i32 sizeClass = GetSizeClass(size);
+		ThreadCache* cache = impl_->GetCache();
+		auto* block = (CachedBlock*)mem;
+		block->next_ = cache->blocks_[sizeClass];
+		cache->blocks_[sizeClass] = block;
+		if(++cache->numBlocks_[sizeClass] > MAX_BLOCKS_PER_CLASS)
+			impl_->Release(cache, sizeClass, MAX_BLOCKS_PER_CLASS / 2);
+	}
+
+	void ThreadCacheAllocator::Flush()
+	{
+		if(auto* cache = (ThreadCache*)impl_->tls_.Get())
+			for(i32 sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+				impl_->Release(cache, sizeClass, 0);
+	}
+
+} // namespace Core
@@ -6,7 +6,12 @@
 #define USE_QUERY_PERF_COUNTER 1
 #endif
 
-#if PLATFORM_LINUX || PLATFORM_OSX || PLATFORM_ANDROID
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+#include <time.h>
+#define USE_CLOCK_GETTIME 1
+#endif
+
+#if PLATFORM_OSX
 #include <sys/time.h>
 #define USE_GET_TIME_OF_DAY 1
 #endif
@@ -17,22 +22,66 @@
 
 namespace Core
 {
-	f64 Timer::GetAbsoluteTime()
+	namespace
 	{
 #if USE_QUERY_PERF_COUNTER
+		i64 GetPerfFrequency()
+		{
+			LARGE_INTEGER freq;
+			::QueryPerformanceFrequency(&freq);
+			return freq.QuadPart;
+		}
+#endif
+
+		f64 CalibrateCycleFrequency()
+		{
+#if ARCH_X86_64 || ARCH_X86
+			// Long enough to make timer resolution insignificant, short enough not to stall startup.
+			static const i64 CALIBRATION_NS = 2000000;
+			const i64 beginTime = Timer::GetAbsoluteTimeNS();
+			const u64 beginCycles = Timer::GetCycleCount();
+			i64 endTime = beginTime;
+			while((endTime - beginTime) < CALIBRATION_NS)
+				endTime = Timer::GetAbsoluteTimeNS();
+			const u64 endCycles = Timer::GetCycleCount();
+			return (f64)(endCycles - beginCycles) * 1000000000.0 / (f64)(endTime - beginTime);
+#else
+			return 1000000000.0;
+#endif
+		}
+	} // namespace
+
+	f64 Timer::GetAbsoluteTime() { return (f64)GetAbsoluteTimeNS() / 1000000000.0; }
+
+	i64 Timer::GetAbsoluteTimeNS()
+	{
+#if USE_QUERY_PERF_COUNTER
+		// Frequency is fixed at boot.
+		static const i64 freq = GetPerfFrequency();
 		LARGE_INTEGER time;
-		LARGE_INTEGER freq;
 		::QueryPerformanceCounter(&time);
-		::QueryPerformanceFrequency(&freq);
-		return (f64)time.QuadPart / (f64)freq.QuadPart;
+		// Split to avoid overflowing when scaling up to nanoseconds.
+		const i64 seconds = time.QuadPart / freq;
+		const i64 remainder = time.QuadPart % freq;
+		return seconds * 1000000000LL + (remainder * 1000000000LL) / freq;
+#elif USE_CLOCK_GETTIME
+		timespec time;
+		::clock_gettime(CLOCK_MONOTONIC, &time);
+		return (i64)time.tv_sec * 1000000000LL + (i64)time.tv_nsec;
 #elif USE_GET_TIME_OF_DAY
 		timeval time;
-		::gettimeofday(&MarkedTime_, nullptr);
-		return (f64)(time.tv_sec * 1000000 + time.tv_usec);
+		::gettimeofday(&time, nullptr);
+		return (i64)time.tv_sec * 1000000000LL + (i64)time.tv_usec * 1000LL;
 #elif PLATFORM_HTML5
-		return emscripten_get_now();
+		return (i64)(emscripten_get_now() * 1000000.0);
 #else
 #error "Unimplemented for platform."
 #endif
 	}
+
+	f64 Timer::GetCycleFrequency()
+	{
+		static const f64 freq = CalibrateCycleFrequency();
+		return freq;
+	}
 } // namespace Core
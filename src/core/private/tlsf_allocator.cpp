@@ -0,0 +1,326 @@
+#include "core/tlsf_allocator.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+
+#if COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace Core
+{
+	namespace
+	{
+		/// Block sizes are a multiple of this, and allocations are aligned to it.
+		static const i64 TLSF_ALIGN = 16;
+		static const i32 TLSF_ALIGN_LOG2 = 4;
+		/// Second level bins per power of two, as log2.
+		static const i32 SL_INDEX_COUNT_LOG2 = 4;
+		static const i32 SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+		/// Sizes below SMALL_BLOCK_SIZE all map to first level 0, spaced linearly by TLSF_ALIGN.
+		static const i32 FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + TLSF_ALIGN_LOG2;
+		static const i64 SMALL_BLOCK_SIZE = (i64)1 << FL_INDEX_SHIFT;
+		/// Blocks must be smaller than 2^FL_INDEX_MAX. Keeps the first level bitmap within 32 bits.
+		static const i32 FL_INDEX_MAX = 38;
+		static const i32 FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+		static const i64 MAX_BLOCK_SIZE = ((i64)1 << FL_INDEX_MAX) - 1;
+
+		/// Set in TLSFBlock::size_ when free. Sizes are multiples of TLSF_ALIGN, so low bits are unused.
+		static const u64 BLOCK_FREE_BIT = 1;
+
+		struct TLSFBlock
+		{
+			/// Payload size, and BLOCK_FREE_BIT.
+			u64 size_;
+			union
+			{
+				/// Previous block in memory. nullptr for the first.
+				TLSFBlock* prevPhys_;
+				u64 pad_;
+			};
+			/// Free list links. Only valid when free, as they're in the payload.
+			TLSFBlock* nextFree_;
+			TLSFBlock* prevFree_;
+		};
+
+		/// Header before every payload.
+		static const i64 BLOCK_HEADER_SIZE = sizeof(u64) * 2;
+		/// Smallest payload, so a free block can hold its free list links.
+		static const i64 MIN_BLOCK_SIZE = TLSF_ALIGN;
+
+		static_assert(BLOCK_HEADER_SIZE % TLSF_ALIGN == 0, "Header must keep payloads aligned.");
+		static_assert(sizeof(TLSFBlock) <= BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE, "Free block must fit.");
+
+		inline i64 GetSize(const TLSFBlock* block) { return (i64)(block->size_ & ~BLOCK_FREE_BIT); }
+		inline bool IsFree(const TLSFBlock* block) { return (block->size_ & BLOCK_FREE_BIT) != 0; }
+		inline u8* GetPayload(TLSFBlock* block) { return (u8*)block + BLOCK_HEADER_SIZE; }
+		inline TLSFBlock* GetBlock(void* payload) { return (TLSFBlock*)((u8*)payload - BLOCK_HEADER_SIZE); }
+		inline TLSFBlock* GetNextPhys(TLSFBlock* block) { return (TLSFBlock*)(GetPayload(block) + GetSize(block)); }
+
+		inline void SetSize(TLSFBlock* block, i64 size, bool free)
+		{
+			block->size_ = (u64)size | (free ? BLOCK_FREE_BIT : 0);
+		}
+
+		inline i32 FindFirstSet(u32 value)
+		{
+#if COMPILER_MSVC
+			unsigned long idx = 0;
+			_BitScanForward(&idx, value);
+			return (i32)idx;
+#else
+			return __builtin_ctz(value);
+#endif
+		}
+
+		inline i32 FindLastSet(u64 value)
+		{
+#if COMPILER_MSVC
+			unsigned long idx = 0;
+			if(_BitScanReverse(&idx, (u32)(value >> 32)))
+				return (i32)idx + 32;
+			_BitScanReverse(&idx, (u32)value);
+			return (i32)idx;
+#else
+			return 63 - __builtin_clzll(value);
+#endif
+		}
+
+		inline i64 AlignUp(i64 value, i64 align) { return (value + (align - 1)) & ~(align - 1); }
+
+		/// Bin that a free block of @a size goes in.
+		void MappingInsert(i64 size, i32& outFL, i32& outSL)
+		{
+			if(size < SMALL_BLOCK_SIZE)
+			{
+				outFL = 0;
+				outSL = (i32)(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+			}
+			else
+			{
+				const i32 bit = FindLastSet((u64)size);
+				outSL = (i32)(size >> (bit - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+				outFL = bit - (FL_INDEX_SHIFT - 1);
+			}
+		}
+
+		/// First bin in which every block is at least @a size.
+		void MappingSearch(i64 size, i32& outFL, i32& outSL)
+		{
+			if(size >= SMALL_BLOCK_SIZE)
+				size += ((i64)1 << (FindLastSet((u64)size) - SL_INDEX_COUNT_LOG2)) - 1;
+			MappingInsert(size, outFL, outSL);
+		}
+	} // namespace
+
+	struct TLSFAllocatorImpl
+	{
+		Mutex mutex_;
+		u8* memory_ = nullptr;
+		i64 usage_ = 0;
+		/// Bit per first level with any free blocks.
+		u32 flBitmap_ = 0;
+		/// Bit per second level with any free blocks, for each first level.
+		u32 slBitmaps_[FL_INDEX_COUNT] = {0};
+		/// Free lists.
+		TLSFBlock* freeBlocks_[FL_INDEX_COUNT][SL_INDEX_COUNT] = {{nullptr}};
+
+		void InsertFree(TLSFBlock* block)
+		{
+			i32 fl = 0, sl = 0;
+			MappingInsert(GetSize(block), fl, sl);
+			TLSFBlock* head = freeBlocks_[fl][sl];
+			block->nextFree_ = head;
+			block->prevFree_ = nullptr;
+			if(head)
+				head->prevFree_ = block;
+			freeBlocks_[fl][sl] = block;
+			flBitmap_ |= 1u << fl;
+			slBitmaps_[fl] |= 1u << sl;
+		}
+
+		void RemoveFree(TLSFBlock* block)
+		{
+			i32 fl = 0, sl = 0;
+			MappingInsert(GetSize(block), fl, sl);
+			if(block->nextFree_)
+				block->nextFree_->prevFree_ = block->prevFree_;
+			if(block->prevFree_)
+				block->prevFree_->nextFree_ = block->nextFree_;
+			if(freeBlocks_[fl][sl] == block)
+			{
+				freeBlocks_[fl][sl] = block->nextFree_;
+				if(freeBlocks_[fl][sl] == nullptr)
+				{
+					slBitmaps_[fl] &= ~(1u << sl);
+					if(slBitmaps_[fl] == 0)
+						flBitmap_ &= ~(1u << fl);
+				}
+			}
+		}
+
+		/// Find and remove a free block of at least @a size.
+		TLSFBlock* TakeFree(i64 size)
+		{
+			i32 fl = 0, sl = 0;
+			MappingSearch(size, fl, sl);
+			if(fl >= FL_INDEX_COUNT)
+				return nullptr;
+
+			u32 slMap = slBitmaps_[fl] & (~0u << sl);
+			if(slMap == 0)
+			{
+				// Nothing in this first level, take the smallest larger one.
+				const u32 flMap = (fl + 1) < 32 ? flBitmap_ & (~0u << (fl + 1)) : 0;
+				if(flMap == 0)
+					return nullptr;
+				fl = FindFirstSet(flMap);
+				slMap = slBitmaps_[fl];
+			}
+			sl = FindFirstSet(slMap);
+
+			TLSFBlock* block = freeBlocks_[fl][sl];
+			DBG_ASSERT(block && IsFree(block) && GetSize(block) >= size);
+			RemoveFree(block);
+			return block;
+		}
+
+		/// Split @a block at @a offset into its payload, returning the new block after it.
+		TLSFBlock* Split(TLSFBlock* block, i64 offset)
+		{
+			auto* remaining = (TLSFBlock*)(GetPayload(block) + offset);
+			SetSize(remaining, GetSize(block) - offset - BLOCK_HEADER_SIZE, false);
+			remaining->prevPhys_ = block;
+			GetNextPhys(remaining)->prevPhys_ = remaining;
+			SetSize(block, offset, false);
+			return remaining;
+		}
+
+		/// Merge @a next into @a block, which precedes it.
+		void Merge(TLSFBlock* block, TLSFBlock* next)
+		{
+			SetSize(block, GetSize(block) + BLOCK_HEADER_SIZE + GetSize(next), false);
+			GetNextPhys(block)->prevPhys_ = block;
+		}
+	};
+
+	TLSFAllocator::TLSFAllocator(i64 capacity)
+	{
+		DBG_ASSERT(capacity >= (BLOCK_HEADER_SIZE * 2 + MIN_BLOCK_SIZE));
+		impl_ = new TLSFAllocatorImpl();
+		impl_->memory_ = ::new u8[capacity + TLSF_ALIGN];
+
+		// One free block covering everything, followed by a zero sized used block so the last real block
+		// never looks for a neighbour past the end.
+		u8* begin = (u8*)AlignUp((i64)(uintptr_t)impl_->memory_, TLSF_ALIGN);
+		const i64 size = ((capacity & ~(TLSF_ALIGN - 1)) - BLOCK_HEADER_SIZE * 2);
+		DBG_ASSERT(size <= MAX_BLOCK_SIZE);
+		auto* block = (TLSFBlock*)begin;
+		SetSize(block, size, true);
+		block->prevPhys_ = nullptr;
+		TLSFBlock* sentinel = GetNextPhys(block);
+		SetSize(sentinel, 0, false);
+		sentinel->prevPhys_ = block;
+		impl_->InsertFree(block);
+	}
+
+	TLSFAllocator::~TLSFAllocator()
+	{
+		DBG_ASSERT_MSG(impl_->usage_ == 0, "TLSF allocator destroyed with %lld bytes still allocated.", impl_->usage_);
+		delete[] impl_->memory_;
+		delete impl_;
+	}
+
+	void* TLSFAllocator::Allocate(i64 size, i64 align)
+	{
+		DBG_ASSERT(size >= 0);
+		DBG_ASSERT(align > 0 && (align & (align - 1)) == 0);
+
+		const i64 blockSize = size > MIN_BLOCK_SIZE ? AlignUp(size, TLSF_ALIGN) : MIN_BLOCK_SIZE;
+		// Larger alignments need room to split off a free block in front of the aligned payload.
+		const i64 searchSize =
+		    align > TLSF_ALIGN ? blockSize + align + BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE : blockSize;
+		if(size > MAX_BLOCK_SIZE || searchSize > MAX_BLOCK_SIZE)
+			return nullptr;
+
+		ScopedMutex lock(impl_->mutex_);
+		TLSFBlock* block = impl_->TakeFree(searchSize);
+		if(block == nullptr)
+			return nullptr;
+
+		if(align > TLSF_ALIGN)
+		{
+			const i64 payload = (i64)(uintptr_t)GetPayload(block);
+			if((payload & (align - 1)) != 0)
+			{
+				const i64 gap = AlignUp(payload + BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE, align) - payload;
+				TLSFBlock* aligned = impl_->Split(block, gap - BLOCK_HEADER_SIZE);
+				SetSize(block, GetSize(block), true);
+				impl_->InsertFree(block);
+				block = aligned;
+			}
+		}
+
+		// Return the remainder to the free lists, if there's enough for a block.
+		if(GetSize(block) >= blockSize + BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE)
+		{
+			TLSFBlock* remaining = impl_->Split(block, blockSize);
+			SetSize(remaining, GetSize(remaining), true);
+			impl_->InsertFree(remaining);
+		}
+
+		SetSize(block, GetSize(block), false);
+		impl_->usage_ += GetSize(block) + BLOCK_HEADER_SIZE;
+		return GetPayload(block);
+	}
+
+	void TLSFAllocator::Deallocate(void* mem, i64 size)
+	{
+		if(mem == nullptr)
+			return;
+
+		TLSFBlock* block = GetBlock(mem);
+		DBG_ASSERT(!IsFree(block));
+		DBG_ASSERT(GetSize(block) >= size);
+		(void)size;
+
+		ScopedMutex lock(impl_->mutex_);
+		impl_->usage_ -= GetSize(block) + BLOCK_HEADER_SIZE;
+
+		// Merge with free neighbours, so there are never two free blocks next to each other.
+		TLSFBlock* prev = block->prevPhys_;
+		if(prev && IsFree(prev))
+		{
+			impl_->RemoveFree(prev);
+			impl_->Merge(prev, block);
+			block = prev;
+		}
+		TLSFBlock* next = GetNextPhys(block);
+		if(IsFree(next))
+		{
+			impl_->RemoveFree(next);
+			impl_->Merge(block, next);
+		}
+		SetSize(block, GetSize(block), true);
+		impl_->InsertFree(block);
+	}
+
+	i64 TLSFAllocator::GetUsage() const
+	{
+		ScopedMutex lock(impl_->mutex_);
+		return impl_->usage_;
+	}
+
+	i64 TLSFAllocator::GetLargestFree() const
+	{
+		ScopedMutex lock(impl_->mutex_);
+		if(impl_->flBitmap_ == 0)
+			return 0;
+		const i32 fl = FindLastSet(impl_->flBitmap_);
+		const i32 sl = FindLastSet(impl_->slBitmaps_[fl]);
+		i64 largest = 0;
+		for(TLSFBlock* block = impl_->freeBlocks_[fl][sl]; block; block = block->nextFree_)
+			largest = GetSize(block) > largest ? GetSize(block) : largest;
+		return largest;
+	}
+
+} // namespace Core
@@ -118,6 +118,6 @@ namespace Core
 
 	u32 Hash(u32 input, const UUID& data)
 	{ //
-		return HashCRC32(input, &data, sizeof(data));
+		return HashCRC32C(input, &data, sizeof(data));
 	}
 } // namespace core
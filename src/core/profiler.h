@@ -0,0 +1,104 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/types.h"
+#include "core/timer.h"
+
+#ifndef CORE_PROFILE_ENABLED
+#define CORE_PROFILE_ENABLED (0)
+#endif
+
+namespace Core
+{
+	/**
+	 * Timings for one scope on one thread over a frame.
+	 */
+	struct ProfilerEntry
+	{
+		/// Name passed to PROFILE_SCOPE.
+		const char* name_ = nullptr;
+		/// Thread recorded on, numbered in the order threads first recorded.
+		i32 threadIdx_ = 0;
+		/// Times the scope was exited.
+		i32 callCount_ = 0;
+		/// Total time in the scope, in seconds.
+		f64 totalTime_ = 0.0;
+		/// Longest single time in the scope, in seconds.
+		f64 maxTime_ = 0.0;
+	};
+
+	/**
+	 * Aggregates timings recorded by PROFILE_SCOPE into a per-frame report.
+	 * Each thread counts calls, total and max cycles per scope into its own table, so recording never
+	 * contends with other threads. EndFrame gathers and resets every thread's table into the report.
+	 * Scopes are identified by name pointer, so names must be string literals or otherwise outlive the
+	 * report, and a thread drops scopes beyond MAX_SCOPES distinct names in a frame.
+	 * Thread safe.
+	 */
+	class CORE_DLL Profiler final
+	{
+	public:
+		/// Distinct scopes recorded per thread per frame. Must be a power of two.
+		static const i32 MAX_SCOPES = 256;
+
+		/**
+		 * Record time spent in a scope on the calling thread. Normally called by ProfilerScope.
+		 * @param name Scope name.
+		 * @param cycles Time in scope, from Timer::GetCycleCount.
+		 */
+		static void Record(const char* name, u64 cycles);
+
+		/**
+		 * End frame, making timings recorded since the previous EndFrame the frame report.
+		 * Call once per frame.
+		 */
+		static void EndFrame();
+
+		/**
+		 * Get report for the last ended frame, sorted by descending total time.
+		 * @param outEntries Array to fill. Can be nullptr to just count.
+		 * @param maxEntries Size of @a outEntries.
+		 * @return Number of entries in the report.
+		 */
+		static i32 GetFrameReport(ProfilerEntry* outEntries, i32 maxEntries);
+
+	private:
+		Profiler() = delete;
+		~Profiler() = delete;
+	};
+
+	/**
+	 * Records the time between construction and destruction with Profiler.
+	 */
+	class ProfilerScope final
+	{
+	public:
+		ProfilerScope(const char* name)
+		    : name_(name)
+		    , begin_(Timer::GetCycleCount())
+		{
+		}
+
+		~ProfilerScope() { Profiler::Record(name_, Timer::GetCycleCount() - begin_); }
+
+	private:
+		ProfilerScope(const ProfilerScope&) = delete;
+		ProfilerScope& operator=(const ProfilerScope&) = delete;
+
+		const char* name_;
+		u64 begin_;
+	};
+} // namespace Core
+
+#define PROFILE_CONCAT_INTERNAL(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INTERNAL(A, B)
+
+/**
+ * Time the rest of the enclosing scope, reported under @a NAME.
+ * Compiled out unless CORE_PROFILE_ENABLED.
+ */
+#if CORE_PROFILE_ENABLED
+#define PROFILE_SCOPE(NAME) Core::ProfilerScope PROFILE_CONCAT(profileScope_, __LINE__)(NAME)
+#else
+#define PROFILE_SCOPE(NAME) (void)0
+#endif
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/allocator.h"
+#include "core/debug.h"
+#include "core/handle.h"
+#include "core/vector.h"
+
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Slot map.
+	 * Stores values densely, addressed by handles that are validated by magic ID, as HandleAllocator does.
+	 * Insert and erase are O(1). Erase moves the last value into the hole, so iteration is over a contiguous
+	 * array with no holes, but doesn't preserve insertion order, and pointers to values are invalidated by
+	 * insert and erase. Use GetHandle to get the handle for a value while iterating.
+	 * Not thread safe.
+	 */
+	template<typename TYPE, typename ALLOCATOR = Allocator>
+	class SlotMap
+	{
+	public:
+		using index_type = i32;
+		using value_type = TYPE;
+		using iterator = value_type*;
+		using const_iterator = const value_type*;
+
+		/**
+		 * @param type Type to store in handles, so handles from maps of different types can be told apart.
+		 */
+		explicit SlotMap(i32 type = 0, const ALLOCATOR& allocator = ALLOCATOR())
+		    : values_(allocator)
+		    , valueSlots_(allocator)
+		    , slots_(allocator)
+		    , type_(type)
+		{
+			DBG_ASSERT(type >= 0 && type < Handle::MAX_TYPE);
+		}
+
+		SlotMap(SlotMap&& other) { swap(other); }
+
+		SlotMap& operator=(SlotMap&& other)
+		{
+			swap(other);
+			return *this;
+		}
+
+		void swap(SlotMap& other)
+		{
+			values_.swap(other.values_);
+			valueSlots_.swap(other.valueSlots_);
+			slots_.swap(other.slots_);
+			std::swap(freeHead_, other.freeHead_);
+			std::swap(type_, other.type_);
+		}
+
+		/**
+		 * Insert value.
+		 * @return Handle to value, or invalid handle if there are already Handle::MAX_INDEX values.
+		 */
+		Handle insert(const TYPE& value) { return emplace(value); }
+		Handle insert(TYPE&& value) { return emplace(std::move(value)); }
+
+		template<class... VAL_TYPE>
+		Handle emplace(VAL_TYPE&&... value)
+		{
+			Handle handle = allocSlot();
+			if(handle)
+			{
+				values_.emplace_back(std::forward<VAL_TYPE>(value)...);
+				valueSlots_.push_back(handle.index_);
+			}
+			return handle;
+		}
+
+		/**
+		 * Erase value.
+		 * @return false if @a handle isn't valid.
+		 */
+		bool erase(Handle handle)
+		{
+			if(!contains(handle))
+				return false;
+
+			// Move last value into the hole, and point its slot at the new location.
+			Slot& slot = slots_[handle.index_];
+			const index_type lastIdx = values_.size() - 1;
+			if(slot.index_ != lastIdx)
+			{
+				values_[slot.index_] = std::move(values_[lastIdx]);
+				valueSlots_[slot.index_] = valueSlots_[lastIdx];
+				slots_[valueSlots_[lastIdx]].index_ = slot.index_;
+			}
+			values_.pop_back();
+			valueSlots_.pop_back();
+
+			// Increment magic, wrapping at MAX_MAGIC and skipping zero.
+			slot.magic_ = (u16)((slot.magic_ + 1) & (Handle::MAX_MAGIC - 1));
+			if(slot.magic_ == 0)
+				++slot.magic_;
+			slot.index_ = freeHead_;
+			freeHead_ = handle.index_;
+			return true;
+		}
+
+		/**
+		 * Is @a handle valid for this map?
+		 */
+		bool contains(Handle handle) const
+		{
+			return handle && (i32)handle.type_ == type_ && (i32)handle.index_ < slots_.size() &&
+			       slots_[handle.index_].magic_ == handle.magic_;
+		}
+
+		/**
+		 * @return Value for @a handle, or nullptr if it isn't valid.
+		 */
+		TYPE* find(Handle handle) { return contains(handle) ? &values_[slots_[handle.index_].index_] : nullptr; }
+
+		const TYPE* find(Handle handle) const
+		{
+			return contains(handle) ? &values_[slots_[handle.index_].index_] : nullptr;
+		}
+
+		TYPE& operator[](Handle handle)
+		{
+			DBG_ASSERT_MSG(contains(handle), "Invalid handle.");
+			return values_[slots_[handle.index_].index_];
+		}
+
+		const TYPE& operator[](Handle handle) const
+		{
+			DBG_ASSERT_MSG(contains(handle), "Invalid handle.");
+			return values_[slots_[handle.index_].index_];
+		}
+
+		/**
+		 * @return Handle for value at @a idx in iteration order.
+		 */
+		Handle GetHandle(index_type idx) const
+		{
+			const index_type slotIdx = valueSlots_[idx];
+			return makeHandle(slotIdx, slots_[slotIdx].magic_);
+		}
+
+		/**
+		 * @return Handle for @a it.
+		 */
+		Handle GetHandle(const_iterator it) const { return GetHandle((index_type)(it - begin())); }
+
+		/**
+		 * Erase all values. Existing handles become invalid.
+		 */
+		void clear()
+		{
+			while(values_.size() > 0)
+				erase(GetHandle(values_.size() - 1));
+		}
+
+		void reserve(index_type capacity)
+		{
+			values_.reserve(capacity);
+			valueSlots_.reserve(capacity);
+			slots_.reserve(capacity);
+		}
+
+		iterator begin() noexcept { return values_.begin(); }
+		const_iterator begin() const noexcept { return values_.begin(); }
+		iterator end() noexcept { return values_.end(); }
+		const_iterator end() const noexcept { return values_.end(); }
+
+		TYPE* data() noexcept { return values_.data(); }
+		const TYPE* data() const noexcept { return values_.data(); }
+		index_type size() const noexcept { return values_.size(); }
+		bool empty() const noexcept { return values_.empty(); }
+
+	private:
+		SlotMap(const SlotMap&) = delete;
+		SlotMap& operator=(const SlotMap&) = delete;
+
+		struct Slot
+		{
+			/// Index into values_ while in use, next free slot while free.
+			index_type index_ = -1;
+			u16 magic_ = 1;
+		};
+
+		Handle makeHandle(index_type slotIdx, u16 magic) const
+		{
+			Handle handle;
+			handle.index_ = slotIdx;
+			handle.magic_ = magic;
+			handle.type_ = type_;
+			return handle;
+		}
+
+		Handle allocSlot()
+		{
+			index_type slotIdx = freeHead_;
+			if(slotIdx >= 0)
+			{
+				freeHead_ = slots_[slotIdx].index_;
+			}
+			else
+			{
+				if(slots_.size() >= Handle::MAX_INDEX)
+					return Handle();
+				slotIdx = slots_.size();
+				slots_.emplace_back();
+			}
+			slots_[slotIdx].index_ = values_.size();
+			return makeHandle(slotIdx, slots_[slotIdx].magic_);
+		}
+
+		/// Values, dense.
+		Vector<TYPE, ALLOCATOR> values_;
+		/// Slot for each value, parallel to values_.
+		Vector<index_type, ALLOCATOR> valueSlots_;
+		/// Slots, indexed by handle index.
+		Vector<Slot, ALLOCATOR> slots_;
+		/// First free slot, or -1.
+		index_type freeHead_ = -1;
+		i32 type_ = 0;
+	};
+
+} // namespace Core
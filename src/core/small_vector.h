@@ -0,0 +1,282 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/allocator.h"
+#include "core/debug.h"
+#include "core/vector.h"
+
+#include <type_traits>
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Vector with storage for INLINE_CAPACITY elements inside itself.
+	 * Doesn't allocate until it grows past INLINE_CAPACITY, so is suited to short lists built on the stack
+	 * or held in many objects. Once on the heap it behaves as Vector does, and stays there until shrink_to_fit.
+	 * Moving a SmallVector with inline elements moves the elements, so it isn't O(1) as it is for Vector.
+	 */
+	template<typename TYPE, i32 INLINE_CAPACITY, typename ALLOCATOR = Allocator>
+	class SmallVector
+	{
+	public:
+		static_assert(INLINE_CAPACITY > 0, "INLINE_CAPACITY must be greater than 0.");
+
+		using index_type = i32;
+		using value_type = TYPE;
+		using iterator = value_type*;
+		using const_iterator = const value_type*;
+
+		SmallVector() = default;
+		explicit SmallVector(const ALLOCATOR& allocator)
+		    : allocator_(allocator)
+		{
+		}
+
+		SmallVector(const SmallVector& other)
+		    : allocator_(other.allocator_)
+		{
+			insert(other.begin(), other.end());
+		}
+
+		SmallVector(SmallVector&& other)
+		    : allocator_(other.allocator_)
+		{
+			internalMove(other);
+		}
+
+		~SmallVector()
+		{
+			clear();
+			internalFree();
+		}
+
+		SmallVector& operator=(const SmallVector& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				insert(other.begin(), other.end());
+			}
+			return *this;
+		}
+
+		SmallVector& operator=(SmallVector&& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				internalFree();
+				allocator_ = other.allocator_;
+				internalMove(other);
+			}
+			return *this;
+		}
+
+		void swap(SmallVector& other)
+		{
+			SmallVector temp(std::move(other));
+			other = std::move(*this);
+			*this = std::move(temp);
+		}
+
+		TYPE& operator[](index_type idx)
+		{
+			DBG_ASSERT_MSG(idx >= 0 && idx < size_, "Index out of bounds. (index %u, size %u)", idx, size_);
+			return data_[idx];
+		}
+
+		const TYPE& operator[](index_type idx) const
+		{
+			DBG_ASSERT_MSG(idx >= 0 && idx < size_, "Index out of bounds. (%u, size %u)", idx, size_);
+			return data_[idx];
+		}
+
+		void clear()
+		{
+			DestructElements(data_, data_ + size_);
+			size_ = 0;
+		}
+
+		iterator erase(iterator it) { return erase(it, it + 1); }
+
+		/**
+		 * Erase elements in [first, last), moving the following elements down.
+		 * @return Iterator to the element that followed the erased range.
+		 */
+		iterator erase(iterator first, iterator last)
+		{
+			DBG_ASSERT_MSG(first >= begin() && first <= last && last <= end(), "Invalid iterator.");
+			if(first != last)
+			{
+				EraseElements(first, last, end());
+				size_ -= (index_type)(last - first);
+			}
+			return first;
+		}
+
+		iterator push_back(const TYPE& value) { return emplace_back(value); }
+		iterator push_back(TYPE&& value) { return emplace_back(std::move(value)); }
+
+		template<class... VAL_TYPE>
+		iterator emplace_back(VAL_TYPE&&... value)
+		{
+			if(capacity_ < (size_ + 1))
+				internalResize(capacity_ + capacity_ / 2 + 1);
+			new(data_ + size_) TYPE(std::forward<VAL_TYPE>(value)...);
+			return (data_ + size_++);
+		}
+
+		/**
+		 * Append copies of [begin, end). The range must not be within this vector.
+		 * @return Iterator to the last element.
+		 */
+		iterator insert(const_iterator begin, const_iterator end)
+		{
+			const index_type numValues = (index_type)(end - begin);
+			if(capacity_ < (size_ + numValues))
+				internalResize(Core::Max(size_ + numValues, capacity_ + capacity_ / 2));
+			CopyConstructElements(data_ + size_, begin, numValues);
+			size_ += numValues;
+			return (data_ + size_ - 1);
+		}
+
+		void pop_back()
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			--size_;
+			DestructElements(data_ + size_, data_ + size_ + 1);
+		}
+
+		void reserve(index_type capacity)
+		{
+			if(capacity_ < capacity)
+				internalResize(capacity);
+		}
+
+		void resize(index_type size)
+		{
+			reserve(size);
+			DestructElements(data_ + Core::Min(size, size_), data_ + size_);
+			for(index_type idx = size_; idx < size; ++idx)
+				new(data_ + idx) TYPE();
+			size_ = size;
+		}
+
+		/**
+		 * Resize without initializing new elements, for buffers that are about to be overwritten.
+		 */
+		void resize_uninitialized(index_type size)
+		{
+			static_assert(std::is_trivial<TYPE>::value, "resize_uninitialized requires a trivial type.");
+			reserve(size);
+			size_ = size;
+		}
+
+		/**
+		 * Move elements back inline if they fit, or into an exactly sized allocation if not.
+		 */
+		void shrink_to_fit()
+		{
+			if(capacity_ > size_ && !isInline())
+				internalResize(size_);
+		}
+
+		TYPE& front()
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			return data_[0];
+		}
+
+		const TYPE& front() const
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			return data_[0];
+		}
+
+		TYPE& back()
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			return data_[size_ - 1];
+		}
+
+		const TYPE& back() const
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			return data_[size_ - 1];
+		}
+
+		iterator begin() noexcept { return data_; }
+		const_iterator begin() const noexcept { return data_; }
+		iterator end() noexcept { return data_ + size_; }
+		const_iterator end() const noexcept { return data_ + size_; }
+
+		TYPE* data() noexcept { return data_; }
+		const TYPE* data() const noexcept { return data_; }
+		index_type size() const noexcept { return size_; }
+		index_type capacity() const noexcept { return capacity_; }
+		bool empty() const noexcept { return size_ == 0; }
+		const ALLOCATOR& get_allocator() const noexcept { return allocator_; }
+
+	private:
+		bool isInline() const { return data_ == getInlineData(); }
+		TYPE* getInlineData() { return reinterpret_cast<TYPE*>(&inline_); }
+		const TYPE* getInlineData() const { return reinterpret_cast<const TYPE*>(&inline_); }
+
+		/// Take @a other's elements, leaving it empty and inline. Must be empty and inline.
+		void internalMove(SmallVector& other)
+		{
+			if(other.isInline())
+			{
+				RelocateElements(data_, other.data_, other.size_);
+			}
+			else
+			{
+				data_ = other.data_;
+				capacity_ = other.capacity_;
+				other.data_ = other.getInlineData();
+				other.capacity_ = INLINE_CAPACITY;
+			}
+			size_ = other.size_;
+			other.size_ = 0;
+		}
+
+		void internalFree()
+		{
+			if(!isInline())
+				allocator_.deallocate(data_, capacity_, sizeof(TYPE));
+			data_ = getInlineData();
+			capacity_ = INLINE_CAPACITY;
+		}
+
+		/// Move elements to inline storage if @a newCapacity fits, otherwise to a new allocation.
+		void internalResize(index_type newCapacity)
+		{
+			DBG_ASSERT(newCapacity >= size_);
+			TYPE* newData = nullptr;
+			if(newCapacity <= INLINE_CAPACITY)
+			{
+				if(isInline())
+					return;
+				newData = getInlineData();
+				newCapacity = INLINE_CAPACITY;
+			}
+			else
+			{
+				newData = static_cast<TYPE*>(allocator_.allocate(newCapacity, sizeof(TYPE)));
+				DBG_ASSERT_MSG(newData, "Unable to allocate for resize.");
+			}
+			RelocateElements(newData, data_, size_);
+			if(!isInline())
+				allocator_.deallocate(data_, capacity_, sizeof(TYPE));
+			data_ = newData;
+			capacity_ = newCapacity;
+		}
+
+		TYPE* data_ = getInlineData();
+		index_type size_ = 0;
+		index_type capacity_ = INLINE_CAPACITY;
+		ALLOCATOR allocator_;
+		typename std::aligned_storage<sizeof(TYPE) * INLINE_CAPACITY, alignof(TYPE)>::type inline_;
+	};
+} // namespace Core
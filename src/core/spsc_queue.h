@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core/concurrency.h"
+#include "core/debug.h"
+
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Single-producer/single-consumer bounded queue.
+	 * Ring buffer where Enqueue is only called from one thread and Dequeue from one other thread.
+	 * Wait free, and uses no atomic operations: each side only writes its own position, and keeps a
+	 * copy of the other side's so it only reads the other side's cache line when it looks full or empty.
+	 */
+	template<typename TYPE>
+	class SPSCQueue
+	{
+	public:
+		SPSCQueue() = default;
+		SPSCQueue(i32 size)
+		    : buffer_(new TYPE[size])
+		    , bufferMask_(size - 1)
+		{
+			DBG_ASSERT((size >= 2) && ((size & (size - 1)) == 0));
+		}
+		SPSCQueue(SPSCQueue&& other) { swap(other); }
+		SPSCQueue& operator=(SPSCQueue&& other)
+		{
+			swap(other);
+			return *this;
+		}
+
+		~SPSCQueue() { delete[] buffer_; }
+
+		void swap(SPSCQueue& other)
+		{
+			using std::swap;
+			swap(buffer_, other.buffer_);
+			swap(bufferMask_, other.bufferMask_);
+			swap(enqueuePos_, other.enqueuePos_);
+			swap(cachedDequeuePos_, other.cachedDequeuePos_);
+			swap(dequeuePos_, other.dequeuePos_);
+			swap(cachedEnqueuePos_, other.cachedEnqueuePos_);
+		}
+
+		/**
+		 * Enqueue data. Producer thread only.
+		 * @return Successfully queued.
+		 */
+		bool Enqueue(const TYPE& data) { return Enqueue(&data, 1) == 1; }
+
+		/**
+		 * Enqueue several. Producer thread only.
+		 * @return Number queued, less than @a count if the queue filled.
+		 */
+		i32 Enqueue(const TYPE* data, i32 count)
+		{
+			const i64 pos = enqueuePos_;
+			i64 space = (bufferMask_ + 1) - (pos - cachedDequeuePos_);
+			if(space < count)
+			{
+				cachedDequeuePos_ = Core::AtomicLoadAcq(&dequeuePos_);
+				space = (bufferMask_ + 1) - (pos - cachedDequeuePos_);
+			}
+			const i32 numEnqueued = count < space ? count : (i32)space;
+			for(i32 i = 0; i < numEnqueued; ++i)
+				buffer_[(pos + i) & bufferMask_] = data[i];
+			Core::AtomicStoreRel(&enqueuePos_, pos + numEnqueued);
+			return numEnqueued;
+		}
+
+		/**
+		 * Dequeue data. Consumer thread only.
+		 * @return Successfully dequeued.
+		 */
+		bool Dequeue(TYPE& data) { return Dequeue(&data, 1) == 1; }
+
+		/**
+		 * Dequeue several. Consumer thread only.
+		 * @return Number dequeued.
+		 */
+		i32 Dequeue(TYPE* data, i32 maxCount)
+		{
+			const i64 pos = dequeuePos_;
+			i64 available = cachedEnqueuePos_ - pos;
+			if(available < maxCount)
+			{
+				cachedEnqueuePos_ = Core::AtomicLoadAcq(&enqueuePos_);
+				available = cachedEnqueuePos_ - pos;
+			}
+			const i32 numDequeued = maxCount < available ? maxCount : (i32)available;
+			for(i32 i = 0; i < numDequeued; ++i)
+				data[i] = std::move(buffer_[(pos + i) & bufferMask_]);
+			Core::AtomicStoreRel(&dequeuePos_, pos + numDequeued);
+			return numDequeued;
+		}
+
+	private:
+		typedef char CacheLinePad[CACHE_LINE_SIZE];
+
+		CacheLinePad pad0_ = {0};
+		TYPE* buffer_ = nullptr;
+		i32 bufferMask_ = 0;
+		CacheLinePad pad1_ = {0};
+		/// Producer owned.
+		volatile i64 enqueuePos_ = 0;
+		i64 cachedDequeuePos_ = 0;
+		CacheLinePad pad2_ = {0};
+		/// Consumer owned.
+		volatile i64 dequeuePos_ = 0;
+		i64 cachedEnqueuePos_ = 0;
+		CacheLinePad pad3_ = {0};
+
+		SPSCQueue(const SPSCQueue&) = delete;
+		void operator=(const SPSCQueue&) = delete;
+	};
+} // namespace Core
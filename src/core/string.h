@@ -2,9 +2,11 @@
 
 #include "core/dll.h"
 #include "core/types.h"
+#include "core/allocator.h"
 #include "core/array.h"
 #include "core/vector.h"
 
+#include <cstring>
 #include <utility>
 
 namespace Core
@@ -39,15 +41,37 @@ namespace Core
 
 	/**
 	 * String class.
+	 * Strings of up to SSO_CAPACITY characters are stored inline, so short names don't allocate.
+	 * Longer strings are allocated from the allocator, which is kept when copied, moved or swapped.
 	 */
 	class String
 	{
 	public:
+		/// Maximum number of characters stored without allocating.
+		static const i32 SSO_CAPACITY = 23;
+
 		String() {}
 		String(const char* str) { internalSet(str); }
-		String(const String& str) { internalSet(str.c_str()); }
+		String(const String& str)
+		    : allocator_(str.allocator_)
+		{
+			internalSet(str.c_str(), str.size());
+		}
+		explicit String(IAllocator& allocator)
+		    : allocator_(allocator)
+		{
+		}
+		String(const char* str, IAllocator& allocator)
+		    : allocator_(allocator)
+		{
+			internalSet(str);
+		}
 		String(String&& str) { swap(str); }
-		~String() {}
+		~String()
+		{
+			if(isHeap())
+				allocator_.deallocate(storage_.heap_, capacity_ + 1, 1);
+		}
 
 		// Custom interfaces.
 		CORE_DLL void Printf(const char* fmt, ...);
@@ -56,12 +80,29 @@ namespace Core
 		CORE_DLL void Appendfv(const char* fmt, va_list argList);
 
 		// STL compatible interfaces.
-		void clear() { data_.clear(); }
-		const char* c_str() const { return data_.data(); }
-		i32 size() const { return data_.size() > 0 ? data_.size() - 1 : 0; }
+		void clear()
+		{
+			size_ = 0;
+			data()[0] = '\0';
+		}
+		const char* c_str() const { return isHeap() ? storage_.heap_ : storage_.inline_; }
+		i32 size() const { return size_; }
+		i32 capacity() const { return capacity_; }
+		bool empty() const { return size_ == 0; }
+
+		void reserve(i32 capacity)
+		{
+			if(capacity > capacity_)
+				internalGrow(capacity);
+		}
 
-		void reserve(i32 capacity) { data_.reserve(capacity); }
-		void swap(String& other) { data_.swap(other.data_); }
+		void swap(String& other)
+		{
+			std::swap(storage_, other.storage_);
+			std::swap(size_, other.size_);
+			std::swap(capacity_, other.capacity_);
+			std::swap(allocator_, other.allocator_);
+		}
 
 		// cstring versions.
 		void append(const char* str) { internalAppend(str); }
@@ -75,11 +116,11 @@ namespace Core
 		bool operator>=(const char* str) const { return internalCompare(str) >= 0; }
 
 		// String versions.
-		void append(const String& str) { internalAppend(str.c_str()); }
+		void append(const String& str) { internalAppend(str.c_str(), str.size()); }
 		int compare(const String& str) const { return internalCompare(str.c_str()); }
 
 		String& operator=(const char* str) { return internalSet(str); }
-		String& operator=(const String& str) { return internalSet(str.c_str()); }
+		String& operator=(const String& str) { return internalSet(str.c_str(), str.size()); }
 		String& operator=(String&& str)
 		{
 			swap(str);
@@ -87,22 +128,49 @@ namespace Core
 		}
 
 		String& operator+=(const char* str) { return internalAppend(str); }
-		String& operator+=(const String& str) { return internalAppend(str.c_str()); }
+		String& operator+=(const String& str) { return internalAppend(str.c_str(), str.size()); }
 
-		bool operator==(const String& str) const { return internalCompare(str.c_str()) == 0; }
-		bool operator!=(const String& str) const { return internalCompare(str.c_str()) != 0; }
+		bool operator==(const String& str) const { return internalEquals(str); }
+		bool operator!=(const String& str) const { return !internalEquals(str); }
 		bool operator<(const String& str) const { return internalCompare(str.c_str()) < 0; }
 		bool operator>(const String& str) const { return internalCompare(str.c_str()) > 0; }
 		bool operator<=(const String& str) const { return internalCompare(str.c_str()) <= 0; }
 		bool operator>=(const String& str) const { return internalCompare(str.c_str()) >= 0; }
 
 	private:
-		CORE_DLL String& internalRemoveNullTerminator();
+		bool isHeap() const { return capacity_ > SSO_CAPACITY; }
+		char* data() { return isHeap() ? storage_.heap_ : storage_.inline_; }
+
+		bool internalEquals(const String& str) const
+		{
+			return size_ == str.size_ && memcmp(c_str(), str.c_str(), size_) == 0;
+		}
+
+		CORE_DLL void internalGrow(i32 capacity);
 		CORE_DLL String& internalSet(const char* str);
+		CORE_DLL String& internalSet(const char* str, i32 length);
 		CORE_DLL String& internalAppend(const char* str);
+		CORE_DLL String& internalAppend(const char* str, i32 length);
 		CORE_DLL int internalCompare(const char* str) const;
 
-		Core::Vector<char> data_;
+		union Storage
+		{
+			char inline_[SSO_CAPACITY + 1];
+			char* heap_;
+		};
+
+		Storage storage_ = {};
+		i32 size_ = 0;
+		/// Characters that fit, excluding null terminator. Greater than SSO_CAPACITY when on the heap.
+		i32 capacity_ = SSO_CAPACITY;
+		ContainerAllocator allocator_;
+	};
+
+	/// Inline characters are found through capacity_ rather than a pointer, so String is relocatable.
+	template<>
+	struct IsTriviallyRelocatable<String>
+	{
+		static const bool value = true;
 	};
 
 	CORE_DLL u32 Hash(u32 input, const String& string);
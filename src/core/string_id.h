@@ -0,0 +1,58 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/types.h"
+#include "core/hash.h"
+
+namespace Core
+{
+	/**
+	 * Interned string storage, followed by the null terminated string.
+	 */
+	struct StringIdEntry
+	{
+		const StringIdEntry* next_ = nullptr;
+		u32 hash_ = 0;
+		i32 length_ = 0;
+	};
+
+	/**
+	 * Interned string.
+	 * Equal strings intern to the same entry, so comparison is a pointer compare and the hash is
+	 * only calculated when interning. Interned strings are stored in a chunked arena and are never
+	 * freed, so use it for names from a bounded set (resource names, debug names), not arbitrary data.
+	 * Default constructed, it is the empty string.
+	 * Thread safe.
+	 */
+	class CORE_DLL StringId final
+	{
+	public:
+		StringId() = default;
+		explicit StringId(const char* str);
+		StringId(const char* str, i32 length);
+
+		/**
+		 * Find an already interned string.
+		 * Useful for lookups, since a string that was never interned can't be a key.
+		 * @return StringId, or empty StringId if @a str hasn't been interned.
+		 */
+		static StringId Find(const char* str);
+
+		/// @return Interned string. Valid until shutdown.
+		const char* c_str() const { return entry_ ? reinterpret_cast<const char*>(entry_ + 1) : ""; }
+		i32 size() const { return entry_ ? entry_->length_ : 0; }
+		bool empty() const { return entry_ == nullptr; }
+
+		/// @return Hash of string, same as Hash(0, c_str()).
+		u32 GetHash() const { return entry_ ? entry_->hash_ : 0; }
+
+		bool operator==(const StringId& other) const { return entry_ == other.entry_; }
+		bool operator!=(const StringId& other) const { return entry_ != other.entry_; }
+
+	private:
+		const StringIdEntry* entry_ = nullptr;
+	};
+
+	inline u32 Hash(u32 input, const StringId& stringId) { return Hash(input, stringId.GetHash()); }
+
+} // namespace Core
@@ -0,0 +1,489 @@
+#include "core/concurrency.h"
+#include "core/linear_allocator.h"
+#include "core/map.h"
+#include "core/pool_allocator.h"
+#include "core/set.h"
+#include "core/string.h"
+#include "core/thread_cache_allocator.h"
+#include "core/timer.h"
+#include "core/tlsf_allocator.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+using namespace Core;
+
+namespace
+{
+	inline bool IsAligned(void* mem, i64 align) { return ((uintptr_t)mem & (uintptr_t)(align - 1)) == 0; }
+
+	/// Small deterministic generator, so failures reproduce.
+	struct TestRandom
+	{
+		u32 state_ = 0x12345678;
+		u32 Next()
+		{
+			state_ = state_ * 1664525 + 1013904223;
+			return state_ >> 8;
+		}
+	};
+
+	/// Wraps an allocator and counts calls through to it.
+	struct CountingAllocator : public IAllocator
+	{
+		CountingAllocator(IAllocator* backing = nullptr)
+		    : backing_(backing)
+		{
+		}
+
+		void* Allocate(i64 size, i64 align) override
+		{
+			AtomicInc(&numAllocs_);
+			return backing_ ? backing_->Allocate(size, align) : ::new u8[size];
+		}
+
+		void Deallocate(void* mem, i64 size) override
+		{
+			if(mem == nullptr)
+				return;
+			AtomicInc(&numDeallocs_);
+			if(backing_)
+				backing_->Deallocate(mem, size);
+			else
+				delete[](u8*) mem;
+		}
+
+		IAllocator* backing_ = nullptr;
+		volatile i32 numAllocs_ = 0;
+		volatile i32 numDeallocs_ = 0;
+	};
+
+	struct Allocation
+	{
+		u8* mem_ = nullptr;
+		i64 size_ = 0;
+		u8 pattern_ = 0;
+	};
+
+	/// Random allocations and deallocations, checking nothing overlaps.
+	/// @return Success. Doesn't use REQUIRE, so it can run on any thread.
+	bool RandomAllocFree(IAllocator& allocator, i32 numIterations, u32 seed, i64 maxSize)
+	{
+		bool success = true;
+		static const i32 MAX_LIVE = 128;
+		Allocation allocs[MAX_LIVE];
+		TestRandom random;
+		random.state_ = seed;
+
+		for(i32 i = 0; i < numIterations; ++i)
+		{
+			Allocation& alloc = allocs[random.Next() % MAX_LIVE];
+			if(alloc.mem_)
+			{
+				for(i64 j = 0; j < alloc.size_ && success; ++j)
+					success = alloc.mem_[j] == alloc.pattern_;
+				allocator.Deallocate(alloc.mem_, alloc.size_);
+				alloc.mem_ = nullptr;
+			}
+			else
+			{
+				const i64 align = (i64)1 << (random.Next() % 8);
+				alloc.size_ = (i64)(random.Next() % maxSize) + 1;
+				alloc.pattern_ = (u8)random.Next();
+				alloc.mem_ = (u8*)allocator.Allocate(alloc.size_, align);
+				if(alloc.mem_ == nullptr || !IsAligned(alloc.mem_, align))
+				{
+					success = false;
+					break;
+				}
+				memset(alloc.mem_, alloc.pattern_, alloc.size_);
+			}
+		}
+
+		for(auto& alloc : allocs)
+			allocator.Deallocate(alloc.mem_, alloc.size_);
+		return success;
+	}
+
+	/// RandomAllocFree on several threads at once, each with its own seed.
+	bool RandomAllocFreeThreads(IAllocator& allocator, i32 numThreads, i32 numIterations, i64 maxSize)
+	{
+		struct ThreadData
+		{
+			IAllocator* allocator_;
+			i32 numIterations_;
+			u32 seed_;
+			i64 maxSize_;
+			bool success_;
+		};
+
+		Vector<ThreadData> threadData(numThreads);
+		Vector<Thread> threads(numThreads);
+		for(i32 i = 0; i < numThreads; ++i)
+		{
+			threadData[i] = {&allocator, numIterations, (u32)i * 7919 + 1, maxSize, false};
+			threads[i] = Thread(
+			    [](void* userData) -> int {
+				    auto* data = (ThreadData*)userData;
+				    data->success_ =
+				        RandomAllocFree(*data->allocator_, data->numIterations_, data->seed_, data->maxSize_);
+				    return 0;
+				},
+			    &threadData[i], 64 * 1024);
+		}
+		bool success = true;
+		for(i32 i = 0; i < numThreads; ++i)
+		{
+			threads[i].Join();
+			success &= threadData[i].success_;
+		}
+		return success;
+	}
+} // namespace
+
+TEST_CASE("allocator-tests-linear")
+{
+	LinearAllocator allocator(1024);
+
+	SECTION("alignment")
+	{
+		void* a = allocator.Allocate(1, 1);
+		void* b = allocator.Allocate(8, 64);
+		void* c = allocator.Allocate(8, 16);
+		REQUIRE(a != nullptr);
+		REQUIRE(IsAligned(b, 64));
+		REQUIRE(IsAligned(c, 16));
+		REQUIRE((u8*)c >= (u8*)b + 8);
+	}
+
+	SECTION("marker")
+	{
+		allocator.Allocate(100, 1);
+		const LinearAllocator::Marker marker = allocator.GetMarker();
+		void* a = allocator.Allocate(100, 1);
+		REQUIRE(allocator.GetUsage() == 200);
+		allocator.Reset(marker);
+		REQUIRE(allocator.GetUsage() == 100);
+		REQUIRE(allocator.Allocate(100, 1) == a);
+		allocator.Reset();
+		REQUIRE(allocator.GetUsage() == 0);
+	}
+
+	SECTION("exhaustion")
+	{
+		REQUIRE(allocator.Allocate(1000, 1) != nullptr);
+		REQUIRE(allocator.Allocate(100, 1) == nullptr);
+		REQUIRE(allocator.Allocate(24, 1) != nullptr);
+		REQUIRE(allocator.GetUsage() == allocator.GetCapacity());
+	}
+
+	SECTION("deallocate last")
+	{
+		void* a = allocator.Allocate(100, 1);
+		void* b = allocator.Allocate(100, 1);
+		allocator.Deallocate(a, 100);
+		REQUIRE(allocator.GetUsage() == 200);
+		allocator.Deallocate(b, 100);
+		REQUIRE(allocator.GetUsage() == 100);
+		allocator.Deallocate(a, 100);
+		REQUIRE(allocator.GetUsage() == 0);
+	}
+}
+
+TEST_CASE("allocator-tests-pool")
+{
+	PoolAllocator allocator(24, 4);
+	REQUIRE(allocator.GetBlockSize() == 32);
+	REQUIRE(allocator.GetNumFree() == 4);
+
+	void* blocks[4];
+	for(auto& block : blocks)
+	{
+		block = allocator.Allocate(24, 8);
+		REQUIRE(block != nullptr);
+		REQUIRE(IsAligned(block, PLATFORM_ALIGNMENT));
+		REQUIRE(allocator.Owns(block));
+	}
+	REQUIRE(allocator.GetNumFree() == 0);
+	REQUIRE(allocator.Allocate(24, 8) == nullptr);
+	REQUIRE(allocator.Allocate(64, 8) == nullptr);
+
+	allocator.Deallocate(blocks[2], 24);
+	REQUIRE(allocator.Allocate(16, 8) == blocks[2]);
+
+	for(auto& block : blocks)
+		allocator.Deallocate(block, 24);
+	REQUIRE(allocator.GetNumFree() == 4);
+	REQUIRE(!allocator.Owns(&blocks));
+}
+
+TEST_CASE("allocator-tests-tlsf")
+{
+	const i64 CAPACITY = 4 * 1024 * 1024;
+	TLSFAllocator allocator(CAPACITY);
+	const i64 initialFree = allocator.GetLargestFree();
+	REQUIRE(initialFree > CAPACITY - 1024);
+
+	SECTION("basic")
+	{
+		void* a = allocator.Allocate(100, 16);
+		void* b = allocator.Allocate(100, 16);
+		REQUIRE(a != nullptr);
+		REQUIRE(b != nullptr);
+		REQUIRE(a != b);
+		REQUIRE(allocator.GetUsage() > 200);
+		allocator.Deallocate(a, 100);
+		allocator.Deallocate(b, 100);
+		REQUIRE(allocator.GetUsage() == 0);
+	}
+
+	SECTION("alignment")
+	{
+		for(i64 align = 1; align <= 4096; align *= 2)
+		{
+			void* mem = allocator.Allocate(align * 3, align);
+			REQUIRE(mem != nullptr);
+			REQUIRE(IsAligned(mem, align));
+			allocator.Deallocate(mem, align * 3);
+		}
+		REQUIRE(allocator.GetUsage() == 0);
+		REQUIRE(allocator.GetLargestFree() == initialFree);
+	}
+
+	SECTION("coalesce")
+	{
+		// Free in an order that needs merging both ways to get back to a single block.
+		static const i32 NUM_ALLOCS = 64;
+		void* allocs[NUM_ALLOCS];
+		for(auto& alloc : allocs)
+			alloc = allocator.Allocate(1000, 16);
+		for(i32 i = 0; i < NUM_ALLOCS; i += 2)
+			allocator.Deallocate(allocs[i], 1000);
+		for(i32 i = 1; i < NUM_ALLOCS; i += 2)
+			allocator.Deallocate(allocs[i], 1000);
+		REQUIRE(allocator.GetUsage() == 0);
+		REQUIRE(allocator.GetLargestFree() == initialFree);
+	}
+
+	SECTION("exhaustion")
+	{
+		REQUIRE(allocator.Allocate(CAPACITY * 2, 16) == nullptr);
+		const i64 size = initialFree - initialFree / 16;
+		void* mem = allocator.Allocate(size, 16);
+		REQUIRE(mem != nullptr);
+		REQUIRE(allocator.Allocate(initialFree / 2, 16) == nullptr);
+		allocator.Deallocate(mem, size);
+		REQUIRE(allocator.GetLargestFree() == initialFree);
+	}
+
+	SECTION("random")
+	{
+		REQUIRE(RandomAllocFree(allocator, 100000, 0x1234, 4096));
+		REQUIRE(allocator.GetUsage() == 0);
+		REQUIRE(allocator.GetLargestFree() == initialFree);
+	}
+
+	SECTION("threads")
+	{
+		REQUIRE(RandomAllocFreeThreads(allocator, 4, 20000, 2048));
+		REQUIRE(allocator.GetUsage() == 0);
+		REQUIRE(allocator.GetLargestFree() == initialFree);
+	}
+}
+
+TEST_CASE("allocator-tests-thread-cache")
+{
+	TLSFAllocator backing(8 * 1024 * 1024);
+	CountingAllocator counting(&backing);
+
+	SECTION("reuse")
+	{
+		ThreadCacheAllocator allocator(counting);
+		void* a = allocator.Allocate(100, 16);
+		const i32 numAllocs = counting.numAllocs_;
+		allocator.Deallocate(a, 100);
+		REQUIRE(allocator.Allocate(128, 16) == a);
+		REQUIRE(counting.numAllocs_ == numAllocs);
+		allocator.Deallocate(a, 128);
+
+		// Large allocations aren't cached.
+		void* b = allocator.Allocate(ThreadCacheAllocator::MAX_CACHED_SIZE + 1, 16);
+		allocator.Deallocate(b, ThreadCacheAllocator::MAX_CACHED_SIZE + 1);
+		REQUIRE(counting.numAllocs_ == numAllocs + 1);
+		REQUIRE(counting.numDeallocs_ == 1);
+
+		// Over-aligned allocations bypass the cache.
+		void* c = allocator.Allocate(32, 256);
+		REQUIRE(IsAligned(c, 256));
+		allocator.Deallocate(c, 32);
+
+		allocator.Flush();
+		REQUIRE(counting.numAllocs_ == counting.numDeallocs_);
+		REQUIRE(backing.GetUsage() == 0);
+	}
+
+	SECTION("random")
+	{
+		ThreadCacheAllocator allocator(counting);
+		REQUIRE(RandomAllocFree(allocator, 100000, 0x4321, 4096));
+	}
+
+	SECTION("threads")
+	{
+		ThreadCacheAllocator allocator(counting);
+		REQUIRE(RandomAllocFreeThreads(allocator, 4, 20000, 2048));
+	}
+
+	// Cached blocks are returned on destruction.
+	REQUIRE(counting.numAllocs_ == counting.numDeallocs_);
+	REQUIRE(backing.GetUsage() == 0);
+}
+
+TEST_CASE("allocator-tests-containers")
+{
+	TLSFAllocator tlsf(1024 * 1024);
+	CountingAllocator counting(&tlsf);
+	ContainerAllocator allocator(counting);
+
+	SECTION("vector")
+	{
+		Vector<i32, ContainerAllocator> vector(allocator);
+		for(i32 i = 0; i < 1000; ++i)
+			vector.push_back(i);
+		REQUIRE(counting.numAllocs_ > 0);
+		REQUIRE(tlsf.GetUsage() > 0);
+
+		Vector<i32, ContainerAllocator> copy(vector);
+		REQUIRE(copy.get_allocator().GetAllocator() == &counting);
+		for(i32 i = 0; i < 1000; ++i)
+			REQUIRE(copy[i] == i);
+
+		Vector<i32, ContainerAllocator> moved(std::move(copy));
+		REQUIRE(moved.get_allocator().GetAllocator() == &counting);
+		REQUIRE(moved.size() == 1000);
+	}
+
+	SECTION("map")
+	{
+		Map<i32, i32, Hasher<i32>, ContainerAllocator> map(allocator);
+		for(i32 i = 0; i < 1000; ++i)
+			map.insert(i, i * 2);
+		for(i32 i = 0; i < 1000; ++i)
+			REQUIRE(map[i] == i * 2);
+		REQUIRE(counting.numAllocs_ > 0);
+	}
+
+	SECTION("set")
+	{
+		Set<i32, Hasher<i32>, ContainerAllocator> set(allocator);
+		for(i32 i = 0; i < 1000; ++i)
+			set.insert(i);
+		REQUIRE(set.find(500) != set.end());
+		REQUIRE(counting.numAllocs_ > 0);
+	}
+
+	SECTION("string")
+	{
+		// Long enough to not fit inline.
+		String string("test string that is", counting);
+		string += " too long for SSO";
+		REQUIRE(string == "test string that is too long for SSO");
+		REQUIRE(counting.numAllocs_ > 0);
+
+		const i32 numAllocs = counting.numAllocs_;
+		String copy(string);
+		REQUIRE(copy == "test string that is too long for SSO");
+		REQUIRE(counting.numAllocs_ > numAllocs);
+
+		String heapString("heap");
+		heapString = string;
+		REQUIRE(heapString == "test string that is too long for SSO");
+	}
+
+	SECTION("linear")
+	{
+		LinearAllocator linear(64 * 1024);
+		{
+			Vector<i32, ContainerAllocator> vector(linear);
+			for(i32 i = 0; i < 1000; ++i)
+				vector.push_back(i);
+			REQUIRE(linear.GetUsage() >= 4000);
+		}
+		linear.Reset();
+	}
+
+	REQUIRE(counting.numAllocs_ == counting.numDeallocs_);
+	REQUIRE(tlsf.GetUsage() == 0);
+}
+
+namespace
+{
+	/// Typical per-frame scratch use: a few temporary arrays, a lookup map and some strings.
+	template<typename CREATE_ALLOCATOR>
+	f64 RunFrameWorkload(i32 numFrames, CREATE_ALLOCATOR&& createAllocator)
+	{
+		Timer timer;
+		timer.Mark();
+		for(i32 frame = 0; frame < numFrames; ++frame)
+		{
+			ContainerAllocator allocator = createAllocator();
+			Map<i32, i32, Hasher<i32>, ContainerAllocator> lookup(allocator);
+			Vector<Vector<i32, ContainerAllocator>, ContainerAllocator> lists(allocator);
+			for(i32 i = 0; i < 64; ++i)
+			{
+				lists.emplace_back(allocator);
+				for(i32 j = 0; j < 64; ++j)
+					lists.back().push_back(i * j);
+				lookup.insert(i, lists.back().size());
+			}
+			for(i32 i = 0; i < 256; ++i)
+			{
+				String string = allocator.GetAllocator() ? String(*allocator.GetAllocator()) : String();
+				string.Printf("object_%i", i);
+			}
+		}
+		return timer.GetTime();
+	}
+} // namespace
+
+TEST_CASE("allocator-benchmark-frame", "[.benchmark]")
+{
+	const i32 NUM_FRAMES = 1000;
+
+	Core::Log("\"allocator-benchmark-frame\"\n");
+	auto logTime = [](const char* name, f64 time, const CountingAllocator& counting) {
+		Core::Log("\t%s: %f ms/frame, %i allocs/frame\n", name, time * 1000.0 / (f64)NUM_FRAMES,
+		    counting.numAllocs_ / NUM_FRAMES);
+	};
+
+	{
+		CountingAllocator counting;
+		const f64 time = RunFrameWorkload(NUM_FRAMES, [&]() { return ContainerAllocator(counting); });
+		logTime("heap", time, counting);
+	}
+
+	{
+		LinearAllocator linear(4 * 1024 * 1024);
+		CountingAllocator counting(&linear);
+		const f64 time = RunFrameWorkload(NUM_FRAMES, [&]() {
+			linear.Reset();
+			return ContainerAllocator(counting);
+		});
+		logTime("frame linear", time, counting);
+	}
+
+	{
+		TLSFAllocator tlsf(4 * 1024 * 1024);
+		CountingAllocator counting(&tlsf);
+		const f64 time = RunFrameWorkload(NUM_FRAMES, [&]() { return ContainerAllocator(counting); });
+		logTime("tlsf", time, counting);
+	}
+
+	{
+		TLSFAllocator tlsf(4 * 1024 * 1024);
+		ThreadCacheAllocator threadCache(tlsf);
+		CountingAllocator counting(&threadCache);
+		const f64 time = RunFrameWorkload(NUM_FRAMES, [&]() { return ContainerAllocator(counting); });
+		logTime("tlsf thread cache", time, counting);
+	}
+}
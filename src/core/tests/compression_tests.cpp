@@ -0,0 +1,196 @@
+#include "core/compression.h"
+#include "core/debug.h"
+#include "core/random.h"
+#include "core/timer.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+#include <cstring>
+
+using namespace Core;
+
+namespace
+{
+	/// Mix of runs, repeated phrases and noise, roughly as compressible as converted asset data.
+	Vector<u8> MakeTestData(i32 size, u32 seed)
+	{
+		const char* words[] = {"texture", "mesh", "material", "shader", "vertex", "index", "buffer", "sampler"};
+		Random random(seed + 1);
+		Vector<u8> data;
+		data.reserve(size);
+		while(data.size() < size)
+		{
+			const u32 kind = (u32)random.Generate() % 3;
+			if(kind == 0)
+			{
+				const u8 value = (u8)random.Generate();
+				for(i32 i = (u32)random.Generate() % 64; i > 0 && data.size() < size; --i)
+					data.push_back(value);
+			}
+			else if(kind == 1)
+			{
+				const char* word = words[(u32)random.Generate() % 8];
+				for(; *word && data.size() < size; ++word)
+					data.push_back((u8)*word);
+			}
+			else
+			{
+				for(i32 i = (u32)random.Generate() % 16; i > 0 && data.size() < size; --i)
+					data.push_back((u8)random.Generate());
+			}
+		}
+		return data;
+	}
+
+	void TestRoundTrip(CompressionCodec codec, i32 level, const Vector<u8>& data)
+	{
+		Vector<u8> compressed;
+		compressed.resize((i32)CompressionBound(codec, data.size()) + 1);
+		const i64 compressedSize =
+		    Compress(codec, compressed.data(), compressed.size(), data.data(), data.size(), level);
+		if(data.size() > 0)
+			REQUIRE(compressedSize > 0);
+		REQUIRE(compressedSize <= CompressionBound(codec, data.size()));
+
+		Vector<u8> decompressed;
+		decompressed.resize(data.size() + 1);
+		REQUIRE(Decompress(codec, decompressed.data(), decompressed.size(), compressed.data(), compressedSize) ==
+		        data.size());
+		if(data.size() > 0)
+			REQUIRE(memcmp(decompressed.data(), data.data(), data.size()) == 0);
+	}
+} // namespace
+
+TEST_CASE("compression-tests-round-trip")
+{
+	const i32 levels[] = {COMPRESSION_LEVEL_FAST, 1, 4, COMPRESSION_LEVEL_DEFAULT, COMPRESSION_LEVEL_MAX};
+	for(CompressionCodec codec : {CompressionCodec::NONE, CompressionCodec::LZ4})
+	{
+		for(i32 level : levels)
+		{
+			// Sizes either side of the minimum block a match can be found in.
+			for(i32 size : {0, 1, 5, 12, 13, 14, 100, 4096, 65536 + 3, 1024 * 1024})
+				TestRoundTrip(codec, level, MakeTestData(size, size));
+
+			// Incompressible.
+			{
+				Vector<u8> data;
+				Random random(1);
+				for(i32 i = 0; i < 100000; ++i)
+					data.push_back((u8)random.Generate());
+				TestRoundTrip(codec, level, data);
+			}
+
+			// Long runs, which overlap the bytes they copy, and long literal and match lengths.
+			{
+				Vector<u8> data;
+				data.resize(300000, 0);
+				for(i32 i = 0; i < 1000; ++i)
+					data[i] = (u8)(i * 7);
+				for(i32 i = 200000; i < 200003; ++i)
+					data[i] = (u8)i;
+				TestRoundTrip(codec, level, data);
+			}
+		}
+	}
+}
+
+TEST_CASE("compression-tests-lz4-ratio")
+{
+	// Repetitive data compresses.
+	Vector<u8> data = MakeTestData(1024 * 1024, 0);
+	Vector<u8> compressed;
+	compressed.resize((i32)CompressionBound(CompressionCodec::LZ4, data.size()));
+	const i64 compressedSize =
+	    Compress(CompressionCodec::LZ4, compressed.data(), compressed.size(), data.data(), data.size());
+	REQUIRE(compressedSize > 0);
+	REQUIRE(compressedSize < data.size() / 2);
+
+	// Compressing into too small a buffer fails.
+	REQUIRE(Compress(CompressionCodec::LZ4, compressed.data(), compressedSize - 1, data.data(), data.size()) == 0);
+
+	// Higher levels compress at least as well.
+	i64 prevSize = compressedSize;
+	for(i32 level = 1; level <= COMPRESSION_LEVEL_MAX; ++level)
+	{
+		const i64 levelSize =
+		    Compress(CompressionCodec::LZ4, compressed.data(), compressed.size(), data.data(), data.size(), level);
+		REQUIRE(levelSize > 0);
+		REQUIRE(levelSize <= prevSize);
+		prevSize = levelSize;
+	}
+}
+
+TEST_CASE("compression-tests-lz4-corrupt")
+{
+	Vector<u8> data = MakeTestData(65536, 0);
+	Vector<u8> compressed;
+	compressed.resize((i32)CompressionBound(CompressionCodec::LZ4, data.size()));
+	const i64 compressedSize =
+	    Compress(CompressionCodec::LZ4, compressed.data(), compressed.size(), data.data(), data.size());
+	Vector<u8> decompressed;
+	decompressed.resize(data.size());
+
+	// Too small a destination, or truncated source, fails.
+	REQUIRE(Decompress(CompressionCodec::LZ4, decompressed.data(), data.size() - 1, compressed.data(),
+	            compressedSize) == -1);
+	REQUIRE(Decompress(CompressionCodec::LZ4, decompressed.data(), decompressed.size(), compressed.data(),
+	            compressedSize / 2) == -1);
+
+	// Damaged data never writes outside of the destination. Result is unspecified otherwise.
+	Random random(0);
+	for(i32 i = 0; i < 1000; ++i)
+	{
+		Vector<u8> damaged = compressed;
+		for(i32 j = 0; j < 4; ++j)
+			damaged[(u32)random.Generate() % compressedSize] = (u8)random.Generate();
+		const i64 size = Decompress(
+		    CompressionCodec::LZ4, decompressed.data(), decompressed.size(), damaged.data(), compressedSize);
+		REQUIRE(size <= decompressed.size());
+	}
+}
+
+TEST_CASE("compression-benchmark", "[.benchmark]")
+{
+	const i32 DATA_SIZE = 64 * 1024 * 1024;
+	const i32 BLOCK_SIZE = 256 * 1024;
+	Vector<u8> data = MakeTestData(DATA_SIZE, 0);
+	Vector<u8> compressed;
+	compressed.resize((i32)CompressionBound(CompressionCodec::LZ4, BLOCK_SIZE) * (DATA_SIZE / BLOCK_SIZE));
+	Vector<i64> blockSizes;
+	blockSizes.resize(DATA_SIZE / BLOCK_SIZE);
+	Vector<u8> decompressed;
+	decompressed.resize(DATA_SIZE);
+
+	const f64 sizeMB = DATA_SIZE / (1024.0 * 1024.0);
+	Core::Log("\"compression-benchmark\" (%i MB in %i KB blocks)\n", DATA_SIZE / (1024 * 1024), BLOCK_SIZE / 1024);
+	for(i32 level : {COMPRESSION_LEVEL_FAST, 3, COMPRESSION_LEVEL_DEFAULT, COMPRESSION_LEVEL_MAX})
+	{
+		Timer timer;
+		timer.Mark();
+		i64 compressedSize = 0;
+		for(i32 i = 0; i < blockSizes.size(); ++i)
+		{
+			blockSizes[i] = Compress(CompressionCodec::LZ4, compressed.data() + compressedSize,
+			    compressed.size() - compressedSize, data.data() + (i64)i * BLOCK_SIZE, BLOCK_SIZE, level);
+			REQUIRE(blockSizes[i] > 0);
+			compressedSize += blockSizes[i];
+		}
+		const f64 compressTime = timer.GetTime();
+
+		timer.Mark();
+		i64 offset = 0;
+		for(i32 i = 0; i < blockSizes.size(); ++i)
+		{
+			REQUIRE(Decompress(CompressionCodec::LZ4, decompressed.data() + (i64)i * BLOCK_SIZE, BLOCK_SIZE,
+			            compressed.data() + offset, blockSizes[i]) == BLOCK_SIZE);
+			offset += blockSizes[i];
+		}
+		const f64 decompressTime = timer.GetTime();
+		REQUIRE(memcmp(data.data(), decompressed.data(), DATA_SIZE) == 0);
+
+		Core::Log("\tLZ4 level %i: ratio %f, compress %f MB/s, decompress %f MB/s\n", level,
+		    (f64)compressedSize / DATA_SIZE, sizeMB / compressTime, sizeMB / decompressTime);
+	}
+}
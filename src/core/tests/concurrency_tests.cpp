@@ -1,4 +1,6 @@
 #include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/timer.h"
 #include "core/vector.h"
 
 #include "catch.hpp"
@@ -303,6 +305,31 @@ TEST_CASE("concurrency-tests-atomic-cmpexhg")
 	}
 }
 
+TEST_CASE("concurrency-tests-atomic-load-store")
+{
+	volatile i32 i32Test = 0;
+	volatile i64 i64Test = 0;
+
+	AtomicStoreRel(&i32Test, 1);
+	REQUIRE(AtomicLoadAcq(&i32Test) == 1);
+	AtomicStoreRel(&i64Test, 0x100000000LL);
+	REQUIRE(AtomicLoadAcq(&i64Test) == 0x100000000LL);
+}
+
+TEST_CASE("concurrency-tests-atomic-ptr")
+{
+	i32 a = 0;
+	i32 b = 0;
+	void* volatile ptrTest = nullptr;
+
+	REQUIRE(AtomicExchg(&ptrTest, &a) == nullptr);
+	REQUIRE(ptrTest == &a);
+	REQUIRE(AtomicCmpExchg(&ptrTest, &b, nullptr) == &a);
+	REQUIRE(ptrTest == &a);
+	REQUIRE(AtomicCmpExchg(&ptrTest, &b, &a) == &a);
+	REQUIRE(ptrTest == &b);
+}
+
 TEST_CASE("concurrency-tests-thread")
 {
 	SECTION("invalid")
@@ -348,6 +375,24 @@ TEST_CASE("concurrency-tests-thread")
 		REQUIRE(!thread2);
 		REQUIRE(value == 0);
 	}
+
+	SECTION("affinity")
+	{
+		Event event(true, false);
+		Thread thread(
+		    [](void* userData) -> int {
+			    ((Event*)userData)->Wait();
+			    return 0;
+			},
+		    (void*)&event);
+		REQUIRE(thread);
+
+		u64 oldMask = thread.SetAffinity(1);
+		REQUIRE(oldMask != 0);
+		REQUIRE(thread.SetAffinity(oldMask) == 1);
+		event.Signal();
+		REQUIRE(thread.Join() == 0);
+	}
 }
 
 TEST_CASE("concurrency-tests-fiber")
@@ -383,6 +428,68 @@ TEST_CASE("concurrency-tests-fiber")
 	REQUIRE(sharedData.exited_ == sharedData.fibers_.size());
 }
 
+TEST_CASE("concurrency-tests-fiber-fls")
+{
+	Fiber primaryFiber(Fiber::THIS_THREAD);
+	FLS fls;
+
+	struct FiberData
+	{
+		FLS* fls_ = nullptr;
+		Fiber* primaryFiber_ = nullptr;
+		i32 value_ = 0;
+		bool result_ = false;
+	};
+
+	auto fiberFunc = [](void* inData) -> void {
+		auto* data = reinterpret_cast<FiberData*>(inData);
+		data->fls_->Set(&data->value_);
+		data->primaryFiber_->SwitchTo();
+		data->result_ = data->fls_->Get() == &data->value_;
+	};
+
+	FiberData fiberData[2];
+	for(auto& data : fiberData)
+	{
+		data.fls_ = &fls;
+		data.primaryFiber_ = &primaryFiber;
+	}
+
+	Fiber fiber0(fiberFunc, &fiberData[0]);
+	Fiber fiber1(fiberFunc, &fiberData[1]);
+
+	// Both fibers set their FLS value, then resume to check it wasn't changed by the other.
+	fiber0.SwitchTo();
+	fiber1.SwitchTo();
+	fiber0.SwitchTo();
+	fiber1.SwitchTo();
+	REQUIRE(fiberData[0].result_);
+	REQUIRE(fiberData[1].result_);
+}
+
+TEST_CASE("concurrency-benchmark-fiber-switch", "[.benchmark]")
+{
+	static const i32 NUM_ITERATIONS = 1000000;
+	Fiber primaryFiber(Fiber::THIS_THREAD);
+
+	auto fiberFunc = [](void* inData) -> void {
+		auto* primaryFiber = reinterpret_cast<Fiber*>(inData);
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			primaryFiber->SwitchTo();
+	};
+
+	Fiber fiber(fiberFunc, &primaryFiber);
+	Timer timer;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		fiber.SwitchTo();
+	const f64 time = timer.GetTime();
+
+	// Each iteration switches to the fiber and back.
+	Core::Log("\"concurrency-benchmark-fiber-switch\"\n");
+	Core::Log("\tTotal: %f ms (%f ns/switch)\n", time * 1000.0, time * 1000000000.0 / (f64)(NUM_ITERATIONS * 2));
+}
+
 TEST_CASE("concurrency-tests-event")
 {
 	SECTION("st-default")
@@ -489,6 +596,116 @@ TEST_CASE("concurrency-tests-event")
 	}
 }
 
+TEST_CASE("concurrency-tests-semaphore")
+{
+	SECTION("st-default")
+	{
+		Semaphore sem;
+		REQUIRE(!sem.Wait(1));
+		REQUIRE(sem.Signal());
+		REQUIRE(sem.Wait(-1));
+		REQUIRE(!sem.Wait(1));
+	}
+
+	SECTION("st-count")
+	{
+		Semaphore sem(2);
+		REQUIRE(sem.Wait(-1));
+		REQUIRE(sem.Wait(-1));
+		REQUIRE(!sem.Wait(1));
+		REQUIRE(sem.Signal(3));
+		REQUIRE(sem.Wait(-1));
+		REQUIRE(sem.Wait(-1));
+		REQUIRE(sem.Wait(-1));
+		REQUIRE(!sem.Wait(1));
+	}
+
+	SECTION("mt-count")
+	{
+		struct SharedData
+		{
+			Semaphore sem_;
+			volatile i32 woken_ = 0;
+		};
+		SharedData sharedData;
+
+		auto threadFunc = [](void* userData) -> int {
+			auto* sharedData = (SharedData*)userData;
+			if(!sharedData->sem_.Wait(-1))
+				return 0;
+			AtomicInc(&sharedData->woken_);
+			return 1;
+		};
+
+		Vector<Thread> threads;
+		for(i32 i = 0; i < 4; ++i)
+			threads.emplace_back(threadFunc, (void*)&sharedData);
+
+		REQUIRE(sharedData.sem_.Signal(2));
+		while(sharedData.woken_ < 2)
+			SwitchThread();
+		REQUIRE(sharedData.sem_.Signal(2));
+		for(auto& thread : threads)
+			REQUIRE(thread.Join());
+		REQUIRE(sharedData.woken_ == 4);
+	}
+}
+
+namespace
+{
+	/// Wait on each object from @a create then destroy it straight away, while another thread signals it. Anything
+	/// Signal touched after waking the waiter would be freed memory by then.
+	template<typename TYPE, typename CREATE>
+	bool RunDestroyAfterWaitTest(i32 numIterations, CREATE&& create)
+	{
+		struct SharedData
+		{
+			void* volatile object_ = nullptr;
+			volatile i32 exit_ = 0;
+		};
+		SharedData sharedData;
+
+		Thread signalThread(
+		    [](void* userData) -> int {
+			    auto* sharedData = (SharedData*)userData;
+			    while(!sharedData->exit_)
+			    {
+				    if(auto* object = (TYPE*)AtomicExchg(&sharedData->object_, nullptr))
+					    object->Signal();
+				    else
+					    SwitchThread();
+			    }
+			    return 0;
+			},
+		    &sharedData);
+
+		bool success = true;
+		for(i32 i = 0; i < numIterations; ++i)
+		{
+			TYPE* object = create();
+			AtomicExchg(&sharedData.object_, object);
+			success &= object->Wait(-1);
+			delete object;
+		}
+		AtomicExchg(&sharedData.exit_, 1);
+		signalThread.Join();
+		return success;
+	}
+} // namespace
+
+TEST_CASE("concurrency-tests-destroy-after-wait")
+{
+	SECTION("semaphore")
+	{
+		REQUIRE(RunDestroyAfterWaitTest<Semaphore>(10000, []() { return new Semaphore(); }));
+	}
+
+	SECTION("event")
+	{
+		REQUIRE(RunDestroyAfterWaitTest<Event>(10000, []() { return new Event(false, false); }));
+	}
+}
+
 TEST_CASE("concurrency-tests-mutex")
 {
 	SECTION("recursive")
@@ -1,6 +1,9 @@
 #include "core/file.h"
 #include "core/debug.h"
 #include "core/array.h"
+#include "core/concurrency.h"
+#include "core/random.h"
+#include "core/timer.h"
 #include "core/vector.h"
 
 #include "catch.hpp"
@@ -205,6 +208,302 @@ TEST_CASE("file-tests-mem")
 	}
 }
 
+TEST_CASE("file-tests-map")
+{
+	ScopedCleanup scopedCleanup;
+
+	// Large enough that views at an offset aren't page aligned.
+	Core::Vector<u8> fileData;
+	fileData.resize(64 * 1024 + 3);
+	for(i32 i = 0; i < fileData.size(); ++i)
+		fileData[i] = (u8)i;
+
+	{
+		Core::File file(fileName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(file.Write(fileData.data(), fileData.size()) == fileData.size());
+	}
+
+	auto CheckView = [&](const void* view, i64 offset, i64 size) {
+		REQUIRE(view);
+		REQUIRE(memcmp(view, fileData.data() + offset, size) == 0);
+	};
+
+	SECTION("native")
+	{
+		Core::File file(fileName, Core::FileFlags::READ);
+		const void* view0 = file.Map(0, fileData.size());
+		const void* view1 = file.Map(4097, 1000);
+		CheckView(view0, 0, fileData.size());
+		CheckView(view1, 4097, 1000);
+		REQUIRE(file.Tell() == 0);
+		REQUIRE(file.Map(fileData.size() - 1, 2) == nullptr);
+		REQUIRE(file.Map(-1, 2) == nullptr);
+		file.Unmap(view1);
+		file.Unmap(view0);
+
+		// Views left mapped are unmapped with the file.
+		CheckView(file.Map(3, 5), 3, 5);
+	}
+
+	SECTION("native mmap")
+	{
+		Core::File file(fileName, Core::FileFlags::READ | Core::FileFlags::MMAP);
+		CheckView(file.Map(4097, 1000), 4097, 1000);
+		REQUIRE(file.Map(fileData.size() - 1, 2) == nullptr);
+
+		u8 readData[8] = {0};
+		REQUIRE(file.Seek(fileData.size() - 4));
+		REQUIRE(file.Read(readData, sizeof(readData)) == 4);
+		REQUIRE(file.Tell() == fileData.size());
+		REQUIRE(memcmp(readData, fileData.data() + fileData.size() - 4, 4) == 0);
+		REQUIRE(file.Read(readData, sizeof(readData)) == 0);
+		REQUIRE(file.Seek(8));
+		REQUIRE(file.Read(readData, sizeof(readData)) == sizeof(readData));
+		REQUIRE(memcmp(readData, fileData.data() + 8, sizeof(readData)) == 0);
+	}
+
+	SECTION("mem")
+	{
+		Core::File file(fileData.data(), fileData.size(), Core::FileFlags::READ);
+		const void* view = file.Map(4097, 1000);
+		REQUIRE(view == fileData.data() + 4097);
+		REQUIRE(file.Map(fileData.size() - 1, 2) == nullptr);
+		file.Unmap(view);
+
+		// Seeking to the end is valid, as for native files, but not past it.
+		u8 readData[8] = {0};
+		REQUIRE(file.Seek(fileData.size()));
+		REQUIRE(file.Tell() == fileData.size());
+		REQUIRE(file.Read(readData, sizeof(readData)) == 0);
+		REQUIRE(!file.Seek(fileData.size() + 1));
+	}
+}
+
+TEST_CASE("file-benchmark-map", "[.benchmark]")
+{
+	ScopedCleanup scopedCleanup;
+
+	const i32 FILE_SIZE = 64 * 1024 * 1024;
+	const i32 PAGE_SIZE = 4096;
+	{
+		Core::Vector<u8> fileData;
+		fileData.resize(FILE_SIZE);
+		for(i32 i = 0; i < FILE_SIZE; i += PAGE_SIZE)
+			fileData[i] = (u8)(i / PAGE_SIZE);
+		Core::File file(fileName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(file.Write(fileData.data(), fileData.size()) == fileData.size());
+	}
+
+	// Read the whole file and touch each page, as loading a resource does.
+	Core::Timer timer;
+	u64 readSum = 0;
+	timer.Mark();
+	{
+		Core::File file(fileName, Core::FileFlags::READ);
+		Core::Vector<u8> readData;
+		readData.resize_uninitialized((i32)file.Size());
+		REQUIRE(file.Read(readData.data(), readData.size()) == FILE_SIZE);
+		for(i32 i = 0; i < FILE_SIZE; i += PAGE_SIZE)
+			readSum += readData[i];
+	}
+	const f64 readTime = timer.GetTime();
+
+	u64 mapSum = 0;
+	timer.Mark();
+	{
+		Core::File file(fileName, Core::FileFlags::READ);
+		const u8* mapData = static_cast<const u8*>(file.Map(0, file.Size()));
+		REQUIRE(mapData);
+		for(i32 i = 0; i < FILE_SIZE; i += PAGE_SIZE)
+			mapSum += mapData[i];
+		file.Unmap(mapData);
+	}
+	const f64 mapTime = timer.GetTime();
+
+	Core::Log("\"file-benchmark-map\" (%i MB)\n", FILE_SIZE / (1024 * 1024));
+	Core::Log("\tRead: %f ms\n\tMap: %f ms\n", readTime * 1000.0, mapTime * 1000.0);
+	REQUIRE(readSum == mapSum);
+}
+
+TEST_CASE("file-tests-read-at")
+{
+	ScopedCleanup scopedCleanup;
+
+	Core::Vector<u8> fileData;
+	fileData.resize(256 * 1024 + 3);
+	for(i32 i = 0; i < fileData.size(); ++i)
+		fileData[i] = (u8)(i * 7);
+
+	{
+		Core::File file(fileName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(file.Write(fileData.data(), fileData.size()) == fileData.size());
+	}
+
+	auto CheckReadAt = [&](const Core::File& file, i64 offset, i64 bytes) {
+		Core::Vector<u8> readData;
+		readData.resize((i32)bytes);
+		const i64 expected = Core::Min(bytes, fileData.size() - offset);
+		REQUIRE(file.ReadAt(offset, readData.data(), bytes) == expected);
+		REQUIRE(memcmp(readData.data(), fileData.data() + offset, expected) == 0);
+	};
+
+	for(auto flags : {Core::FileFlags::READ, Core::FileFlags::READ | Core::FileFlags::SEQUENTIAL,
+	        Core::FileFlags::READ | Core::FileFlags::RANDOM, Core::FileFlags::READ | Core::FileFlags::DIRECT,
+	        Core::FileFlags::READ | Core::FileFlags::MMAP})
+	{
+		Core::File file(fileName, flags);
+		REQUIRE(file);
+
+		// Doesn't use or move read position.
+		REQUIRE(file.Seek(5));
+		CheckReadAt(file, 0, 4096);
+		CheckReadAt(file, 1, 10);
+		CheckReadAt(file, 4095, 8193);
+		CheckReadAt(file, fileData.size() - 100, 1000);
+		REQUIRE(file.Tell() == 5);
+		u8 value = 0;
+		REQUIRE(file.Read(&value, 1) == 1);
+		REQUIRE(value == fileData[5]);
+		REQUIRE(file.ReadAt(fileData.size(), &value, 1) == 0);
+
+		// Aligned reads, which a DIRECT file reads straight into the buffer.
+		u8* alignedMem = new u8[8 * 1024 + Core::FILE_DIRECT_ALIGNMENT];
+		u8* aligned = (u8*)Core::PotRoundUp((uintptr_t)alignedMem, Core::FILE_DIRECT_ALIGNMENT);
+		REQUIRE(file.ReadAt(4096, aligned, 8192) == 8192);
+		REQUIRE(memcmp(aligned, fileData.data() + 4096, 8192) == 0);
+		REQUIRE(file.ReadAt(fileData.size() & ~4095, aligned, 8192) == (fileData.size() & 4095));
+		delete[] alignedMem;
+
+		file.Prefetch(0, fileData.size());
+	}
+
+	SECTION("64 bit offsets")
+	{
+		Core::File file(fileName, Core::FileFlags::READ);
+		const i64 largeOffset = 5LL * 1024 * 1024 * 1024;
+		REQUIRE(file.Seek(largeOffset));
+		REQUIRE(file.Tell() == largeOffset);
+		u8 value = 0;
+		REQUIRE(file.Read(&value, 1) == 0);
+		REQUIRE(file.ReadAt(largeOffset, &value, 1) == 0);
+	}
+
+	SECTION("threads")
+	{
+		struct ThreadData
+		{
+			const Core::File* file_;
+			const Core::Vector<u8>* fileData_;
+			i32 idx_;
+			bool success_;
+		};
+
+		const i32 NUM_THREADS = 4;
+		Core::File file(fileName, Core::FileFlags::READ);
+		ThreadData threadData[NUM_THREADS];
+		Core::Vector<Core::Thread> threads;
+		for(i32 i = 0; i < NUM_THREADS; ++i)
+		{
+			threadData[i] = {&file, &fileData, i, true};
+			threads.emplace_back(
+			    [](void* userData) -> int {
+				    auto* data = (ThreadData*)userData;
+				    const i64 fileSize = data->fileData_->size();
+				    u8 readData[1000];
+				    for(i64 offset = data->idx_ * 100; offset < fileSize; offset += sizeof(readData))
+				    {
+					    const i64 bytesRead = data->file_->ReadAt(offset, readData, sizeof(readData));
+					    data->success_ &= bytesRead == Core::Min((i64)sizeof(readData), fileSize - offset);
+					    data->success_ &= memcmp(readData, data->fileData_->data() + offset, bytesRead) == 0;
+				    }
+				    return 0;
+				},
+			    &threadData[i], 64 * 1024);
+		}
+		for(auto& thread : threads)
+			thread.Join();
+		for(const auto& data : threadData)
+			REQUIRE(data.success_);
+	}
+}
+
+TEST_CASE("file-benchmark-read", "[.benchmark]")
+{
+	ScopedCleanup scopedCleanup;
+
+	const i32 FILE_SIZE = 256 * 1024 * 1024;
+	const i32 SEQUENTIAL_CHUNK_SIZE = 8 * 1024 * 1024;
+	const i32 RANDOM_CHUNK_SIZE = 4096;
+	const i32 NUM_RANDOM_READS = 16384;
+	{
+		Core::Vector<u8> fileData;
+		fileData.resize(FILE_SIZE);
+		for(i32 i = 0; i < FILE_SIZE; i += 4096)
+			fileData[i] = (u8)(i / 4096);
+		Core::File file(fileName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(file.Write(fileData.data(), fileData.size()) == fileData.size());
+	}
+
+	u8* bufferMem = new u8[SEQUENTIAL_CHUNK_SIZE + Core::FILE_DIRECT_ALIGNMENT];
+	u8* buffer = (u8*)Core::PotRoundUp((uintptr_t)bufferMem, Core::FILE_DIRECT_ALIGNMENT);
+	Core::Vector<i64> randomOffsets;
+	Core::Random random;
+	for(i32 i = 0; i < NUM_RANDOM_READS; ++i)
+		randomOffsets.push_back((i64)((u32)random.Generate() % (FILE_SIZE / RANDOM_CHUNK_SIZE)) * RANDOM_CHUNK_SIZE);
+
+	Core::Log("\"file-benchmark-read\" (%i MB)\n", FILE_SIZE / (1024 * 1024));
+	auto LogTime = [&](const char* name, i64 bytes, f64 time) {
+		Core::Log("\t%s: %f ms (%f MB/s)\n", name, time * 1000.0, (bytes / (1024.0 * 1024.0)) / time);
+	};
+
+	Core::Timer timer;
+
+	// Baseline: stdio, as File used to read.
+	{
+		FILE* file = fopen(fileName, "rb");
+		REQUIRE(file);
+		timer.Mark();
+		for(i64 offset = 0; offset < FILE_SIZE; offset += SEQUENTIAL_CHUNK_SIZE)
+			REQUIRE(fread(buffer, 1, SEQUENTIAL_CHUNK_SIZE, file) == SEQUENTIAL_CHUNK_SIZE);
+		LogTime("stdio sequential", FILE_SIZE, timer.GetTime());
+
+		timer.Mark();
+		for(i64 offset : randomOffsets)
+		{
+			REQUIRE(fseek(file, (long)offset, SEEK_SET) == 0);
+			REQUIRE(fread(buffer, 1, RANDOM_CHUNK_SIZE, file) == RANDOM_CHUNK_SIZE);
+		}
+		LogTime("stdio random", (i64)NUM_RANDOM_READS * RANDOM_CHUNK_SIZE, timer.GetTime());
+		fclose(file);
+	}
+
+	for(auto flags : {Core::FileFlags::READ | Core::FileFlags::SEQUENTIAL,
+	        Core::FileFlags::READ | Core::FileFlags::DIRECT})
+	{
+		Core::File file(fileName, flags);
+		REQUIRE(file);
+		timer.Mark();
+		for(i64 offset = 0; offset < FILE_SIZE; offset += SEQUENTIAL_CHUNK_SIZE)
+			REQUIRE(file.Read(buffer, SEQUENTIAL_CHUNK_SIZE) == SEQUENTIAL_CHUNK_SIZE);
+		const bool direct = Core::ContainsAllFlags(flags, Core::FileFlags::DIRECT);
+		LogTime(direct ? "File sequential (DIRECT)" : "File sequential", FILE_SIZE, timer.GetTime());
+	}
+
+	for(auto flags : {Core::FileFlags::READ | Core::FileFlags::RANDOM,
+	        Core::FileFlags::READ | Core::FileFlags::DIRECT})
+	{
+		Core::File file(fileName, flags);
+		REQUIRE(file);
+		timer.Mark();
+		for(i64 offset : randomOffsets)
+			REQUIRE(file.ReadAt(offset, buffer, RANDOM_CHUNK_SIZE) == RANDOM_CHUNK_SIZE);
+		const bool direct = Core::ContainsAllFlags(flags, Core::FileFlags::DIRECT);
+		LogTime(direct ? "File random (DIRECT)" : "File random", (i64)NUM_RANDOM_READS * RANDOM_CHUNK_SIZE,
+		    timer.GetTime());
+	}
+
+	delete[] bufferMem;
+}
 
 TEST_CASE("file-tests-create-dir")
 {
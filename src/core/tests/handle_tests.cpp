@@ -1,4 +1,8 @@
 #include "core/handle.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/timer.h"
+#include "core/vector.h"
 
 #include "catch.hpp"
 
@@ -62,3 +66,269 @@ TEST_CASE("handle-tests-types")
 	REQUIRE(alloc.GetTotalHandles(0) == 0);
 	REQUIRE(alloc.GetTotalHandles(1) == 0);
 }
+
+TEST_CASE("handle-tests-types-magic")
+{
+	HandleAllocator alloc(2);
+
+	// Magic IDs of one type mustn't be shared with indices of another.
+	Vector<Handle> handles0(Handle::MAX_MAGIC + 1);
+	REQUIRE(alloc.Alloc(0, handles0.data(), handles0.size()) == handles0.size());
+	Handle handle1 = alloc.Alloc(1);
+	alloc.Free(handle1);
+	REQUIRE(!alloc.IsValid(handle1));
+	for(auto handle : handles0)
+		REQUIRE(alloc.IsValid(handle));
+}
+
+TEST_CASE("handle-tests-magic-wrap")
+{
+	HandleAllocator alloc(1);
+
+	Handle first = alloc.Alloc(0);
+	alloc.Free(first);
+	for(i32 i = 0; i < Handle::MAX_MAGIC * 2; ++i)
+	{
+		Handle handle = alloc.Alloc(0);
+		REQUIRE(handle);
+		REQUIRE(handle.GetIndex() == first.GetIndex());
+		REQUIRE(alloc.IsValid(handle));
+		alloc.Free(handle);
+		REQUIRE(!alloc.IsValid(handle));
+	}
+}
+
+TEST_CASE("handle-tests-batch")
+{
+	HandleAllocator alloc(2);
+
+	Vector<Handle> handles(1000);
+	REQUIRE(alloc.Alloc(1, handles.data(), handles.size()) == handles.size());
+	REQUIRE(alloc.GetTotalHandles(0) == 0);
+	REQUIRE(alloc.GetTotalHandles(1) == handles.size());
+
+	Vector<u8> used;
+	used.resize(Handle::MAX_INDEX, 0);
+	for(auto handle : handles)
+	{
+		REQUIRE(handle.GetType() == 1);
+		REQUIRE(alloc.IsValid(handle));
+		REQUIRE(used[handle.GetIndex()] == 0);
+		used[handle.GetIndex()] = 1;
+	}
+
+	alloc.Free(handles.data(), handles.size());
+	REQUIRE(alloc.GetTotalHandles(1) == 0);
+	for(auto handle : handles)
+		REQUIRE(!alloc.IsValid(handle));
+
+	// Exhaust, then check a partial batch.
+	Vector<Handle> all(Handle::MAX_INDEX - 10);
+	REQUIRE(alloc.Alloc(0, all.data(), all.size()) == all.size());
+	REQUIRE(alloc.Alloc(0, handles.data(), handles.size()) == 10);
+	REQUIRE(alloc.GetTotalHandles(0) == Handle::MAX_INDEX);
+	REQUIRE(alloc.Alloc(0) == Handle());
+}
+
+namespace
+{
+	/// Allocate and free handles on several threads at once. Each thread keeps numKept handles live until the end.
+	bool AllocFreeThreads(HandleAllocator& alloc, i32 numThreads, i32 numIterations, i32 numKept)
+	{
+		struct ThreadData
+		{
+			HandleAllocator* alloc_;
+			i32 numIterations_;
+			i32 numKept_;
+			Vector<Handle> kept_;
+			bool success_;
+		};
+
+		Vector<ThreadData> threadData(numThreads);
+		Vector<Thread> threads(numThreads);
+		for(i32 i = 0; i < numThreads; ++i)
+		{
+			threadData[i].alloc_ = &alloc;
+			threadData[i].numIterations_ = numIterations;
+			threadData[i].numKept_ = numKept;
+			threadData[i].success_ = false;
+			threads[i] = Thread(
+			    [](void* userData) -> int {
+				    auto* data = (ThreadData*)userData;
+				    HandleAllocator& alloc = *data->alloc_;
+				    bool success = true;
+				    Handle batch[32];
+				    for(i32 i = 0; i < data->numIterations_; ++i)
+				    {
+					    // Alternate between single and batch allocations.
+					    const i32 count = (i % 2) ? 1 + (i % 32) : 1;
+					    if(count == 1)
+						    batch[0] = alloc.Alloc(0);
+					    else
+						    success &= alloc.Alloc(0, batch, count) == count;
+					    for(i32 j = 0; j < count; ++j)
+						    success &= alloc.IsValid(batch[j]);
+					    if(data->kept_.size() < data->numKept_)
+					    {
+						    data->kept_.push_back(batch[0]);
+						    alloc.Free(batch + 1, count - 1);
+					    }
+					    else
+						    alloc.Free(batch, count);
+					    for(i32 j = 0; j < count; ++j)
+						    success &= !alloc.IsValid(batch[j]) || batch[j] == data->kept_.back();
+				    }
+				    data->success_ = success;
+				    return 0;
+				},
+			    &threadData[i], 64 * 1024);
+		}
+
+		bool success = true;
+		for(i32 i = 0; i < numThreads; ++i)
+		{
+			threads[i].Join();
+			success &= threadData[i].success_;
+		}
+
+		// Kept handles must be unique and still valid, and can be freed from another thread.
+		Vector<u8> used;
+		used.resize(Handle::MAX_INDEX, 0);
+		for(auto& data : threadData)
+		{
+			for(auto handle : data.kept_)
+			{
+				success &= alloc.IsValid(handle);
+				success &= used[handle.GetIndex()]++ == 0;
+			}
+		}
+		success &= alloc.GetTotalHandles(0) == numThreads * numKept;
+		for(auto& data : threadData)
+			alloc.Free(data.kept_.data(), data.kept_.size());
+		success &= alloc.GetTotalHandles(0) == 0;
+		return success;
+	}
+} // namespace
+
+TEST_CASE("handle-tests-threads")
+{
+	HandleAllocator alloc(1);
+	REQUIRE(AllocFreeThreads(alloc, 4, 20000, 1000));
+
+	// Freed handles are still reusable afterwards.
+	Vector<Handle> handles(Handle::MAX_INDEX / 2);
+	REQUIRE(alloc.Alloc(0, handles.data(), handles.size()) == handles.size());
+	alloc.Free(handles.data(), handles.size());
+}
+
+TEST_CASE("handle-tests-thread-exit")
+{
+	HandleAllocator alloc(1);
+
+	// Indices cached by a thread that has exited can be allocated elsewhere.
+	Thread thread(
+	    [](void* userData) -> int {
+		    HandleAllocator& alloc = *(HandleAllocator*)userData;
+		    Vector<Handle> handles(Handle::MAX_INDEX);
+		    alloc.Alloc(0, handles.data(), handles.size());
+		    alloc.Free(handles.data(), handles.size());
+		    return 0;
+		},
+	    &alloc, 64 * 1024);
+	thread.Join();
+
+	Vector<Handle> handles(Handle::MAX_INDEX);
+	REQUIRE(alloc.Alloc(0, handles.data(), handles.size()) == handles.size());
+	REQUIRE(alloc.GetTotalHandles(0) == Handle::MAX_INDEX);
+	alloc.Free(handles.data(), handles.size());
+
+	// Threads outliving the allocator clean up their caches on exit.
+	HandleAllocator* threadAlloc = new HandleAllocator(1);
+	Semaphore allocated;
+	Semaphore destroyed;
+	struct ThreadData
+	{
+		HandleAllocator* alloc_;
+		Semaphore* allocated_;
+		Semaphore* destroyed_;
+	} threadData = {threadAlloc, &allocated, &destroyed};
+	thread = Thread(
+	    [](void* userData) -> int {
+		    auto* data = (ThreadData*)userData;
+		    data->alloc_->Free(data->alloc_->Alloc(0));
+		    data->allocated_->Signal();
+		    data->destroyed_->Wait();
+
+		    // Cache of a new allocator on the same thread, dropping the stale one.
+		    HandleAllocator alloc(1);
+		    alloc.Free(alloc.Alloc(0));
+		    return 0;
+		},
+	    &threadData, 64 * 1024);
+	allocated.Wait();
+	delete threadAlloc;
+	destroyed.Signal();
+	thread.Join();
+}
+
+namespace
+{
+	/// Time numThreads threads each allocating and freeing handles, using @a allocFree for each iteration.
+	template<typename ALLOC_FREE>
+	f64 RunContention(i32 numThreads, i32 numIterations, ALLOC_FREE&& allocFree)
+	{
+		struct ThreadData
+		{
+			ALLOC_FREE* allocFree_;
+			i32 numIterations_;
+		};
+
+		Timer timer;
+		timer.Mark();
+		Vector<ThreadData> threadData(numThreads);
+		Vector<Thread> threads(numThreads);
+		for(i32 i = 0; i < numThreads; ++i)
+		{
+			threadData[i] = {&allocFree, numIterations};
+			threads[i] = Thread(
+			    [](void* userData) -> int {
+				    auto* data = (ThreadData*)userData;
+				    for(i32 i = 0; i < data->numIterations_; ++i)
+					    (*data->allocFree_)();
+				    return 0;
+				},
+			    &threadData[i], 64 * 1024);
+		}
+		for(auto& thread : threads)
+			thread.Join();
+		return timer.GetTime();
+	}
+} // namespace
+
+TEST_CASE("handle-benchmark-contention", "[.benchmark]")
+{
+	const i32 NUM_ITERATIONS = 200000;
+
+	Core::Log("\"handle-benchmark-contention\"\n");
+	for(i32 numThreads = 1; numThreads <= 16; numThreads *= 2)
+	{
+		const i32 numIterations = NUM_ITERATIONS / numThreads;
+		HandleAllocator alloc(1);
+
+		Mutex mutex;
+		const f64 mutexTime = RunContention(numThreads, numIterations, [&]() {
+			Handle handle;
+			{
+				ScopedMutex lock(mutex);
+				handle = alloc.Alloc(0);
+			}
+			ScopedMutex lock(mutex);
+			alloc.Free(handle);
+		});
+
+		const f64 lockFreeTime = RunContention(numThreads, numIterations, [&]() { alloc.Free(alloc.Alloc(0)); });
+
+		Core::Log("\t%i threads: mutex %f ns/op, lock free %f ns/op\n", numThreads,
+		    mutexTime * 1000000000.0 / (f64)NUM_ITERATIONS, lockFreeTime * 1000000000.0 / (f64)NUM_ITERATIONS);
+	}
+}
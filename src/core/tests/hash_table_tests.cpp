@@ -0,0 +1,276 @@
+#include "core/map.h"
+#include "core/set.h"
+#include "core/string.h"
+#include "core/timer.h"
+
+#include "catch.hpp"
+
+using namespace Core;
+
+namespace
+{
+	typedef i32 index_type;
+
+	/// Hasher that collides heavily to exercise probing.
+	template<typename TYPE>
+	class CollidingHasher
+	{
+	public:
+		u32 operator()(u32 input, const TYPE& data) const { return Hash(input, data) & 0x3; }
+	};
+
+	/**
+	 * Previous Map implementation, kept for benchmark comparison only.
+	 */
+	template<typename KEY_TYPE, typename VALUE_TYPE>
+	class LegacyMap
+	{
+	public:
+		typedef Pair<KEY_TYPE, VALUE_TYPE> value_type;
+		typedef value_type* iterator;
+
+		LegacyMap() { indices_.resize(maxIndex_, (index_type)INVALID_INDEX); }
+
+		iterator insert(const KEY_TYPE& key, const VALUE_TYPE& value)
+		{
+			const auto keyValuePair = value_type(key, value);
+			const u32 keyHash = Hash(0, key);
+			const index_type indicesIdx = keyHash & mask_;
+			const index_type idx = indices_[indicesIdx];
+			if(idx != INVALID_INDEX)
+			{
+				if(Hash(0, values_[idx].first) == keyHash)
+				{
+					values_[idx] = keyValuePair;
+					return values_.data() + idx;
+				}
+				values_.push_back(keyValuePair);
+				resizeIndices(maxIndex_ * 2);
+				return values_.data() + values_.size() - 1;
+			}
+			values_.push_back(keyValuePair);
+			indices_[indicesIdx] = values_.size() - 1;
+			return values_.data() + values_.size() - 1;
+		}
+
+		iterator erase(iterator it)
+		{
+			index_type baseIdx = (index_type)(it - begin());
+			values_.erase(it);
+			for(auto& idx : indices_)
+			{
+				if(idx == baseIdx)
+					idx = INVALID_INDEX;
+				else if(idx > baseIdx)
+					--idx;
+			}
+			return it;
+		}
+
+		iterator find(const KEY_TYPE& key)
+		{
+			const u32 keyHash = Hash(0, key);
+			const index_type idx = indices_[keyHash & mask_];
+			if(idx != INVALID_INDEX && Hash(0, values_[idx].first) == keyHash)
+				return values_.data() + idx;
+			return end();
+		}
+
+		iterator begin() { return values_.data(); }
+		iterator end() { return values_.data() + values_.size(); }
+
+	private:
+		static const index_type INVALID_INDEX = (index_type)-1;
+
+		void resizeIndices(index_type size)
+		{
+			bool collisions = true;
+			while(collisions)
+			{
+				collisions = false;
+				indices_.resize(size);
+				indices_.fill((index_type)INVALID_INDEX);
+				maxIndex_ = size;
+				mask_ = size - 1;
+				for(index_type idx = 0; idx < values_.size(); ++idx)
+				{
+					const index_type indicesIdx = Hash(0, values_[idx].first) & mask_;
+					if(indices_[indicesIdx] != INVALID_INDEX)
+					{
+						collisions = true;
+						size *= 2;
+						break;
+					}
+					indices_[indicesIdx] = idx;
+				}
+			}
+		}
+
+		Vector<value_type> values_;
+		Vector<index_type> indices_;
+		index_type maxIndex_ = 0x8;
+		index_type mask_ = 0x7;
+	};
+
+	template<typename MAP_TYPE>
+	void BenchmarkMap(const char* name, index_type numKeys, index_type numErase)
+	{
+		MAP_TYPE map;
+		Timer timer;
+
+		timer.Mark();
+		for(index_type idx = 0; idx < numKeys; ++idx)
+			map.insert(idx, idx);
+		const f64 insertTime = timer.GetTime();
+
+		timer.Mark();
+		index_type numFound = 0;
+		for(index_type idx = 0; idx < numKeys; ++idx)
+			numFound += map.find(idx) != map.end() ? 1 : 0;
+		const f64 findTime = timer.GetTime();
+		REQUIRE(numFound == numKeys);
+
+		timer.Mark();
+		for(index_type idx = 0; idx < numErase; ++idx)
+			map.erase(map.find(idx));
+		const f64 eraseTime = timer.GetTime();
+
+		Core::Log("\"%s\" (%u keys)\n", name, numKeys);
+		Core::Log("\tinsert: %f ms (%f ns/op)\n", insertTime * 1000.0, insertTime * 1000000000.0 / (f64)numKeys);
+		Core::Log("\tfind: %f ms (%f ns/op)\n", findTime * 1000.0, findTime * 1000000000.0 / (f64)numKeys);
+		Core::Log("\terase: %f ms (%f ns/op)\n", eraseTime * 1000.0, eraseTime * 1000000000.0 / (f64)numErase);
+	}
+}
+
+TEST_CASE("hash-table-tests-collisions")
+{
+	Map<index_type, index_type, CollidingHasher<index_type>> map;
+	for(index_type idx = 0; idx < 0x100; ++idx)
+		map.insert(idx, idx * 2);
+	REQUIRE(map.size() == 0x100);
+
+	bool success = true;
+	for(index_type idx = 0; idx < 0x100; ++idx)
+	{
+		auto it = map.find(idx);
+		success &= it != map.end();
+		success &= it->first == idx;
+		success &= it->second == idx * 2;
+	}
+	REQUIRE(success);
+	REQUIRE(map.find(0x100) == map.end());
+}
+
+TEST_CASE("hash-table-tests-erase")
+{
+	SECTION("by-key")
+	{
+		Map<index_type, index_type> map;
+		for(index_type idx = 0; idx < 0x100; ++idx)
+			map.insert(idx, idx);
+
+		for(index_type idx = 0; idx < 0x100; idx += 2)
+			REQUIRE(map.erase(idx));
+		REQUIRE(!map.erase(0));
+		REQUIRE(map.size() == 0x80);
+
+		for(index_type idx = 0; idx < 0x100; ++idx)
+			REQUIRE((map.find(idx) != map.end()) == ((idx & 1) == 1));
+	}
+
+	SECTION("while-iterating")
+	{
+		Map<index_type, index_type, CollidingHasher<index_type>> map;
+		for(index_type idx = 0; idx < 0x100; ++idx)
+			map.insert(idx, idx);
+
+		for(auto it = map.begin(); it != map.end();)
+		{
+			if(it->second % 3 == 0)
+				it = map.erase(it);
+			else
+				++it;
+		}
+
+		for(index_type idx = 0; idx < 0x100; ++idx)
+			REQUIRE((map.find(idx) != map.end()) == ((idx % 3) != 0));
+	}
+
+	SECTION("non-trivial")
+	{
+		Map<Core::String, index_type> map;
+		Core::String key;
+		for(index_type idx = 0; idx < 0x100; ++idx)
+		{
+			key.Printf("%u", idx);
+			map.insert(key, idx);
+		}
+
+		for(index_type idx = 0; idx < 0x100; idx += 4)
+		{
+			key.Printf("%u", idx);
+			REQUIRE(map.erase(key));
+		}
+
+		for(index_type idx = 0; idx < 0x100; ++idx)
+		{
+			key.Printf("%u", idx);
+			auto it = map.find(key);
+			if(idx % 4 == 0)
+				REQUIRE(it == map.end());
+			else
+				REQUIRE(it->second == idx);
+		}
+	}
+}
+
+TEST_CASE("hash-table-tests-load-factor")
+{
+	Map<index_type, index_type> map;
+	map.max_load_factor(0.5f);
+	for(index_type idx = 0; idx < 0x1000; ++idx)
+	{
+		map.insert(idx, idx);
+		REQUIRE(map.load_factor() <= 0.5f);
+	}
+
+	map.max_load_factor(0.9f);
+	REQUIRE(map.load_factor() <= 0.9f);
+	for(index_type idx = 0; idx < 0x1000; ++idx)
+		REQUIRE(map.find(idx) != map.end());
+
+	map.reserve(0x10000);
+	const index_type bucketCount = map.bucket_count();
+	for(index_type idx = 0; idx < 0x10000; ++idx)
+		map.insert(idx, idx);
+	REQUIRE(map.bucket_count() == bucketCount);
+}
+
+TEST_CASE("hash-table-tests-set")
+{
+	Set<index_type> set;
+	for(index_type idx = 0; idx < 0x100; ++idx)
+		set.insert(idx);
+	for(index_type idx = 0; idx < 0x100; ++idx)
+		set.insert(idx);
+	REQUIRE(set.size() == 0x100);
+
+	for(index_type idx = 0; idx < 0x100; ++idx)
+		REQUIRE(*set.find(idx) == idx);
+
+	set.clear();
+	REQUIRE(set.empty());
+	REQUIRE(set.find(0) == set.end());
+}
+
+TEST_CASE("hash-table-benchmark", "[.benchmark]")
+{
+	const index_type numKeys[] = {1000, 10000, 100000, 1000000};
+	for(index_type keys : numKeys)
+	{
+		// Legacy erase is O(n), so only erase a fixed number of keys.
+		const index_type numErase = keys < 1000 ? keys : 1000;
+		BenchmarkMap<LegacyMap<index_type, index_type>>("legacy-map", keys, numErase);
+		BenchmarkMap<Map<index_type, index_type>>("robin-hood-map", keys, numErase);
+	}
+}
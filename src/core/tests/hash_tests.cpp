@@ -0,0 +1,363 @@
+#include "core/hash.h"
+#include "core/random.h"
+#include "core/timer.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace Core;
+
+namespace
+{
+	/// Byte at a time CRC, to check the optimized versions against.
+	u32 ReferenceCRC(u32 poly, u32 input, const void* data, size_t size)
+	{
+		const u8* bytes = reinterpret_cast<const u8*>(data);
+		u32 crc = ~input;
+		while(size--)
+		{
+			crc ^= *bytes++;
+			for(i32 bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ (poly & (0 - (crc & 1)));
+		}
+		return ~crc;
+	}
+
+	/// Byte at a time CRC32 with a 256 entry table, as HashCRC32 used to be.
+	u32 TableCRC32(u32 input, const void* data, size_t size)
+	{
+		static u32 table[256] = {};
+		if(table[1] == 0)
+			for(u32 i = 0; i < 256; ++i)
+				table[i] = ~ReferenceCRC(0xedb88320, 0xffffffff, &i, 1);
+
+		const u8* bytes = reinterpret_cast<const u8*>(data);
+		u32 crc = ~input;
+		while(size--)
+			crc = table[(crc ^ *bytes++) & 0xff] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	enum class TestEnum : i32
+	{
+		A,
+		B,
+	};
+
+	template<typename DIGEST>
+	bool DigestEquals(const DIGEST& digest, const char* hex)
+	{
+		char digestHex[sizeof(digest.data8_) * 2 + 1];
+		for(i32 i = 0; i < (i32)sizeof(digest.data8_); ++i)
+			sprintf_s(digestHex + i * 2, 3, "%02x", digest.data8_[i]);
+		return strcmp(digestHex, hex) == 0;
+	}
+
+	template<typename DIGEST>
+	bool DigestEquals(const DIGEST& a, const DIGEST& b)
+	{
+		return memcmp(a.data8_, b.data8_, sizeof(a.data8_)) == 0;
+	}
+
+	Vector<u8> MakeTestData(i32 size)
+	{
+		Vector<u8> data(size);
+		for(i32 i = 0; i < size; ++i)
+			data[i] = (u8)(i * 13 + 7);
+		return data;
+	}
+
+	/// Hash lanes of different sizes, fed in uneven chunks, and check against hashing each alone.
+	template<typename MULTI_CONTEXT, typename DIGEST, typename HASH_FUNC>
+	bool CheckMultiContext(HASH_FUNC&& hashFunc)
+	{
+		const i32 NUM_LANES = MULTI_CONTEXT::NUM_LANES;
+		const i32 laneSizes[NUM_LANES] = {0, 63, 1000, 10000};
+		Vector<u8> laneData[NUM_LANES];
+		for(i32 lane = 0; lane < NUM_LANES; ++lane)
+		{
+			laneData[lane].resize(laneSizes[lane]);
+			for(i32 i = 0; i < laneSizes[lane]; ++i)
+				laneData[lane][i] = (u8)(i * (lane + 3));
+		}
+
+		MULTI_CONTEXT ctx;
+		i32 offsets[NUM_LANES] = {};
+		for(i32 step = 0;; ++step)
+		{
+			const void* data[NUM_LANES];
+			size_t sizes[NUM_LANES];
+			bool done = true;
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			{
+				// Different chunk sizes per lane and step, so lanes drift out of block alignment.
+				i32 size = ((step + lane) % 5) * 97 + lane * 64;
+				if(size > laneSizes[lane] - offsets[lane])
+					size = laneSizes[lane] - offsets[lane];
+				data[lane] = laneData[lane].data() + offsets[lane];
+				sizes[lane] = size;
+				offsets[lane] += size;
+				done &= offsets[lane] == laneSizes[lane];
+			}
+			ctx.Update(data, sizes);
+			if(done)
+				break;
+		}
+
+		DIGEST digests[NUM_LANES];
+		ctx.Final(digests);
+		for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			if(!DigestEquals(digests[lane], hashFunc(laneData[lane].data(), laneSizes[lane])))
+				return false;
+		return true;
+	}
+
+	/// Keeps benchmark results from being optimized out.
+	volatile u64 hashSink_ = 0;
+
+	template<typename FUNC>
+	void RunHashBenchmark(const char* name, const Vector<u8>& data, i32 size, FUNC&& func)
+	{
+		const i32 numIterations = (i32)((256 * 1024 * 1024) / size);
+		Timer timer;
+		timer.Mark();
+		u64 result = 0;
+		for(i32 i = 0; i < numIterations; ++i)
+			result += func(data.data(), size);
+		hashSink_ = result;
+		const f64 time = timer.GetTime();
+		Core::Log("\t%s, %i bytes: %f GB/s\n", name, size,
+		    ((f64)size * (f64)numIterations) / (time * 1024.0 * 1024.0 * 1024.0));
+	}
+} // namespace
+
+TEST_CASE("hash-tests-crc32")
+{
+	const char* check = "123456789";
+	REQUIRE(HashCRC32(0, check, 9) == 0xcbf43926);
+	REQUIRE(HashCRC32(0, nullptr, 0) == 0);
+
+	// Every length and alignment through the slice-by-8 loop and tail.
+	Random random;
+	Vector<u8> data(256);
+	for(auto& val : data)
+		val = (u8)random.Generate();
+	for(i32 offset = 0; offset < 8; ++offset)
+		for(i32 size = 0; size < 64; ++size)
+			REQUIRE(HashCRC32(0, data.data() + offset, size) ==
+			        ReferenceCRC(0xedb88320, 0, data.data() + offset, size));
+
+	// Chaining with the previous result is the same as hashing all at once.
+	REQUIRE(HashCRC32(HashCRC32(0, data.data(), 100), data.data() + 100, 156) == HashCRC32(0, data.data(), 256));
+}
+
+TEST_CASE("hash-tests-crc32c")
+{
+	const char* check = "123456789";
+	REQUIRE(HashCRC32C(0, check, 9) == 0xe3069283);
+	REQUIRE(HashCRC32C(0, nullptr, 0) == 0);
+
+	Random random;
+	Vector<u8> data(256);
+	for(auto& val : data)
+		val = (u8)random.Generate();
+	for(i32 offset = 0; offset < 8; ++offset)
+		for(i32 size = 0; size < 64; ++size)
+			REQUIRE(HashCRC32C(0, data.data() + offset, size) ==
+			        ReferenceCRC(0x82f63b78, 0, data.data() + offset, size));
+
+	REQUIRE(HashCRC32C(HashCRC32C(0, data.data(), 100), data.data() + 100, 156) == HashCRC32C(0, data.data(), 256));
+}
+
+TEST_CASE("hash-tests-xx64")
+{
+	REQUIRE(HashXX64(0, nullptr, 0) == 0xef46db3751d8e999ULL);
+	REQUIRE(HashXX64(0, "a", 1) == 0xd24ec4f1a98c6e5bULL);
+	REQUIRE(HashXX64(0, "abc", 3) == 0x44bc2cf5ad770999ULL);
+
+	// Long enough for the 4 lane loop, with an 8, 4 and 1 byte tail.
+	u8 data[100];
+	for(i32 i = 0; i < 100; ++i)
+		data[i] = (u8)(i * 7);
+	REQUIRE(HashXX64(0, data, sizeof(data)) == 0x8e2272c08247d5dbULL);
+	REQUIRE(HashXX64(0x1234, data, sizeof(data)) == 0xe0272767d44d6d5dULL);
+}
+
+TEST_CASE("hash-tests-md5")
+{
+	REQUIRE(DigestEquals(HashMD5(nullptr, 0), "d41d8cd98f00b204e9800998ecf8427e"));
+	REQUIRE(DigestEquals(HashMD5("abc", 3), "900150983cd24fb0d6963f7d28e17f72"));
+
+	Vector<u8> data = MakeTestData(10000);
+	REQUIRE(DigestEquals(HashMD5(data.data(), data.size()), "416b4eb4cdaa8480520ceefbc1f2943f"));
+
+	// Streaming in uneven chunks matches hashing in one go.
+	HashMD5Context ctx;
+	for(i32 offset = 0, chunk = 1; offset < data.size(); offset += chunk, chunk = chunk * 3 + 1)
+		ctx.Update(data.data() + offset, (chunk < data.size() - offset) ? chunk : data.size() - offset);
+	REQUIRE(DigestEquals(ctx.Final(), "416b4eb4cdaa8480520ceefbc1f2943f"));
+
+	ctx.Init();
+	ctx.Update("abc", 3);
+	REQUIRE(DigestEquals(ctx.Final(), "900150983cd24fb0d6963f7d28e17f72"));
+
+	// Empty updates are allowed with no data, including part way through a block.
+	ctx.Init();
+	ctx.Update(nullptr, 0);
+	ctx.Update("a", 1);
+	ctx.Update(nullptr, 0);
+	ctx.Update("bc", 2);
+	REQUIRE(DigestEquals(ctx.Final(), "900150983cd24fb0d6963f7d28e17f72"));
+
+	const bool multiMatches = CheckMultiContext<HashMD5MultiContext, HashMD5Digest>(HashMD5);
+	REQUIRE(multiMatches);
+}
+
+TEST_CASE("hash-tests-sha1")
+{
+	REQUIRE(DigestEquals(HashSHA1(nullptr, 0), "da39a3ee5e6b4b0d3255bfef95601890afd80709"));
+	REQUIRE(DigestEquals(HashSHA1("abc", 3), "a9993e364706816aba3e25717850c26c9cd0d89d"));
+
+	Vector<u8> data = MakeTestData(10000);
+	REQUIRE(DigestEquals(HashSHA1(data.data(), data.size()), "3fc0f0c21d6647c1daf0d2d26d43a5a71b114481"));
+
+	HashSHA1Context ctx;
+	for(i32 offset = 0, chunk = 1; offset < data.size(); offset += chunk, chunk = chunk * 3 + 1)
+		ctx.Update(data.data() + offset, (chunk < data.size() - offset) ? chunk : data.size() - offset);
+	REQUIRE(DigestEquals(ctx.Final(), "3fc0f0c21d6647c1daf0d2d26d43a5a71b114481"));
+
+	ctx.Init();
+	ctx.Update("abc", 3);
+	REQUIRE(DigestEquals(ctx.Final(), "a9993e364706816aba3e25717850c26c9cd0d89d"));
+
+	// Empty updates are allowed with no data, including part way through a block.
+	ctx.Init();
+	ctx.Update(nullptr, 0);
+	ctx.Update("a", 1);
+	ctx.Update(nullptr, 0);
+	ctx.Update("bc", 2);
+	REQUIRE(DigestEquals(ctx.Final(), "a9993e364706816aba3e25717850c26c9cd0d89d"));
+
+	const bool multiMatches = CheckMultiContext<HashSHA1MultiContext, HashSHA1Digest>(HashSHA1);
+	REQUIRE(multiMatches);
+}
+
+TEST_CASE("hash-tests-hasher")
+{
+	// Enums and pointers are hashed as bytes.
+	Hasher<TestEnum> enumHasher;
+	const TestEnum enumVal = TestEnum::B;
+	REQUIRE(enumHasher(0, enumVal) == HashCRC32C(0, &enumVal, sizeof(enumVal)));
+
+	i32 val = 0;
+	const i32* ptr = &val;
+	Hasher<const i32*> ptrHasher;
+	REQUIRE(ptrHasher(0, ptr) == HashCRC32C(0, &ptr, sizeof(ptr)));
+
+	// Other types use their Hash function.
+	Hasher<u32> intHasher;
+	REQUIRE(intHasher(0, 1234u) == Hash(0, 1234u));
+}
+
+TEST_CASE("hash-benchmark", "[.benchmark]")
+{
+	Random random;
+	Vector<u8> data(1024 * 1024);
+	for(auto& val : data)
+		val = (u8)random.Generate();
+
+	Core::Log("\"hash-benchmark\"\n");
+	Core::Log("\thardware CRC32C: %s\n", HashHasHardwareCRC32C() ? "yes" : "no");
+	for(i32 size : {16, 1024, 1024 * 1024})
+	{
+		RunHashBenchmark("CRC32 (table)", data, size,
+		    [](const void* mem, i32 bytes) { return (u64)TableCRC32(0, mem, bytes); });
+		RunHashBenchmark("CRC32 (slice-by-8)", data, size,
+		    [](const void* mem, i32 bytes) { return (u64)HashCRC32(0, mem, bytes); });
+		RunHashBenchmark(
+		    "CRC32C", data, size, [](const void* mem, i32 bytes) { return (u64)HashCRC32C(0, mem, bytes); });
+		RunHashBenchmark("xxHash64", data, size, [](const void* mem, i32 bytes) { return HashXX64(0, mem, bytes); });
+		RunHashBenchmark(
+		    "SDBM", data, size, [](const void* mem, i32 bytes) { return (u64)HashSDBM(0, mem, bytes); });
+	}
+}
+
+TEST_CASE("hash-benchmark-multi", "[.benchmark]")
+{
+	const i32 NUM_LANES = HashMD5MultiContext::NUM_LANES;
+	const i32 FILE_SIZE = 16 * 1024 * 1024;
+	const i32 CHUNK_SIZE = 64 * 1024;
+	Vector<u8> files[NUM_LANES];
+	for(auto& file : files)
+		file = MakeTestData(FILE_SIZE);
+
+	// Hash each "file" a chunk at a time, as if reading from disk.
+	auto logTime = [&](const char* name, f64 time) {
+		Core::Log("\t%s: %f MB/s\n", name, ((f64)FILE_SIZE * NUM_LANES) / (time * 1024.0 * 1024.0));
+	};
+
+	Core::Log("\"hash-benchmark-multi\"\n");
+	Timer timer;
+	timer.Mark();
+	for(auto& file : files)
+	{
+		HashMD5Context ctx;
+		for(i32 offset = 0; offset < FILE_SIZE; offset += CHUNK_SIZE)
+			ctx.Update(file.data() + offset, CHUNK_SIZE);
+		hashSink_ = ctx.Final().data64_[0];
+	}
+	logTime("MD5", timer.GetTime());
+
+	timer.Mark();
+	{
+		HashMD5MultiContext ctx;
+		for(i32 offset = 0; offset < FILE_SIZE; offset += CHUNK_SIZE)
+		{
+			const void* data[NUM_LANES];
+			size_t sizes[NUM_LANES];
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			{
+				data[lane] = files[lane].data() + offset;
+				sizes[lane] = CHUNK_SIZE;
+			}
+			ctx.Update(data, sizes);
+		}
+		HashMD5Digest digests[NUM_LANES];
+		ctx.Final(digests);
+		hashSink_ = digests[0].data64_[0];
+	}
+	logTime("MD5 multi-buffer", timer.GetTime());
+
+	timer.Mark();
+	for(auto& file : files)
+	{
+		HashSHA1Context ctx;
+		for(i32 offset = 0; offset < FILE_SIZE; offset += CHUNK_SIZE)
+			ctx.Update(file.data() + offset, CHUNK_SIZE);
+		hashSink_ = ctx.Final().data32_[0];
+	}
+	logTime("SHA-1", timer.GetTime());
+
+	timer.Mark();
+	{
+		HashSHA1MultiContext ctx;
+		for(i32 offset = 0; offset < FILE_SIZE; offset += CHUNK_SIZE)
+		{
+			const void* data[NUM_LANES];
+			size_t sizes[NUM_LANES];
+			for(i32 lane = 0; lane < NUM_LANES; ++lane)
+			{
+				data[lane] = files[lane].data() + offset;
+				sizes[lane] = CHUNK_SIZE;
+			}
+			ctx.Update(data, sizes);
+		}
+		HashSHA1Digest digests[NUM_LANES];
+		ctx.Final(digests);
+		hashSink_ = digests[0].data32_[0];
+	}
+	logTime("SHA-1 multi-buffer", timer.GetTime());
+}
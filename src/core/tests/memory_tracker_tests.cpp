@@ -0,0 +1,201 @@
+#include "core/concurrency.h"
+#include "core/enum.h"
+#include "core/memory_tracker.h"
+#include "core/timer.h"
+#include "core/tlsf_allocator.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+using namespace Core;
+
+namespace
+{
+	// Counters are global, so tests use a tag nothing else in core_test allocates with, and compare
+	// against a snapshot taken at the start.
+	static const MemoryTag TEST_TAG = MemoryTag::SERIALIZATION;
+	using TestAllocator = TaggedAllocator<TEST_TAG>;
+
+	/// Keeps benchmark allocations from being optimized out.
+	void* volatile allocSink_ = nullptr;
+
+	/// @return Average time to allocate and free a vector, in ns.
+	template<typename VECTOR_TYPE>
+	f64 RunAllocBenchmark(i32 numIterations)
+	{
+		Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < numIterations; ++i)
+		{
+			VECTOR_TYPE vector;
+			vector.reserve((i % 64) + 1);
+			allocSink_ = vector.data();
+		}
+		return timer.GetTime() * 1000000000.0 / (f64)numIterations;
+	}
+} // namespace
+
+TEST_CASE("memory-tracker-tests-names")
+{
+	for(i32 i = 0; i < (i32)MemoryTag::MAX; ++i)
+		REQUIRE(EnumToString((MemoryTag)i) != nullptr);
+	REQUIRE(EnumToString(MemoryTag::MAX) == nullptr);
+
+	MemoryTag tag = MemoryTag::UNTAGGED;
+	REQUIRE(EnumFromString(tag, "resource"));
+	REQUIRE(tag == MemoryTag::RESOURCE);
+}
+
+TEST_CASE("memory-tracker-tests-tagged-allocator")
+{
+	MemoryTracker::ResetPeak(TEST_TAG);
+	const MemoryTagStats before = MemoryTracker::GetStats(TEST_TAG);
+	{
+		Vector<i32, TestAllocator> vector;
+		vector.reserve(1024);
+		MemoryTagStats stats = MemoryTracker::GetStats(TEST_TAG);
+		REQUIRE(stats.liveBytes_ == before.liveBytes_ + 4096);
+		REQUIRE(stats.numLiveAllocs_ == before.numLiveAllocs_ + 1);
+		REQUIRE(stats.numTotalAllocs_ == before.numTotalAllocs_ + 1);
+
+		vector.reserve(2048);
+		stats = MemoryTracker::GetStats(TEST_TAG);
+		REQUIRE(stats.liveBytes_ == before.liveBytes_ + 8192);
+		REQUIRE(stats.peakBytes_ == before.liveBytes_ + 4096 + 8192);
+		REQUIRE(stats.numLiveAllocs_ == before.numLiveAllocs_ + 1);
+	}
+
+	const MemoryTagStats after = MemoryTracker::GetStats(TEST_TAG);
+	REQUIRE(after.liveBytes_ == before.liveBytes_);
+	REQUIRE(after.numLiveAllocs_ == before.numLiveAllocs_);
+	REQUIRE(after.peakBytes_ == before.liveBytes_ + 4096 + 8192);
+
+	MemoryTracker::ResetPeak(TEST_TAG);
+	REQUIRE(MemoryTracker::GetStats(TEST_TAG).peakBytes_ == before.liveBytes_);
+}
+
+TEST_CASE("memory-tracker-tests-tracked-allocator")
+{
+	TLSFAllocator tlsf(64 * 1024);
+	TrackedAllocator allocator(TEST_TAG, tlsf);
+	const MemoryTagStats before = MemoryTracker::GetStats(TEST_TAG);
+
+	void* mem = allocator.Allocate(1000, 16);
+	REQUIRE(mem != nullptr);
+	REQUIRE(MemoryTracker::GetStats(TEST_TAG).liveBytes_ == before.liveBytes_ + 1000);
+
+	// Failed allocations aren't counted.
+	REQUIRE(allocator.Allocate(1024 * 1024, 16) == nullptr);
+	REQUIRE(MemoryTracker::GetStats(TEST_TAG).numTotalAllocs_ == before.numTotalAllocs_ + 1);
+
+	allocator.Deallocate(mem, 1000);
+	REQUIRE(MemoryTracker::GetStats(TEST_TAG).liveBytes_ == before.liveBytes_);
+}
+
+TEST_CASE("memory-tracker-tests-budget")
+{
+	const MemoryTagStats before = MemoryTracker::GetStats(TEST_TAG);
+	MemoryTracker::SetBudget(TEST_TAG, before.liveBytes_ + 1024);
+	REQUIRE(MemoryTracker::GetStats(TEST_TAG).budgetBytes_ == before.liveBytes_ + 1024);
+
+	Vector<u8, TestAllocator> vector;
+	vector.reserve(1024);
+	REQUIRE(!MemoryTracker::IsOverBudget(TEST_TAG));
+
+	vector.reserve(2048);
+	REQUIRE(MemoryTracker::IsOverBudget(TEST_TAG));
+	MemoryTag overBudget[(i32)MemoryTag::MAX];
+	const i32 numOverBudget = MemoryTracker::GetOverBudget(overBudget, (i32)MemoryTag::MAX);
+	REQUIRE(numOverBudget >= 1);
+	REQUIRE(MemoryTracker::GetOverBudget(nullptr, 0) == numOverBudget);
+	bool found = false;
+	for(i32 i = 0; i < numOverBudget; ++i)
+		found |= overBudget[i] == TEST_TAG;
+	REQUIRE(found);
+
+	MemoryTracker::SetBudget(TEST_TAG, 0);
+	REQUIRE(!MemoryTracker::IsOverBudget(TEST_TAG));
+}
+
+TEST_CASE("memory-tracker-tests-callstack-sampling")
+{
+	MemoryTracker::SetCallstackSampleRate(1);
+	{
+		Vector<u8, TestAllocator> a;
+		Vector<u8, TestAllocator> b;
+		a.reserve(100);
+		b.reserve(200);
+
+		MemorySample samples[4];
+		REQUIRE(MemoryTracker::GetSamples(TEST_TAG, samples, 4) == 2);
+		REQUIRE(MemoryTracker::GetSamples(MemoryTag::MAX, nullptr, 0) >= 2);
+		REQUIRE(MemoryTracker::GetSamples(MemoryTag::UNTAGGED, nullptr, 0) == 0);
+		for(i32 i = 0; i < 2; ++i)
+		{
+			REQUIRE(samples[i].tag_ == TEST_TAG);
+			REQUIRE((samples[i].mem_ == a.data() || samples[i].mem_ == b.data()));
+			REQUIRE(samples[i].bytes_ == (samples[i].mem_ == a.data() ? 100 : 200));
+#if PLATFORM_WINDOWS || PLATFORM_LINUX
+			REQUIRE(samples[i].numFrames_ > 0);
+#endif
+		}
+	}
+
+	// Freed allocations are no longer live.
+	REQUIRE(MemoryTracker::GetSamples(TEST_TAG, nullptr, 0) == 0);
+
+	MemoryTracker::SetCallstackSampleRate(2);
+	{
+		Vector<Vector<u8, TestAllocator>> vectors(10);
+		for(auto& vector : vectors)
+			vector.reserve(16);
+		REQUIRE(MemoryTracker::GetSamples(TEST_TAG, nullptr, 0) == 5);
+	}
+	MemoryTracker::SetCallstackSampleRate(0);
+}
+
+TEST_CASE("memory-tracker-tests-threads")
+{
+	static const i32 NUM_THREADS = 4;
+	static const i32 NUM_ITERATIONS = 10000;
+
+	MemoryTracker::ResetPeak(TEST_TAG);
+	const MemoryTagStats before = MemoryTracker::GetStats(TEST_TAG);
+
+	Vector<Thread> threads(NUM_THREADS);
+	for(auto& thread : threads)
+	{
+		thread = Thread(
+		    [](void*) -> int {
+			    for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			    {
+				    Vector<u8, TestAllocator> vector;
+				    vector.reserve(64);
+			    }
+			    return 0;
+			},
+		    nullptr);
+	}
+	for(auto& thread : threads)
+		thread.Join();
+
+	const MemoryTagStats after = MemoryTracker::GetStats(TEST_TAG);
+	REQUIRE(after.liveBytes_ == before.liveBytes_);
+	REQUIRE(after.numLiveAllocs_ == before.numLiveAllocs_);
+	REQUIRE(after.numTotalAllocs_ == before.numTotalAllocs_ + NUM_THREADS * NUM_ITERATIONS);
+	REQUIRE(after.peakBytes_ >= before.liveBytes_ + 64);
+	REQUIRE(after.peakBytes_ <= before.liveBytes_ + 64 * NUM_THREADS);
+}
+
+TEST_CASE("memory-tracker-benchmark-overhead", "[.benchmark]")
+{
+	static const i32 NUM_ITERATIONS = 1000000;
+
+	Core::Log("\"memory-tracker-benchmark-overhead\"\n");
+	Core::Log("\tuntracked: %f ns/alloc\n", RunAllocBenchmark<Vector<u8>>(NUM_ITERATIONS));
+	Core::Log("\ttagged: %f ns/alloc\n", RunAllocBenchmark<Vector<u8, TestAllocator>>(NUM_ITERATIONS));
+	MemoryTracker::SetCallstackSampleRate(1024);
+	Core::Log(
+	    "\ttagged, sampling 1 in 1024: %f ns/alloc\n", RunAllocBenchmark<Vector<u8, TestAllocator>>(NUM_ITERATIONS));
+	MemoryTracker::SetCallstackSampleRate(0);
+}
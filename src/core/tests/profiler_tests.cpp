@@ -0,0 +1,134 @@
+#include "core/profiler.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/timer.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+using namespace Core;
+
+namespace
+{
+	const char* SCOPE_A = "profiler-tests-a";
+	const char* SCOPE_B = "profiler-tests-b";
+
+	/// Get this test's entries from the frame report.
+	Vector<ProfilerEntry> GetTestEntries()
+	{
+		Vector<ProfilerEntry> entries(Profiler::GetFrameReport(nullptr, 0));
+		entries.resize(Profiler::GetFrameReport(entries.data(), entries.size()));
+		Vector<ProfilerEntry> testEntries;
+		for(const auto& entry : entries)
+			if(entry.name_ == SCOPE_A || entry.name_ == SCOPE_B)
+				testEntries.push_back(entry);
+		return testEntries;
+	}
+} // namespace
+
+TEST_CASE("profiler-tests-frame")
+{
+	Profiler::EndFrame();
+
+	Profiler::Record(SCOPE_A, 100);
+	Profiler::Record(SCOPE_A, 300);
+	Profiler::Record(SCOPE_B, 1000);
+	Profiler::EndFrame();
+
+	auto entries = GetTestEntries();
+	REQUIRE(entries.size() == 2);
+
+	// Sorted by total time.
+	REQUIRE(entries[0].name_ == SCOPE_B);
+	REQUIRE(entries[0].callCount_ == 1);
+	REQUIRE(entries[1].name_ == SCOPE_A);
+	REQUIRE(entries[1].callCount_ == 2);
+	REQUIRE(entries[0].threadIdx_ == entries[1].threadIdx_);
+
+	const f64 secondsPerCycle = 1.0 / Timer::GetCycleFrequency();
+	REQUIRE(entries[1].totalTime_ == Approx(400.0 * secondsPerCycle));
+	REQUIRE(entries[1].maxTime_ == Approx(300.0 * secondsPerCycle));
+	REQUIRE(entries[0].totalTime_ == Approx(entries[0].maxTime_));
+
+	// Report is kept until the next frame ends, which starts counting from zero.
+	REQUIRE(GetTestEntries().size() == 2);
+	Profiler::EndFrame();
+	REQUIRE(GetTestEntries().size() == 0);
+}
+
+TEST_CASE("profiler-tests-scope")
+{
+	Profiler::EndFrame();
+	{
+		ProfilerScope scope(SCOPE_A);
+		Timer timer;
+		timer.Mark();
+		while(timer.GetTime() < 0.001)
+			YieldCPU();
+	}
+	Profiler::EndFrame();
+
+	auto entries = GetTestEntries();
+	REQUIRE(entries.size() == 1);
+	REQUIRE(entries[0].callCount_ == 1);
+	REQUIRE(entries[0].totalTime_ >= 0.0009);
+}
+
+TEST_CASE("profiler-tests-threads")
+{
+	static const i32 NUM_THREADS = 4;
+	static const i32 NUM_RECORDS = 1000;
+
+	Profiler::EndFrame();
+	Vector<Thread> threads(NUM_THREADS);
+	for(auto& thread : threads)
+	{
+		thread = Thread(
+		    [](void*) -> int {
+			    for(i32 i = 0; i < NUM_RECORDS; ++i)
+				    Profiler::Record(SCOPE_A, 1);
+			    return 0;
+			},
+		    nullptr, 64 * 1024);
+	}
+	for(auto& thread : threads)
+		thread.Join();
+	Profiler::EndFrame();
+
+	// One entry per thread.
+	auto entries = GetTestEntries();
+	REQUIRE(entries.size() == NUM_THREADS);
+	bool success = true;
+	for(i32 i = 0; i < entries.size(); ++i)
+	{
+		success &= entries[i].callCount_ == NUM_RECORDS;
+		for(i32 j = 0; j < i; ++j)
+			success &= entries[i].threadIdx_ != entries[j].threadIdx_;
+	}
+	REQUIRE(success);
+}
+
+TEST_CASE("profiler-benchmark", "[.benchmark]")
+{
+	const i32 NUM_ITERATIONS = 1000000;
+
+	Core::Log("\"profiler-benchmark\"\n");
+	Timer timer;
+	u64 sum = 0;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		sum += (u64)Timer::GetAbsoluteTimeNS();
+	Core::Log("\tTimer::GetAbsoluteTimeNS: %f ns\n", timer.GetTime() * 1000000000.0 / NUM_ITERATIONS);
+
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		sum += Timer::GetCycleCount();
+	Core::Log("\tTimer::GetCycleCount: %f ns\n", timer.GetTime() * 1000000000.0 / NUM_ITERATIONS);
+
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		ProfilerScope scope(SCOPE_A);
+	Core::Log("\tProfilerScope: %f ns\n", timer.GetTime() * 1000000000.0 / NUM_ITERATIONS);
+	Profiler::EndFrame();
+	REQUIRE(sum != 0);
+}
@@ -0,0 +1,287 @@
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/misc.h"
+#include "core/mpmc_bounded_queue.h"
+#include "core/mpsc_queue.h"
+#include "core/spsc_queue.h"
+#include "core/timer.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+using namespace Core;
+
+namespace
+{
+	/// Adapters so tests and benchmarks can treat the queues alike. Enqueue retries while full.
+	template<typename QUEUE>
+	struct QueueOps
+	{
+		static void Enqueue(QUEUE& queue, const i32* values, i32 count)
+		{
+			while(count > 0)
+			{
+				const i32 numEnqueued = queue.Enqueue(values, count);
+				values += numEnqueued;
+				count -= numEnqueued;
+				if(numEnqueued == 0)
+					SwitchThread();
+			}
+		}
+	};
+
+	template<>
+	struct QueueOps<MPSCQueue<i32>>
+	{
+		static void Enqueue(MPSCQueue<i32>& queue, const i32* values, i32 count) { queue.Enqueue(values, count); }
+	};
+
+	/**
+	 * Enqueue from numProducers threads and dequeue from numConsumers threads, batchSize at a time.
+	 * Each producer enqueues increasing values, tagged with its index.
+	 * @return Time taken, or -1.0 if values were lost, duplicated or reordered within a producer.
+	 */
+	template<typename QUEUE>
+	f64 RunProducersConsumers(QUEUE& queue, i32 numProducers, i32 numConsumers, i32 numValues, i32 batchSize)
+	{
+		static const i32 MAX_BATCH = 64;
+		static const i32 MAX_PRODUCERS = 16;
+		DBG_ASSERT(batchSize <= MAX_BATCH && numProducers <= MAX_PRODUCERS);
+
+		struct ThreadData
+		{
+			QUEUE* queue_;
+			i32 idx_;
+			i32 numValues_;
+			i32 batchSize_;
+			volatile i32* numDequeued_;
+			i32 totalValues_;
+			i64 sum_;
+			bool success_;
+		};
+
+		volatile i32 numDequeued = 0;
+		Vector<ThreadData> producerData(numProducers);
+		Vector<ThreadData> consumerData(numConsumers);
+		Vector<Thread> threads(numConsumers + numProducers);
+
+		Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < numConsumers; ++i)
+		{
+			consumerData[i] = {&queue, i, 0, batchSize, &numDequeued, numValues * numProducers, 0, true};
+			threads[i] = Thread(
+			    [](void* userData) -> int {
+				    auto* data = (ThreadData*)userData;
+				    i32 lastValue[MAX_PRODUCERS];
+				    for(auto& value : lastValue)
+					    value = -1;
+				    i32 values[MAX_BATCH];
+				    while(AtomicLoadAcq(data->numDequeued_) < data->totalValues_)
+				    {
+					    const i32 count = data->queue_->Dequeue(values, data->batchSize_);
+					    if(count == 0)
+					    {
+						    SwitchThread();
+						    continue;
+					    }
+					    for(i32 i = 0; i < count; ++i)
+					    {
+						    // Values from a producer must arrive in order for any one consumer.
+						    const i32 producer = values[i] >> 24;
+						    const i32 value = values[i] & 0xffffff;
+						    data->success_ &= value > lastValue[producer];
+						    lastValue[producer] = value;
+						    data->sum_ += value;
+					    }
+					    AtomicAdd(data->numDequeued_, count);
+				    }
+				    return 0;
+				},
+			    &consumerData[i], 64 * 1024);
+		}
+
+		for(i32 i = 0; i < numProducers; ++i)
+		{
+			producerData[i] = {&queue, i, numValues, batchSize, nullptr, 0, 0, true};
+			threads[numConsumers + i] = Thread(
+			    [](void* userData) -> int {
+				    auto* data = (ThreadData*)userData;
+				    i32 values[MAX_BATCH];
+				    for(i32 i = 0; i < data->numValues_; i += data->batchSize_)
+				    {
+					    const i32 count = Core::Min(data->batchSize_, data->numValues_ - i);
+					    for(i32 j = 0; j < count; ++j)
+						    values[j] = (data->idx_ << 24) | (i + j);
+					    QueueOps<QUEUE>::Enqueue(*data->queue_, values, count);
+				    }
+				    return 0;
+				},
+			    &producerData[i], 64 * 1024);
+		}
+
+		for(auto& thread : threads)
+			thread.Join();
+		const f64 time = timer.GetTime();
+
+		bool success = numDequeued == numValues * numProducers;
+		i64 sum = 0;
+		for(const auto& data : consumerData)
+		{
+			success &= data.success_;
+			sum += data.sum_;
+		}
+		success &= sum == ((i64)numValues * (numValues - 1) / 2) * numProducers;
+		return success ? time : -1.0;
+	}
+} // namespace
+
+TEST_CASE("queue-tests-mpmc")
+{
+	MPMCBoundedQueue<i32> queue(8);
+	i32 value = 0;
+	REQUIRE(!queue.Dequeue(value));
+	REQUIRE(queue.Enqueue(1));
+	REQUIRE(queue.Dequeue(value));
+	REQUIRE(value == 1);
+
+	SECTION("batch")
+	{
+		const i32 values[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+		REQUIRE(queue.Enqueue(values, 6) == 6);
+		REQUIRE(queue.Enqueue(values + 6, 4) == 2);
+		REQUIRE(!queue.Enqueue(0));
+
+		i32 outValues[10] = {};
+		REQUIRE(queue.Dequeue(outValues, 3) == 3);
+		REQUIRE(queue.Dequeue(outValues + 3, 10) == 5);
+		REQUIRE(queue.Dequeue(outValues, 10) == 0);
+		for(i32 i = 0; i < 8; ++i)
+			REQUIRE(outValues[i] == i);
+	}
+
+	SECTION("threads")
+	{
+		MPMCBoundedQueue<i32> threadQueue(256);
+		REQUIRE(RunProducersConsumers(threadQueue, 2, 2, 100000, 1) >= 0.0);
+		REQUIRE(RunProducersConsumers(threadQueue, 2, 2, 100000, 16) >= 0.0);
+	}
+}
+
+TEST_CASE("queue-tests-spsc")
+{
+	SPSCQueue<i32> queue(8);
+	i32 value = 0;
+	REQUIRE(!queue.Dequeue(value));
+	REQUIRE(queue.Enqueue(1));
+	REQUIRE(queue.Dequeue(value));
+	REQUIRE(value == 1);
+
+	SECTION("batch")
+	{
+		// Wrap around the end of the ring a few times.
+		const i32 values[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+		for(i32 i = 0; i < 4; ++i)
+		{
+			REQUIRE(queue.Enqueue(values, 6) == 6);
+			REQUIRE(queue.Enqueue(values + 6, 4) == 2);
+			REQUIRE(!queue.Enqueue(0));
+
+			i32 outValues[10] = {};
+			REQUIRE(queue.Dequeue(outValues, 3) == 3);
+			REQUIRE(queue.Dequeue(outValues + 3, 10) == 5);
+			REQUIRE(queue.Dequeue(outValues, 10) == 0);
+			for(i32 j = 0; j < 8; ++j)
+				REQUIRE(outValues[j] == j);
+		}
+	}
+
+	SECTION("threads")
+	{
+		SPSCQueue<i32> threadQueue(256);
+		REQUIRE(RunProducersConsumers(threadQueue, 1, 1, 100000, 1) >= 0.0);
+		REQUIRE(RunProducersConsumers(threadQueue, 1, 1, 100000, 16) >= 0.0);
+	}
+}
+
+TEST_CASE("queue-tests-mpsc")
+{
+	MPSCQueue<i32> queue;
+	i32 value = 0;
+	REQUIRE(!queue.Dequeue(value));
+	queue.Enqueue(1);
+	REQUIRE(queue.Dequeue(value));
+	REQUIRE(value == 1);
+	REQUIRE(!queue.Dequeue(value));
+
+	SECTION("batch")
+	{
+		// Unbounded, and spanning several segments.
+		Vector<i32> values;
+		for(i32 i = 0; i < 1000; ++i)
+			values.push_back(i);
+		queue.Enqueue(values.data(), 100);
+		for(i32 i = 100; i < 1000; ++i)
+			queue.Enqueue(values[i]);
+
+		Vector<i32> outValues(1000);
+		REQUIRE(queue.Dequeue(outValues.data(), 10) == 10);
+		REQUIRE(queue.Dequeue(outValues.data() + 10, 1000) == 990);
+		REQUIRE(!queue.Dequeue(value));
+		for(i32 i = 0; i < 1000; ++i)
+			REQUIRE(outValues[i] == i);
+	}
+
+	SECTION("threads")
+	{
+		REQUIRE(RunProducersConsumers(queue, 4, 1, 50000, 1) >= 0.0);
+		REQUIRE(RunProducersConsumers(queue, 4, 1, 50000, 16) >= 0.0);
+	}
+
+	SECTION("destruct non-empty")
+	{
+		MPSCQueue<i32> otherQueue;
+		for(i32 i = 0; i < 100; ++i)
+			otherQueue.Enqueue(i);
+	}
+}
+
+TEST_CASE("queue-benchmark", "[.benchmark]")
+{
+	const i32 NUM_VALUES = 1000000;
+	const i32 QUEUE_SIZE = 1024;
+
+	Core::Log("\"queue-benchmark\" (%i values per producer)\n", NUM_VALUES);
+	auto logTime = [](const char* name, i32 numProducers, i32 numConsumers, i32 batchSize, f64 time) {
+		Core::Log("\t%s %ip/%ic, batch %i: %f ms (%f ns/value)\n", name, numProducers, numConsumers, batchSize,
+		    time * 1000.0, time * 1000000000.0 / ((f64)NUM_VALUES * numProducers));
+	};
+
+	for(i32 batchSize : {1, 16})
+	{
+		{
+			MPMCBoundedQueue<i32> queue(QUEUE_SIZE);
+			logTime("mpmc", 1, 1, batchSize, RunProducersConsumers(queue, 1, 1, NUM_VALUES, batchSize));
+		}
+		{
+			SPSCQueue<i32> queue(QUEUE_SIZE);
+			logTime("spsc", 1, 1, batchSize, RunProducersConsumers(queue, 1, 1, NUM_VALUES, batchSize));
+		}
+		{
+			MPSCQueue<i32> queue;
+			logTime("mpsc", 1, 1, batchSize, RunProducersConsumers(queue, 1, 1, NUM_VALUES, batchSize));
+		}
+		{
+			MPMCBoundedQueue<i32> queue(QUEUE_SIZE);
+			logTime("mpmc", 4, 1, batchSize, RunProducersConsumers(queue, 4, 1, NUM_VALUES, batchSize));
+		}
+		{
+			MPSCQueue<i32> queue;
+			logTime("mpsc", 4, 1, batchSize, RunProducersConsumers(queue, 4, 1, NUM_VALUES, batchSize));
+		}
+		{
+			MPMCBoundedQueue<i32> queue(QUEUE_SIZE);
+			logTime("mpmc", 4, 4, batchSize, RunProducersConsumers(queue, 4, 4, NUM_VALUES, batchSize));
+		}
+	}
+}
@@ -0,0 +1,207 @@
+#include "core/slot_map.h"
+#include "core/debug.h"
+#include "core/random.h"
+#include "core/timer.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+using namespace Core;
+
+namespace
+{
+	struct CtorDtorTest
+	{
+		static i32 numAllocs_;
+		CtorDtorTest(i32 value = -1)
+		    : value_(value)
+		{
+			numAllocs_++;
+		}
+		CtorDtorTest(const CtorDtorTest& other)
+		    : value_(other.value_)
+		{
+			numAllocs_++;
+		}
+		CtorDtorTest(CtorDtorTest&& other)
+		    : value_(other.value_)
+		{
+			numAllocs_++;
+		}
+		~CtorDtorTest() { --numAllocs_; }
+		CtorDtorTest& operator=(CtorDtorTest&& other)
+		{
+			value_ = other.value_;
+			return *this;
+		}
+
+		i32 value_ = -1;
+	};
+
+	i32 CtorDtorTest::numAllocs_ = 0;
+} // namespace
+
+TEST_CASE("slot-map-tests-insert-erase")
+{
+	SlotMap<i32> slotMap;
+	REQUIRE(slotMap.empty());
+
+	Handle handle0 = slotMap.insert(0);
+	Handle handle1 = slotMap.insert(1);
+	Handle handle2 = slotMap.emplace(2);
+	REQUIRE(slotMap.size() == 3);
+	REQUIRE(handle0 != handle1);
+	REQUIRE(slotMap[handle0] == 0);
+	REQUIRE(slotMap[handle1] == 1);
+	REQUIRE(*slotMap.find(handle2) == 2);
+
+	// Erasing from the middle keeps values dense.
+	REQUIRE(slotMap.erase(handle0));
+	REQUIRE(!slotMap.erase(handle0));
+	REQUIRE(!slotMap.contains(handle0));
+	REQUIRE(slotMap.find(handle0) == nullptr);
+	REQUIRE(slotMap.size() == 2);
+	REQUIRE(slotMap[handle1] == 1);
+	REQUIRE(slotMap[handle2] == 2);
+
+	// Slot is reused with a new magic ID.
+	Handle handle3 = slotMap.insert(3);
+	REQUIRE(handle3.GetIndex() == handle0.GetIndex());
+	REQUIRE(handle3 != handle0);
+	REQUIRE(!slotMap.contains(handle0));
+	REQUIRE(slotMap[handle3] == 3);
+
+	slotMap.clear();
+	REQUIRE(slotMap.empty());
+	REQUIRE(!slotMap.contains(handle1));
+	REQUIRE(!slotMap.contains(handle3));
+	REQUIRE(!slotMap.contains(Handle()));
+}
+
+TEST_CASE("slot-map-tests-types")
+{
+	SlotMap<i32> slotMap0(0);
+	SlotMap<i32> slotMap1(1);
+
+	Handle handle0 = slotMap0.insert(0);
+	Handle handle1 = slotMap1.insert(1);
+	REQUIRE(handle0.GetType() == 0);
+	REQUIRE(handle1.GetType() == 1);
+	REQUIRE(handle0.GetIndex() == handle1.GetIndex());
+	REQUIRE(!slotMap0.contains(handle1));
+	REQUIRE(!slotMap1.contains(handle0));
+}
+
+TEST_CASE("slot-map-tests-iterate")
+{
+	SlotMap<i32> slotMap;
+	Vector<Handle> handles;
+	for(i32 i = 0; i < 100; ++i)
+		handles.push_back(slotMap.insert(i));
+	for(i32 i = 0; i < 100; i += 3)
+		slotMap.erase(handles[i]);
+
+	// Iteration visits only live values, and GetHandle maps back to them.
+	i32 count = 0;
+	for(auto it = slotMap.begin(); it != slotMap.end(); ++it)
+	{
+		REQUIRE((*it % 3) != 0);
+		Handle handle = slotMap.GetHandle(it);
+		REQUIRE(handle == handles[*it]);
+		REQUIRE(&slotMap[handle] == it);
+		++count;
+	}
+	REQUIRE(count == slotMap.size());
+	REQUIRE(count == 66);
+}
+
+TEST_CASE("slot-map-tests-random")
+{
+	CtorDtorTest::numAllocs_ = 0;
+	{
+		SlotMap<CtorDtorTest> slotMap;
+		Vector<Handle> handles;
+		Vector<i32> values;
+		Random random;
+		for(i32 i = 0; i < 10000; ++i)
+		{
+			if(handles.size() == 0 || ((u32)random.Generate() % 3) != 0)
+			{
+				handles.push_back(slotMap.insert(CtorDtorTest(i)));
+				values.push_back(i);
+			}
+			else
+			{
+				const i32 idx = (i32)((u32)random.Generate() % (u32)handles.size());
+				REQUIRE(slotMap.erase(handles[idx]));
+				REQUIRE(!slotMap.contains(handles[idx]));
+				handles[idx] = handles.back();
+				values[idx] = values.back();
+				handles.pop_back();
+				values.pop_back();
+			}
+		}
+
+		REQUIRE(slotMap.size() == handles.size());
+		for(i32 i = 0; i < handles.size(); ++i)
+			REQUIRE(slotMap[handles[i]].value_ == values[i]);
+		REQUIRE(CtorDtorTest::numAllocs_ == slotMap.size());
+	}
+	REQUIRE(CtorDtorTest::numAllocs_ == 0);
+}
+
+TEST_CASE("slot-map-tests-full")
+{
+	SlotMap<i32> slotMap;
+	for(i32 i = 0; i < Handle::MAX_INDEX; ++i)
+		slotMap.insert(i);
+	REQUIRE(slotMap.size() == Handle::MAX_INDEX);
+	REQUIRE(slotMap.insert(0) == Handle());
+}
+
+TEST_CASE("slot-map-benchmark-iterate", "[.benchmark]")
+{
+	const i32 NUM_VALUES = 16384;
+	const i32 NUM_ITERATIONS = 1000;
+
+	struct Value
+	{
+		bool valid_ = false;
+		f32 data_[7] = {};
+	};
+
+	// Half live, scattered, as a resource table tends to become after churn.
+	Vector<Value> sparse(NUM_VALUES);
+	SlotMap<Value> slotMap;
+	Random random;
+	for(i32 i = 0; i < NUM_VALUES; ++i)
+	{
+		if((u32)random.Generate() % 2)
+		{
+			sparse[i].valid_ = true;
+			sparse[i].data_[0] = (f32)i;
+			slotMap.insert(sparse[i]);
+		}
+	}
+
+	Core::Log("\"slot-map-benchmark-iterate\" (%i live of %i)\n", slotMap.size(), NUM_VALUES);
+	Timer timer;
+	f64 sparseSum = 0.0;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		for(const auto& value : sparse)
+			if(value.valid_)
+				sparseSum += value.data_[0];
+	const f64 sparseTime = timer.GetTime();
+
+	f64 slotMapSum = 0.0;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		for(const auto& value : slotMap)
+			slotMapSum += value.data_[0];
+	const f64 slotMapTime = timer.GetTime();
+
+	Core::Log("\tsparse vector: %f ms\n\tslot map: %f ms\n", sparseTime * 1000.0 / NUM_ITERATIONS,
+	    slotMapTime * 1000.0 / NUM_ITERATIONS);
+	REQUIRE(sparseSum == slotMapSum);
+}
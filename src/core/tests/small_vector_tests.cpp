@@ -0,0 +1,219 @@
+#include "core/small_vector.h"
+#include "core/debug.h"
+#include "core/timer.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+#include <utility>
+
+using namespace Core;
+
+namespace
+{
+	struct CtorDtorTest
+	{
+		static i32 numAllocs_;
+		CtorDtorTest(i32 value = -1)
+		    : value_(value)
+		{
+			numAllocs_++;
+		}
+		CtorDtorTest(const CtorDtorTest& other)
+		    : value_(other.value_)
+		{
+			numAllocs_++;
+		}
+		CtorDtorTest(CtorDtorTest&& other)
+		    : value_(other.value_)
+		{
+			other.value_ = -1;
+			numAllocs_++;
+		}
+		~CtorDtorTest() { --numAllocs_; }
+		CtorDtorTest& operator=(const CtorDtorTest& other)
+		{
+			value_ = other.value_;
+			return *this;
+		}
+		CtorDtorTest& operator=(CtorDtorTest&& other)
+		{
+			value_ = other.value_;
+			other.value_ = -1;
+			return *this;
+		}
+
+		i32 value_ = -1;
+	};
+
+	i32 CtorDtorTest::numAllocs_ = 0;
+
+	struct AllocatorTest : public Core::Allocator
+	{
+		static i32 numAllocs_;
+
+		void* allocate(index_type count, index_type size)
+		{
+			++numAllocs_;
+			return Core::Allocator::allocate(count, size);
+		}
+
+		void deallocate(void* mem, index_type count, index_type size)
+		{
+			if(mem)
+				--numAllocs_;
+			Core::Allocator::deallocate(mem, count, size);
+		}
+	};
+
+	i32 AllocatorTest::numAllocs_ = 0;
+} // namespace
+
+TEST_CASE("small-vector-tests-inline")
+{
+	using TestVector = SmallVector<i32, 8, AllocatorTest>;
+	{
+		TestVector vec;
+		REQUIRE(vec.empty());
+		REQUIRE(vec.capacity() == 8);
+
+		// Inline elements don't allocate.
+		for(i32 i = 0; i < 8; ++i)
+			vec.push_back(i);
+		REQUIRE(AllocatorTest::numAllocs_ == 0);
+		REQUIRE(vec.size() == 8);
+
+		// Growing past inline capacity moves to the heap.
+		vec.push_back(8);
+		REQUIRE(AllocatorTest::numAllocs_ == 1);
+		REQUIRE(vec.capacity() > 8);
+		for(i32 i = 0; i < vec.size(); ++i)
+			REQUIRE(vec[i] == i);
+
+		// Shrinking to fit moves back inline when it can.
+		vec.pop_back();
+		vec.shrink_to_fit();
+		REQUIRE(AllocatorTest::numAllocs_ == 0);
+		REQUIRE(vec.capacity() == 8);
+		for(i32 i = 0; i < vec.size(); ++i)
+			REQUIRE(vec[i] == i);
+	}
+	REQUIRE(AllocatorTest::numAllocs_ == 0);
+}
+
+TEST_CASE("small-vector-tests-copy-move")
+{
+	using TestVector = SmallVector<CtorDtorTest, 4>;
+	for(i32 numValues : {2, 10})
+	{
+		{
+			TestVector vec;
+			for(i32 i = 0; i < numValues; ++i)
+				vec.emplace_back(i);
+
+			TestVector copied(vec);
+			REQUIRE(CtorDtorTest::numAllocs_ == numValues * 2);
+
+			TestVector moved(std::move(vec));
+			REQUIRE(vec.empty());
+			REQUIRE(CtorDtorTest::numAllocs_ == numValues * 2);
+
+			TestVector assigned;
+			assigned.emplace_back(-1);
+			assigned = copied;
+			REQUIRE(CtorDtorTest::numAllocs_ == numValues * 3);
+
+			copied.swap(vec);
+			REQUIRE(copied.empty());
+			REQUIRE(vec.size() == numValues);
+
+			for(i32 i = 0; i < numValues; ++i)
+			{
+				REQUIRE(vec[i].value_ == i);
+				REQUIRE(moved[i].value_ == i);
+				REQUIRE(assigned[i].value_ == i);
+			}
+
+			moved = std::move(assigned);
+			REQUIRE(assigned.empty());
+			REQUIRE(CtorDtorTest::numAllocs_ == numValues * 2);
+			for(i32 i = 0; i < numValues; ++i)
+				REQUIRE(moved[i].value_ == i);
+		}
+		REQUIRE(CtorDtorTest::numAllocs_ == 0);
+	}
+}
+
+TEST_CASE("small-vector-tests-resize-erase-insert")
+{
+	{
+		SmallVector<CtorDtorTest, 4> vec;
+		vec.resize(10);
+		REQUIRE(CtorDtorTest::numAllocs_ == 10);
+		for(i32 i = 0; i < vec.size(); ++i)
+			vec[i].value_ = i;
+
+		vec.erase(vec.begin() + 2, vec.begin() + 8);
+		REQUIRE(vec.size() == 4);
+		REQUIRE(CtorDtorTest::numAllocs_ == 4);
+		const i32 expected[] = {0, 1, 8, 9};
+		for(i32 i = 0; i < vec.size(); ++i)
+			REQUIRE(vec[i].value_ == expected[i]);
+
+		vec.erase(vec.begin());
+		REQUIRE(vec.front().value_ == 1);
+		vec.resize(1);
+		REQUIRE(CtorDtorTest::numAllocs_ == 1);
+
+		vec.insert(vec.begin(), vec.begin());
+		REQUIRE(vec.size() == 1);
+		CtorDtorTest values[8];
+		for(i32 i = 0; i < 8; ++i)
+			values[i].value_ = i;
+		vec.insert(values, values + 8);
+		REQUIRE(vec.size() == 9);
+		REQUIRE(vec.back().value_ == 7);
+	}
+	REQUIRE(CtorDtorTest::numAllocs_ == 0);
+
+	SmallVector<u8, 16> bytes;
+	bytes.resize_uninitialized(100);
+	REQUIRE(bytes.size() == 100);
+}
+
+TEST_CASE("small-vector-benchmark", "[.benchmark]")
+{
+	const i32 NUM_ITERATIONS = 100000;
+	const i32 NUM_VALUES = 8;
+
+	// Short lived short lists, as built while gathering per-object data.
+	Timer timer;
+	i64 vectorSum = 0;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		Vector<i32> vec;
+		for(i32 j = 0; j < NUM_VALUES; ++j)
+			vec.push_back(i + j);
+		for(i32 value : vec)
+			vectorSum += value;
+	}
+	const f64 vectorTime = timer.GetTime();
+
+	i64 smallVectorSum = 0;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		SmallVector<i32, NUM_VALUES> vec;
+		for(i32 j = 0; j < NUM_VALUES; ++j)
+			vec.push_back(i + j);
+		for(i32 value : vec)
+			smallVectorSum += value;
+	}
+	const f64 smallVectorTime = timer.GetTime();
+
+	Core::Log("\"small-vector-benchmark\" (%i values)\n", NUM_VALUES);
+	Core::Log("\tVector: %f ns/list\n\tSmallVector: %f ns/list\n", vectorTime * 1000000000.0 / NUM_ITERATIONS,
+	    smallVectorTime * 1000000000.0 / NUM_ITERATIONS);
+	REQUIRE(vectorSum == smallVectorSum);
+}
@@ -0,0 +1,105 @@
+#include "core/concurrency.h"
+#include "core/map.h"
+#include "core/string_id.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace Core;
+
+TEST_CASE("string-id-tests-basic")
+{
+	StringId empty;
+	REQUIRE(empty.empty());
+	REQUIRE(empty.size() == 0);
+	REQUIRE(strcmp(empty.c_str(), "") == 0);
+	REQUIRE(StringId("") == empty);
+	REQUIRE(StringId(nullptr) == empty);
+
+	StringId a("textures/test.png");
+	StringId b("textures/test.png");
+	StringId c("textures/other.png");
+	REQUIRE(a == b);
+	REQUIRE(a != c);
+	REQUIRE(a.c_str() == b.c_str());
+	REQUIRE(strcmp(a.c_str(), "textures/test.png") == 0);
+	REQUIRE(a.size() == (i32)strlen("textures/test.png"));
+	REQUIRE(a.GetHash() == Hash(0, "textures/test.png"));
+
+	// Substrings intern to the same entry as the equivalent null terminated string.
+	REQUIRE(StringId("textures/test.png.bak", a.size()) == a);
+}
+
+TEST_CASE("string-id-tests-find")
+{
+	REQUIRE(StringId::Find("string-id-tests-find-never-interned").empty());
+	StringId a("string-id-tests-find-interned");
+	REQUIRE(StringId::Find("string-id-tests-find-interned") == a);
+}
+
+TEST_CASE("string-id-tests-map")
+{
+	Map<StringId, i32> map;
+	char name[64];
+	for(i32 i = 0; i < 1000; ++i)
+	{
+		sprintf_s(name, sizeof(name), "string-id-tests-map-%i", i);
+		map.insert(StringId(name), i);
+	}
+
+	for(i32 i = 0; i < 1000; ++i)
+	{
+		sprintf_s(name, sizeof(name), "string-id-tests-map-%i", i);
+		auto it = map.find(StringId(name));
+		REQUIRE(it != map.end());
+		REQUIRE(it->second == i);
+	}
+}
+
+TEST_CASE("string-id-tests-large")
+{
+	Vector<char> large;
+	large.resize(128 * 1024, 'a');
+	large.push_back('\0');
+	StringId a(large.data());
+	REQUIRE(a.size() == large.size() - 1);
+	REQUIRE(StringId(large.data()) == a);
+}
+
+TEST_CASE("string-id-tests-threads")
+{
+	static const i32 NUM_THREADS = 4;
+	static const i32 NUM_STRINGS = 1000;
+
+	// Each thread interns the same strings, and must get the same StringIds.
+	struct ThreadData
+	{
+		Vector<StringId> ids_;
+	};
+	Vector<ThreadData> threadData(NUM_THREADS);
+	Vector<Thread> threads(NUM_THREADS);
+	for(i32 i = 0; i < NUM_THREADS; ++i)
+	{
+		threads[i] = Thread(
+		    [](void* userData) -> int {
+			    auto* data = static_cast<ThreadData*>(userData);
+			    char name[64];
+			    for(i32 j = 0; j < NUM_STRINGS; ++j)
+			    {
+				    sprintf_s(name, sizeof(name), "string-id-tests-threads-%i", j);
+				    data->ids_.push_back(StringId(name));
+			    }
+			    return 0;
+			},
+		    &threadData[i], 64 * 1024);
+	}
+	for(auto& thread : threads)
+		thread.Join();
+
+	for(i32 i = 1; i < NUM_THREADS; ++i)
+		for(i32 j = 0; j < NUM_STRINGS; ++j)
+			REQUIRE(threadData[i].ids_[j] == threadData[0].ids_[j]);
+}
@@ -110,3 +110,59 @@ TEST_CASE("string-test-hash")
 	Core::String str1("Test hash");
 	REQUIRE(Core::Hash(0, str1) == Core::Hash(0, "Test hash"));
 }
+
+TEST_CASE("string-test-sso")
+{
+	const int ssoCapacity = Core::String::SSO_CAPACITY;
+	Core::String str1("Short name");
+	REQUIRE(str1.capacity() == ssoCapacity);
+
+	// Grows onto the heap once past SSO_CAPACITY.
+	std::string str1_ref("Short name");
+	for(int i = 0; i < 8; ++i)
+	{
+		str1 += ", longer";
+		str1_ref += ", longer";
+		REQUIRE(str1.size() == str1_ref.size());
+		REQUIRE(str1 == str1_ref.c_str());
+	}
+	REQUIRE(str1.capacity() > ssoCapacity);
+
+	// Copy and move between inline and heap strings.
+	Core::String str2(str1);
+	REQUIRE(str2 == str1);
+	Core::String str3("Inline");
+	str3 = std::move(str2);
+	REQUIRE(str3 == str1);
+	REQUIRE(str2 == "Inline");
+	str3.swap(str2);
+	REQUIRE(str3 == "Inline");
+	REQUIRE(str2 == str1);
+
+	// Assigning a short string keeps the heap allocation.
+	str2 = "Short";
+	REQUIRE(str2.size() == 5);
+	REQUIRE(str2 == "Short");
+	REQUIRE(str2.capacity() > ssoCapacity);
+
+	str2.clear();
+	REQUIRE(str2.empty());
+	REQUIRE(str2 == "");
+
+	// Appending to self.
+	Core::String str4("12345678901234567890");
+	str4 += str4;
+	REQUIRE(str4 == "1234567890123456789012345678901234567890");
+}
+
+TEST_CASE("string-test-compare-string")
+{
+	Core::String str1("Same length A");
+	Core::String str2("Same length B");
+	Core::String str3("Same length A");
+	REQUIRE(str1 != str2);
+	REQUIRE(str1 == str3);
+	REQUIRE(str1 < str2);
+	REQUIRE(Core::String() == Core::String(""));
+	REQUIRE(Core::String().c_str() != nullptr);
+}
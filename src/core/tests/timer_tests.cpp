@@ -0,0 +1,40 @@
+#include "core/timer.h"
+#include "core/concurrency.h"
+
+#include "catch.hpp"
+
+using namespace Core;
+
+TEST_CASE("timer-tests-monotonic")
+{
+	i64 lastTime = Timer::GetAbsoluteTimeNS();
+	u64 lastCycles = Timer::GetCycleCount();
+	bool success = true;
+	for(i32 i = 0; i < 1000; ++i)
+	{
+		const i64 time = Timer::GetAbsoluteTimeNS();
+		const u64 cycles = Timer::GetCycleCount();
+		success &= time >= lastTime;
+		success &= cycles >= lastCycles;
+		lastTime = time;
+		lastCycles = cycles;
+	}
+	REQUIRE(success);
+}
+
+TEST_CASE("timer-tests-elapsed")
+{
+	const f64 freq = Timer::GetCycleFrequency();
+	REQUIRE(freq > 0.0);
+
+	Timer timer;
+	timer.Mark();
+	const u64 beginCycles = Timer::GetCycleCount();
+	Sleep(0.01);
+	const f64 time = timer.GetTime();
+	const f64 cycleTime = (f64)(Timer::GetCycleCount() - beginCycles) / freq;
+
+	// Sleep may overrun, but can't return early.
+	REQUIRE(time >= 0.009);
+	REQUIRE(cycleTime == Approx(time).epsilon(0.1));
+}
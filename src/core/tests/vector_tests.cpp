@@ -1,8 +1,14 @@
 #include "core/array.h"
+#include "core/debug.h"
+#include "core/string.h"
+#include "core/timer.h"
 #include "core/vector.h"
 
 #include "catch.hpp"
 
+#include <string>
+#include <vector>
+
 using namespace Core;
 
 namespace
@@ -823,4 +829,288 @@ TEST_CASE("vector-tests-allocator-test")
 		}
 		REQUIRE(AllocatorTest::numBytes_ == 0);
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("vector-tests-relocatable")
+{
+	static_assert(IsTriviallyRelocatable<i32>::value, "i32 should be relocatable.");
+	static_assert(IsTriviallyRelocatable<Vector<std::string>>::value, "Vector should be relocatable.");
+	static_assert(IsTriviallyRelocatable<String>::value, "String should be relocatable.");
+	static_assert(!IsTriviallyRelocatable<CtorDtorTest>::value, "CtorDtorTest shouldn't be relocatable.");
+
+	SECTION("vector")
+	{
+		// Inner vectors are relocated with memcpy as the outer one grows.
+		Vector<Vector<i32>> vec;
+		for(i32 i = 0; i < 100; ++i)
+		{
+			vec.emplace_back();
+			for(i32 j = 0; j <= i; ++j)
+				vec.back().push_back(j);
+		}
+
+		bool success = true;
+		for(i32 i = 0; i < vec.size(); ++i)
+		{
+			success &= vec[i].size() == i + 1;
+			for(i32 j = 0; j <= i; ++j)
+				success &= vec[i][j] == j;
+		}
+		REQUIRE(success);
+	}
+
+	SECTION("string")
+	{
+		// Mix of inline and heap strings.
+		Vector<String> vec;
+		for(i32 i = 0; i < 100; ++i)
+		{
+			String str;
+			for(i32 j = 0; j < i % 40; ++j)
+				str.append("a");
+			vec.push_back(std::move(str));
+		}
+
+		bool success = true;
+		for(i32 i = 0; i < vec.size(); ++i)
+			success &= vec[i].size() == i % 40;
+		vec.erase(vec.begin(), vec.begin() + 50);
+		for(i32 i = 0; i < vec.size(); ++i)
+			success &= vec[i].size() == (i + 50) % 40;
+		REQUIRE(success);
+	}
+}
+
+TEST_CASE("vector-tests-erase-range")
+{
+	SECTION("trivial")
+	{
+		Vector<i32> vec;
+		for(i32 i = 0; i < 10; ++i)
+			vec.push_back(i);
+
+		auto it = vec.erase(vec.begin() + 2, vec.begin() + 5);
+		REQUIRE(it == vec.begin() + 2);
+		REQUIRE(vec.size() == 7);
+		const i32 expected[] = {0, 1, 5, 6, 7, 8, 9};
+		for(i32 i = 0; i < vec.size(); ++i)
+			REQUIRE(vec[i] == expected[i]);
+
+		it = vec.erase(vec.begin() + 3, vec.begin() + 3);
+		REQUIRE(it == vec.begin() + 3);
+		REQUIRE(vec.size() == 7);
+
+		it = vec.erase(vec.begin() + 4, vec.end());
+		REQUIRE(it == vec.end());
+		REQUIRE(vec.size() == 4);
+
+		vec.erase(vec.begin(), vec.end());
+		REQUIRE(vec.empty());
+	}
+
+	SECTION("non-trivial")
+	{
+		{
+			Vector<CtorDtorTest> vec;
+			for(i32 i = 0; i < 10; ++i)
+				vec.emplace_back(i);
+			REQUIRE(CtorDtorTest::numAllocs_ == 10);
+
+			vec.erase(vec.begin() + 1, vec.begin() + 4);
+			REQUIRE(CtorDtorTest::numAllocs_ == 7);
+			const i32 expected[] = {0, 4, 5, 6, 7, 8, 9};
+			for(i32 i = 0; i < vec.size(); ++i)
+				REQUIRE(vec[i] == expected[i]);
+		}
+		REQUIRE(CtorDtorTest::numAllocs_ == 0);
+	}
+}
+
+TEST_CASE("vector-tests-insert")
+{
+	SECTION("trivial")
+	{
+		const i32 values[] = {0, 1, 2, 3, 4, 5, 6, 7};
+		Vector<i32> vec;
+		auto it = vec.insert(values, values + 8);
+		REQUIRE(*it == 7);
+		vec.insert(values, values);
+		REQUIRE(vec.size() == 8);
+
+		// Appending a little at a time grows geometrically, rather than to the exact size each time.
+		vec.shrink_to_fit();
+		REQUIRE(vec.capacity() == 8);
+		vec.insert(values, values + 1);
+		REQUIRE(vec.capacity() >= 12);
+		const i32 capacity = vec.capacity();
+		vec.insert(values, values + 1);
+		REQUIRE(vec.capacity() == capacity);
+
+		for(i32 i = 0; i < 8; ++i)
+			REQUIRE(vec[i] == i);
+		REQUIRE(vec[8] == 0);
+		REQUIRE(vec[9] == 0);
+	}
+
+	SECTION("non-trivial")
+	{
+		{
+			Vector<CtorDtorTest> src;
+			for(i32 i = 0; i < 10; ++i)
+				src.emplace_back(i);
+
+			Vector<CtorDtorTest> vec;
+			for(i32 i = 0; i < 10; ++i)
+				vec.insert(src.begin(), src.end());
+			REQUIRE(CtorDtorTest::numAllocs_ == 110);
+			for(i32 i = 0; i < vec.size(); ++i)
+				REQUIRE(vec[i] == i % 10);
+		}
+		REQUIRE(CtorDtorTest::numAllocs_ == 0);
+	}
+}
+
+TEST_CASE("vector-tests-resize-uninitialized")
+{
+	Vector<u8> vec;
+	vec.resize_uninitialized(100);
+	REQUIRE(vec.size() == 100);
+	for(i32 i = 0; i < vec.size(); ++i)
+		vec[i] = (u8)i;
+
+	vec.resize_uninitialized(200);
+	REQUIRE(vec.size() == 200);
+	vec.resize_uninitialized(50);
+	REQUIRE(vec.size() == 50);
+
+	bool success = true;
+	for(i32 i = 0; i < vec.size(); ++i)
+		success &= vec[i] == (u8)i;
+	REQUIRE(success);
+}
+
+TEST_CASE("vector-benchmark", "[.benchmark]")
+{
+	const i32 NUM_VALUES = 1000000;
+	const i32 NUM_ITERATIONS = 10;
+
+	Core::Log("\"vector-benchmark\" (%i values)\n", NUM_VALUES);
+	Timer timer;
+	auto logTime = [&timer](const char* name, f64 stdTime, f64 coreTime) {
+		Core::Log("\t%s: std::vector %f ms, Core::Vector %f ms\n", name, stdTime * 1000.0 / NUM_ITERATIONS,
+		    coreTime * 1000.0 / NUM_ITERATIONS);
+	};
+
+	// Growth from empty, where relocation dominates.
+	{
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			std::vector<i32> vec;
+			for(i32 j = 0; j < NUM_VALUES; ++j)
+				vec.push_back(j);
+		}
+		const f64 stdTime = timer.GetTime();
+
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			Vector<i32> vec;
+			for(i32 j = 0; j < NUM_VALUES; ++j)
+				vec.push_back(j);
+		}
+		logTime("push_back i32", stdTime, timer.GetTime());
+	}
+
+	{
+		const i32 NUM_STRINGS = NUM_VALUES / 10;
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			std::vector<std::string> vec;
+			for(i32 j = 0; j < NUM_STRINGS; ++j)
+				vec.emplace_back("string");
+		}
+		const f64 stdTime = timer.GetTime();
+
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			Vector<String> vec;
+			for(i32 j = 0; j < NUM_STRINGS; ++j)
+				vec.emplace_back("string");
+		}
+		logTime("push_back string", stdTime, timer.GetTime());
+	}
+
+	// Appending in small batches.
+	{
+		const i32 values[] = {0, 1, 2, 3, 4, 5, 6, 7};
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			std::vector<i32> vec;
+			for(i32 j = 0; j < NUM_VALUES; j += 8)
+				vec.insert(vec.end(), values, values + 8);
+		}
+		const f64 stdTime = timer.GetTime();
+
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			Vector<i32> vec;
+			for(i32 j = 0; j < NUM_VALUES; j += 8)
+				vec.insert(values, values + 8);
+		}
+		logTime("insert", stdTime, timer.GetTime());
+	}
+
+	// Byte buffer that is about to be overwritten, as texture data is.
+	{
+		u8 sum = 0;
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			std::vector<u8> vec;
+			vec.resize(NUM_VALUES * 16);
+			sum += vec[i];
+		}
+		const f64 stdTime = timer.GetTime();
+
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			Vector<u8> vec;
+			vec.resize_uninitialized(NUM_VALUES * 16);
+			vec[i] = 0;
+			sum += vec[i];
+		}
+		logTime("resize u8", stdTime, timer.GetTime());
+		REQUIRE(sum == 0);
+	}
+
+	// Erasing from the front.
+	{
+		const i32 NUM_ERASES = 1000;
+		std::vector<i32> stdVec;
+		Vector<i32> vec;
+		for(i32 j = 0; j < NUM_VALUES; ++j)
+		{
+			stdVec.push_back(j);
+			vec.push_back(j);
+		}
+
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			for(i32 j = 0; j < NUM_ERASES / NUM_ITERATIONS; ++j)
+				stdVec.erase(stdVec.begin());
+		const f64 stdTime = timer.GetTime();
+
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			for(i32 j = 0; j < NUM_ERASES / NUM_ITERATIONS; ++j)
+				vec.erase(vec.begin());
+		logTime("erase front", stdTime, timer.GetTime());
+		REQUIRE(stdVec.front() == vec.front());
+	}
+}
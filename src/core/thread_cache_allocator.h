@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/allocator.h"
+
+namespace Core
+{
+	/**
+	 * Thread cache allocator.
+	 * Front-end for a thread safe allocator that keeps a cache of free small blocks per thread, so most
+	 * small allocations and deallocations never touch the backing allocator or its lock.
+	 * Blocks freed on a thread go to that thread's cache, whichever thread allocated them.
+	 * Thread safe.
+	 */
+	class CORE_DLL ThreadCacheAllocator final : public IAllocator
+	{
+	public:
+		/// Largest allocation that is cached. Larger go straight to the backing allocator.
+		static const i32 MAX_CACHED_SIZE = 2048;
+
+		/**
+		 * @param backing Thread safe allocator to allocate from. Must outlive this.
+		 */
+		ThreadCacheAllocator(IAllocator& backing);
+		~ThreadCacheAllocator();
+
+		void* Allocate(i64 size, i64 align) override;
+		void Deallocate(void* mem, i64 size) override;
+
+		/**
+		 * Return blocks cached for the calling thread to the backing allocator.
+		 */
+		void Flush();
+
+	private:
+		ThreadCacheAllocator(const ThreadCacheAllocator&) = delete;
+		ThreadCacheAllocator& operator=(const ThreadCacheAllocator&) = delete;
+
+		struct ThreadCacheAllocatorImpl* impl_ = nullptr;
+	};
+
+} // namespace Core
@@ -3,10 +3,19 @@
 #include "core/types.h"
 #include "core/dll.h"
 
+#if ARCH_X86_64 || ARCH_X86
+#if COMPILER_MSVC
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
 namespace Core
 {
 	/**
 	 * High precision timer.
+	 * Times come from a monotonic clock, so are unaffected by changes to the system time.
 	 */
 	class CORE_DLL Timer
 	{
@@ -16,19 +25,46 @@ namespace Core
 		/**
 		 * Mark point of reference.
 		 */
-		void Mark() { start_ = GetAbsoluteTime(); }
+		void Mark() { start_ = GetAbsoluteTimeNS(); }
 
 		/**
 		 * @return seconds since last call to Mark.
 		 */
-		f64 GetTime() { return GetAbsoluteTime() - start_; }
+		f64 GetTime() const { return (f64)(GetAbsoluteTimeNS() - start_) / 1000000000.0; }
 
 		/**
 		 * @return absolute time in seconds.
 		 */
 		static f64 GetAbsoluteTime();
 
+		/**
+		 * @return absolute time in nanoseconds.
+		 */
+		static i64 GetAbsoluteTimeNS();
+
+		/**
+		 * Get CPU cycle counter.
+		 * Much cheaper than GetAbsoluteTimeNS, so suited to timing short scopes. Not serializing, and only
+		 * comparable between threads on CPUs with an invariant TSC. Falls back to GetAbsoluteTimeNS on
+		 * architectures without one.
+		 * @return Cycle count. Use GetCycleFrequency to convert to seconds.
+		 */
+		static u64 GetCycleCount()
+		{
+#if ARCH_X86_64 || ARCH_X86
+			return __rdtsc();
+#else
+			return (u64)GetAbsoluteTimeNS();
+#endif
+		}
+
+		/**
+		 * @return GetCycleCount cycles per second. Calibrated against GetAbsoluteTimeNS on first call, which
+		 * takes a couple of milliseconds.
+		 */
+		static f64 GetCycleFrequency();
+
 	private:
-		f64 start_ = 0;
+		i64 start_ = 0;
 	};
 } // namespace Core
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/allocator.h"
+
+namespace Core
+{
+	/**
+	 * Two-level segregated fit allocator.
+	 * General purpose allocator over a fixed block of memory, with O(1) allocate and deallocate and low
+	 * fragmentation. Free blocks are binned by size class (log2, then linearly within each power of two),
+	 * with bitmaps to find a suitable bin in a couple of bit scans. Neighbouring free blocks are merged
+	 * on deallocate.
+	 * Based on "TLSF: a New Dynamic Memory Allocator for Real-Time Systems", Masmano et al.
+	 * Thread safe.
+	 */
+	class CORE_DLL TLSFAllocator final : public IAllocator
+	{
+	public:
+		/**
+		 * @param capacity Size of memory block to manage in bytes.
+		 */
+		TLSFAllocator(i64 capacity);
+		~TLSFAllocator();
+
+		void* Allocate(i64 size, i64 align) override;
+		void Deallocate(void* mem, i64 size) override;
+
+		/// @return Bytes allocated, including block headers.
+		i64 GetUsage() const;
+		/// @return Size of largest free block. Searches round up to the next size class, so the largest
+		/// allocation that succeeds may be up to 1/16th smaller.
+		i64 GetLargestFree() const;
+
+	private:
+		TLSFAllocator(const TLSFAllocator&) = delete;
+		TLSFAllocator& operator=(const TLSFAllocator&) = delete;
+
+		struct TLSFAllocatorImpl* impl_ = nullptr;
+	};
+
+} // namespace Core
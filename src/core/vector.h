@@ -3,13 +3,125 @@
 #include "core/types.h"
 #include "core/allocator.h"
 #include "core/debug.h"
+#include "core/misc.h"
 
+#include <cstring>
+#include <type_traits>
 #include <utility>
 
 namespace Core
 {
+	/**
+	 * Types that can be moved to a new address by copying their bytes, after which the old address is treated as
+	 * uninitialized storage rather than destructed. True for trivially copyable types. Specialize for types that own
+	 * memory through pointers but never point into themselves, so containers can memcpy them when growing.
+	 */
+	template<typename TYPE>
+	struct IsTriviallyRelocatable
+	{
+		static const bool value = std::is_trivially_copyable<TYPE>::value;
+	};
+
+	/**
+	 * Move @a count elements from @a src to uninitialized, non-overlapping @a dest, and destruct them at @a src.
+	 */
+	template<typename TYPE>
+	void RelocateElements(TYPE* dest, TYPE* src, i32 count, std::true_type)
+	{
+		if(count > 0)
+			memcpy((void*)dest, (const void*)src, sizeof(TYPE) * count);
+	}
+
+	template<typename TYPE>
+	void RelocateElements(TYPE* dest, TYPE* src, i32 count, std::false_type)
+	{
+		for(i32 idx = 0; idx < count; ++idx)
+		{
+			new(dest + idx) TYPE(std::move(src[idx]));
+			src[idx].~TYPE();
+		}
+	}
+
+	template<typename TYPE>
+	void RelocateElements(TYPE* dest, TYPE* src, i32 count)
+	{
+		RelocateElements(dest, src, count, std::integral_constant<bool, IsTriviallyRelocatable<TYPE>::value>());
+	}
+
+	/**
+	 * Copy construct @a count elements from @a src into uninitialized, non-overlapping @a dest.
+	 */
+	template<typename TYPE>
+	void CopyConstructElements(TYPE* dest, const TYPE* src, i32 count, std::true_type)
+	{
+		if(count > 0)
+			memcpy((void*)dest, (const void*)src, sizeof(TYPE) * count);
+	}
+
+	template<typename TYPE>
+	void CopyConstructElements(TYPE* dest, const TYPE* src, i32 count, std::false_type)
+	{
+		for(i32 idx = 0; idx < count; ++idx)
+			new(dest + idx) TYPE(src[idx]);
+	}
+
+	template<typename TYPE>
+	void CopyConstructElements(TYPE* dest, const TYPE* src, i32 count)
+	{
+		using IsTrivial = std::integral_constant<bool, std::is_trivially_copyable<TYPE>::value>;
+		CopyConstructElements(dest, src, count, IsTrivial());
+	}
+
+	/**
+	 * Destruct elements in [first, last).
+	 */
+	template<typename TYPE>
+	void DestructElements(TYPE*, TYPE*, std::true_type)
+	{
+	}
+
+	template<typename TYPE>
+	void DestructElements(TYPE* first, TYPE* last, std::false_type)
+	{
+		for(; first != last; ++first)
+			first->~TYPE();
+	}
+
+	template<typename TYPE>
+	void DestructElements(TYPE* first, TYPE* last)
+	{
+		DestructElements(first, last, std::integral_constant<bool, std::is_trivially_destructible<TYPE>::value>());
+	}
+
+	/**
+	 * Destruct elements in [first, last), and move elements in [last, end) down to first.
+	 */
+	template<typename TYPE>
+	void EraseElements(TYPE* first, TYPE* last, TYPE* end, std::true_type)
+	{
+		DestructElements(first, last);
+		memmove((void*)first, (const void*)last, sizeof(TYPE) * (end - last));
+	}
+
+	template<typename TYPE>
+	void EraseElements(TYPE* first, TYPE* last, TYPE* end, std::false_type)
+	{
+		TYPE* dest = first;
+		for(TYPE* src = last; src != end; ++dest, ++src)
+			*dest = std::move(*src);
+		DestructElements(dest, end);
+	}
+
+	template<typename TYPE>
+	void EraseElements(TYPE* first, TYPE* last, TYPE* end)
+	{
+		EraseElements(first, last, end, std::integral_constant<bool, IsTriviallyRelocatable<TYPE>::value>());
+	}
+
 	/**
 	 * Vector of elements.
+	 * Grows geometrically. Elements are relocated with memcpy when IsTriviallyRelocatable, and elements that are
+	 * trivially destructible aren't destructed.
 	 */
 	template<typename TYPE, typename ALLOCATOR = Allocator>
 	class Vector
@@ -21,13 +133,17 @@ namespace Core
 		using const_iterator = const value_type*;
 
 		Vector() = default;
+		explicit Vector(const ALLOCATOR& allocator)
+		    : allocator_(allocator)
+		{
+		}
 
 		Vector(const Vector& other)
+		    : allocator_(other.allocator_)
 		{
 			internalResize(other.size_);
+			CopyConstructElements(data_, other.data_, other.size_);
 			size_ = other.size_;
-			for(index_type idx = 0; idx < other.size_; ++idx)
-				new(data_ + idx) TYPE(other.data_[idx]);
 		}
 
 		Vector(Vector&& other) { swap(other); }
@@ -41,12 +157,11 @@ namespace Core
 				internalResize(other.size_);
 
 			// destruct
-			destruct(data_, data_ + size_);
+			DestructElements(data_, data_ + size_);
 
 			// reconstruct
+			CopyConstructElements(data_, other.data_, other.size_);
 			size_ = other.size_;
-			for(index_type idx = 0; idx < other.size_; ++idx)
-				new(data_ + idx) TYPE(other.data_[idx]);
 			return *this;
 		}
 
@@ -61,6 +176,7 @@ namespace Core
 			std::swap(data_, other.data_);
 			std::swap(size_, other.size_);
 			std::swap(capacity_, other.capacity_);
+			std::swap(allocator_, other.allocator_);
 		}
 
 		TYPE& operator[](index_type idx)
@@ -77,25 +193,33 @@ namespace Core
 
 		void clear()
 		{
-			destruct(data_, data_ + size_);
+			DestructElements(data_, data_ + size_);
 			size_ = 0;
 		}
 
 		void fill(const TYPE& value)
 		{
-			destruct(data_, data_ + size_);
+			DestructElements(data_, data_ + size_);
 			for(index_type idx = 0; idx < size_; ++idx)
 				new(data_ + idx) TYPE(value);
 		}
 
-		iterator erase(iterator it)
+		iterator erase(iterator it) { return erase(it, it + 1); }
+
+		/**
+		 * Erase elements in [first, last), moving the following elements down.
+		 * @return Iterator to the element that followed the erased range.
+		 */
+		iterator erase(iterator first, iterator last)
 		{
-			DBG_ASSERT_MSG(it >= begin() && it < end(), "Invalid iterator.");
-			for(iterator dstIt = it, srcIt = it + 1; srcIt != end(); ++dstIt, ++srcIt)
-				*dstIt = std::move(*srcIt);
-			--size_;
-			destruct(data_ + size_);
-			return it;
+			DBG_ASSERT_MSG(first >= begin() && first <= last && last <= end(), "Invalid iterator.");
+			const index_type numErased = (index_type)(last - first);
+			if(numErased > 0)
+			{
+				EraseElements(first, last, end());
+				size_ -= numErased;
+			}
+			return first;
 		}
 
 		iterator push_back(const TYPE& value)
@@ -123,16 +247,18 @@ namespace Core
 			return (data_ + size_++);
 		}
 
+		/**
+		 * Append copies of [begin, end). The range must not be within this vector.
+		 * @return Iterator to the last element.
+		 */
 		iterator insert(const_iterator begin, const_iterator end)
 		{
-			i32 numValues = (i32)(end - begin);
+			const index_type numValues = (index_type)(end - begin);
+			DBG_ASSERT_MSG(numValues == 0 || end <= data_ || begin >= data_ + capacity_, "Range is within vector.");
 			if(capacity_ < (size_ + numValues))
-				internalResize(size_ + numValues);
-			for(const_iterator it = begin; it != end; ++it)
-			{
-				new(data_ + size_) TYPE(*it);
-				++size_;
-			}
+				internalResize(Core::Max(size_ + numValues, getGrowCapacity(capacity_)));
+			CopyConstructElements(data_ + size_, begin, numValues);
+			size_ += numValues;
 			return (data_ + size_ - 1);
 		}
 
@@ -140,7 +266,7 @@ namespace Core
 		{
 			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
 			--size_;
-			destruct(data_ + size_);
+			DestructElements(data_ + size_, data_ + size_ + 1);
 		}
 
 		void reserve(index_type capacity)
@@ -167,6 +293,17 @@ namespace Core
 			size_ = size;
 		}
 
+		/**
+		 * Resize without initializing new elements, for buffers that are about to be overwritten.
+		 */
+		void resize_uninitialized(index_type size)
+		{
+			static_assert(std::is_trivial<TYPE>::value, "resize_uninitialized requires a trivial type.");
+			if(size_ != size)
+				internalResize(size);
+			size_ = size;
+		}
+
 		void shrink_to_fit()
 		{
 			if(capacity_ > size_)
@@ -207,6 +344,7 @@ namespace Core
 		index_type size() const noexcept { return size_; }
 		index_type capacity() const noexcept { return capacity_; }
 		bool empty() const noexcept { return size_ == 0; }
+		const ALLOCATOR& get_allocator() const noexcept { return allocator_; }
 
 	private:
 		static index_type getGrowCapacity(index_type CurrCapacity)
@@ -214,21 +352,6 @@ namespace Core
 			return CurrCapacity ? (CurrCapacity + CurrCapacity / 2) : 16;
 		}
 
-		static iterator uninitialized_move(iterator first, iterator last, iterator dest)
-		{
-			for(; first != last; ++dest, ++first)
-				new(dest) TYPE(std::move(*first));
-			return dest;
-		}
-
-		static void destruct(iterator first) { first->~TYPE(); }
-
-		static void destruct(iterator first, iterator last)
-		{
-			for(; first != last; ++first)
-				destruct(first);
-		}
-
 		void internalResize(index_type newCapacity)
 		{
 			index_type copySize = newCapacity < size_ ? newCapacity : size_;
@@ -237,13 +360,12 @@ namespace Core
 			{
 				newData = static_cast<TYPE*>(allocator_.allocate(newCapacity, sizeof(TYPE)));
 				DBG_ASSERT_MSG(newData, "Unable to allocate for resize.");
-				uninitialized_move(data_, data_ + copySize, newData);
-				destruct(data_, data_ + copySize);
+				RelocateElements(newData, data_, copySize);
 			}
 
 			// destruct trailing elements.
 			if(copySize < size_)
-				destruct(data_ + copySize, data_ + size());
+				DestructElements(data_ + copySize, data_ + size_);
 
 			allocator_.deallocate(data_, capacity_, sizeof(TYPE));
 
@@ -260,4 +382,11 @@ namespace Core
 
 		ALLOCATOR allocator_;
 	};
+
+	/// Vector only points to its elements, so is relocatable whatever TYPE is.
+	template<typename TYPE, typename ALLOCATOR>
+	struct IsTriviallyRelocatable<Vector<TYPE, ALLOCATOR>>
+	{
+		static const bool value = IsTriviallyRelocatable<ALLOCATOR>::value;
+	};
 } // namespace Core
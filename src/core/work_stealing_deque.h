@@ -0,0 +1,135 @@
+#pragma once
+
+#include "core/concurrency.h"
+#include "core/debug.h"
+
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Bounded work stealing deque.
+	 * Based on "Dynamic Circular Work-Stealing Deque" by Chase & Lev, with the memory ordering described in
+	 * "Correct and Efficient Work-Stealing for Weak Memory Models" by Le, Pop, Cohen & Zappa Nardelli.
+	 * The owning thread may Push and Pop from the bottom, any thread may Steal from the top.
+	 * Unlike the original algorithm the buffer does not grow, so Push can fail and callers must handle overflow.
+	 */
+	template<typename TYPE>
+	class WorkStealingDeque
+	{
+	public:
+		WorkStealingDeque() = default;
+		WorkStealingDeque(i32 size)
+		    : buffer_(new TYPE[size])
+		    , bufferMask_(size - 1)
+		{
+			DBG_ASSERT((size >= 2) && ((size & (size - 1)) == 0));
+		}
+
+		WorkStealingDeque(WorkStealingDeque&& other)
+		{
+			using std::swap;
+			swap(buffer_, other.buffer_);
+			swap(bufferMask_, other.bufferMask_);
+			swap(top_, other.top_);
+			swap(bottom_, other.bottom_);
+		}
+
+		WorkStealingDeque& operator=(WorkStealingDeque&& other)
+		{
+			using std::swap;
+			swap(buffer_, other.buffer_);
+			swap(bufferMask_, other.bufferMask_);
+			swap(top_, other.top_);
+			swap(bottom_, other.bottom_);
+			return *this;
+		}
+
+		~WorkStealingDeque() { delete[] buffer_; }
+
+		/**
+		 * Push to bottom. Owner thread only.
+		 * @return Successfully pushed. Fails if deque is full.
+		 */
+		bool Push(const TYPE& data)
+		{
+			const i64 bottom = bottom_;
+			const i64 top = Core::AtomicCmpExchgAcq(&top_, 0, 0);
+			if((bottom - top) > bufferMask_)
+				return false;
+
+			buffer_[bottom & bufferMask_] = data;
+			Core::Barrier();
+			bottom_ = bottom + 1;
+			return true;
+		}
+
+		/**
+		 * Pop from bottom. Owner thread only.
+		 * @return Successfully popped.
+		 */
+		bool Pop(TYPE& data)
+		{
+			const i64 bottom = bottom_ - 1;
+			Core::AtomicExchg(&bottom_, bottom);
+			i64 top = top_;
+
+			if(top > bottom)
+			{
+				// Empty, restore bottom.
+				bottom_ = bottom + 1;
+				return false;
+			}
+
+			data = buffer_[bottom & bufferMask_];
+			if(top == bottom)
+			{
+				// Last element, race against thieves for it.
+				const bool won = Core::AtomicCmpExchg(&top_, top + 1, top) == top;
+				bottom_ = bottom + 1;
+				return won;
+			}
+			return true;
+		}
+
+		/**
+		 * Steal from top. Any thread.
+		 * @return Successfully stolen. May fail spuriously if another thief wins.
+		 */
+		bool Steal(TYPE& data)
+		{
+			const i64 top = Core::AtomicCmpExchgAcq(&top_, 0, 0);
+			Core::Barrier();
+			const i64 bottom = bottom_;
+			if(top >= bottom)
+				return false;
+
+			data = buffer_[top & bufferMask_];
+			return Core::AtomicCmpExchg(&top_, top + 1, top) == top;
+		}
+
+		/**
+		 * @return Approximate number of elements. Only a hint when called concurrently.
+		 */
+		i32 Size() const
+		{
+			const i64 size = bottom_ - top_;
+			return size > 0 ? (i32)size : 0;
+		}
+
+	private:
+		typedef char CacheLinePad[CACHE_LINE_SIZE];
+
+		CacheLinePad pad0_ = {0};
+		TYPE* buffer_ = nullptr;
+		i64 bufferMask_ = 0;
+		CacheLinePad pad1_ = {0};
+		volatile i64 top_ = 0;
+		CacheLinePad pad2_ = {0};
+		volatile i64 bottom_ = 0;
+		CacheLinePad pad3_ = {0};
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		void operator=(const WorkStealingDeque&) = delete;
+	};
+} // namespace Core
@@ -3,6 +3,7 @@
 #include "gpu/dll.h"
 #include "gpu/commands.h"
 #include "gpu/types.h"
+#include "core/memory_tracker.h"
 #include "core/vector.h"
 
 namespace GPU
@@ -176,7 +177,7 @@ namespace GPU
 		    const Point& dstPoint, Handle srcTexture, i32 srcSubResourceIdx, const Box& srcBox);
 
 		/// for iterator support.
-		typedef Core::Vector<Command*> CommandVector;
+		typedef Core::Vector<Command*, Core::TaggedAllocator<Core::MemoryTag::GPU>> CommandVector;
 		typedef CommandVector::iterator iterator;
 		typedef CommandVector::const_iterator const_iterator;
 
@@ -193,7 +194,7 @@ namespace GPU
 
 		CommandQueueType queueType_ = CommandQueueType::NONE;
 		i32 allocatedBytes_ = 0;
-		Core::Vector<u8> commandData_;
+		Core::Vector<u8, Core::TaggedAllocator<Core::MemoryTag::GPU>> commandData_;
 		CommandVector commands_;
 
 		DrawState drawState_;
@@ -9,7 +9,10 @@
 #include "core/debug.h"
 #include "core/handle.h"
 #include "core/library.h"
+#include "core/memory_tracker.h"
 #include "core/misc.h"
+#include "core/mpsc_queue.h"
+#include "core/profiler.h"
 #include "core/vector.h"
 
 #include "renderdoc_app.h"
@@ -91,9 +94,9 @@ namespace GPU
 		BackendPlugin plugin_;
 		IBackend* backend_ = nullptr;
 
-		Core::Mutex mutex_;
 		Core::HandleAllocator handles_ = Core::HandleAllocator(ResourceType::MAX);
-		Core::Vector<Handle> deferredDeletions_;
+		/// Handles to destroy. Enqueued from any thread, dequeued by ProcessDeletions.
+		Core::MPSCQueue<Handle> deferredDeletions_;
 
 		ManagerImpl(const SetupParams& setupParams)
 		    : deviceWindow_(setupParams.deviceWindow_)
@@ -138,19 +141,18 @@ namespace GPU
 
 		~ManagerImpl() { plugin_.DestroyBackend(backend_); }
 
-		Handle AllocHandle(ResourceType type)
-		{
-			Core::ScopedMutex lock(mutex_);
-			return handles_.Alloc<Handle>(type);
-		}
+		Handle AllocHandle(ResourceType type) { return handles_.Alloc<Handle>(type); }
 
 		void ProcessDeletions()
 		{
-			Core::ScopedMutex lock(mutex_);
-			for(auto handle : deferredDeletions_)
+			Handle handles[64];
+			while(i32 numHandles = deferredDeletions_.Dequeue(handles, 64))
 			{
-				backend_->DestroyResource(handle);
-				handles_.Free(handle);
+				for(i32 i = 0; i < numHandles; ++i)
+				{
+					backend_->DestroyResource(handles[i]);
+					handles_.Free(handles[i]);
+				}
 			}
 		}
 
@@ -321,13 +323,13 @@ namespace GPU
 	void Manager::DestroyResource(Handle handle)
 	{
 		DBG_ASSERT(IsInitialized());
-		Core::ScopedMutex lock(impl_->mutex_);
-		impl_->deferredDeletions_.push_back(handle);
+		impl_->deferredDeletions_.Enqueue(handle);
 	}
 
 	bool Manager::CompileCommandList(Handle handle, const CommandList& commandList)
 	{
 		DBG_ASSERT(IsInitialized());
+		PROFILE_SCOPE("GPU::CompileCommandList");
 		DBG_ASSERT(handle.GetType() == ResourceType::COMMAND_LIST);
 		return impl_->HandleErrorCode(handle, impl_->backend_->CompileCommandList(handle, commandList));
 	}
@@ -335,6 +337,7 @@ namespace GPU
 	bool Manager::SubmitCommandList(Handle handle)
 	{
 		DBG_ASSERT(IsInitialized());
+		PROFILE_SCOPE("GPU::SubmitCommandList");
 		DBG_ASSERT(handle.GetType() == ResourceType::COMMAND_LIST);
 		return impl_->HandleErrorCode(handle, impl_->backend_->SubmitCommandList(handle));
 	}
@@ -342,6 +345,7 @@ namespace GPU
 	bool Manager::PresentSwapChain(Handle handle)
 	{
 		DBG_ASSERT(IsInitialized());
+		PROFILE_SCOPE("GPU::PresentSwapChain");
 		DBG_ASSERT(handle.GetType() == ResourceType::SWAP_CHAIN);
 		return impl_->HandleErrorCode(handle, impl_->backend_->PresentSwapChain(handle));
 	}
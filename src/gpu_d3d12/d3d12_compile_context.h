@@ -7,7 +7,7 @@
 
 namespace Core
 {
-	inline u32 Hash(u32 input, const GPU::D3D12Resource* data) { return HashCRC32(input, &data, sizeof(data)); }
+	inline u32 Hash(u32 input, const GPU::D3D12Resource* data) { return HashCRC32C(input, &data, sizeof(data)); }
 }
 
 namespace GPU
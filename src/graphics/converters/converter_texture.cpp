@@ -1,12 +1,14 @@
 #include "graphics/converters/dds.h"
 #include "graphics/converters/image.h"
 #include "graphics/texture.h"
+#include "resource/compressed_data.h"
 #include "resource/converter.h"
 #include "core/array.h"
 #include "core/debug.h"
 #include "core/enum.h"
 #include "core/file.h"
 #include "core/hash.h"
+#include "core/memory_tracker.h"
 #include "core/misc.h"
 #include "core/vector.h"
 
@@ -14,6 +16,8 @@
 #include "gpu/resources.h"
 #include "gpu/utils.h"
 
+#include "job/parallel.h"
+
 #include "serialization/serializer.h"
 
 #pragma warning(push)
@@ -151,7 +155,7 @@ namespace
 
 			// Fall through to stb_image for loading other images.
 			Core::File imageFile(sourceFile, Core::FileFlags::READ, context.GetPathResolver());
-			Core::Vector<u8> imageData;
+			Core::Vector<u8, Core::TaggedAllocator<Core::MemoryTag::GRAPHICS>> imageData;
 			imageData.resize((i32)imageFile.Size());
 			imageFile.Read(imageData.data(), imageFile.Size());
 
@@ -166,16 +170,15 @@ namespace
 
 		bool WriteTexture(const char* outFilename, const GPU::TextureDesc& desc, const u8* data)
 		{
-			// Write out texture data.
+			// Write out texture data, block compressed so it can be decompressed in parallel as it's loaded.
 			Core::File outFile(outFilename, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
 			if(outFile)
 			{
 				outFile.Write(&desc, sizeof(desc));
 				i64 size = GPU::GetTextureSize(
 				    desc.format_, desc.width_, desc.height_, desc.depth_, desc.levels_, desc.elements_);
-				outFile.Write(data, size);
-
-				return true;
+				return Resource::WriteCompressedData(
+				    outFile, data, size, Core::CompressionCodec::LZ4, Core::COMPRESSION_LEVEL_DEFAULT);
 			}
 			return false;
 		}
@@ -245,8 +248,16 @@ namespace
 				// Squish takes RGBA8, so no need to convert before passing in.
 				if(image.width_ >= 4 && image.height_ >= 4)
 				{
-					squish::CompressImage(
-					    reinterpret_cast<squish::u8*>(image.data_), image.width_, image.height_, outData, squishFormat);
+					// Each row of blocks is contiguous in both source and destination, so compress rows in parallel.
+					const i32 numBlockRows = (image.height_ + 3) / 4;
+					const i32 blockRowSize = squish::GetStorageRequirements(image.width_, 4, squishFormat);
+					const i32 srcRowSize = image.width_ * 4 * 4; // 4 bytes per pixel, 4 rows per block.
+					Job::ParallelFor(0, numBlockRows, 1, [&](i32 begin, i32 end) {
+						const i32 beginY = begin * 4;
+						const i32 endY = Core::Min(end * 4, image.height_);
+						squish::CompressImage(reinterpret_cast<squish::u8*>(image.data_ + begin * srcRowSize),
+						    image.width_, endY - beginY, outData + begin * blockRowSize, squishFormat);
+					});
 				}
 				// If less than block size, copy into a 4x4 block.
 				else if((image.width_ < 4 || image.height_ < 4) && !(image.width_ > 4 || image.height_ > 4))
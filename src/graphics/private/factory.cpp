@@ -3,6 +3,7 @@
 #include "graphics/private/texture_impl.h"
 
 #include "core/file.h"
+#include "core/memory_tracker.h"
 #include "core/misc.h"
 
 #include "gpu/resources.h"
@@ -10,6 +11,8 @@
 
 #include "gpu/manager.h"
 
+#include "resource/compressed_data.h"
+
 #include <utility>
 
 namespace Graphics
@@ -63,13 +66,28 @@ namespace Graphics
 		i64 bytes =
 		    GPU::GetTextureSize(desc.format_, desc.width_, desc.height_, desc.depth_, desc.levels_, desc.elements_);
 
-		// Allocate bytes to read in.
-		// TODO: Implement a Map/Unmap interface on Core::File to allow reading in-place or memory mapping.
-		Core::Vector<u8> texData((i32)bytes);
-		memset(texData.data(), 0, texData.size());
-
-		// Read texture data in.
-		inFile.Read(texData.data(), texData.size());
+		// Decompress block compressed data, otherwise use texture data in place if the file can be mapped.
+		Core::Vector<u8, Core::TaggedAllocator<Core::MemoryTag::GRAPHICS>> texData;
+		const bool compressed = bytes > 0 && Resource::GetUncompressedSize(inFile) == bytes;
+		const u8* mappedData =
+		    bytes > 0 && !compressed ? static_cast<const u8*>(inFile.Map(inFile.Tell(), bytes)) : nullptr;
+		const u8* srcData = mappedData;
+		if(compressed)
+		{
+			texData.resize_uninitialized((i32)bytes);
+			if(!Resource::ReadCompressedData(inFile, texData.data(), bytes))
+				return false;
+			srcData = texData.data();
+		}
+		else if(mappedData == nullptr)
+		{
+			// Read texture data in, only clearing what the file doesn't fill.
+			texData.resize_uninitialized((i32)bytes);
+			const i64 bytesRead = Core::Max(inFile.Read(texData.data(), texData.size()), (i64)0);
+			if(bytesRead < texData.size())
+				memset(texData.data() + bytesRead, 0, (size_t)(texData.size() - bytesRead));
+			srcData = texData.data();
+		}
 
 		// Setup subresources.
 		i32 numSubRsc = desc.levels_ * desc.elements_;
@@ -89,7 +107,7 @@ namespace Graphics
 				const auto subRscSize = GPU::GetTextureSize(desc.format_, desc.width_, desc.height_, desc.depth_, 1, 1);
 
 				GPU::TextureSubResourceData subRsc;
-				subRsc.data_ = texData.data() + texDataOffset;
+				subRsc.data_ = srcData + texDataOffset;
 				subRsc.rowPitch_ = texLayoutInfo.pitch_;
 				subRsc.slicePitch_ = texLayoutInfo.slicePitch_;
 
@@ -104,6 +122,7 @@ namespace Graphics
 		{
 			handle = GPU::Manager::CreateTexture(desc, subRscs.data(), name);
 		}
+		inFile.Unmap(mappedData);
 
 		// Finish creating texture.
 		inResource->impl_ = new TextureImpl();
@@ -8,6 +8,7 @@
 #include "core/os.h"
 #include "job/manager.h"
 #include "plugin/manager.h"
+#include "resource/archive.h"
 #include "resource/manager.h"
 
 #include "graphics/factory.h"
@@ -69,3 +70,29 @@ TEST_CASE("graphics-tests-converter-texture")
 	Resource::Manager::WaitForResource(texture);
 	REQUIRE(Resource::Manager::ReleaseResource(texture));
 }
+
+TEST_CASE("graphics-tests-converter-texture-archive")
+{
+	Plugin::Manager::Scoped pluginManager;
+	Job::Manager::Scoped jobManager(2, 256, 32 * 1024);
+	Resource::Manager::Scoped resourceManager;
+	ScopedFactory factory;
+
+	// Converted textures end with their block compressed data, so loading from an archive entry, which is
+	// served as a memory file, reads right up to the end of the file.
+	const char* convertedName = "archive_texture.converted";
+	const char* archiveName = "archive_texture.pak";
+	REQUIRE(Resource::Manager::ConvertResource(
+	    "test_texture_png.png", convertedName, Graphics::Texture::GetTypeUUID()));
+	{
+		Resource::ArchiveWriter writer(archiveName);
+		REQUIRE(writer.AddFile(Core::UUID("archived_texture.png"), Graphics::Texture::GetTypeUUID(), convertedName));
+	}
+	REQUIRE(Resource::Manager::MountArchive(archiveName));
+
+	Graphics::Texture* texture = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(texture, "archived_texture.png"));
+	Resource::Manager::WaitForResource(texture);
+	REQUIRE(texture->IsReady());
+	REQUIRE(Resource::Manager::ReleaseResource(texture));
+}
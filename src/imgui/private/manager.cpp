@@ -3,8 +3,12 @@
 #include "client/key_input.h"
 #include "math/mat44.h"
 
+#include "core/memory_tracker.h"
+#include "core/profiler.h"
 #include "gpu/manager.h"
 
+#include <cstdlib>
+
 typedef u8 BYTE;
 #include "imgui/private/shaders/imgui_vs.h"
 #include "imgui/private/shaders/imgui_ps.h"
@@ -30,6 +34,30 @@ namespace ImGui
 		GPU::Handle pbsHandle_;
 
 		bool isInitialized_ = false;
+
+		// ImGui frees without a size, so keep it in a header before each allocation for tracking.
+		static const size_t ALLOC_HEADER_SIZE = PLATFORM_ALIGNMENT;
+		static_assert(ALLOC_HEADER_SIZE >= sizeof(size_t), "Header must be able to store size.");
+
+		void* TrackedMemAlloc(size_t size)
+		{
+			u8* mem = (u8*)malloc(size + ALLOC_HEADER_SIZE);
+			if(mem == nullptr)
+				return nullptr;
+			*(size_t*)mem = size;
+			Core::MemoryTracker::TrackAlloc(Core::MemoryTag::IMGUI, mem, (i64)size);
+			return mem + ALLOC_HEADER_SIZE;
+		}
+
+		void TrackedMemFree(void* ptr)
+		{
+			if(ptr == nullptr)
+				return;
+			u8* mem = (u8*)ptr - ALLOC_HEADER_SIZE;
+			const size_t size = *(size_t*)mem;
+			Core::MemoryTracker::TrackDealloc(Core::MemoryTag::IMGUI, mem, (i64)size);
+			free(mem);
+		}
 	}
 
 	void Manager::Initialize()
@@ -39,6 +67,10 @@ namespace ImGui
 
 		ImGuiIO& IO = ImGui::GetIO();
 
+		// Must be set before ImGui allocates anything.
+		IO.MemAllocFn = TrackedMemAlloc;
+		IO.MemFreeFn = TrackedMemFree;
+
 		GPU::BufferDesc vbDesc;
 		vbDesc.size_ = MAX_VERTICES * sizeof(ImDrawVert);
 		vbDesc.bindFlags_ = GPU::BindFlags::VERTEX_BUFFER;
@@ -242,6 +274,7 @@ namespace ImGui
 	void Manager::BeginFrame(const Client::IInputProvider& input, i32 w, i32 h)
 	{
 		DBG_ASSERT(IsInitialized());
+		PROFILE_SCOPE("ImGui::BeginFrame");
 
 		ImGuiIO& IO = ImGui::GetIO();
 		IO.DisplaySize.x = (f32)w;
@@ -283,6 +316,7 @@ namespace ImGui
 	void Manager::EndFrame(const GPU::Handle& fbs, GPU::CommandList& cmdList)
 	{
 		DBG_ASSERT(IsInitialized());
+		PROFILE_SCOPE("ImGui::EndFrame");
 
 		ImGui::Render();
 
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/memory_tracker.h"
+#include "core/vector.h"
+#include "job/types.h"
+
+namespace Job
+{
+	/**
+	 * Job dependency graph.
+	 * Nodes are jobs, and edges are dependencies between them. Once submitted, nodes with no dependencies
+	 * run straight away, and every other node is run by the worker that completes its last dependency, so
+	 * nothing occupies a fiber waiting on a counter.
+	 * A graph can be submitted any number of times, but must not be modified or resubmitted until the
+	 * previous submission has completed.
+	 */
+	class JOB_DLL Graph final
+	{
+	public:
+		Graph() = default;
+		~Graph() = default;
+
+		/**
+		 * Add node.
+		 * @param jobDesc Job to run. Its counter is managed by the graph.
+		 * @return Node index.
+		 */
+		i32 AddNode(const JobDesc& jobDesc);
+
+		/**
+		 * Add dependency. Node @a after won't run until node @a before has completed.
+		 * @pre Nodes are valid, and the edge doesn't form a cycle.
+		 */
+		void AddEdge(i32 before, i32 after);
+
+		/**
+		 * Submit graph to run.
+		 * @param counter As Manager::RunJobs. Reaches zero once every node has completed.
+		 * @pre counter != nullptr.
+		 * @pre GetNumNodes() > 0.
+		 */
+		void Submit(Counter** counter);
+
+		/**
+		 * Submit graph to run, and wait for it to complete.
+		 */
+		void Run();
+
+		/**
+		 * @return Number of nodes.
+		 */
+		i32 GetNumNodes() const { return nodes_.size(); }
+
+	private:
+		Graph(const Graph&) = delete;
+		Graph& operator=(const Graph&) = delete;
+
+		struct Node
+		{
+			JobDesc jobDesc_;
+			/// Range in successors_.
+			i32 firstSuccessor_ = 0;
+			i32 numSuccessors_ = 0;
+			i32 numPredecessors_ = 0;
+			/// Predecessors yet to complete in the current submission.
+			volatile i32 numPending_ = 0;
+		};
+
+		struct Edge
+		{
+			i32 before_ = 0;
+			i32 after_ = 0;
+		};
+
+		static void NodeEntryPoint(i32 nodeIdx, void* data);
+		void Build();
+		JobDesc GetNodeJob(i32 nodeIdx) const;
+
+		using Allocator = Core::TaggedAllocator<Core::MemoryTag::JOB>;
+		Core::Vector<Node, Allocator> nodes_;
+		/// All edges, in the order added.
+		Core::Vector<Edge, Allocator> edges_;
+		/// Successors of each node, in node order.
+		Core::Vector<i32, Allocator> successors_;
+		/// Have nodes or edges been added since successors_ was built?
+		bool dirty_ = false;
+		/// Counter for the current submission. Continuations are added to it.
+		Counter* counter_ = nullptr;
+	};
+} // namespace Job
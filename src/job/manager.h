@@ -16,10 +16,18 @@ namespace Job
 		/**
 		 * Initialize job manager.
 		 * @param numWorkers Number of workers to create.
-		 * @param numFibers Number of fibers to allocate.
-		 * @param fiberStackSize Stack size for each fiber.
+		 * @param numFibers Number of fibers to allocate up front, with StackClass::SMALL stacks.
+		 * @param fiberStackSize Stack size for StackClass::SMALL fibers.
+		 * @param mode Scheduler mode.
+		 * @param numHighPriorityWorkers Number of workers that only take Priority::HIGH jobs.
+		 * @param maxFibers Number of fibers the pool may grow to on demand. 0 for 4x @a numFibers.
+		 * @param largeFiberStackSize Stack size for StackClass::LARGE fibers. 0 for 8x @a fiberStackSize.
+		 * @pre numHighPriorityWorkers < numWorkers.
+		 * @pre maxFibers == 0 || maxFibers >= numFibers.
 		 */
-		static void Initialize(i32 numWorkers, i32 numFibers, i32 fiberStackSize);
+		static void Initialize(i32 numWorkers, i32 numFibers, i32 fiberStackSize,
+		    SchedulerMode mode = SchedulerMode::GLOBAL_QUEUE, i32 numHighPriorityWorkers = 0, i32 maxFibers = 0,
+		    i32 largeFiberStackSize = 0);
 
 		/**
 		 * Shutdown job manager.
@@ -31,16 +39,33 @@ namespace Job
 		 */
 		static bool IsInitialized();
 
+		/**
+		 * @return Number of fibers allocated, of all stack classes.
+		 */
+		static i32 GetNumFibers();
+
 		/**
 		 * Run jobs.
+		 * When using SchedulerMode::WORK_STEALING and called from within a job, Priority::NORMAL jobs are
+		 * pushed to the calling worker's deque.
 		 * @param jobDescs Jobs to run.
 		 * @param numJobDesc Number of jobs to run.
 		 * @param counter Counter for how many jobs are currently pending completion.
+		 *                If it points to an existing counter, the jobs are added to it. That counter must not
+		 *                be able to reach zero until this returns, e.g. when called from a job it's tracking.
 		 * @pre jobDescs != nullptr.
 		 * @pre numJobDesc > 0.
 		 */
 		static void RunJobs(JobDesc* jobDescs, i32 numJobDesc, Counter** counter = nullptr);
 
+		/**
+		 * Try to run a job without waiting for space in the job queue.
+		 * @param jobDesc Job to run.
+		 * @param counter As RunJobs. Unchanged on failure.
+		 * @return true if job was queued.
+		 */
+		static bool TryRunJob(JobDesc& jobDesc, Counter** counter = nullptr);
+
 		/**
 		 * Wait for counter.
 		 * If @a value is zero, then it will free once complete.
@@ -61,9 +86,11 @@ namespace Job
 		class Scoped
 		{
 		public:
-			Scoped(i32 numWorkers, i32 numFibers, i32 fiberStackSize)
+			Scoped(i32 numWorkers, i32 numFibers, i32 fiberStackSize, SchedulerMode mode = SchedulerMode::GLOBAL_QUEUE,
+			    i32 numHighPriorityWorkers = 0, i32 maxFibers = 0, i32 largeFiberStackSize = 0)
 			{
-				Initialize(numWorkers, numFibers, fiberStackSize);
+				Initialize(
+				    numWorkers, numFibers, fiberStackSize, mode, numHighPriorityWorkers, maxFibers, largeFiberStackSize);
 			}
 			~Scoped() { Finalize(); }
 		};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/vector.h"
+#include "job/manager.h"
+
+#include <utility>
+
+namespace Job
+{
+	/**
+	 * Range produced by recursively splitting a ParallelFor/ParallelReduce range.
+	 * Internal use. Do not use.
+	 */
+	struct ParallelRange final
+	{
+		i32 begin_ = 0;
+		i32 end_ = 0;
+	};
+
+	/**
+	 * Per-call state shared by all jobs of a ParallelFor/ParallelReduce. Lives on the caller's stack, and
+	 * ranges are bump allocated from a single array so no job allocates.
+	 * Internal use. Do not use.
+	 */
+	template<typename FUNC>
+	struct ParallelContext final
+	{
+		/// Called for each grain as func_(begin, end).
+		FUNC func_;
+		i32 grainSize_ = 1;
+		Priority priority_ = Priority::NORMAL;
+		const char* name_ = nullptr;
+		/// Counter for all jobs. Each split adds to it.
+		Counter* counter_ = nullptr;
+		/// Initial range of each job.
+		Core::Vector<ParallelRange> ranges_;
+		volatile i32 numRanges_ = 0;
+
+		ParallelContext(FUNC func, i32 begin, i32 end, i32 grainSize, Priority priority, const char* name)
+		    : func_(std::move(func))
+		    , grainSize_(grainSize)
+		    , priority_(priority)
+		    , name_(name)
+		{
+			// Splits are grain aligned, and each range allocated either becomes a job with at least one grain,
+			// or is used for one grain run inline when the job queue is full. So there's at most one per grain.
+			const i32 numGrains = ((end - begin) + grainSize_ - 1) / grainSize_;
+			ranges_.resize(numGrains);
+			ranges_[0].begin_ = begin;
+			ranges_[0].end_ = end;
+			numRanges_ = 1;
+		}
+
+		i32 AllocRange(i32 begin, i32 end)
+		{
+			const i32 rangeIdx = Core::AtomicInc(&numRanges_) - 1;
+			DBG_ASSERT(rangeIdx < ranges_.size());
+			ranges_[rangeIdx].begin_ = begin;
+			ranges_[rangeIdx].end_ = end;
+			return rangeIdx;
+		}
+
+		static void JobEntryPoint(i32 rangeIdx, void* data)
+		{
+			auto* context = reinterpret_cast<ParallelContext*>(data);
+			ParallelRange range = context->ranges_[rangeIdx];
+
+			// Split off the upper half for other workers while larger than the grain. Idle workers pick up
+			// the biggest pieces first, so load balances without callers having to size batches.
+			// Splits are on grain boundaries, so func_ is always called on the same grains regardless of timing.
+			// Never wait for space in the job queue: every job doing so could hold every fiber.
+			while((range.end_ - range.begin_) > context->grainSize_)
+			{
+				const i32 numGrains = ((range.end_ - range.begin_) + context->grainSize_ - 1) / context->grainSize_;
+				const i32 mid = range.begin_ + (numGrains / 2) * context->grainSize_;
+				const i32 splitIdx = context->AllocRange(mid, range.end_);
+
+				JobDesc jobDesc;
+				jobDesc.func_ = JobEntryPoint;
+				jobDesc.param_ = splitIdx;
+				jobDesc.data_ = context;
+				jobDesc.name_ = context->name_;
+				jobDesc.priority_ = context->priority_;
+				Counter* counter = context->counter_;
+				if(Manager::TryRunJob(jobDesc, &counter))
+				{
+					range.end_ = mid;
+				}
+				else
+				{
+					// Queue full, do a grain of work here then try again.
+					const i32 grainEnd = range.begin_ + context->grainSize_;
+					context->func_(range.begin_, grainEnd);
+					range.begin_ = grainEnd;
+				}
+			}
+
+			context->func_(range.begin_, range.end_);
+		}
+
+		/// Run jobs and wait for them all to complete.
+		void Run()
+		{
+			JobDesc jobDesc;
+			jobDesc.func_ = JobEntryPoint;
+			jobDesc.param_ = 0;
+			jobDesc.data_ = this;
+			jobDesc.name_ = name_;
+			jobDesc.priority_ = priority_;
+			Manager::RunJobs(&jobDesc, 1, &counter_);
+			Manager::WaitForCounter(counter_, 0);
+		}
+	};
+
+	/**
+	 * Parallel for.
+	 * Calls @a func over [begin, end) split into sub-ranges, from jobs, and waits for them to complete.
+	 * Ranges are split in half recursively on @a grainSize boundaries, so @a func is called once per grain:
+	 * [begin, begin + grainSize), [begin + grainSize, begin + grainSize * 2), etc.
+	 * If the job manager isn't initialized, or the range fits in one grain, it's run on the calling thread.
+	 * @param begin First index.
+	 * @param end One past last index.
+	 * @param grainSize Largest range to pass to @a func.
+	 * @param func Callable as func(i32 begin, i32 end).
+	 * @param priority Priority of jobs.
+	 * @param name Name of jobs.
+	 * @pre grainSize > 0.
+	 */
+	template<typename FUNC>
+	void ParallelFor(i32 begin, i32 end, i32 grainSize, FUNC&& func, Priority priority = Priority::NORMAL,
+	    const char* name = "ParallelFor")
+	{
+		DBG_ASSERT(grainSize > 0);
+		if(begin >= end)
+			return;
+
+		if((end - begin) <= grainSize || !Manager::IsInitialized())
+		{
+			for(i32 rangeBegin = begin; rangeBegin < end; rangeBegin += grainSize)
+				func(rangeBegin, (end - rangeBegin) > grainSize ? rangeBegin + grainSize : end);
+			return;
+		}
+
+		auto grainFunc = [&func](i32 grainBegin, i32 grainEnd) { func(grainBegin, grainEnd); };
+		ParallelContext<decltype(grainFunc)> context(grainFunc, begin, end, grainSize, priority, name);
+		context.Run();
+	}
+
+	/**
+	 * Parallel reduce.
+	 * Calls @a func for each grain as ParallelFor does, then once all have completed, combines the results
+	 * of each grain with @a reduce in order of grain. Grains and the order they're combined in don't depend
+	 * on timing, so the result is the same every call, with or without jobs, even for non-associative
+	 * @a reduce (e.g. floating point sums).
+	 * @param begin First index.
+	 * @param end One past last index.
+	 * @param grainSize Largest range to pass to @a func.
+	 * @param identity Result for an empty range.
+	 * @param func Callable as TYPE func(i32 begin, i32 end).
+	 * @param reduce Callable as TYPE reduce(const TYPE& a, const TYPE& b).
+	 * @param priority Priority of jobs.
+	 * @param name Name of jobs.
+	 * @pre grainSize > 0.
+	 */
+	template<typename TYPE, typename FUNC, typename REDUCE>
+	TYPE ParallelReduce(i32 begin, i32 end, i32 grainSize, const TYPE& identity, FUNC&& func, REDUCE&& reduce,
+	    Priority priority = Priority::NORMAL, const char* name = "ParallelReduce")
+	{
+		DBG_ASSERT(grainSize > 0);
+		if(begin >= end)
+			return identity;
+
+		if((end - begin) <= grainSize || !Manager::IsInitialized())
+		{
+			TYPE result = identity;
+			for(i32 rangeBegin = begin; rangeBegin < end; rangeBegin += grainSize)
+			{
+				const i32 rangeEnd = (end - rangeBegin) > grainSize ? rangeBegin + grainSize : end;
+				result = reduce(result, func(rangeBegin, rangeEnd));
+			}
+			return result;
+		}
+
+		// One result per grain.
+		Core::Vector<TYPE> results;
+		results.resize(((end - begin) + grainSize - 1) / grainSize, identity);
+		auto grainFunc = [&func, &results, begin, grainSize](
+		    i32 grainBegin, i32 grainEnd) { results[(grainBegin - begin) / grainSize] = func(grainBegin, grainEnd); };
+		ParallelContext<decltype(grainFunc)> context(grainFunc, begin, end, grainSize, priority, name);
+		context.Run();
+
+		// Combine in grain order.
+		TYPE result = identity;
+		for(const TYPE& grainResult : results)
+			result = reduce(result, grainResult);
+		return result;
+	}
+
+} // namespace Job
@@ -0,0 +1,168 @@
+#include "job/graph.h"
+#include "job/manager.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+
+namespace Job
+{
+	namespace
+	{
+		/// Maximum continuations released in one RunJobs call.
+		static const i32 MAX_RELEASE_BATCH = 32;
+	}
+
+	i32 Graph::AddNode(const JobDesc& jobDesc)
+	{
+		DBG_ASSERT(jobDesc.func_);
+		DBG_ASSERT(jobDesc.counter_ == nullptr);
+		Node node;
+		node.jobDesc_ = jobDesc;
+		nodes_.push_back(node);
+		dirty_ = true;
+		return nodes_.size() - 1;
+	}
+
+	void Graph::AddEdge(i32 before, i32 after)
+	{
+		DBG_ASSERT(before >= 0 && before < nodes_.size());
+		DBG_ASSERT(after >= 0 && after < nodes_.size());
+		DBG_ASSERT(before != after);
+		Edge edge;
+		edge.before_ = before;
+		edge.after_ = after;
+		edges_.push_back(edge);
+		dirty_ = true;
+	}
+
+	void Graph::Build()
+	{
+		// Bucket successors by node, so a completing node walks a contiguous range.
+		for(auto& node : nodes_)
+		{
+			node.numSuccessors_ = 0;
+			node.numPredecessors_ = 0;
+		}
+		for(const auto& edge : edges_)
+		{
+			nodes_[edge.before_].numSuccessors_++;
+			nodes_[edge.after_].numPredecessors_++;
+		}
+		i32 firstSuccessor = 0;
+		for(auto& node : nodes_)
+		{
+			node.firstSuccessor_ = firstSuccessor;
+			firstSuccessor += node.numSuccessors_;
+			node.numSuccessors_ = 0;
+		}
+		successors_.resize(edges_.size());
+		for(const auto& edge : edges_)
+		{
+			Node& node = nodes_[edge.before_];
+			successors_[node.firstSuccessor_ + node.numSuccessors_++] = edge.after_;
+		}
+
+#ifdef DEBUG
+		{
+			// Check for cycles: repeatedly remove nodes with no remaining predecessors, all should go.
+			Core::Vector<i32> numPending;
+			Core::Vector<i32> ready;
+			numPending.reserve(nodes_.size());
+			ready.reserve(nodes_.size());
+			for(i32 nodeIdx = 0; nodeIdx < nodes_.size(); ++nodeIdx)
+			{
+				numPending.push_back(nodes_[nodeIdx].numPredecessors_);
+				if(numPending[nodeIdx] == 0)
+					ready.push_back(nodeIdx);
+			}
+			for(i32 readyIdx = 0; readyIdx < ready.size(); ++readyIdx)
+			{
+				const Node& node = nodes_[ready[readyIdx]];
+				for(i32 i = 0; i < node.numSuccessors_; ++i)
+				{
+					const i32 successor = successors_[node.firstSuccessor_ + i];
+					if(--numPending[successor] == 0)
+						ready.push_back(successor);
+				}
+			}
+			DBG_ASSERT_MSG(ready.size() == nodes_.size(), "Job graph contains a cycle.");
+		}
+#endif
+		dirty_ = false;
+	}
+
+	JobDesc Graph::GetNodeJob(i32 nodeIdx) const
+	{
+		const JobDesc& nodeJobDesc = nodes_[nodeIdx].jobDesc_;
+		JobDesc jobDesc;
+		jobDesc.func_ = NodeEntryPoint;
+		jobDesc.param_ = nodeIdx;
+		jobDesc.data_ = const_cast<Graph*>(this);
+		jobDesc.name_ = nodeJobDesc.name_;
+		jobDesc.priority_ = nodeJobDesc.priority_;
+		jobDesc.stackClass_ = nodeJobDesc.stackClass_;
+		return jobDesc;
+	}
+
+	void Graph::NodeEntryPoint(i32 nodeIdx, void* data)
+	{
+		auto* graph = reinterpret_cast<Graph*>(data);
+		const Node& node = graph->nodes_[nodeIdx];
+		node.jobDesc_.func_(node.jobDesc_.param_, node.jobDesc_.data_);
+
+		// Release successors whose last predecessor this was. This job is still tracked by the counter,
+		// so it can't reach zero while they're added to it.
+		Counter* counter = graph->counter_;
+		JobDesc releaseJobs[MAX_RELEASE_BATCH];
+		i32 numReleaseJobs = 0;
+		for(i32 i = 0; i < node.numSuccessors_; ++i)
+		{
+			const i32 successorIdx = graph->successors_[node.firstSuccessor_ + i];
+			if(Core::AtomicDec(&graph->nodes_[successorIdx].numPending_) == 0)
+			{
+				releaseJobs[numReleaseJobs++] = graph->GetNodeJob(successorIdx);
+				if(numReleaseJobs == MAX_RELEASE_BATCH)
+				{
+					Manager::RunJobs(releaseJobs, numReleaseJobs, &counter);
+					numReleaseJobs = 0;
+				}
+			}
+		}
+		if(numReleaseJobs > 0)
+			Manager::RunJobs(releaseJobs, numReleaseJobs, &counter);
+	}
+
+	void Graph::Submit(Counter** counter)
+	{
+		DBG_ASSERT(counter);
+		DBG_ASSERT(nodes_.size() > 0);
+
+		if(dirty_)
+			Build();
+
+		Core::Vector<JobDesc> rootJobs;
+		for(i32 nodeIdx = 0; nodeIdx < nodes_.size(); ++nodeIdx)
+		{
+			Node& node = nodes_[nodeIdx];
+			node.numPending_ = node.numPredecessors_;
+			if(node.numPredecessors_ == 0)
+				rootJobs.push_back(GetNodeJob(nodeIdx));
+		}
+		DBG_ASSERT(rootJobs.size() > 0);
+
+		// Counter is stored before any root can run, so continuations can add to it.
+		counter_ = *counter;
+		Manager::RunJobs(rootJobs.data(), rootJobs.size(), &counter_);
+		*counter = counter_;
+	}
+
+	void Graph::Run()
+	{
+		if(nodes_.size() == 0)
+			return;
+
+		Counter* counter = nullptr;
+		Submit(&counter);
+		Manager::WaitForCounter(counter, 0);
+	}
+
+} // namespace Job
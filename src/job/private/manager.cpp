@@ -1,8 +1,12 @@
 #include "job/manager.h"
+#include "job/private/trace.h"
 #include "core/concurrency.h"
+#include "core/memory_tracker.h"
 #include "core/mpmc_bounded_queue.h"
+#include "core/profiler.h"
 #include "core/timer.h"
 #include "core/vector.h"
+#include "core/work_stealing_deque.h"
 
 #include <utility>
 
@@ -10,6 +14,23 @@
 
 namespace Job
 {
+	using JobAllocator = Core::TaggedAllocator<Core::MemoryTag::JOB>;
+
+	/**
+	 * Something waiting on a counter. Either a job fiber, or a thread outside of the job system.
+	 */
+	struct CounterWaiter final
+	{
+		/// Next waiter in counter's wait list.
+		CounterWaiter* next_ = nullptr;
+		/// Value being waited on.
+		i32 value_ = 0;
+		/// Fiber to resume.
+		class Fiber* fiber_ = nullptr;
+		/// Semaphore to signal, if not a fiber.
+		Core::Semaphore* semaphore_ = nullptr;
+	};
+
 	/**
 	 * Counter internal details.
 	 */
@@ -19,44 +40,130 @@ namespace Job
 		volatile i32 value_ = 0;
 		/// Should counter be freed by the last that's using it?
 		bool free_ = false;
+		/// Number of waiters. Checked by jobs on completion to avoid taking the lock.
+		volatile i32 numWaiters_ = 0;
+		/// Lock for waiters_.
+		volatile i32 lock_ = 0;
+		/// Waiters.
+		CounterWaiter* waiters_ = nullptr;
 
 		Counter() = default;
 		Counter(const Counter&) = delete;
+
+		void Lock()
+		{
+			while(Core::AtomicCmpExchgAcq(&lock_, 1, 0) != 0)
+				Core::YieldCPU();
+		}
+
+		void Unlock() { Core::AtomicExchg(&lock_, 0); }
 	};
 
 
+	/// Size of each worker's local job deque when work stealing.
+	static const i32 WORKER_DEQUE_SIZE = 1024;
+	/// Number of times an idle worker will spin on YieldCPU before switching thread.
+	static const i32 WORKER_SPIN_COUNT = 64;
+	/// Number of times an idle worker will switch thread before parking.
+	static const i32 WORKER_SWITCH_COUNT = 16;
+	/// Number of counters kept in the free pool.
+	static const i32 COUNTER_POOL_SIZE = 1024;
+	/// Number of times a thread outside of the job system will spin on a counter before blocking.
+	static const i32 COUNTER_SPIN_COUNT = 64;
+	/// Number of job priorities.
+	static const i32 NUM_PRIORITIES = (i32)Priority::MAX;
+	/// Number of fiber stack classes.
+	static const i32 NUM_STACK_CLASSES = (i32)StackClass::MAX;
+	/// Fiber pool cap relative to the initial number of fibers, if not specified.
+	static const i32 DEFAULT_MAX_FIBERS_SCALE = 4;
+	/// Large fiber stack size relative to the small stack size, if not specified.
+	static const i32 DEFAULT_LARGE_STACK_SCALE = 8;
+
+	/**
+	 * Worker groups. Workers in each group park separately, so high priority work can wake
+	 * workers dedicated to it without waking everyone.
+	 */
+	enum class WorkerGroup : i32
+	{
+		/// Takes jobs of any priority.
+		GENERAL = 0,
+		/// Only takes Priority::HIGH jobs.
+		HIGH_PRIORITY,
+
+		MAX
+	};
+
 	/**
 	 * Private manager implementation.
 	 */
 	struct ManagerImpl
 	{
+		/// Scheduler mode.
+		SchedulerMode mode_ = SchedulerMode::GLOBAL_QUEUE;
 		/// Worker pool.
-		Core::Vector<class Worker*> workers_;
-		/// Free fibers.
-		Core::MPMCBoundedQueue<class Fiber*> freeFibers_;
-		/// Waiting fibers.
-		Core::MPMCBoundedQueue<class Fiber*> waitingFibers_;
-		/// Jobs.
-		Core::MPMCBoundedQueue<JobDesc> pendingJobs_;
+		Core::Vector<class Worker*, JobAllocator> workers_;
+		/// Free fibers, per stack class. Holds every fiber the pool can grow to, so never fills.
+		Core::MPMCBoundedQueue<class Fiber*> freeFibers_[NUM_STACK_CLASSES];
+		/// Fibers ready to resume, per priority. Holds every fiber the pool can grow to, so never fills.
+		Core::MPMCBoundedQueue<class Fiber*> readyFibers_[NUM_PRIORITIES];
+		/// Jobs, per priority. Only holds numFibers jobs, so it does fill: RunJobs then wakes workers to drain it
+		/// and waits, and TryRunJob fails.
+		Core::MPMCBoundedQueue<JobDesc> pendingJobs_[NUM_PRIORITIES];
 		/// Out of fibers counter.
 		volatile i32 outOfFibers_ = 0;
 #ifdef DEBUG
 		/// Number of free fibers. ONLY FOR DEBUG PURPOSES.
 		volatile i32 numFreeFibers_ = 0;
-		/// Number of waiting fibers. ONLY FOR DEBUG PURPOSES.
-		volatile i32 numWaitingFibers_ = 0;
+		/// Number of ready fibers. ONLY FOR DEBUG PURPOSES.
+		volatile i32 numReadyFibers_ = 0;
 		/// Number of pending jobs. ONLY FOR DEBUG PURPOSES.
 		volatile i32 numPendingJobs_ = 0;
 #endif
-		/// Fiber stack size.
-		i32 fiberStackSize_ = 0;
+		/// Fiber stack size, per stack class.
+		i32 fiberStackSizes_[NUM_STACK_CLASSES] = {0};
+		/// Number of fibers allocated, of all stack classes.
+		volatile i32 numFibers_ = 0;
+		/// Number of fibers the pool may grow to.
+		i32 maxFibers_ = 0;
 		/// Are we exiting?
 		bool exiting_ = false;
 		/// How many jobs are in flight.
 		volatile i32 jobCount_ = 0;
-
-		bool GetFiber(Fiber** outFiber);
+		/// Amount of work queued for workers to pick up (pending jobs, local jobs & ready fibers).
+		volatile i32 numQueued_ = 0;
+		/// Amount of Priority::HIGH work queued. Included in numQueued_.
+		volatile i32 numQueuedHigh_ = 0;
+		/// Number of workers parked, or about to park, per group.
+		volatile i32 numParked_[(i32)WorkerGroup::MAX] = {0};
+		/// Parked workers wait on these, per group.
+		Core::Semaphore wakeSemaphores_[(i32)WorkerGroup::MAX];
+		/// Free counters.
+		Core::MPMCBoundedQueue<Counter*> freeCounters_;
+		/// All counters allocated, so they can be freed on finalize.
+		Core::Vector<Counter*, JobAllocator> counters_;
+		/// Lock for counters_.
+		Core::Mutex countersMutex_;
+
+		bool GetJob(class Worker* worker, Priority priority, JobDesc& outJob);
+		bool StealJob(class Worker* worker, JobDesc& outJob);
+		bool GetFiber(class Worker* worker, Fiber** outFiber);
+		Fiber* NewFiber(StackClass stackClass);
+		bool TryAllocFiber(StackClass stackClass, Fiber*& outFiber);
+		Fiber* AllocFiber(StackClass stackClass);
 		void ReleaseFiber(Fiber* fiber, bool complete);
+		void ParkWorker(class Worker* worker);
+		i32 WakeWorkers(WorkerGroup group, i32 numToWake);
+		void WakeWorkers(Priority priority, i32 numToWake);
+		void OnDequeued(Priority priority);
+		Fiber* GetCallingJobFiber();
+		Worker* GetLocalWorker(Fiber* callingJobFiber);
+		bool TryEnqueueJob(Worker* localWorker, const JobDesc& job);
+		void OnJobsQueued(i32 numJobs, i32 numHighJobs);
+		void ResumeFiber(Fiber* fiber);
+		Counter* AllocCounter();
+		void FreeCounter(Counter* counter);
+		bool AddWaiter(Counter* counter, CounterWaiter* waiter);
+		void SignalCounter(Counter* counter);
 	};
 
 	ManagerImpl* impl_ = nullptr;
@@ -64,12 +171,23 @@ namespace Job
 	class Fiber final
 	{
 	public:
-		Fiber(ManagerImpl* manager)
+		Fiber(ManagerImpl* manager, StackClass stackClass)
 		    : manager_(manager)
+		    , stackClass_(stackClass)
+		{
+			fiber_ = Core::Fiber(FiberEntryPoint, this, manager_->fiberStackSizes_[(i32)stackClass], "Job Fiber");
+			if(fiber_)
+				Core::MemoryTracker::TrackAlloc(Core::MemoryTag::JOB, this, GetStackSize());
+		}
+
+		~Fiber()
 		{
-			fiber_ = Core::Fiber(FiberEntryPoint, this, manager_->fiberStackSize_, "Job Fiber");
+			if(fiber_)
+				Core::MemoryTracker::TrackDealloc(Core::MemoryTag::JOB, this, GetStackSize());
 		}
 
+		i64 GetStackSize() const { return manager_->fiberStackSizes_[(i32)stackClass_]; }
+
 		static void FiberEntryPoint(void* param)
 		{
 			auto* fiber = reinterpret_cast<Fiber*>(param);
@@ -80,14 +198,23 @@ namespace Job
 				DBG_ASSERT(fiber->job_.func_);
 
 				// Execute job.
+				fiber->BeginProfileSlice();
 				fiber->job_.func_(fiber->job_.param_, fiber->job_.data_);
+				fiber->EndProfileSlice();
 
-				// Tick counter down.
-				u32 counter = Core::AtomicDec(&fiber->job_.counter_->value_);
-				if(counter == 0)
+				// Tick counter down, and resume anything waiting on it.
+				Counter* counter = fiber->job_.counter_;
+				const bool freeCounter = counter->free_;
+				const i32 value = Core::AtomicDec(&counter->value_);
+				if(freeCounter)
 				{
-					if(fiber->job_.counter_->free_)
-						delete fiber->job_.counter_;
+					// Nobody else holds a free counter, so nobody can be waiting on it.
+					if(value == 0)
+						fiber->manager_->FreeCounter(counter);
+				}
+				else
+				{
+					fiber->manager_->SignalCounter(counter);
 				}
 
 				fiber->job_.func_ = nullptr;
@@ -111,6 +238,7 @@ namespace Job
 		{
 			DBG_ASSERT(job_.func_ == nullptr);
 			job_ = job;
+			readyPriority_ = job.priority_;
 		}
 
 		void SwitchTo(class Worker* worker, Core::Fiber* workerFiber)
@@ -120,21 +248,70 @@ namespace Job
 			fiber_.SwitchTo();
 		}
 
+		/**
+		 * Switch back to the worker from within the job, until resumed, possibly by another worker.
+		 */
+		void Suspend()
+		{
+			EndProfileSlice();
+			workerFiber_->SwitchTo();
+			BeginProfileSlice();
+		}
+
+		/**
+		 * Profile the job one slice at a time, as it may suspend and resume on another worker. Each slice is
+		 * recorded on the thread that ran it, and time spent suspended isn't counted.
+		 */
+		void BeginProfileSlice()
+		{
+#if CORE_PROFILE_ENABLED
+			profileBegin_ = Core::Timer::GetCycleCount();
+#endif
+		}
+
+		void EndProfileSlice()
+		{
+#if CORE_PROFILE_ENABLED
+			Core::Profiler::Record(job_.name_ ? job_.name_ : "Job", Core::Timer::GetCycleCount() - profileBegin_);
+#endif
+		}
+
 		ManagerImpl* manager_ = nullptr;
 		Core::Fiber fiber_;
+		/// Stack class, for returning to the right free pool.
+		StackClass stackClass_ = StackClass::SMALL;
 		class Worker* worker_ = nullptr;
 		Core::Fiber* workerFiber_ = nullptr;
 		JobDesc job_;
+		/// Counter to wait on when moved to waiting. nullptr if just yielding.
+		Counter* waitCounter_ = nullptr;
+		CounterWaiter waiter_;
+		/// Priority to resume at. Normally the job's priority.
+		Priority readyPriority_ = Priority::NORMAL;
 		bool exiting_ = false;
 		bool exited_ = false;
+#if CORE_PROFILE_ENABLED
+		/// Start of the slice of the job being profiled.
+		u64 profileBegin_ = 0;
+#endif
 	};
 
 
 	class Worker final
 	{
 	public:
-		Worker(ManagerImpl* manager, i32 idx)
+		Worker(ManagerImpl* manager, i32 idx, WorkerGroup group)
 		    : manager_(manager)
+		    , idx_(idx)
+		    , group_(group)
+		    , maxPriority_(group == WorkerGroup::HIGH_PRIORITY ? Priority::HIGH : Priority::BACKGROUND)
+		    , randState_((u32)idx * 0x9e3779b9 + 1)
+		{
+			if(manager_->mode_ == SchedulerMode::WORK_STEALING)
+				jobs_ = Core::WorkStealingDeque<JobDesc>(WORKER_DEQUE_SIZE);
+		}
+
+		void Start()
 		{
 			// Create thread.
 			thread_ = Core::Thread(ThreadEntryPoint, this, Core::Thread::DEFAULT_STACK_SIZE, "Job Worker Thread");
@@ -155,10 +332,12 @@ namespace Job
 			// Fiber for the worker thread.
 			Core::Fiber workerFiber(Core::Fiber::THIS_THREAD, "Job Worker Fiber");
 			DBG_ASSERT(workerFiber);
+			JOB_TRACE_THREAD_NAME("Job Worker", worker->idx_);
 
 			// Grab fiber from manager to execute.
 			Job::Fiber* jobFiber = nullptr;
-			while(worker->manager_->GetFiber(&jobFiber))
+			i32 idleCount = 0;
+			while(worker->manager_->GetFiber(worker, &jobFiber))
 			{
 				if(jobFiber)
 				{
@@ -171,8 +350,24 @@ namespace Job
 					DBG_ASSERT(jobFiber->job_.func_ || complete);
 					complete |= jobFiber->job_.func_ == nullptr;
 					worker->manager_->ReleaseFiber(jobFiber, complete);
+					idleCount = 0;
+				}
+				else if(idleCount < WORKER_SPIN_COUNT)
+				{
+					// Spin briefly, work often arrives shortly after we run out.
+					Core::YieldCPU();
+					++idleCount;
+				}
+				else if(idleCount < (WORKER_SPIN_COUNT + WORKER_SWITCH_COUNT))
+				{
+					Core::SwitchThread();
+					++idleCount;
+				}
+				else
+				{
+					worker->manager_->ParkWorker(worker);
+					idleCount = 0;
 				}
-				Core::SwitchThread();
 			}
 			while(!worker->exiting_)
 				Core::SwitchThread();
@@ -180,101 +375,220 @@ namespace Job
 			return 0;
 		}
 
+		/// @return Next pseudo-random number, used for victim selection.
+		u32 NextRandom()
+		{
+			randState_ ^= randState_ << 13;
+			randState_ ^= randState_ >> 17;
+			randState_ ^= randState_ << 5;
+			return randState_;
+		}
+
 		ManagerImpl* manager_ = nullptr;
+		i32 idx_ = 0;
+		WorkerGroup group_ = WorkerGroup::GENERAL;
+		/// Lowest priority this worker will take.
+		Priority maxPriority_ = Priority::BACKGROUND;
 		Core::Thread thread_;
+		/// Local jobs. Only used with SchedulerMode::WORK_STEALING.
+		Core::WorkStealingDeque<JobDesc> jobs_;
+		u32 randState_ = 1;
 		volatile i32 moveToWaiting_ = 0;
 		bool exiting_ = false;
 		bool exited_ = false;
 	};
 
-	bool ManagerImpl::GetFiber(Fiber** outFiber)
+	bool ManagerImpl::GetJob(Worker* worker, Priority priority, JobDesc& outJob)
 	{
-		Fiber* fiber = nullptr;
-		*outFiber = nullptr;
+		// Worker deques only hold Priority::NORMAL jobs.
+		const bool localJobs = mode_ == SchedulerMode::WORK_STEALING && priority == Priority::NORMAL;
+
+		// Local jobs first, they're the most likely to have their data in cache.
+		if(localJobs && worker->jobs_.Pop(outJob))
+		{
+			OnDequeued(priority);
+			return true;
+		}
 
-		// Check pending jobs.
-		JobDesc job;
-		if(pendingJobs_.Dequeue(job))
+		if(pendingJobs_[(i32)priority].Dequeue(outJob))
 		{
+			OnDequeued(priority);
 #ifdef DEBUG
 			Core::AtomicDec(&numPendingJobs_);
 #endif
+			return true;
+		}
 
-			DBG_ASSERT(job.func_);
+		if(localJobs && StealJob(worker, outJob))
+		{
+			OnDequeued(priority);
+			return true;
+		}
+		return false;
+	}
 
-#if VERBOSE_LOGGING >= 1
-			double startTime = Core::Timer::GetAbsoluteTime();
-			const double LOG_TIME_THRESHOLD = 100.0f / 1000000.0; // 100us.
-			const double LOG_TIME_REPEAT = 1000.0f / 1000.0;      // 1000ms.
-			double nextLogTime = startTime + LOG_TIME_THRESHOLD;
-#endif
-			i32 spinCount = 0;
-			i32 spinCountMax = 100;
-			while(!freeFibers_.Dequeue(fiber))
+	bool ManagerImpl::StealJob(Worker* worker, JobDesc& outJob)
+	{
+		// Start from a random victim to avoid all idle workers hammering the same deque.
+		const i32 numWorkers = workers_.size();
+		i32 victimIdx = (i32)(worker->NextRandom() % (u32)numWorkers);
+		for(i32 i = 0; i < numWorkers; ++i)
+		{
+			Worker* victim = workers_[victimIdx];
+			if(victim != worker && victim->group_ == WorkerGroup::GENERAL && victim->jobs_.Steal(outJob))
 			{
-				++spinCount;
-				if(spinCount > spinCountMax)
-				{
-					Core::AtomicInc(&outOfFibers_);
-				}
-#if VERBOSE_LOGGING >= 1
-				double time = Core::Timer::GetAbsoluteTime();
-				if((time - startTime) > LOG_TIME_THRESHOLD)
-				{
-					if(time > nextLogTime)
-					{
-						Core::Log("Unable to get free fiber. Increase numFibers. (Total time waiting: %f ms)\n",
-						    (time - startTime) * 1000.0);
-						nextLogTime = time + LOG_TIME_REPEAT;
-					}
-				}
+#if VERBOSE_LOGGING >= 3
+				Core::Log("Job \"%s\" (%u) stolen from worker %u by worker %u.\n", outJob.name_, outJob.param_,
+				    victim->idx_, worker->idx_);
 #endif
-				Core::SwitchThread();
+				JOB_TRACE(STEAL, outJob.name_, victim->idx_, 0);
+				return true;
+			}
+			victimIdx = (victimIdx + 1) % numWorkers;
+		}
+		return false;
+	}
 
-				// If all threads have spun this loop for too long simultaneously,
-				// we probably have a deadlock due to exhausting the fiber pool.
-				if(spinCount > spinCountMax)
-				{
-					if((Core::AtomicDec(&outOfFibers_) + 1) == workers_.size())
-					{
-						static bool breakHere = true;
-						if(breakHere)
-						{
-							DBG_BREAK;
-							breakHere = false;
-						}
-					}
-				}
+	bool ManagerImpl::GetFiber(Worker* worker, Fiber** outFiber)
+	{
+		Fiber* fiber = nullptr;
+		*outFiber = nullptr;
+
+		// Highest priority first. Within a priority, pending jobs are taken before ready fibers so a fiber
+		// yielding on a full queue doesn't keep being rescheduled ahead of the jobs that would drain it.
+		for(i32 priority = 0; priority <= (i32)worker->maxPriority_; ++priority)
+		{
+			// Check pending jobs.
+			JobDesc job;
+			if(GetJob(worker, (Priority)priority, job))
+			{
+				DBG_ASSERT(job.func_);
+				DBG_ASSERT(job.priority_ == (Priority)priority);
+
+				fiber = AllocFiber(job.stackClass_);
+				*outFiber = fiber;
+				fiber->SetJob(job);
+#if VERBOSE_LOGGING >= 3
+				Core::Log("Pending job \"%s\" (%u) being scheduled.\n", fiber->job_.name_, fiber->job_.param_);
+#endif
+				JOB_TRACE(JOB_BEGIN, job.name_, job.param_, fiber);
+				return true;
 			}
 
+			// Check ready fibers.
+			if(readyFibers_[priority].Dequeue(fiber))
+			{
+				OnDequeued((Priority)priority);
 #ifdef DEBUG
-			Core::AtomicDec(&numFreeFibers_);
+				Core::AtomicDec(&numReadyFibers_);
 #endif
-
-			*outFiber = fiber;
-			fiber->SetJob(job);
+				*outFiber = fiber;
+				DBG_ASSERT(fiber->job_.func_);
 #if VERBOSE_LOGGING >= 3
-			Core::Log("Pending job \"%s\" (%u) being scheduled.\n", fiber->job_.name_, fiber->job_.param_);
+				Core::Log("Waiting job \"%s\" (%u) being rescheduled.\n", fiber->job_.name_, fiber->job_.param_);
 #endif
-			return true;
+				JOB_TRACE(JOB_RESUME, fiber->job_.name_, fiber->job_.param_, &fiber->waiter_);
+				return true;
+			}
 		}
 
-		// First check for waiting fibers.
-		if(waitingFibers_.Dequeue(fiber))
+		return !exiting_;
+	}
+
+	Fiber* ManagerImpl::NewFiber(StackClass stackClass)
+	{
+		// Claim a slot under the cap first, so concurrent workers can't overshoot it.
+		if(Core::AtomicInc(&numFibers_) > maxFibers_)
 		{
-#ifdef DEBUG
-			Core::AtomicInc(&numWaitingFibers_);
-#endif
-			*outFiber = fiber;
-			DBG_ASSERT(fiber->job_.func_);
-#if VERBOSE_LOGGING >= 3
-			Core::Log("Waiting job \"%s\" (%u) being rescheduled.\n", fiber->job_.name_, fiber->job_.param_);
+			Core::AtomicDec(&numFibers_);
+			return nullptr;
+		}
+
+		auto* fiber = new Fiber(this, stackClass);
+		if(!fiber->fiber_)
+		{
+			delete fiber;
+			Core::AtomicDec(&numFibers_);
+			return nullptr;
+		}
+#if VERBOSE_LOGGING >= 2
+		Core::Log("Fiber pool grown to %u fibers.\n", numFibers_);
 #endif
-			return true;
+		return fiber;
+	}
+
+	bool ManagerImpl::TryAllocFiber(StackClass stackClass, Fiber*& outFiber)
+	{
+		bool dequeued = freeFibers_[(i32)stackClass].Dequeue(outFiber);
+		if(!dequeued)
+		{
+			// Grow on demand, so the pool only holds as many fibers as have been needed at once.
+			outFiber = NewFiber(stackClass);
+			if(outFiber)
+				return true;
+
+			// At the cap. A larger stack will do.
+			for(i32 i = (i32)stackClass + 1; i < NUM_STACK_CLASSES && !dequeued; ++i)
+				dequeued = freeFibers_[i].Dequeue(outFiber);
 		}
+#ifdef DEBUG
+		if(dequeued)
+			Core::AtomicDec(&numFreeFibers_);
+#endif
+		return dequeued;
+	}
 
+	Fiber* ManagerImpl::AllocFiber(StackClass stackClass)
+	{
+		Fiber* fiber = nullptr;
 
-		return !exiting_;
+#if VERBOSE_LOGGING >= 1
+		double startTime = Core::Timer::GetAbsoluteTime();
+		const double LOG_TIME_THRESHOLD = 100.0f / 1000000.0; // 100us.
+		const double LOG_TIME_REPEAT = 1000.0f / 1000.0;      // 1000ms.
+		double nextLogTime = startTime + LOG_TIME_THRESHOLD;
+#endif
+		i32 spinCount = 0;
+		i32 spinCountMax = 100;
+		while(!TryAllocFiber(stackClass, fiber))
+		{
+			++spinCount;
+			if(spinCount > spinCountMax)
+			{
+				Core::AtomicInc(&outOfFibers_);
+				if(spinCount == (spinCountMax + 1))
+					JOB_TRACE(OUT_OF_FIBERS, nullptr, outOfFibers_, 0);
+			}
+#if VERBOSE_LOGGING >= 1
+			double time = Core::Timer::GetAbsoluteTime();
+			if((time - startTime) > LOG_TIME_THRESHOLD)
+			{
+				if(time > nextLogTime)
+				{
+					Core::Log("Unable to get free fiber. Increase maxFibers. (Total time waiting: %f ms)\n",
+					    (time - startTime) * 1000.0);
+					nextLogTime = time + LOG_TIME_REPEAT;
+				}
+			}
+#endif
+			Core::SwitchThread();
+
+			// If all threads have spun this loop for too long simultaneously,
+			// we probably have a deadlock due to the fiber pool reaching its cap.
+			if(spinCount > spinCountMax)
+			{
+				if((Core::AtomicDec(&outOfFibers_) + 1) == workers_.size())
+				{
+					static bool breakHere = true;
+					if(breakHere)
+					{
+						DBG_BREAK;
+						breakHere = false;
+					}
+				}
+			}
+		}
+		return fiber;
 	}
 
 	void ManagerImpl::ReleaseFiber(Fiber* fiber, bool complete)
@@ -284,7 +598,8 @@ namespace Job
 #endif
 		if(complete)
 		{
-			while(!freeFibers_.Enqueue(fiber))
+			JOB_TRACE(JOB_END, fiber->job_.name_, fiber->job_.param_, fiber);
+			while(!freeFibers_[(i32)fiber->stackClass_].Enqueue(fiber))
 			{
 #if VERBOSE_LOGGING >= 1
 				Core::Log("Unable to enqueue free fiber.\n");
@@ -297,44 +612,297 @@ namespace Job
 		}
 		else
 		{
-			while(!waitingFibers_.Enqueue(fiber))
-			{
+			// Park on counter. If it's already reached its value, it's ready to resume straight away.
+			Counter* counter = fiber->waitCounter_;
+			fiber->waitCounter_ = nullptr;
+#if JOB_TRACE_ENABLED
+			if(counter)
+				JOB_TRACE(JOB_WAIT, fiber->job_.name_, fiber->job_.param_, counter);
+			else
+				JOB_TRACE(JOB_YIELD, fiber->job_.name_, fiber->job_.param_, fiber);
+#endif
+			if(counter == nullptr || !AddWaiter(counter, &fiber->waiter_))
+				ResumeFiber(fiber);
+		}
+	}
+
+	void ManagerImpl::OnDequeued(Priority priority)
+	{
+		Core::AtomicDec(&numQueued_);
+		if(priority == Priority::HIGH)
+			Core::AtomicDec(&numQueuedHigh_);
+	}
+
+	Fiber* ManagerImpl::GetCallingJobFiber()
+	{
+		if(auto* callingFiber = Core::Fiber::GetCurrentFiber())
+			return reinterpret_cast<Fiber*>(callingFiber->GetUserData());
+		return nullptr;
+	}
+
+	Worker* ManagerImpl::GetLocalWorker(Fiber* callingJobFiber)
+	{
+		// If work stealing and we're being called from a job, jobs go to the worker's local deque.
+		if(mode_ == SchedulerMode::WORK_STEALING && callingJobFiber &&
+		    callingJobFiber->worker_->group_ == WorkerGroup::GENERAL)
+		{
+			return callingJobFiber->worker_;
+		}
+		return nullptr;
+	}
+
+	bool ManagerImpl::TryEnqueueJob(Worker* localWorker, const JobDesc& job)
+	{
+		// Only the owning worker may push to its deque.
+		DBG_ASSERT(localWorker == nullptr || localWorker == GetCallingJobFiber()->worker_);
+
+		// Local deque full falls through to the global queue.
+		if(localWorker && job.priority_ == Priority::NORMAL && localWorker->jobs_.Push(job))
+			return true;
+
+		if(pendingJobs_[(i32)job.priority_].Enqueue(job))
+		{
+#ifdef DEBUG
+			Core::AtomicInc(&numPendingJobs_);
+#endif
+			return true;
+		}
+		return false;
+	}
+
+	void ManagerImpl::OnJobsQueued(i32 numJobs, i32 numHighJobs)
+	{
+		// Wake only as many parked workers as there are new jobs.
+		Core::AtomicAdd(&numQueuedHigh_, numHighJobs);
+		Core::AtomicAdd(&numQueued_, numJobs);
+		WakeWorkers(Priority::HIGH, numHighJobs);
+		WakeWorkers(Priority::NORMAL, numJobs - numHighJobs);
+	}
+
+	void ManagerImpl::ResumeFiber(Fiber* fiber)
+	{
+		const Priority priority = fiber->readyPriority_;
+		while(!readyFibers_[(i32)priority].Enqueue(fiber))
+		{
 #if VERBOSE_LOGGING >= 1
-				Core::Log("Unable to enqueue waiting fiber.\n");
+			Core::Log("Unable to enqueue ready fiber.\n");
 #endif
-				Core::SwitchThread();
-			}
+			Core::SwitchThread();
+		}
 #ifdef DEBUG
-			Core::AtomicInc(&numWaitingFibers_);
+		Core::AtomicInc(&numReadyFibers_);
+#endif
+		if(priority == Priority::HIGH)
+			Core::AtomicInc(&numQueuedHigh_);
+		Core::AtomicInc(&numQueued_);
+		WakeWorkers(priority, 1);
+	}
+
+	Counter* ManagerImpl::AllocCounter()
+	{
+		Counter* counter = nullptr;
+		if(!freeCounters_.Dequeue(counter))
+		{
+			counter = new Counter();
+			Core::ScopedMutex lock(countersMutex_);
+			counters_.push_back(counter);
+		}
+		return counter;
+	}
+
+	void ManagerImpl::FreeCounter(Counter* counter)
+	{
+		DBG_ASSERT(counter->value_ == 0);
+		DBG_ASSERT(counter->waiters_ == nullptr);
+		counter->free_ = false;
+
+		// Counters are only deleted on finalize, as a completing job may still be checking for waiters
+		// after the counter has been freed. If the pool is full, it'll just wait until then.
+		freeCounters_.Enqueue(counter);
+	}
+
+	bool ManagerImpl::AddWaiter(Counter* counter, CounterWaiter* waiter)
+	{
+		counter->Lock();
+		// Increment before checking value. This pairs with SignalCounter decrementing value before checking
+		// numWaiters_, so either we see the new value or it sees us.
+		Core::AtomicInc(&counter->numWaiters_);
+		if(counter->value_ <= waiter->value_)
+		{
+			Core::AtomicDec(&counter->numWaiters_);
+			counter->Unlock();
+			return false;
+		}
+		waiter->next_ = counter->waiters_;
+		counter->waiters_ = waiter;
+		counter->Unlock();
+		return true;
+	}
+
+	void ManagerImpl::SignalCounter(Counter* counter)
+	{
+		if(counter->numWaiters_ == 0)
+			return;
+
+		// Gather ready waiters under lock, but resume them outside of it: once resumed the counter may be freed.
+		CounterWaiter* readyWaiters = nullptr;
+		counter->Lock();
+		const i32 value = counter->value_;
+		CounterWaiter** waiterIt = &counter->waiters_;
+		while(*waiterIt)
+		{
+			CounterWaiter* waiter = *waiterIt;
+			if(value <= waiter->value_)
+			{
+				*waiterIt = waiter->next_;
+				waiter->next_ = readyWaiters;
+				readyWaiters = waiter;
+				Core::AtomicDec(&counter->numWaiters_);
+			}
+			else
+			{
+				waiterIt = &waiter->next_;
+			}
+		}
+		counter->Unlock();
+
+		while(readyWaiters)
+		{
+			// Grab next first, a thread's waiter is on its stack and is gone once signalled.
+			CounterWaiter* waiter = readyWaiters;
+			readyWaiters = waiter->next_;
+			JOB_TRACE(WAKE, waiter->fiber_ ? waiter->fiber_->job_.name_ : nullptr, value, waiter);
+			if(waiter->fiber_)
+				ResumeFiber(waiter->fiber_);
+			else
+				waiter->semaphore_->Signal();
+		}
+	}
+
+	void ManagerImpl::ParkWorker(Worker* worker)
+	{
+		const i32 group = (i32)worker->group_;
+		volatile i32* numQueued = worker->group_ == WorkerGroup::HIGH_PRIORITY ? &numQueuedHigh_ : &numQueued_;
+
+		// Register as parked before the final check for work. This pairs with OnJobsQueued increasing numQueued_
+		// before checking numParked_, so either we see the new work or it sees us and signals.
+		Core::AtomicInc(&numParked_[group]);
+		if(*numQueued <= 0 && !exiting_)
+		{
+#if VERBOSE_LOGGING >= 2
+			Core::Log("Worker %u parking.\n", worker->idx_);
 #endif
+			JOB_TRACE(PARK, nullptr, worker->idx_, 0);
+			wakeSemaphores_[group].Wait();
+			JOB_TRACE(UNPARK, nullptr, worker->idx_, 0);
+			return;
+		}
+
+		// Work arrived, unregister. If a waker already claimed us, consume its signal instead.
+		for(;;)
+		{
+			const i32 numParked = numParked_[group];
+			if(numParked == 0)
+			{
+				wakeSemaphores_[group].Wait();
+				return;
+			}
+			if(Core::AtomicCmpExchg(&numParked_[group], numParked - 1, numParked) == numParked)
+				return;
 		}
 	}
 
-	void Manager::Initialize(i32 numWorkers, i32 numFibers, i32 fiberStackSize)
+	i32 ManagerImpl::WakeWorkers(WorkerGroup group, i32 numToWake)
 	{
+		// Claim parked workers before signalling, so concurrent wakers don't signal the same worker twice.
+		volatile i32* numParkedPtr = &numParked_[(i32)group];
+		for(;;)
+		{
+			const i32 numParked = *numParkedPtr;
+			if(numParked == 0 || numToWake <= 0)
+				return 0;
+			const i32 numWaking = numToWake < numParked ? numToWake : numParked;
+			if(Core::AtomicCmpExchg(numParkedPtr, numParked - numWaking, numParked) == numParked)
+			{
+				wakeSemaphores_[(i32)group].Signal(numWaking);
+				return numWaking;
+			}
+		}
+	}
+
+	void ManagerImpl::WakeWorkers(Priority priority, i32 numToWake)
+	{
+		// High priority work goes to dedicated workers first, so general workers stay on their current work.
+		if(priority == Priority::HIGH)
+			numToWake -= WakeWorkers(WorkerGroup::HIGH_PRIORITY, numToWake);
+		WakeWorkers(WorkerGroup::GENERAL, numToWake);
+	}
+
+	void Manager::Initialize(i32 numWorkers, i32 numFibers, i32 fiberStackSize, SchedulerMode mode,
+	    i32 numHighPriorityWorkers, i32 maxFibers, i32 largeFiberStackSize)
+	{
+		if(maxFibers == 0)
+			maxFibers = numFibers * DEFAULT_MAX_FIBERS_SCALE;
+		if(largeFiberStackSize == 0)
+			largeFiberStackSize = fiberStackSize * DEFAULT_LARGE_STACK_SCALE;
+
 		DBG_ASSERT(impl_ == nullptr);
 		DBG_ASSERT(numWorkers > 0);
 		DBG_ASSERT(numFibers > 0);
+		DBG_ASSERT(maxFibers >= numFibers);
 		DBG_ASSERT(fiberStackSize > (4 * 1024));
+		DBG_ASSERT(largeFiberStackSize >= fiberStackSize);
+		DBG_ASSERT(numHighPriorityWorkers >= 0 && numHighPriorityWorkers < numWorkers);
+
+		// Fiber queues must be able to hold every fiber the pool can grow to.
+		i32 fiberQueueSize = 2;
+		while(fiberQueueSize < maxFibers)
+			fiberQueueSize *= 2;
 
 		impl_ = new ManagerImpl();
 		impl_->workers_.reserve(numWorkers);
-		impl_->freeFibers_ = Core::MPMCBoundedQueue<class Fiber*>(numFibers);
-		impl_->waitingFibers_ = Core::MPMCBoundedQueue<class Fiber*>(numFibers);
-		impl_->pendingJobs_ = Core::MPMCBoundedQueue<JobDesc>(numFibers);
-		impl_->fiberStackSize_ = fiberStackSize;
-
-		for(i32 i = 0; i < numWorkers; ++i)
+		for(i32 i = 0; i < NUM_STACK_CLASSES; ++i)
+		{
+			impl_->freeFibers_[i] = Core::MPMCBoundedQueue<class Fiber*>(fiberQueueSize);
+		}
+		for(i32 i = 0; i < NUM_PRIORITIES; ++i)
 		{
-			impl_->workers_.emplace_back(new Worker(impl_, i));
+			impl_->readyFibers_[i] = Core::MPMCBoundedQueue<class Fiber*>(fiberQueueSize);
+			// Bounded, to limit how far submitters can run ahead of workers.
+			impl_->pendingJobs_[i] = Core::MPMCBoundedQueue<JobDesc>(numFibers);
 		}
+		impl_->freeCounters_ = Core::MPMCBoundedQueue<Counter*>(COUNTER_POOL_SIZE);
+		impl_->fiberStackSizes_[(i32)StackClass::SMALL] = fiberStackSize;
+		impl_->fiberStackSizes_[(i32)StackClass::LARGE] = largeFiberStackSize;
+		impl_->maxFibers_ = maxFibers;
+		impl_->mode_ = mode;
+
+		// Initial fibers are created before workers start, so they don't grow the pool instead.
 		for(i32 i = 0; i < numFibers; ++i)
 		{
-			bool retVal = impl_->freeFibers_.Enqueue(new Fiber(impl_));
+			Fiber* fiber = impl_->NewFiber(StackClass::SMALL);
+			DBG_ASSERT(fiber);
+			if(fiber)
+			{
+				bool retVal = impl_->freeFibers_[(i32)StackClass::SMALL].Enqueue(fiber);
 #ifdef DEBUG
-			Core::AtomicInc(&impl_->numFreeFibers_);
+				Core::AtomicInc(&impl_->numFreeFibers_);
 #endif
-			DBG_ASSERT(retVal);
+				DBG_ASSERT(retVal);
+			}
+		}
+
+		// All workers must exist before any start, as they may attempt to steal from each other.
+		// Dedicated high priority workers are last.
+		const i32 numGeneralWorkers = numWorkers - numHighPriorityWorkers;
+		for(i32 i = 0; i < numWorkers; ++i)
+		{
+			const WorkerGroup group = i < numGeneralWorkers ? WorkerGroup::GENERAL : WorkerGroup::HIGH_PRIORITY;
+			impl_->workers_.emplace_back(new Worker(impl_, i, group));
+		}
+		for(auto* worker : impl_->workers_)
+		{
+			worker->Start();
 		}
 	}
 
@@ -343,6 +911,9 @@ namespace Job
 		DBG_ASSERT(impl_);
 
 		impl_->exiting_ = true;
+		Core::Barrier();
+		impl_->WakeWorkers(WorkerGroup::GENERAL, impl_->workers_.size());
+		impl_->WakeWorkers(WorkerGroup::HIGH_PRIORITY, impl_->workers_.size());
 
 		// Wait for jobs to complete, and exit all fibers.
 		{
@@ -353,15 +924,30 @@ namespace Job
 				Core::SwitchThread();
 
 			Fiber* fiber = nullptr;
-			DBG_ASSERT(!impl_->waitingFibers_.Dequeue(fiber));
+#ifdef DEBUG
+			for(i32 i = 0; i < NUM_PRIORITIES; ++i)
+			{
+				DBG_ASSERT(!impl_->readyFibers_[i].Dequeue(fiber));
+			}
+#endif
 
-			// Ensure all fibers exit.
-			while(impl_->freeFibers_.Dequeue(fiber))
+			// Ensure all fibers exit. Workers may still be returning the last to complete.
+			i32 numFibersExited = 0;
+			while(numFibersExited < impl_->numFibers_)
 			{
-				fiber->exiting_ = true;
-				fiber->SwitchTo(nullptr, nullptr);
-				DBG_ASSERT(fiber->exited_);
-				delete fiber;
+				for(i32 i = 0; i < NUM_STACK_CLASSES; ++i)
+				{
+					while(impl_->freeFibers_[i].Dequeue(fiber))
+					{
+						fiber->exiting_ = true;
+						fiber->SwitchTo(nullptr, nullptr);
+						DBG_ASSERT(fiber->exited_);
+						delete fiber;
+						++numFibersExited;
+					}
+				}
+				if(numFibersExited < impl_->numFibers_)
+					Core::SwitchThread();
 			}
 
 			// Ensure all threads exit.
@@ -372,6 +958,12 @@ namespace Job
 				DBG_ASSERT(worker->exited_);
 				delete worker;
 			}
+
+			// Free all counters.
+			for(auto* counter : impl_->counters_)
+			{
+				delete counter;
+			}
 		}
 		delete impl_;
 		impl_ = nullptr;
@@ -379,18 +971,39 @@ namespace Job
 
 	bool Manager::IsInitialized() { return !!impl_; }
 
+	i32 Manager::GetNumFibers()
+	{
+		DBG_ASSERT(IsInitialized());
+		return impl_->numFibers_;
+	}
+
 	void Manager::RunJobs(JobDesc* jobDescs, i32 numJobDesc, Counter** counter)
 	{
 		DBG_ASSERT(IsInitialized());
-		DBG_ASSERT(counter == nullptr || *counter == nullptr);
 
-		// Setup counter.
-		auto* localCounter = new Counter();
-		localCounter->value_ = numJobDesc;
-		localCounter->free_ = counter == nullptr;
+		// Setup counter, or add to an existing one.
+		Counter* localCounter = counter ? *counter : nullptr;
+		if(localCounter)
+		{
+			DBG_ASSERT(localCounter->value_ > 0);
+			Core::AtomicAdd(&localCounter->value_, numJobDesc);
+		}
+		else
+		{
+			localCounter = impl_->AllocCounter();
+			localCounter->value_ = numJobDesc;
+			localCounter->free_ = counter == nullptr;
+
+			// Store before any job can run, so they're able to add to it.
+			if(counter != nullptr)
+				*counter = localCounter;
+		}
 
 		Core::AtomicAdd(&impl_->jobCount_, numJobDesc);
 
+		Fiber* callingJobFiber = impl_->GetCallingJobFiber();
+		Worker* localWorker = impl_->GetLocalWorker(callingJobFiber);
+
 // Push jobs into pending job queue ready to be given fibers.
 #if VERBOSE_LOGGING >= 1
 		double startTime = Core::Timer::GetAbsoluteTime();
@@ -399,13 +1012,26 @@ namespace Job
 		double nextLogTime = startTime + LOG_TIME_THRESHOLD;
 #endif
 
+		// Jobs queued but not yet counted in numQueued_, so parked workers don't know about them yet.
+		i32 numUnpublished = 0;
+		i32 numHighUnpublished = 0;
 		for(i32 i = 0; i < numJobDesc; ++i)
 		{
 			DBG_ASSERT(jobDescs[i].counter_ == nullptr);
+			DBG_ASSERT(jobDescs[i].priority_ >= Priority::HIGH && jobDescs[i].priority_ < Priority::MAX);
 			jobDescs[i].counter_ = localCounter;
+			const Priority priority = jobDescs[i].priority_;
 
-			while(!impl_->pendingJobs_.Enqueue(jobDescs[i]))
+			while(!impl_->TryEnqueueJob(localWorker, jobDescs[i]))
 			{
+				// Queue is full. Publish what's queued so far, waking workers to drain it, or this never ends.
+				if(numUnpublished > 0)
+				{
+					impl_->OnJobsQueued(numUnpublished, numHighUnpublished);
+					numUnpublished = 0;
+					numHighUnpublished = 0;
+				}
+
 #if VERBOSE_LOGGING >= 1
 				double time = Core::Timer::GetAbsoluteTime();
 				if((time - startTime) > LOG_TIME_THRESHOLD)
@@ -418,19 +1044,71 @@ namespace Job
 					}
 				}
 #endif
+				// Resume no sooner than the queue's own priority, so workers drain it before rescheduling us.
+				if(callingJobFiber && priority > callingJobFiber->readyPriority_)
+					callingJobFiber->readyPriority_ = priority;
 				YieldCPU();
-			}
 
-#ifdef DEBUG
-			Core::AtomicInc(&impl_->numPendingJobs_);
-#endif
+				// May have resumed on another worker, whose deque only it may push to.
+				localWorker = impl_->GetLocalWorker(callingJobFiber);
+			}
+			++numUnpublished;
+			if(priority == Priority::HIGH)
+				++numHighUnpublished;
 		}
+		if(callingJobFiber)
+			callingJobFiber->readyPriority_ = callingJobFiber->job_.priority_;
+
+		if(numUnpublished > 0)
+			impl_->OnJobsQueued(numUnpublished, numHighUnpublished);
+	}
+
+	bool Manager::TryRunJob(JobDesc& jobDesc, Counter** counter)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(jobDesc.counter_ == nullptr);
+		DBG_ASSERT(jobDesc.priority_ >= Priority::HIGH && jobDesc.priority_ < Priority::MAX);
 
-		// If counter is requests, store it.
-		if(counter != nullptr)
+		// Counter must account for the job before it's queued, as it may complete straight away.
+		Counter* localCounter = counter ? *counter : nullptr;
+		const bool newCounter = localCounter == nullptr;
+		if(newCounter)
 		{
+			localCounter = impl_->AllocCounter();
+			localCounter->value_ = 1;
+			localCounter->free_ = counter == nullptr;
+		}
+		else
+		{
+			DBG_ASSERT(localCounter->value_ > 0);
+			Core::AtomicInc(&localCounter->value_);
+		}
+		Core::AtomicInc(&impl_->jobCount_);
+
+		jobDesc.counter_ = localCounter;
+		if(counter && newCounter)
 			*counter = localCounter;
+		if(!impl_->TryEnqueueJob(impl_->GetLocalWorker(impl_->GetCallingJobFiber()), jobDesc))
+		{
+			// Roll back.
+			jobDesc.counter_ = nullptr;
+			Core::AtomicDec(&impl_->jobCount_);
+			if(newCounter)
+			{
+				if(counter)
+					*counter = nullptr;
+				localCounter->value_ = 0;
+				impl_->FreeCounter(localCounter);
+			}
+			else
+			{
+				Core::AtomicDec(&localCounter->value_);
+			}
+			return false;
 		}
+
+		impl_->OnJobsQueued(1, jobDesc.priority_ == Priority::HIGH ? 1 : 0);
+		return true;
 	}
 
 	void Manager::WaitForCounter(Counter*& counter, i32 value)
@@ -438,16 +1116,52 @@ namespace Job
 		DBG_ASSERT(IsInitialized());
 		DBG_ASSERT(counter);
 
-		while(counter->value_ > value)
+		if(auto* callingFiber = Core::Fiber::GetCurrentFiber())
 		{
-			YieldCPU();
+			auto* fiber = reinterpret_cast<Fiber*>(callingFiber->GetUserData());
+			DBG_ASSERT(fiber->worker_);
+			DBG_ASSERT(fiber->workerFiber_);
+
+			// Switch back to worker, which will park us on the counter until it reaches value.
+			while(counter->value_ > value)
+			{
+#if VERBOSE_LOGGING >= 2
+				Core::Log("Job \"%s\" waiting on counter\n", fiber->job_.name_);
+#endif
+				fiber->waitCounter_ = counter;
+				fiber->waiter_.value_ = value;
+				fiber->waiter_.fiber_ = fiber;
+				Core::AtomicExchg(&fiber->worker_->moveToWaiting_, 1);
+				fiber->Suspend();
+			}
+		}
+		else
+		{
+			PROFILE_SCOPE("Job::WaitForCounter");
+
+			// Not in a job, spin briefly then block the thread until signalled.
+			for(i32 i = 0; i < COUNTER_SPIN_COUNT && counter->value_ > value; ++i)
+				Core::SwitchThread();
+
+			if(counter->value_ > value)
+			{
+				Core::Semaphore semaphore;
+				CounterWaiter waiter;
+				waiter.value_ = value;
+				waiter.semaphore_ = &semaphore;
+				if(impl_->AddWaiter(counter, &waiter))
+				{
+					JOB_TRACE(WAIT_BEGIN, nullptr, value, counter);
+					semaphore.Wait();
+					JOB_TRACE(WAIT_END, nullptr, value, &waiter);
+				}
+			}
 		}
 
 		// Free counter.
-		// TODO: Keep a pool of these?
 		if(value == 0)
 		{
-			delete counter;
+			impl_->FreeCounter(counter);
 			counter = nullptr;
 		}
 	}
@@ -469,7 +1183,7 @@ namespace Job
 
 			// Switch back to worker, but set waiting flag.
 			Core::AtomicExchg(&fiber->worker_->moveToWaiting_, 1);
-			fiber->workerFiber_->SwitchTo();
+			fiber->Suspend();
 		}
 		else
 		{
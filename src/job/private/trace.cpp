@@ -0,0 +1,354 @@
+#include "job/trace.h"
+#include "job/private/trace.h"
+#include "core/concurrency.h"
+#include "core/misc.h"
+#include "core/string.h"
+#include "core/timer.h"
+#include "core/vector.h"
+
+#include <cstdio>
+
+namespace Job
+{
+#if JOB_TRACE_ENABLED
+	namespace
+	{
+		/// Events kept per thread. Must be a power of two.
+		static const i32 TRACE_BUFFER_SIZE = 32 * 1024;
+		static const i32 TRACE_THREAD_NAME_SIZE = 32;
+
+		struct TraceEvent
+		{
+			u64 ticks_;
+			u64 id_;
+			const char* name_;
+			i32 param_;
+			TraceEventType type_;
+		};
+
+		struct TraceBuffer
+		{
+			TraceEvent events_[TRACE_BUFFER_SIZE];
+			/// Total events written. Only the owning thread writes.
+			u64 numWritten_ = 0;
+			char name_[TRACE_THREAD_NAME_SIZE] = {0};
+			i32 idx_ = 0;
+			/// Cleared when owning thread exits, buffer is freed on next Start.
+			volatile i32 inUse_ = 1;
+		};
+
+		/// Owns the calling thread's buffer.
+		struct TraceThread
+		{
+			TraceBuffer* buffer_ = nullptr;
+
+			~TraceThread()
+			{
+				if(buffer_)
+					Core::AtomicExchg(&buffer_->inUse_, 0);
+			}
+		};
+
+		volatile i32 traceActive_ = 0;
+		u64 startTicks_ = 0;
+		u64 stopTicks_ = 0;
+		f64 startTime_ = 0.0;
+		f64 stopTime_ = 0.0;
+		Core::Mutex buffersMutex_;
+
+		/// Every thread's buffer. Outlives the threads, so a trace can be written after workers exit.
+		struct TraceBuffers
+		{
+			Core::Vector<TraceBuffer*> buffers_;
+
+			~TraceBuffers()
+			{
+				for(TraceBuffer* buffer : buffers_)
+					delete buffer;
+			}
+		};
+		TraceBuffers traceBuffers_;
+		i32 nextThreadIdx_ = 0;
+		thread_local TraceThread traceThread_;
+
+		inline u64 GetTraceTicks()
+		{
+			// Not serializing, but events on a thread are already ordered and it's a fraction of the cost.
+			return Core::Timer::GetCycleCount();
+		}
+
+		TraceBuffer* GetTraceBuffer()
+		{
+			TraceBuffer* buffer = traceThread_.buffer_;
+			if(buffer == nullptr)
+			{
+				buffer = new TraceBuffer();
+				Core::ScopedMutex lock(buffersMutex_);
+				buffer->idx_ = nextThreadIdx_++;
+				sprintf_s(buffer->name_, sizeof(buffer->name_), "Thread %d", buffer->idx_);
+				traceBuffers_.buffers_.push_back(buffer);
+				traceThread_.buffer_ = buffer;
+			}
+			return buffer;
+		}
+
+		/// Append @a str to @a out as a JSON string, with quotes.
+		void AppendJSONString(Core::String& out, const char* str)
+		{
+			char escaped[256];
+			i32 len = 0;
+			escaped[len++] = '"';
+			for(const char* c = str ? str : ""; *c && len < (i32)sizeof(escaped) - 3; ++c)
+			{
+				if(*c == '"' || *c == '\\')
+					escaped[len++] = '\\';
+				escaped[len++] = (u8)*c >= 0x20 ? *c : ' ';
+			}
+			escaped[len++] = '"';
+			escaped[len] = '\0';
+			out += escaped;
+		}
+
+		/// Writes events for one thread.
+		class ChromeTraceWriter
+		{
+		public:
+			ChromeTraceWriter(Core::String& out, f64 usPerTick)
+			    : out_(out)
+			    , usPerTick_(usPerTick)
+			{
+			}
+
+			void Write(const TraceBuffer& buffer)
+			{
+				tid_ = buffer.idx_;
+				out_.Appendf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":", tid_);
+				AppendJSONString(out_, buffer.name_);
+				out_ += "}},\n";
+
+				// Oldest events have been overwritten once wrapped, so slices may begin without a start.
+				const u64 end = buffer.numWritten_;
+				const u64 begin = end > TRACE_BUFFER_SIZE ? end - TRACE_BUFFER_SIZE : 0;
+				for(u64 idx = begin; idx < end; ++idx)
+					WriteEvent(buffer.events_[idx & (TRACE_BUFFER_SIZE - 1)]);
+
+				// Close anything still open.
+				if(jobBegin_)
+					WriteSlice(jobBegin_, end > begin ? buffer.events_[(end - 1) & (TRACE_BUFFER_SIZE - 1)].ticks_ : 0,
+					    "running");
+			}
+
+		private:
+			void WriteEvent(const TraceEvent& event)
+			{
+				switch(event.type_)
+				{
+				case TraceEventType::JOB_RESUME:
+					// Arrow from whatever woke the job. Chrome ignores ends without a start, i.e. after yielding.
+					WriteFlow("f", event.ticks_, event.id_);
+				// fall through.
+				case TraceEventType::JOB_BEGIN:
+					jobBegin_ = &event;
+					break;
+				case TraceEventType::JOB_END:
+					WriteSlice(jobBegin_, event.ticks_, "complete");
+					jobBegin_ = nullptr;
+					break;
+				case TraceEventType::JOB_YIELD:
+					WriteSlice(jobBegin_, event.ticks_, "yield");
+					jobBegin_ = nullptr;
+					break;
+				case TraceEventType::JOB_WAIT:
+					WriteSlice(jobBegin_, event.ticks_, "wait");
+					jobBegin_ = nullptr;
+					break;
+				case TraceEventType::WAKE:
+					WriteInstant("Wake", event);
+					WriteFlow("s", event.ticks_, event.id_);
+					break;
+				case TraceEventType::STEAL:
+					WriteInstant("Steal", event);
+					break;
+				case TraceEventType::OUT_OF_FIBERS:
+					WriteInstant("Out of fibers", event);
+					out_.Appendf("{\"name\":\"outOfFibers\",\"ph\":\"C\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,"
+					             "\"args\":{\"workers\":%d}},\n",
+					    tid_, ToUs(event.ticks_), event.param_);
+					break;
+				case TraceEventType::PARK:
+				case TraceEventType::WAIT_BEGIN:
+					waitBegin_ = &event;
+					break;
+				case TraceEventType::UNPARK:
+					WriteWait("Parked", event);
+					break;
+				case TraceEventType::WAIT_END:
+					WriteWait("WaitForCounter", event);
+					WriteFlow("f", event.ticks_, event.id_);
+					break;
+				default:
+					break;
+				}
+			}
+
+			void WriteSlice(const TraceEvent* begin, u64 endTicks, const char* reason)
+			{
+				if(begin == nullptr)
+					return;
+				out_ += "{\"name\":";
+				AppendJSONString(out_, begin->name_);
+				out_.Appendf(",\"cat\":\"job\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+				             "\"args\":{\"param\":%d,\"%s\":\"%s\"}},\n",
+				    tid_, ToUs(begin->ticks_), ToUs(endTicks) - ToUs(begin->ticks_), begin->param_,
+				    begin->type_ == TraceEventType::JOB_RESUME ? "resumed" : "began", reason);
+			}
+
+			void WriteWait(const char* name, const TraceEvent& end)
+			{
+				if(waitBegin_ == nullptr)
+					return;
+				out_.Appendf("{\"name\":\"%s\",\"cat\":\"wait\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,"
+				             "\"dur\":%.3f},\n",
+				    name, tid_, ToUs(waitBegin_->ticks_), ToUs(end.ticks_) - ToUs(waitBegin_->ticks_));
+				waitBegin_ = nullptr;
+			}
+
+			void WriteInstant(const char* name, const TraceEvent& event)
+			{
+				out_.Appendf("{\"name\":\"%s\",\"cat\":\"sched\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":%d,"
+				             "\"ts\":%.3f,\"args\":{\"job\":",
+				    name, tid_, ToUs(event.ticks_));
+				AppendJSONString(out_, event.name_);
+				out_.Appendf(",\"param\":%d}},\n", event.param_);
+			}
+
+			void WriteFlow(const char* phase, u64 ticks, u64 id)
+			{
+				out_.Appendf("{\"name\":\"wake\",\"cat\":\"wait\",\"ph\":\"%s\",\"bp\":\"e\",\"id\":\"0x%llx\","
+				             "\"pid\":0,\"tid\":%d,\"ts\":%.3f},\n",
+				    phase, (unsigned long long)id, tid_, ToUs(ticks));
+			}
+
+			f64 ToUs(u64 ticks) const { return (f64)(i64)(ticks - startTicks_) * usPerTick_; }
+
+			Core::String& out_;
+			f64 usPerTick_ = 0.0;
+			i32 tid_ = 0;
+			const TraceEvent* jobBegin_ = nullptr;
+			const TraceEvent* waitBegin_ = nullptr;
+		};
+	} // namespace
+
+	void TraceRecord(TraceEventType type, const char* name, i32 param, u64 id)
+	{
+		if(!traceActive_)
+			return;
+
+		TraceBuffer* buffer = GetTraceBuffer();
+		TraceEvent& event = buffer->events_[buffer->numWritten_ & (TRACE_BUFFER_SIZE - 1)];
+		event.ticks_ = GetTraceTicks();
+		event.id_ = id;
+		event.name_ = name;
+		event.param_ = param;
+		event.type_ = type;
+		++buffer->numWritten_;
+	}
+
+	void TraceSetThreadName(const char* name, i32 idx)
+	{
+		TraceBuffer* buffer = GetTraceBuffer();
+		sprintf_s(buffer->name_, sizeof(buffer->name_), "%s %d", name, idx);
+	}
+
+	bool Trace::IsAvailable() { return true; }
+
+	void Trace::Start()
+	{
+		Stop();
+
+		Core::ScopedMutex lock(buffersMutex_);
+		for(i32 idx = 0; idx < traceBuffers_.buffers_.size();)
+		{
+			TraceBuffer* buffer = traceBuffers_.buffers_[idx];
+			if(buffer->inUse_)
+			{
+				buffer->numWritten_ = 0;
+				++idx;
+			}
+			else
+			{
+				delete buffer;
+				traceBuffers_.buffers_.erase(traceBuffers_.buffers_.begin() + idx);
+			}
+		}
+
+		startTime_ = Core::Timer::GetAbsoluteTime();
+		startTicks_ = GetTraceTicks();
+		stopTicks_ = startTicks_;
+		stopTime_ = startTime_;
+		Core::AtomicExchg(&traceActive_, 1);
+	}
+
+	void Trace::Stop()
+	{
+		if(Core::AtomicExchg(&traceActive_, 0))
+		{
+			stopTime_ = Core::Timer::GetAbsoluteTime();
+			stopTicks_ = GetTraceTicks();
+		}
+	}
+
+	i32 Trace::GetNumEvents(TraceEventType type)
+	{
+		Core::ScopedMutex lock(buffersMutex_);
+		i32 numEvents = 0;
+		for(const TraceBuffer* buffer : traceBuffers_.buffers_)
+		{
+			const u64 end = buffer->numWritten_;
+			const u64 begin = end > TRACE_BUFFER_SIZE ? end - TRACE_BUFFER_SIZE : 0;
+			for(u64 idx = begin; idx < end; ++idx)
+				if(buffer->events_[idx & (TRACE_BUFFER_SIZE - 1)].type_ == type)
+					++numEvents;
+		}
+		return numEvents;
+	}
+
+	bool Trace::WriteChromeTrace(Core::String& outJSON)
+	{
+		// Ticks are calibrated against the timer over the whole trace.
+		u64 stopTicks = stopTicks_;
+		f64 stopTime = stopTime_;
+		if(traceActive_)
+		{
+			stopTime = Core::Timer::GetAbsoluteTime();
+			stopTicks = GetTraceTicks();
+		}
+		const f64 usPerTick =
+		    stopTicks > startTicks_ ? ((stopTime - startTime_) * 1000000.0) / (f64)(stopTicks - startTicks_) : 0.0;
+
+		Core::ScopedMutex lock(buffersMutex_);
+		u64 numEvents = 0;
+		for(const TraceBuffer* buffer : traceBuffers_.buffers_)
+			numEvents += Core::Min(buffer->numWritten_, (u64)TRACE_BUFFER_SIZE);
+		outJSON.reserve((i32)Core::Min(numEvents * 160 + 1024, (u64)0x7fffffff));
+
+		outJSON = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+		for(const TraceBuffer* buffer : traceBuffers_.buffers_)
+		{
+			ChromeTraceWriter writer(outJSON, usPerTick);
+			writer.Write(*buffer);
+		}
+		// Terminating event, so every other one can have a trailing comma.
+		outJSON += "{\"name\":\"trace_end\",\"ph\":\"M\",\"pid\":0,\"tid\":0}\n]}\n";
+		return true;
+	}
+
+#else
+	bool Trace::IsAvailable() { return false; }
+	void Trace::Start() {}
+	void Trace::Stop() {}
+	i32 Trace::GetNumEvents(TraceEventType) { return 0; }
+	bool Trace::WriteChromeTrace(Core::String&) { return false; }
+
+#endif // JOB_TRACE_ENABLED
+} // namespace Job
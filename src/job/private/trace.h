@@ -0,0 +1,33 @@
+#pragma once
+
+#include "core/types.h"
+#include "job/trace.h"
+
+#ifndef JOB_TRACE_ENABLED
+#define JOB_TRACE_ENABLED (0)
+#endif
+
+#if JOB_TRACE_ENABLED
+namespace Job
+{
+	/**
+	 * Record trace event for the calling thread. Does nothing unless recording.
+	 * @param type Event type.
+	 * @param name Name, normally JobDesc::name_. Must outlive the trace.
+	 * @param param Parameter, normally JobDesc::param_.
+	 * @param id Identifier linking events, i.e. WAKE to the JOB_RESUME or WAIT_END it caused.
+	 */
+	void TraceRecord(TraceEventType type, const char* name, i32 param, u64 id);
+
+	/**
+	 * Set name of calling thread in trace, as "<name> <idx>".
+	 */
+	void TraceSetThreadName(const char* name, i32 idx);
+} // namespace Job
+
+#define JOB_TRACE(TYPE, NAME, PARAM, ID) Job::TraceRecord(Job::TraceEventType::TYPE, NAME, PARAM, (u64)(ID))
+#define JOB_TRACE_THREAD_NAME(NAME, IDX) Job::TraceSetThreadName(NAME, IDX)
+#else
+#define JOB_TRACE(TYPE, NAME, PARAM, ID) (void)0
+#define JOB_TRACE_THREAD_NAME(NAME, IDX) (void)0
+#endif
@@ -0,0 +1,242 @@
+#include "catch.hpp"
+
+#include "core/concurrency.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "job/graph.h"
+#include "job/manager.h"
+
+using namespace Core;
+
+namespace
+{
+	static const i32 MAX_FIBERS = 128;
+	static const i32 FIBER_STACK_SIZE = 16 * 1024;
+
+	/// Records the order nodes ran in.
+	struct OrderData
+	{
+		volatile i32 nextOrder_ = 0;
+		Core::Vector<i32> order_;
+	};
+
+	Job::JobDesc OrderJob(OrderData& data, i32 nodeIdx)
+	{
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) {
+			auto* orderData = (OrderData*)data;
+			orderData->order_[param] = Core::AtomicInc(&orderData->nextOrder_);
+		};
+		jobDesc.param_ = nodeIdx;
+		jobDesc.data_ = &data;
+		jobDesc.name_ = "orderJob";
+		return jobDesc;
+	}
+
+	/// Build a graph of @a numNodes order jobs.
+	void AddOrderNodes(Job::Graph& graph, OrderData& data, i32 numNodes)
+	{
+		data.order_.resize(numNodes, 0);
+		for(i32 i = 0; i < numNodes; ++i)
+			REQUIRE(graph.AddNode(OrderJob(data, i)) == i);
+	}
+
+	void ResetOrder(OrderData& data)
+	{
+		data.nextOrder_ = 0;
+		data.order_.fill(0);
+	}
+}
+
+TEST_CASE("graph-tests-diamond")
+{
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	// 0 -> 1, 2 -> 3
+	OrderData data;
+	Job::Graph graph;
+	AddOrderNodes(graph, data, 4);
+	graph.AddEdge(0, 1);
+	graph.AddEdge(0, 2);
+	graph.AddEdge(1, 3);
+	graph.AddEdge(2, 3);
+
+	// Resubmitting must give the same ordering constraints.
+	for(i32 i = 0; i < 100; ++i)
+	{
+		ResetOrder(data);
+		graph.Run();
+
+		REQUIRE(data.nextOrder_ == 4);
+		REQUIRE(data.order_[0] == 1);
+		REQUIRE(data.order_[1] > data.order_[0]);
+		REQUIRE(data.order_[2] > data.order_[0]);
+		REQUIRE(data.order_[3] == 4);
+	}
+}
+
+TEST_CASE("graph-tests-fan-in")
+{
+	const i32 NUM_SOURCES = 1000;
+
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	// Many sources feeding a single sink, which must run last.
+	OrderData data;
+	Job::Graph graph;
+	AddOrderNodes(graph, data, NUM_SOURCES + 1);
+	for(i32 i = 0; i < NUM_SOURCES; ++i)
+		graph.AddEdge(i, NUM_SOURCES);
+
+	SECTION("run")
+	{
+		graph.Run();
+		REQUIRE(data.nextOrder_ == NUM_SOURCES + 1);
+		REQUIRE(data.order_[NUM_SOURCES] == NUM_SOURCES + 1);
+	}
+
+	SECTION("submit-from-job")
+	{
+		// Submitted and waited on from within a job.
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32, void* data) {
+			Job::Counter* counter = nullptr;
+			((Job::Graph*)data)->Submit(&counter);
+			Job::Manager::WaitForCounter(counter, 0);
+		};
+		jobDesc.data_ = &graph;
+		jobDesc.name_ = "submitGraph";
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(&jobDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+
+		REQUIRE(data.nextOrder_ == NUM_SOURCES + 1);
+		REQUIRE(data.order_[NUM_SOURCES] == NUM_SOURCES + 1);
+	}
+}
+
+TEST_CASE("graph-tests-fan-out-fan-in")
+{
+	const i32 NUM_LAYERS = 8;
+	const i32 LAYER_SIZE = 64;
+
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE, Job::SchedulerMode::WORK_STEALING);
+
+	// Fully connected layers: every node must run after every node in the previous layer.
+	OrderData data;
+	Job::Graph graph;
+	AddOrderNodes(graph, data, NUM_LAYERS * LAYER_SIZE);
+	for(i32 layer = 1; layer < NUM_LAYERS; ++layer)
+		for(i32 before = 0; before < LAYER_SIZE; ++before)
+			for(i32 after = 0; after < LAYER_SIZE; ++after)
+				graph.AddEdge((layer - 1) * LAYER_SIZE + before, layer * LAYER_SIZE + after);
+
+	graph.Run();
+
+	REQUIRE(data.nextOrder_ == NUM_LAYERS * LAYER_SIZE);
+	for(i32 layer = 0; layer < NUM_LAYERS; ++layer)
+	{
+		for(i32 i = 0; i < LAYER_SIZE; ++i)
+		{
+			const i32 order = data.order_[layer * LAYER_SIZE + i];
+			REQUIRE(order > layer * LAYER_SIZE);
+			REQUIRE(order <= (layer + 1) * LAYER_SIZE);
+		}
+	}
+}
+
+TEST_CASE("graph-tests-chain")
+{
+	const i32 NUM_NODES = 1000;
+
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	// Added back to front, so node order doesn't match execution order.
+	OrderData data;
+	Job::Graph graph;
+	AddOrderNodes(graph, data, NUM_NODES);
+	for(i32 i = NUM_NODES - 1; i > 0; --i)
+		graph.AddEdge(i, i - 1);
+
+	graph.Run();
+	for(i32 i = 0; i < NUM_NODES; ++i)
+		REQUIRE(data.order_[i] == NUM_NODES - i);
+}
+
+TEST_CASE("graph-benchmark-overhead", "[.benchmark]")
+{
+	const i32 NUM_NODES = 10000;
+	const i32 NUM_ITERATIONS = 10;
+
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	Job::JobDesc emptyJob;
+	emptyJob.func_ = [](i32, void*) {};
+	emptyJob.name_ = "emptyJob";
+
+	Core::Log("\"graph-benchmark-overhead\"\n");
+	auto logTime = [](const char* name, f64 time) {
+		Core::Log("\t%s: %f ns/node\n", name, time * 1000000000.0 / (f64)(NUM_NODES * NUM_ITERATIONS));
+	};
+
+	// Chain expressed as a graph, each node released by the last.
+	{
+		Job::Graph graph;
+		for(i32 i = 0; i < NUM_NODES; ++i)
+		{
+			graph.AddNode(emptyJob);
+			if(i > 0)
+				graph.AddEdge(i - 1, i);
+		}
+		graph.Run();
+
+		Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			graph.Run();
+		logTime("graph chain", timer.GetTime());
+	}
+
+	// The same chain, with a job waiting on each step.
+	{
+		Job::JobDesc chainJob;
+		chainJob.func_ = [](i32, void* data) {
+			for(i32 i = 0; i < NUM_NODES; ++i)
+			{
+				Job::JobDesc jobDesc = *(Job::JobDesc*)data;
+				Job::Counter* counter = nullptr;
+				Job::Manager::RunJobs(&jobDesc, 1, &counter);
+				Job::Manager::WaitForCounter(counter, 0);
+			}
+		};
+		chainJob.data_ = &emptyJob;
+		chainJob.name_ = "chainJob";
+
+		Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			Job::JobDesc jobDesc = chainJob;
+			Job::Counter* counter = nullptr;
+			Job::Manager::RunJobs(&jobDesc, 1, &counter);
+			Job::Manager::WaitForCounter(counter, 0);
+		}
+		logTime("wait chain", timer.GetTime());
+	}
+
+	// Wide fan-in.
+	{
+		Job::Graph graph;
+		for(i32 i = 0; i < NUM_NODES; ++i)
+			graph.AddNode(emptyJob);
+		for(i32 i = 0; i < NUM_NODES - 1; ++i)
+			graph.AddEdge(i, NUM_NODES - 1);
+		graph.Run();
+
+		Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			graph.Run();
+		logTime("graph fan-in", timer.GetTime());
+	}
+}
@@ -3,6 +3,8 @@
 #include "catch.hpp"
 
 #include "core/concurrency.h"
+#include "core/memory_tracker.h"
+#include "core/profiler.h"
 #include "core/timer.h"
 #include "core/vector.h"
 #include "job/manager.h"
@@ -13,6 +15,10 @@ namespace
 {
 	Core::Mutex loggingMutex_;
 
+	static const i32 MAX_FIBERS = 128;
+	static const i32 MAX_JOBS = 512;
+	static const i32 FIBER_STACK_SIZE = 16 * 1024;
+
 	void CalculatePrimes(i64 max)
 	{
 		Vector<i64> primesFound;
@@ -76,17 +82,19 @@ namespace
 		}
 	}
 
-	void RunJobTest2(i32 numJobs, const char* name)
+	void RunJobTest2(i32 numJobs, const char* name, bool log = true)
 	{
 		struct JobData
 		{
 			i32 jobsToLaunch = 1;
+			bool log = true;
 		};
 		Core::Vector<JobData> jobDatas;
 		jobDatas.resize(numJobs);
 		for(i32 i = 0; i < numJobs; ++i)
 		{
 			jobDatas[i].jobsToLaunch = (i / 8) + 1;
+			jobDatas[i].log = log;
 		}
 
 		Core::Vector<Job::JobDesc> jobDescs;
@@ -96,7 +104,7 @@ namespace
 			Job::JobDesc jobDesc;
 			jobDesc.func_ = [](i32 param, void* data) {
 				auto jobData = reinterpret_cast<JobData*>(data);
-				RunJobTest(jobData->jobsToLaunch, "testJobRecursive");
+				RunJobTest(jobData->jobsToLaunch, "testJobRecursive", jobData->log);
 			};
 			jobDesc.param_ = i + 1;
 			jobDesc.data_ = &jobDatas[i];
@@ -112,17 +120,112 @@ namespace
 		double runTime = timer.GetTime();
 		Job::Manager::WaitForCounter(counter, 0);
 		double time = timer.GetTime();
+		if(log)
+		{
+			Core::Log("\"%s\"\n", name);
+			Core::Log("\tRubJobs: %f ms (%f ms. avg)\n", runTime * 1000.0, runTime * 1000.0 / (double)numJobs);
+			Core::Log("\tWaitForCounter: %f ms (%f ms. avg)\n", (time - runTime) * 1000.0,
+			    (time - runTime) * 1000.0 / (double)numJobs);
+			Core::Log("\tTotal: %f ms (%f ms. avg)\n", time * 1000.0, time * 1000.0 / (double)numJobs);
+		}
+	}
+
+	void RunThroughputBenchmark(i32 numWorkers, Job::SchedulerMode mode, const char* name)
+	{
+		const i32 NUM_ITERATIONS = 10;
+		const i32 NUM_FLAT_JOBS = 1000;
+		const i32 NUM_RECURSIVE_JOBS = 100;
+
+		Job::Manager::Scoped manager(numWorkers, MAX_FIBERS, FIBER_STACK_SIZE, mode);
+
+		Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			RunJobTest(NUM_FLAT_JOBS, name, false);
+		double flatTime = timer.GetTime();
+
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			RunJobTest2(NUM_RECURSIVE_JOBS, name, false);
+		double recursiveTime = timer.GetTime();
+
+		// Recursive job i launches (i / 8) + 1 jobs, on top of itself.
+		i32 numRecursiveJobs = NUM_RECURSIVE_JOBS;
+		for(i32 i = 0; i < NUM_RECURSIVE_JOBS; ++i)
+			numRecursiveJobs += (i / 8) + 1;
+
 		Core::Log("\"%s\"\n", name);
-		Core::Log("\tRubJobs: %f ms (%f ms. avg)\n", runTime * 1000.0, runTime * 1000.0 / (double)numJobs);
-		Core::Log("\tWaitForCounter: %f ms (%f ms. avg)\n", (time - runTime) * 1000.0,
-		    (time - runTime) * 1000.0 / (double)numJobs);
-		Core::Log("\tTotal: %f ms (%f ms. avg)\n", time * 1000.0, time * 1000.0 / (double)numJobs);
+		Core::Log("\tFlat: %f ms (%f jobs/s)\n", flatTime * 1000.0,
+		    (double)(NUM_FLAT_JOBS * NUM_ITERATIONS) / flatTime);
+		Core::Log("\tRecursive: %f ms (%f jobs/s)\n", recursiveTime * 1000.0,
+		    (double)(numRecursiveJobs * NUM_ITERATIONS) / recursiveTime);
+	}
+
+	void RunPriorityTest(i32 numWorkers, i32 numHighPriorityWorkers, const char* name)
+	{
+		const i32 NUM_BACKGROUND_JOBS = MAX_FIBERS;
+		const i32 NUM_FRAMES = 10;
+		const i32 NUM_FRAME_JOBS = 4;
+
+		Job::Manager::Scoped manager(
+		    numWorkers, MAX_FIBERS, FIBER_STACK_SIZE, Job::SchedulerMode::GLOBAL_QUEUE, numHighPriorityWorkers);
+
+		// Queue up a large amount of busy background work.
+		volatile i32 numBackgroundComplete = 0;
+		Core::Vector<Job::JobDesc> backgroundDescs(NUM_BACKGROUND_JOBS);
+		for(auto& jobDesc : backgroundDescs)
+		{
+			jobDesc.func_ = [](i32 param, void* data) {
+				const f64 endTime = Timer::GetAbsoluteTime() + 0.002;
+				while(Timer::GetAbsoluteTime() < endTime)
+					Core::YieldCPU();
+				Core::AtomicInc((volatile i32*)data);
+			};
+			jobDesc.data_ = (void*)&numBackgroundComplete;
+			jobDesc.name_ = "backgroundJob";
+			jobDesc.priority_ = Job::Priority::BACKGROUND;
+		}
+
+		Timer timer;
+		timer.Mark();
+		Job::Counter* backgroundCounter = nullptr;
+		Job::Manager::RunJobs(backgroundDescs.data(), backgroundDescs.size(), &backgroundCounter);
+
+		// Frame critical work should complete without waiting for the background work to drain.
+		f64 maxFrameTime = 0.0;
+		for(i32 frame = 0; frame < NUM_FRAMES; ++frame)
+		{
+			volatile i32 numFrameComplete = 0;
+			Job::JobDesc frameDescs[NUM_FRAME_JOBS];
+			for(auto& jobDesc : frameDescs)
+			{
+				jobDesc.func_ = [](i32 param, void* data) { Core::AtomicInc((volatile i32*)data); };
+				jobDesc.data_ = (void*)&numFrameComplete;
+				jobDesc.name_ = "frameJob";
+				jobDesc.priority_ = Job::Priority::HIGH;
+			}
+
+			const f64 frameStartTime = Timer::GetAbsoluteTime();
+			Job::Counter* frameCounter = nullptr;
+			Job::Manager::RunJobs(frameDescs, NUM_FRAME_JOBS, &frameCounter);
+			Job::Manager::WaitForCounter(frameCounter, 0);
+			const f64 frameTime = Timer::GetAbsoluteTime() - frameStartTime;
+			maxFrameTime = frameTime > maxFrameTime ? frameTime : maxFrameTime;
+			REQUIRE(numFrameComplete == NUM_FRAME_JOBS);
+		}
+		REQUIRE(numBackgroundComplete < NUM_BACKGROUND_JOBS);
+
+		Job::Manager::WaitForCounter(backgroundCounter, 0);
+		const f64 backgroundTime = timer.GetTime();
+		REQUIRE(numBackgroundComplete == NUM_BACKGROUND_JOBS);
+		REQUIRE(maxFrameTime < backgroundTime);
+
+		Core::Log("\"%s\"\n", name);
+		Core::Log("\tMax frame: %f ms\n", maxFrameTime * 1000.0);
+		Core::Log("\tBackground: %f ms\n", backgroundTime * 1000.0);
 	}
 
 
-	static const i32 MAX_FIBERS = 128;
-	static const i32 MAX_JOBS = 512;
-	static const i32 FIBER_STACK_SIZE = 16 * 1024;
 }
 
 TEST_CASE("job-tests-create-st-1")
@@ -191,13 +294,13 @@ TEST_CASE("job-tests-run-job-1000-mt-8")
 
 TEST_CASE("job-tests-run-job-1000-mt-4-fiber-blocked")
 {
-	Job::Manager::Scoped manager(4, 2, FIBER_STACK_SIZE);
+	Job::Manager::Scoped manager(4, 2, FIBER_STACK_SIZE, Job::SchedulerMode::GLOBAL_QUEUE, 0, 2);
 	RunJobTest(1000, "job-tests-run-job-100-mt-4-fiber-blocked");
 }
 
 TEST_CASE("job-tests-run-job-1000-mt-8-fiber-blocked")
 {
-	Job::Manager::Scoped manager(8, 4, FIBER_STACK_SIZE);
+	Job::Manager::Scoped manager(8, 4, FIBER_STACK_SIZE, Job::SchedulerMode::GLOBAL_QUEUE, 0, 4);
 	RunJobTest(1000, "job-tests-run-job-100-mt-8-fiber-blocked");
 }
 
@@ -254,3 +357,359 @@ TEST_CASE("job-tests-run-job-recursive-3-mt-8")
 	Job::Manager::Scoped manager(8, MAX_FIBERS, FIBER_STACK_SIZE);
 	RunJobTest2(100, "job-tests-run-job-recursive-100-mt-8");
 }
+
+TEST_CASE("job-tests-run-job-1000-mt-8-work-stealing")
+{
+	Job::Manager::Scoped manager(8, MAX_FIBERS, FIBER_STACK_SIZE, Job::SchedulerMode::WORK_STEALING);
+	RunJobTest(1000, "job-tests-run-job-1000-mt-8-work-stealing");
+}
+
+TEST_CASE("job-tests-run-job-1000-mt-8-fiber-blocked-work-stealing")
+{
+	Job::Manager::Scoped manager(8, 4, FIBER_STACK_SIZE, Job::SchedulerMode::WORK_STEALING, 0, 4);
+	RunJobTest(1000, "job-tests-run-job-1000-mt-8-fiber-blocked-work-stealing");
+}
+
+TEST_CASE("job-tests-run-job-recursive-1-mt-1-work-stealing")
+{
+	Job::Manager::Scoped manager(1, MAX_FIBERS, FIBER_STACK_SIZE, Job::SchedulerMode::WORK_STEALING);
+	RunJobTest2(1, "job-tests-run-job-recursive-1-mt-1-work-stealing");
+}
+
+TEST_CASE("job-tests-run-job-recursive-3-mt-8-work-stealing")
+{
+	Job::Manager::Scoped manager(8, MAX_FIBERS, FIBER_STACK_SIZE, Job::SchedulerMode::WORK_STEALING);
+	RunJobTest2(100, "job-tests-run-job-recursive-100-mt-8-work-stealing");
+}
+
+TEST_CASE("job-tests-fiber-pool")
+{
+	SECTION("growth")
+	{
+		// Every job holds its fiber until all have started, which a fixed pool of 2 could never satisfy.
+		const i32 NUM_FIBERS = 2;
+		const i32 MAX_POOL_FIBERS = 64;
+		const i32 NUM_BLOCKING_JOBS = 32;
+		Job::Manager::Scoped manager(
+		    4, NUM_FIBERS, FIBER_STACK_SIZE, Job::SchedulerMode::GLOBAL_QUEUE, 0, MAX_POOL_FIBERS);
+		REQUIRE(Job::Manager::GetNumFibers() == NUM_FIBERS);
+
+		struct JobData
+		{
+			volatile i32 started_ = 0;
+			volatile i32 release_ = 0;
+		};
+		JobData jobData;
+
+		Job::JobDesc jobDescs[NUM_BLOCKING_JOBS];
+		for(auto& jobDesc : jobDescs)
+		{
+			jobDesc.func_ = [](i32, void* data) {
+				auto* jobData = (JobData*)data;
+				Core::AtomicInc(&jobData->started_);
+				while(jobData->release_ == 0)
+					Job::Manager::YieldCPU();
+			};
+			jobDesc.data_ = &jobData;
+			jobDesc.name_ = "blockingJob";
+		}
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(jobDescs, NUM_BLOCKING_JOBS, &counter);
+		while(jobData.started_ < NUM_BLOCKING_JOBS)
+			Core::SwitchThread();
+		Core::AtomicExchg(&jobData.release_, 1);
+		Job::Manager::WaitForCounter(counter, 0);
+
+		REQUIRE(Job::Manager::GetNumFibers() >= NUM_BLOCKING_JOBS);
+		REQUIRE(Job::Manager::GetNumFibers() <= MAX_POOL_FIBERS);
+	}
+
+	SECTION("stack-classes")
+	{
+		const i32 LARGE_STACK_SIZE = 512 * 1024;
+		const i32 NUM_SMALL_JOBS = 64;
+		const i32 NUM_LARGE_JOBS = 8;
+		Job::Manager::Scoped manager(
+		    4, MAX_FIBERS, FIBER_STACK_SIZE, Job::SchedulerMode::GLOBAL_QUEUE, 0, 0, LARGE_STACK_SIZE);
+
+		volatile i32 numComplete = 0;
+		Core::Vector<Job::JobDesc> jobDescs;
+		for(i32 i = 0; i < NUM_SMALL_JOBS + NUM_LARGE_JOBS; ++i)
+		{
+			Job::JobDesc jobDesc;
+			jobDesc.data_ = (void*)&numComplete;
+			if(i < NUM_SMALL_JOBS)
+			{
+				jobDesc.func_ = [](i32, void* data) { Core::AtomicInc((volatile i32*)data); };
+				jobDesc.name_ = "smallStackJob";
+			}
+			else
+			{
+				// Far more stack than a small fiber has.
+				jobDesc.func_ = [](i32, void* data) {
+					volatile u8 buffer[256 * 1024];
+					for(i32 j = 0; j < (i32)sizeof(buffer); j += 1024)
+						buffer[j] = (u8)j;
+					if(buffer[1024] == 0)
+						Core::AtomicInc((volatile i32*)data);
+				};
+				jobDesc.name_ = "largeStackJob";
+				jobDesc.stackClass_ = Job::StackClass::LARGE;
+			}
+			jobDescs.push_back(jobDesc);
+		}
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+		REQUIRE(numComplete == NUM_SMALL_JOBS + NUM_LARGE_JOBS);
+	}
+}
+
+TEST_CASE("job-tests-memory-tracking")
+{
+	const i64 liveBytes = Core::MemoryTracker::GetStats(Core::MemoryTag::JOB).liveBytes_;
+	{
+		Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+		const i64 fiberBytes = (i64)Job::Manager::GetNumFibers() * FIBER_STACK_SIZE;
+		REQUIRE(Core::MemoryTracker::GetStats(Core::MemoryTag::JOB).liveBytes_ >= liveBytes + fiberBytes);
+	}
+	REQUIRE(Core::MemoryTracker::GetStats(Core::MemoryTag::JOB).liveBytes_ == liveBytes);
+}
+
+TEST_CASE("job-tests-priority-latency")
+{
+	SECTION("shared-workers") { RunPriorityTest(4, 0, "job-tests-priority-latency-shared-workers"); }
+	SECTION("dedicated-worker") { RunPriorityTest(4, 1, "job-tests-priority-latency-dedicated-worker"); }
+}
+
+TEST_CASE("job-benchmark-throughput", "[.benchmark]")
+{
+	RunThroughputBenchmark(8, Job::SchedulerMode::GLOBAL_QUEUE, "job-benchmark-throughput-mt-8-global-queue");
+	RunThroughputBenchmark(8, Job::SchedulerMode::WORK_STEALING, "job-benchmark-throughput-mt-8-work-stealing");
+	RunThroughputBenchmark(16, Job::SchedulerMode::GLOBAL_QUEUE, "job-benchmark-throughput-mt-16-global-queue");
+	RunThroughputBenchmark(16, Job::SchedulerMode::WORK_STEALING, "job-benchmark-throughput-mt-16-work-stealing");
+}
+
+TEST_CASE("job-benchmark-wake-latency", "[.benchmark]")
+{
+	const i32 NUM_ITERATIONS = 100;
+
+	Job::Manager::Scoped manager(8, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	f64 totalLatency = 0.0;
+	f64 maxLatency = 0.0;
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		// Give workers time to go idle.
+		Core::Sleep(0.01);
+
+		f64 startTime = 0.0;
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) { *(f64*)data = Timer::GetAbsoluteTime(); };
+		jobDesc.data_ = &startTime;
+		jobDesc.name_ = "wakeLatency";
+
+		Job::Counter* counter = nullptr;
+		const f64 submitTime = Timer::GetAbsoluteTime();
+		Job::Manager::RunJobs(&jobDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+
+		const f64 latency = startTime - submitTime;
+		totalLatency += latency;
+		maxLatency = latency > maxLatency ? latency : maxLatency;
+	}
+
+	Core::Log("\"job-benchmark-wake-latency\"\n");
+	Core::Log("\tAvg: %f us\n", totalLatency * 1000000.0 / (f64)NUM_ITERATIONS);
+	Core::Log("\tMax: %f us\n", maxLatency * 1000000.0);
+}
+
+TEST_CASE("job-tests-wait-for-counter-value")
+{
+	struct JobData
+	{
+		volatile i32 release_ = 0;
+		volatile i32 complete_ = 0;
+	};
+
+	auto waitJobFunc = [](i32 param, void* data) {
+		auto* jobData = (JobData*)data;
+		while(jobData->release_ < param)
+			Job::Manager::YieldCPU();
+		Core::AtomicInc(&jobData->complete_);
+	};
+
+	SECTION("thread")
+	{
+		Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+		JobData jobData;
+		Job::JobDesc jobDescs[4];
+		for(i32 i = 0; i < 4; ++i)
+		{
+			jobDescs[i].func_ = waitJobFunc;
+			jobDescs[i].param_ = i + 1;
+			jobDescs[i].data_ = &jobData;
+		}
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(jobDescs, 4, &counter);
+		for(i32 i = 0; i < 4; ++i)
+		{
+			Core::AtomicInc(&jobData.release_);
+			Job::Manager::WaitForCounter(counter, 3 - i);
+			REQUIRE(jobData.complete_ >= i + 1);
+		}
+		REQUIRE(counter == nullptr);
+		REQUIRE(jobData.complete_ == 4);
+	}
+
+	SECTION("job")
+	{
+		Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+		struct OuterData
+		{
+			JobData jobData_;
+			Job::JobFunc waitJobFunc_ = nullptr;
+			bool success_ = true;
+		};
+		OuterData outerData;
+		outerData.waitJobFunc_ = waitJobFunc;
+
+		Job::JobDesc outerDesc;
+		outerDesc.func_ = [](i32 param, void* data) {
+			auto* outerData = (OuterData*)data;
+			Job::JobDesc jobDescs[4];
+			for(i32 i = 0; i < 4; ++i)
+			{
+				jobDescs[i].func_ = outerData->waitJobFunc_;
+				jobDescs[i].param_ = i + 1;
+				jobDescs[i].data_ = &outerData->jobData_;
+			}
+
+			Job::Counter* counter = nullptr;
+			Job::Manager::RunJobs(jobDescs, 4, &counter);
+			for(i32 i = 0; i < 4; ++i)
+			{
+				Core::AtomicInc(&outerData->jobData_.release_);
+				Job::Manager::WaitForCounter(counter, 3 - i);
+				outerData->success_ &= outerData->jobData_.complete_ >= i + 1;
+			}
+			outerData->success_ &= counter == nullptr;
+		};
+		outerDesc.data_ = &outerData;
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(&outerDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+		REQUIRE(outerData.success_);
+		REQUIRE(outerData.jobData_.complete_ == 4);
+	}
+}
+
+TEST_CASE("job-tests-run-jobs-fill-queue-parked")
+{
+	// Pending job queue holds as many jobs as there are fibers, so submitting more from outside a job has to
+	// wake the parked workers to make room.
+	Job::Manager::Scoped manager(2, 8, FIBER_STACK_SIZE);
+	Core::Sleep(0.05);
+
+	const i32 NUM_JOBS = 64;
+	volatile i32 numRun = 0;
+	Vector<Job::JobDesc> jobDescs(NUM_JOBS);
+	for(auto& jobDesc : jobDescs)
+	{
+		jobDesc.func_ = [](i32, void* data) { Core::AtomicInc((volatile i32*)data); };
+		jobDesc.data_ = (void*)&numRun;
+	}
+
+	Job::Counter* counter = nullptr;
+	Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+	Job::Manager::WaitForCounter(counter, 0);
+	REQUIRE(numRun == NUM_JOBS);
+}
+
+TEST_CASE("job-tests-run-jobs-fill-queue-work-stealing")
+{
+	// A job submitting more than its worker's deque and the pending queue hold yields for space, and may resume
+	// on another worker. It must then push to that worker's deque, not the one it started on.
+	Job::Manager::Scoped manager(4, 8, FIBER_STACK_SIZE, Job::SchedulerMode::WORK_STEALING);
+
+	struct JobData
+	{
+		Vector<Job::JobDesc> jobDescs_;
+		volatile i32 numRun_ = 0;
+	};
+	JobData jobData;
+	jobData.jobDescs_.resize(4096);
+	for(auto& jobDesc : jobData.jobDescs_)
+	{
+		jobDesc.func_ = [](i32, void* data) { Core::AtomicInc(&((JobData*)data)->numRun_); };
+		jobDesc.data_ = &jobData;
+	}
+
+	Job::JobDesc outerDesc;
+	outerDesc.func_ = [](i32, void* data) {
+		auto* jobData = (JobData*)data;
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(jobData->jobDescs_.data(), jobData->jobDescs_.size(), &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+	};
+	outerDesc.data_ = &jobData;
+
+	for(i32 i = 0; i < 4; ++i)
+	{
+		jobData.numRun_ = 0;
+		for(auto& jobDesc : jobData.jobDescs_)
+			jobDesc.counter_ = nullptr;
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(&outerDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+		outerDesc.counter_ = nullptr;
+		REQUIRE(jobData.numRun_ == jobData.jobDescs_.size());
+	}
+}
+
+#if CORE_PROFILE_ENABLED
+TEST_CASE("job-tests-profile-suspended")
+{
+	Job::Manager::Scoped manager(2, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	static const char* OUTER_NAME = "job-tests-profile-outer";
+	Job::JobDesc outerDesc;
+	outerDesc.name_ = OUTER_NAME;
+	outerDesc.func_ = [](i32, void*) {
+		// Suspended while the inner job sleeps, which shouldn't count towards this job's time.
+		Job::JobDesc innerDesc;
+		innerDesc.func_ = [](i32, void*) { Core::Sleep(0.1); };
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(&innerDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+	};
+
+	Core::Profiler::EndFrame();
+	Job::Counter* counter = nullptr;
+	Job::Manager::RunJobs(&outerDesc, 1, &counter);
+	Job::Manager::WaitForCounter(counter, 0);
+	Core::Profiler::EndFrame();
+
+	Vector<Core::ProfilerEntry> entries(Core::Profiler::GetFrameReport(nullptr, 0));
+	entries.resize(Core::Profiler::GetFrameReport(entries.data(), entries.size()));
+	i32 callCount = 0;
+	f64 totalTime = 0.0;
+	for(const auto& entry : entries)
+	{
+		if(entry.name_ == OUTER_NAME)
+		{
+			callCount += entry.callCount_;
+			totalTime += entry.totalTime_;
+		}
+	}
+	REQUIRE(callCount >= 1);
+	REQUIRE(totalTime < 0.05);
+}
+#endif
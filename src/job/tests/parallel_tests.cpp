@@ -0,0 +1,233 @@
+#include "catch.hpp"
+
+#include "core/concurrency.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "job/manager.h"
+#include "job/parallel.h"
+
+using namespace Core;
+
+namespace
+{
+	static const i32 MAX_FIBERS = 128;
+	static const i32 FIBER_STACK_SIZE = 16 * 1024;
+
+	void RunParallelForTest(i32 numItems, i32 grainSize)
+	{
+		Core::Vector<i32> visited;
+		visited.resize(numItems, 0);
+		volatile i32 maxRangeSize = 0;
+
+		Job::ParallelFor(0, numItems, grainSize, [&](i32 begin, i32 end) {
+			for(i32 i = begin; i < end; ++i)
+				visited[i]++;
+
+			i32 oldMax = maxRangeSize;
+			while((end - begin) > oldMax)
+			{
+				const i32 prevMax = Core::AtomicCmpExchg(&maxRangeSize, end - begin, oldMax);
+				if(prevMax == oldMax)
+					break;
+				oldMax = prevMax;
+			}
+		});
+
+		for(i32 i = 0; i < numItems; ++i)
+			REQUIRE(visited[i] == 1);
+		REQUIRE(maxRangeSize <= grainSize);
+	}
+
+	/// Reduction result for checking ranges are combined in order.
+	struct RangeResult
+	{
+		i32 begin_ = -1;
+		i32 end_ = -1;
+		bool contiguous_ = true;
+	};
+
+	RangeResult RunParallelReduceRangeTest(i32 numItems, i32 grainSize)
+	{
+		return Job::ParallelReduce(0, numItems, grainSize, RangeResult(),
+		    [](i32 begin, i32 end) {
+			    RangeResult result;
+			    result.begin_ = begin;
+			    result.end_ = end;
+			    return result;
+			},
+		    [](const RangeResult& a, const RangeResult& b) {
+			    if(a.begin_ < 0)
+				    return b;
+			    if(b.begin_ < 0)
+				    return a;
+			    RangeResult result;
+			    result.begin_ = a.begin_;
+			    result.end_ = b.end_;
+			    result.contiguous_ = a.contiguous_ && b.contiguous_ && a.end_ == b.begin_;
+			    return result;
+			});
+	}
+
+	/// Sum values of very different magnitudes in f32, so the result depends on the order they're added in.
+	f32 SumMixedMagnitudes(const Core::Vector<f32>& values, i32 grainSize)
+	{
+		return Job::ParallelReduce(0, values.size(), grainSize, 0.0f,
+		    [&values](i32 begin, i32 end) {
+			    f32 sum = 0.0f;
+			    for(i32 i = begin; i < end; ++i)
+				    sum += values[i];
+			    return sum;
+			},
+		    [](f32 a, f32 b) { return a + b; });
+	}
+
+	Core::Vector<f32> MakeMixedMagnitudes(i32 numItems)
+	{
+		Core::Vector<f32> values;
+		values.resize(numItems);
+		u32 seed = 1;
+		for(i32 i = 0; i < numItems; ++i)
+		{
+			seed = seed * 1664525U + 1013904223U;
+			const f32 magnitude = (seed >> 28) < 2 ? 1.0e7f : ((seed >> 28) < 8 ? 1.0f : 1.0e-3f);
+			values[i] = magnitude * (f32)((seed >> 8) & 0xffff) / 65536.0f * ((seed & 1) ? 1.0f : -1.0f);
+		}
+		return values;
+	}
+}
+
+TEST_CASE("parallel-tests-for")
+{
+	SECTION("no-manager") { RunParallelForTest(1000, 10); }
+
+	SECTION("mt-4")
+	{
+		Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+		RunParallelForTest(0, 1);
+		RunParallelForTest(1, 1);
+		RunParallelForTest(1000, 1);
+		RunParallelForTest(1000, 7);
+		RunParallelForTest(1000, 1000);
+		RunParallelForTest(100000, 64);
+	}
+
+	SECTION("mt-4-work-stealing")
+	{
+		Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE, Job::SchedulerMode::WORK_STEALING);
+		RunParallelForTest(1000, 1);
+		RunParallelForTest(100000, 64);
+	}
+
+	SECTION("nested")
+	{
+		Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+		const i32 NUM_OUTER = 16;
+		const i32 NUM_INNER = 256;
+		Core::Vector<i32> visited;
+		visited.resize(NUM_OUTER * NUM_INNER, 0);
+		Job::ParallelFor(0, NUM_OUTER, 1, [&](i32 outerBegin, i32 outerEnd) {
+			for(i32 i = outerBegin; i < outerEnd; ++i)
+			{
+				Job::ParallelFor(0, NUM_INNER, 16, [&](i32 innerBegin, i32 innerEnd) {
+					for(i32 j = innerBegin; j < innerEnd; ++j)
+						visited[i * NUM_INNER + j]++;
+				});
+			}
+		});
+
+		for(i32 i = 0; i < visited.size(); ++i)
+			REQUIRE(visited[i] == 1);
+	}
+}
+
+TEST_CASE("parallel-tests-reduce")
+{
+	SECTION("no-manager")
+	{
+		RangeResult result = RunParallelReduceRangeTest(1000, 10);
+		REQUIRE(result.begin_ == 0);
+		REQUIRE(result.end_ == 1000);
+		REQUIRE(result.contiguous_);
+	}
+
+	SECTION("mt-4")
+	{
+		Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+		RangeResult result = RunParallelReduceRangeTest(0, 1);
+		REQUIRE(result.begin_ == -1);
+
+		result = RunParallelReduceRangeTest(1000, 1);
+		REQUIRE(result.begin_ == 0);
+		REQUIRE(result.end_ == 1000);
+		REQUIRE(result.contiguous_);
+
+		result = RunParallelReduceRangeTest(100000, 64);
+		REQUIRE(result.begin_ == 0);
+		REQUIRE(result.end_ == 100000);
+		REQUIRE(result.contiguous_);
+	}
+
+	SECTION("deterministic")
+	{
+		const Core::Vector<f32> values = MakeMixedMagnitudes(100000);
+
+		// Adding the same values in another order gives a different sum, so a fixed order is being tested.
+		f32 serialSum = 0.0f;
+		for(i32 i = 0; i < values.size(); ++i)
+			serialSum += values[i];
+		const f32 expected = SumMixedMagnitudes(values, 100);
+		REQUIRE(expected != serialSum);
+
+		{
+			Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+			for(i32 i = 0; i < 10; ++i)
+				REQUIRE(SumMixedMagnitudes(values, 100) == expected);
+		}
+
+		// Few fibers, so splits often find the job queue full and run grains inline.
+		{
+			Job::Manager::Scoped manager(4, 4, FIBER_STACK_SIZE);
+			for(i32 i = 0; i < 10; ++i)
+				REQUIRE(SumMixedMagnitudes(values, 100) == expected);
+		}
+	}
+}
+
+TEST_CASE("parallel-benchmark-scaling", "[.benchmark]")
+{
+	const i32 NUM_ITEMS = 1 << 20;
+	const i32 GRAIN_SIZE = 1024;
+	const i32 NUM_ITERATIONS = 10;
+
+	Core::Vector<f32> data;
+	data.resize(NUM_ITEMS, 1.0f);
+
+	Core::Log("\"parallel-benchmark-scaling\"\n");
+	f64 baseTime = 0.0;
+	for(i32 numWorkers = 1; numWorkers <= 16; numWorkers *= 2)
+	{
+		Job::Manager::Scoped manager(numWorkers, MAX_FIBERS, FIBER_STACK_SIZE);
+
+		Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			Job::ParallelFor(0, NUM_ITEMS, GRAIN_SIZE, [&data](i32 begin, i32 end) {
+				for(i32 j = begin; j < end; ++j)
+				{
+					f32 value = data[j];
+					for(i32 k = 0; k < 16; ++k)
+						value = value * 0.999f + 0.001f;
+					data[j] = value;
+				}
+			});
+		}
+		const f64 time = timer.GetTime();
+		if(numWorkers == 1)
+			baseTime = time;
+
+		Core::Log("\t%u workers: %f ms (%.2fx)\n", numWorkers, time * 1000.0 / (f64)NUM_ITERATIONS, baseTime / time);
+	}
+}
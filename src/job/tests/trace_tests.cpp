@@ -0,0 +1,96 @@
+#include "catch.hpp"
+
+#include "core/string.h"
+#include "core/timer.h"
+#include "job/manager.h"
+#include "job/parallel.h"
+#include "job/trace.h"
+
+#include <cstring>
+
+using namespace Core;
+
+namespace
+{
+	static const i32 MAX_FIBERS = 128;
+	static const i32 FIBER_STACK_SIZE = 16 * 1024;
+
+	void RunTracedJobs()
+	{
+		// Outer jobs wait on inner jobs, so there are waits and wakes as well as begin & end.
+		Job::ParallelFor(0, 8, 1, [](i32 begin, i32 end) {
+			Job::ParallelFor(0, 64, 4, [](i32, i32) {}, Job::Priority::NORMAL, "TraceInner");
+		}, Job::Priority::NORMAL, "TraceOuter");
+	}
+}
+
+TEST_CASE("trace-tests-chrome")
+{
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	Job::Trace::Start();
+	RunTracedJobs();
+	Job::Trace::Stop();
+
+	String json;
+	if(!Job::Trace::IsAvailable())
+	{
+		REQUIRE(Job::Trace::GetNumEvents(Job::TraceEventType::JOB_BEGIN) == 0);
+		REQUIRE(!Job::Trace::WriteChromeTrace(json));
+		return;
+	}
+
+	const i32 numBegin = Job::Trace::GetNumEvents(Job::TraceEventType::JOB_BEGIN);
+	const i32 numEnd = Job::Trace::GetNumEvents(Job::TraceEventType::JOB_END);
+	REQUIRE(numBegin > 8);
+	REQUIRE(numBegin == numEnd);
+	REQUIRE(Job::Trace::GetNumEvents(Job::TraceEventType::JOB_RESUME) ==
+	        Job::Trace::GetNumEvents(Job::TraceEventType::JOB_WAIT) +
+	            Job::Trace::GetNumEvents(Job::TraceEventType::JOB_YIELD));
+
+	REQUIRE(Job::Trace::WriteChromeTrace(json));
+	REQUIRE(strstr(json.c_str(), "\"traceEvents\"") != nullptr);
+	REQUIRE(strstr(json.c_str(), "\"TraceOuter\"") != nullptr);
+	REQUIRE(strstr(json.c_str(), "\"TraceInner\"") != nullptr);
+	REQUIRE(strstr(json.c_str(), "\"Job Worker 0\"") != nullptr);
+
+	// Nothing recorded once stopped.
+	RunTracedJobs();
+	REQUIRE(Job::Trace::GetNumEvents(Job::TraceEventType::JOB_BEGIN) == numBegin);
+}
+
+TEST_CASE("trace-benchmark-overhead", "[.benchmark]")
+{
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	const i32 NUM_JOBS = 100000;
+	auto runJobs = [NUM_JOBS]() {
+		Timer timer;
+		timer.Mark();
+		Job::ParallelFor(0, NUM_JOBS, 1, [](i32, i32) {}, Job::Priority::NORMAL, "TraceBenchmark");
+		return timer.GetTime();
+	};
+
+	runJobs();
+	const f64 untracedTime = runJobs();
+	Job::Trace::Start();
+	const f64 tracedTime = runJobs();
+	Job::Trace::Stop();
+
+	i32 numEvents = 0;
+	for(i32 type = 0; type < (i32)Job::TraceEventType::MAX; ++type)
+		numEvents += Job::Trace::GetNumEvents((Job::TraceEventType)type);
+
+	Core::Log("\"trace-benchmark-overhead\"\n");
+	Core::Log("\tuntraced: %f ms, traced: %f ms, %d events held\n", untracedTime * 1000.0, tracedTime * 1000.0,
+	    numEvents);
+
+	if(numEvents > 0)
+	{
+		String json;
+		Timer timer;
+		timer.Mark();
+		Job::Trace::WriteChromeTrace(json);
+		Core::Log("\tWriteChromeTrace: %f ms, %d bytes\n", timer.GetTime() * 1000.0, json.size());
+	}
+}
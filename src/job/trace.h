@@ -0,0 +1,89 @@
+#pragma once
+
+#include "core/types.h"
+#include "job/dll.h"
+
+namespace Core
+{
+	class String;
+} // namespace Core
+
+namespace Job
+{
+	/**
+	 * Trace event types.
+	 */
+	enum class TraceEventType : u8
+	{
+		/// Job started on a worker.
+		JOB_BEGIN = 0,
+		/// Job resumed on a worker after yielding or waiting.
+		JOB_RESUME,
+		/// Job completed.
+		JOB_END,
+		/// Job yielded.
+		JOB_YIELD,
+		/// Job waiting on a counter.
+		JOB_WAIT,
+		/// Counter reached the value a waiter wanted, and it's being woken.
+		WAKE,
+		/// Job stolen from another worker.
+		STEAL,
+		/// Worker unable to get a free fiber.
+		OUT_OF_FIBERS,
+		/// Worker parked.
+		PARK,
+		/// Worker unparked.
+		UNPARK,
+		/// Thread outside of the job system started waiting on a counter.
+		WAIT_BEGIN,
+		/// Thread outside of the job system finished waiting on a counter.
+		WAIT_END,
+
+		MAX
+	};
+
+	/**
+	 * Job system tracer.
+	 * Records scheduling events into a ring buffer per thread, so only the most recent events for each
+	 * thread are kept. Events are only recorded when the job library is built with JOB_TRACE_ENABLED=1, i.e. the
+	 * JOB_TRACE CMake option. Otherwise recording compiles out, and Trace never holds any events.
+	 */
+	class JOB_DLL Trace final
+	{
+	public:
+		/**
+		 * @return Is tracing compiled in?
+		 */
+		static bool IsAvailable();
+
+		/**
+		 * Start recording. Discards previously recorded events.
+		 */
+		static void Start();
+
+		/**
+		 * Stop recording.
+		 */
+		static void Stop();
+
+		/**
+		 * @return Number of events of @a type held in buffers.
+		 */
+		static i32 GetNumEvents(TraceEventType type);
+
+		/**
+		 * Write recorded events as Chrome trace event JSON, for loading into chrome://tracing.
+		 * Jobs appear as slices on the thread that ran them, with flow arrows from whatever woke them.
+		 * Should be called once stopped.
+		 * @param outJSON String to write to.
+		 * @return true if successful.
+		 */
+		static bool WriteChromeTrace(Core::String& outJSON);
+
+	private:
+		Trace() = delete;
+		~Trace() = delete;
+		Trace(const Trace&) = delete;
+	};
+} // namespace Job
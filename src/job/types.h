@@ -12,6 +12,35 @@ namespace Job
 	 */
 	typedef void (*JobFunc)(i32, void*);
 
+	/**
+	 * Job priority.
+	 * Workers take jobs from the highest priority queue that has any.
+	 */
+	enum class Priority : i32
+	{
+		/// Latency critical work, e.g. per-frame jobs.
+		HIGH = 0,
+		NORMAL,
+		LOW,
+		/// Long running work that can wait, e.g. resource conversion.
+		BACKGROUND,
+
+		MAX
+	};
+
+	/**
+	 * Fiber stack class.
+	 * Most jobs fit in a small stack, so only jobs that need deep call stacks or large locals should ask
+	 * for a large one.
+	 */
+	enum class StackClass : i32
+	{
+		SMALL = 0,
+		LARGE,
+
+		MAX
+	};
+
 	/**
 	 * Job descriptor.
 	 */
@@ -25,11 +54,27 @@ namespace Job
 		void* data_ = nullptr;
 		/// Name of job.
 		const char* name_ = nullptr;
+		/// Priority of job.
+		Priority priority_ = Priority::NORMAL;
+		/// Stack class of fiber to run job on.
+		StackClass stackClass_ = StackClass::SMALL;
 
 		/// Internal use. Do not use.
 		struct Counter* counter_ = nullptr;
 	};
 
+	/**
+	 * Scheduler mode.
+	 */
+	enum class SchedulerMode : i32
+	{
+		/// All jobs are pushed to a single global queue shared by all workers.
+		GLOBAL_QUEUE = 0,
+		/// Each worker owns a deque. Jobs run from within a job are pushed to the local deque,
+		/// and idle workers steal from other workers.
+		WORK_STEALING,
+	};
+
 	/**
 	 * Counter used for waiting on jobs.
 	 */
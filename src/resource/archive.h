@@ -0,0 +1,172 @@
+#pragma once
+
+#include "core/compression.h"
+#include "core/types.h"
+#include "core/uuid.h"
+#include "core/vector.h"
+#include "resource/dll.h"
+
+namespace Core
+{
+	class File;
+} // namespace Core
+
+namespace Resource
+{
+	/**
+	 * Archive layout, little endian, all offsets from the start of the file:
+	 * - ArchiveHeader.
+	 * - Entry data, each entry starting on ARCHIVE_ALIGNMENT.
+	 * - Table of contents: ArchiveHeader::tableSize_ ArchiveEntry slots, on ARCHIVE_ALIGNMENT. This is an open
+	 *   addressing hash table keyed by resource UUID, so it's used in place from the mapped file. An entry's first
+	 *   slot is HashCRC32C(0, uuid bytes) & (tableSize_ - 1), probing linearly from there.
+	 */
+	static const i64 ARCHIVE_ALIGNMENT = 64;
+
+	struct ArchiveHeader
+	{
+		static const u32 MAGIC = 0x4b415052; // 'RPAK'
+		static const u32 VERSION = 1;
+
+		u32 magic_ = MAGIC;
+		u32 version_ = VERSION;
+		/// Number of entries in the table.
+		u32 numEntries_ = 0;
+		/// Number of slots in the table. Power of two, at least twice numEntries_.
+		u32 tableSize_ = 0;
+		/// Offset of the table.
+		i64 tableOffset_ = 0;
+	};
+
+	struct ArchiveEntry
+	{
+		/// Resource UUID. Zero for an empty slot.
+		Core::UUID uuid_;
+		/// Resource type.
+		Core::UUID type_;
+		/// Offset of data.
+		i64 offset_ = 0;
+		/// Size of data as stored.
+		i64 size_ = 0;
+		/// Size of data once decompressed. Same as size_ if codec_ is NONE.
+		i64 uncompressedSize_ = 0;
+		/// Codec data was compressed with.
+		Core::CompressionCodec codec_ = Core::CompressionCodec::NONE;
+		u32 padding_ = 0;
+	};
+
+	/**
+	 * Read only archive of converted resources.
+	 * The whole archive is mapped into memory when opened. Entries are found by hashing their UUID into
+	 * the mapped table of contents, and served as memory files, so loading a resource from an archive
+	 * makes no file system calls.
+	 */
+	class RESOURCE_DLL Archive final
+	{
+	public:
+		Archive() = default;
+
+		/**
+		 * Open archive.
+		 * @param path Path to archive.
+		 */
+		Archive(const char* path);
+
+		~Archive();
+
+		/// Move operators.
+		Archive(Archive&&);
+		Archive& operator=(Archive&&);
+
+		/**
+		 * Find entry.
+		 * @param uuid UUID of resource.
+		 * @return Entry, or nullptr if not in archive. Valid for the life of the archive.
+		 */
+		const ArchiveEntry* FindEntry(const Core::UUID& uuid) const;
+
+		/**
+		 * Open entry as a read only memory file.
+		 * Uncompressed entries are read straight from the mapped archive. Compressed entries are decompressed
+		 * into @a buffer first, which must outlive the returned file.
+		 * @param entry Entry returned by FindEntry.
+		 * @param buffer Buffer to decompress into, if required.
+		 * @return File, or an invalid file if the entry is corrupt.
+		 */
+		Core::File OpenEntry(const ArchiveEntry& entry, Core::Vector<u8>& buffer) const;
+
+		/**
+		 * @return Number of entries.
+		 */
+		i32 GetNumEntries() const;
+
+		/**
+		 * @return Is archive valid?
+		 */
+		operator bool() const { return impl_ != nullptr; }
+
+	private:
+		Archive(const Archive&) = delete;
+		Archive& operator=(const Archive&) = delete;
+
+		struct ArchiveImpl* impl_ = nullptr;
+	};
+
+	/**
+	 * Writes archives read by Archive.
+	 * Entry data is written as it's added; the table of contents and header are written by Finalize.
+	 */
+	class RESOURCE_DLL ArchiveWriter final
+	{
+	public:
+		/**
+		 * Create archive.
+		 * @param path Path to write archive to. Replaces any existing file.
+		 */
+		ArchiveWriter(const char* path);
+
+		/**
+		 * Calls Finalize if it hasn't been.
+		 */
+		~ArchiveWriter();
+
+		/**
+		 * Add entry.
+		 * @param uuid UUID of resource.
+		 * @param type Type of resource.
+		 * @param data Data to add.
+		 * @param size Size of data.
+		 * @param codec Codec to compress with. Stored uncompressed if compressing doesn't make it smaller.
+		 * @return true if success. false if @a uuid has already been added, or the write failed.
+		 * @pre uuid isn't zero.
+		 * @pre Finalize hasn't been called.
+		 */
+		bool AddEntry(const Core::UUID& uuid, const Core::UUID& type, const void* data, i64 size,
+		    Core::CompressionCodec codec = Core::CompressionCodec::NONE);
+
+		/**
+		 * Add entry from a file, i.e. a converted resource.
+		 * @param path Path of file to add.
+		 * @return true if success. false if file couldn't be read, or as AddEntry.
+		 */
+		bool AddFile(const Core::UUID& uuid, const Core::UUID& type, const char* path,
+		    Core::CompressionCodec codec = Core::CompressionCodec::NONE);
+
+		/**
+		 * Write table of contents and header, completing the archive.
+		 * @return true if success.
+		 */
+		bool Finalize();
+
+		/**
+		 * @return Is writer valid?
+		 */
+		operator bool() const { return impl_ != nullptr; }
+
+	private:
+		ArchiveWriter(const ArchiveWriter&) = delete;
+		ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+		struct ArchiveWriterImpl* impl_ = nullptr;
+	};
+} // namespace Resource
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/compression.h"
+#include "core/types.h"
+#include "resource/dll.h"
+
+namespace Core
+{
+	class File;
+} // namespace Core
+
+namespace Resource
+{
+	/**
+	 * Block compressed data layout, little endian:
+	 * - CompressedDataHeader.
+	 * - Stored size of each block, as u32. COMPRESSED_BLOCK_RAW is set for blocks stored uncompressed.
+	 * - Block data, back to back.
+	 * Each block is compressed independently, so blocks are compressed and decompressed in parallel, and
+	 * can be decompressed as soon as they've been read rather than once the whole payload has.
+	 */
+	static const i32 COMPRESSED_DATA_BLOCK_SIZE = 256 * 1024;
+	static const u32 COMPRESSED_BLOCK_RAW = 0x80000000U;
+
+	struct CompressedDataHeader
+	{
+		static const u32 MAGIC = 0x4b4c4252; // 'RBLK'
+		static const u32 VERSION = 1;
+
+		u32 magic_ = MAGIC;
+		u32 version_ = VERSION;
+		/// Codec blocks were compressed with.
+		Core::CompressionCodec codec_ = Core::CompressionCodec::NONE;
+		/// Uncompressed size of each block. Last block may be smaller.
+		u32 blockSize_ = 0;
+		/// Size of data once decompressed.
+		i64 uncompressedSize_ = 0;
+		/// Number of blocks.
+		u32 numBlocks_ = 0;
+		u32 padding_ = 0;
+	};
+
+	/**
+	 * Write block compressed data at the file's write position.
+	 * Blocks are compressed from jobs when the job manager is initialized. Blocks that don't get smaller
+	 * are stored uncompressed.
+	 * @param file File to write to.
+	 * @param data Data to compress.
+	 * @param size Size of @a data.
+	 * @param codec Codec to compress blocks with.
+	 * @param level Compression level. Loading cost doesn't depend on it, so converters should use the default.
+	 * @param blockSize Uncompressed size of each block.
+	 * @return true if success.
+	 * @pre size >= 0.
+	 * @pre blockSize > 0 && blockSize < COMPRESSED_BLOCK_RAW.
+	 */
+	RESOURCE_DLL bool WriteCompressedData(Core::File& file, const void* data, i64 size, Core::CompressionCodec codec,
+	    i32 level = Core::COMPRESSION_LEVEL_DEFAULT, i32 blockSize = COMPRESSED_DATA_BLOCK_SIZE);
+
+	/**
+	 * Check for block compressed data at the file's read position, without moving it.
+	 * @return Uncompressed size, or -1 if there isn't a valid header, i.e. the data was written uncompressed.
+	 */
+	RESOURCE_DLL i64 GetUncompressedSize(const Core::File& file);
+
+	/**
+	 * Read and decompress block compressed data at the file's read position, and leave it positioned after.
+	 * Memory files, and files opened with Core::FileFlags::MMAP, are decompressed straight from a mapped view.
+	 * Other files are streamed: the next window of blocks is read while jobs decompress the last.
+	 * @param file File to read from.
+	 * @param dest Buffer to decompress into.
+	 * @param destSize Size of @a dest. Must be the size returned by GetUncompressedSize.
+	 * @return true if success. false if data is invalid, corrupt or truncated.
+	 */
+	RESOURCE_DLL bool ReadCompressedData(Core::File& file, void* dest, i64 destSize);
+} // namespace Resource
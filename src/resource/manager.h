@@ -42,6 +42,16 @@ namespace Resource
 		 */
 		static bool IsInitialized();
 
+		/**
+		 * Mount archive of converted resources. Resources are looked up by Core::UUID(name) in mounted
+		 * archives before converted files, most recently mounted first, and loaded without file system calls.
+		 * Archives remain mounted until Finalize.
+		 * @param path Path to archive written by ArchiveWriter.
+		 * @return true if success.
+		 * @pre No resources are being requested on other threads.
+		 */
+		static bool MountArchive(const char* path);
+
 		/**
 		 * Request resource by name & type.
 		 * If a resource is loaded, it
@@ -0,0 +1,292 @@
+#include "resource/archive.h"
+
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/hash.h"
+#include "core/misc.h"
+#include "core/set.h"
+
+#include <limits>
+#include <utility>
+
+namespace Resource
+{
+	static_assert(sizeof(ArchiveHeader) <= ARCHIVE_ALIGNMENT, "ArchiveHeader must fit before the first entry.");
+	static_assert(sizeof(ArchiveEntry) == 64, "ArchiveEntry size is part of the file format.");
+
+	namespace
+	{
+		/// @return First slot to probe for @a uuid. Part of the file format, so hashes the UUID bytes directly rather
+		/// than going through Core::Hash, which is free to change.
+		u32 GetArchiveSlot(const Core::UUID& uuid, u32 tableSize)
+		{
+			return Core::HashCRC32C(0, &uuid, sizeof(uuid)) & (tableSize - 1);
+		}
+	} // namespace
+
+	struct ArchiveImpl
+	{
+		Core::File file_;
+		const u8* data_ = nullptr;
+		i64 size_ = 0;
+		const ArchiveHeader* header_ = nullptr;
+		const ArchiveEntry* table_ = nullptr;
+	};
+
+	Archive::Archive(const char* path)
+	{
+		Core::File file(path, Core::FileFlags::READ | Core::FileFlags::MMAP);
+		if(!file)
+			return;
+
+		const i64 size = file.Size();
+		if(size < (i64)sizeof(ArchiveHeader))
+		{
+			DBG_LOG("Archive \"%s\" is too small.\n", path);
+			return;
+		}
+
+		const u8* data = static_cast<const u8*>(file.Map(0, size));
+		if(!data)
+		{
+			DBG_LOG("Unable to map archive \"%s\".\n", path);
+			return;
+		}
+
+		// Validate header, so lookups only need to check entries.
+		const auto* header = reinterpret_cast<const ArchiveHeader*>(data);
+		const i64 tableBytes = (i64)header->tableSize_ * sizeof(ArchiveEntry);
+		if(header->magic_ != ArchiveHeader::MAGIC || header->version_ != ArchiveHeader::VERSION)
+		{
+			DBG_LOG("Archive \"%s\" has invalid header.\n", path);
+			return;
+		}
+		if(header->tableSize_ == 0 || !Core::Pot(header->tableSize_) || header->numEntries_ >= header->tableSize_ ||
+		    header->tableOffset_ < ARCHIVE_ALIGNMENT || (header->tableOffset_ % ARCHIVE_ALIGNMENT) != 0 ||
+		    header->tableOffset_ > (size - tableBytes))
+		{
+			DBG_LOG("Archive \"%s\" has invalid table of contents.\n", path);
+			return;
+		}
+
+		impl_ = new ArchiveImpl();
+		impl_->file_ = std::move(file);
+		impl_->data_ = data;
+		impl_->size_ = size;
+		impl_->header_ = header;
+		impl_->table_ = reinterpret_cast<const ArchiveEntry*>(data + header->tableOffset_);
+	}
+
+	Archive::~Archive() { delete impl_; }
+
+	Archive::Archive(Archive&& other)
+	{
+		using std::swap;
+		swap(impl_, other.impl_);
+	}
+
+	Archive& Archive::operator=(Archive&& other)
+	{
+		using std::swap;
+		swap(impl_, other.impl_);
+		return *this;
+	}
+
+	const ArchiveEntry* Archive::FindEntry(const Core::UUID& uuid) const
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(uuid != Core::UUID());
+
+		// Linear probe until the UUID or an empty slot. Table is never full, but bound it in case of corruption.
+		const u32 tableSize = impl_->header_->tableSize_;
+		u32 slot = GetArchiveSlot(uuid, tableSize);
+		for(u32 probe = 0; probe < tableSize; ++probe)
+		{
+			const ArchiveEntry& entry = impl_->table_[slot];
+			if(entry.uuid_ == uuid)
+				return &entry;
+			if(entry.uuid_ == Core::UUID())
+				return nullptr;
+			slot = (slot + 1) & (tableSize - 1);
+		}
+		return nullptr;
+	}
+
+	Core::File Archive::OpenEntry(const ArchiveEntry& entry, Core::Vector<u8>& buffer) const
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(&entry >= impl_->table_ && &entry < (impl_->table_ + impl_->header_->tableSize_));
+
+		if(entry.size_ <= 0 || entry.offset_ < ARCHIVE_ALIGNMENT || entry.offset_ > (impl_->size_ - entry.size_))
+		{
+			DBG_LOG("Archive entry has invalid range.\n");
+			return Core::File();
+		}
+
+		const u8* data = impl_->data_ + entry.offset_;
+		if(entry.codec_ == Core::CompressionCodec::NONE)
+			return Core::File(data, entry.size_);
+
+		if(entry.uncompressedSize_ <= 0 || entry.uncompressedSize_ > std::numeric_limits<i32>::max())
+		{
+			DBG_LOG("Archive entry has invalid size.\n");
+			return Core::File();
+		}
+
+		buffer.resize((i32)entry.uncompressedSize_);
+		if(Core::Decompress(entry.codec_, buffer.data(), buffer.size(), data, entry.size_) != entry.uncompressedSize_)
+		{
+			DBG_LOG("Archive entry failed to decompress.\n");
+			return Core::File();
+		}
+		return Core::File(buffer.data(), buffer.size());
+	}
+
+	i32 Archive::GetNumEntries() const
+	{
+		DBG_ASSERT(impl_);
+		return (i32)impl_->header_->numEntries_;
+	}
+
+	struct ArchiveWriterImpl
+	{
+		Core::File file_;
+		Core::Vector<ArchiveEntry> entries_;
+		Core::Set<Core::UUID> uuids_;
+		bool finalized_ = false;
+
+		/// Pad file with zeros up to the next ARCHIVE_ALIGNMENT.
+		bool WritePadding()
+		{
+			const u8 zeros[ARCHIVE_ALIGNMENT] = {0};
+			const i64 offset = file_.Tell();
+			const i64 paddingSize = Core::PotRoundUp(offset, ARCHIVE_ALIGNMENT) - offset;
+			return paddingSize == 0 || file_.Write(zeros, paddingSize) == paddingSize;
+		}
+	};
+
+	ArchiveWriter::ArchiveWriter(const char* path)
+	{
+		// Creating a file doesn't truncate it, so remove any existing one.
+		Core::FileRemove(path);
+		Core::File file(path, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		if(!file)
+			return;
+
+		// Header is zeroed until Finalize, so an incomplete archive fails to open.
+		const u8 zeros[ARCHIVE_ALIGNMENT] = {0};
+		if(file.Write(zeros, ARCHIVE_ALIGNMENT) != ARCHIVE_ALIGNMENT)
+			return;
+
+		impl_ = new ArchiveWriterImpl();
+		impl_->file_ = std::move(file);
+	}
+
+	ArchiveWriter::~ArchiveWriter()
+	{
+		if(impl_ && !impl_->finalized_)
+			Finalize();
+		delete impl_;
+	}
+
+	bool ArchiveWriter::AddEntry(
+	    const Core::UUID& uuid, const Core::UUID& type, const void* data, i64 size, Core::CompressionCodec codec)
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(!impl_->finalized_);
+		DBG_ASSERT(uuid != Core::UUID());
+		DBG_ASSERT(data);
+		DBG_ASSERT(size > 0);
+
+		if(impl_->uuids_.find(uuid) != impl_->uuids_.end())
+		{
+			char uuidStr[38];
+			uuid.AsString(uuidStr);
+			DBG_LOG("Archive already contains UUID %s.\n", uuidStr);
+			return false;
+		}
+
+		ArchiveEntry entry;
+		entry.uuid_ = uuid;
+		entry.type_ = type;
+		entry.offset_ = impl_->file_.Tell();
+		entry.size_ = size;
+		entry.uncompressedSize_ = size;
+
+		// Only keep compressed data if it's smaller.
+		Core::Vector<u8> compressed;
+		const void* writeData = data;
+		const i64 bound = Core::CompressionBound(codec, size);
+		if(codec != Core::CompressionCodec::NONE && bound <= std::numeric_limits<i32>::max())
+		{
+			compressed.resize((i32)bound);
+			const i64 compressedSize = Core::Compress(codec, compressed.data(), compressed.size(), data, size);
+			if(compressedSize > 0 && compressedSize < size)
+			{
+				writeData = compressed.data();
+				entry.size_ = compressedSize;
+				entry.codec_ = codec;
+			}
+		}
+
+		if(impl_->file_.Write(writeData, entry.size_) != entry.size_ || !impl_->WritePadding())
+			return false;
+
+		impl_->entries_.push_back(entry);
+		impl_->uuids_.insert(uuid);
+		return true;
+	}
+
+	bool ArchiveWriter::AddFile(
+	    const Core::UUID& uuid, const Core::UUID& type, const char* path, Core::CompressionCodec codec)
+	{
+		DBG_ASSERT(impl_);
+		Core::File file(path, Core::FileFlags::READ | Core::FileFlags::SEQUENTIAL);
+		if(!file)
+			return false;
+
+		const i64 size = file.Size();
+		if(size <= 0 || size > std::numeric_limits<i32>::max())
+			return false;
+
+		Core::Vector<u8> data;
+		data.resize((i32)size);
+		if(file.Read(data.data(), size) != size)
+			return false;
+		return AddEntry(uuid, type, data.data(), size, codec);
+	}
+
+	bool ArchiveWriter::Finalize()
+	{
+		DBG_ASSERT(impl_);
+		if(impl_->finalized_)
+			return true;
+		impl_->finalized_ = true;
+
+		// Keep at least half the slots empty, so probes stay short.
+		u32 tableSize = 1;
+		while(tableSize < (u32)impl_->entries_.size() * 2 + 1)
+			tableSize <<= 1;
+
+		Core::Vector<ArchiveEntry> table;
+		table.resize((i32)tableSize);
+		for(const ArchiveEntry& entry : impl_->entries_)
+		{
+			u32 slot = GetArchiveSlot(entry.uuid_, tableSize);
+			while(table[slot].uuid_ != Core::UUID())
+				slot = (slot + 1) & (tableSize - 1);
+			table[slot] = entry;
+		}
+
+		ArchiveHeader header;
+		header.numEntries_ = (u32)impl_->entries_.size();
+		header.tableSize_ = tableSize;
+		header.tableOffset_ = impl_->file_.Tell();
+		const i64 tableBytes = (i64)tableSize * sizeof(ArchiveEntry);
+		if(impl_->file_.Write(table.data(), tableBytes) != tableBytes)
+			return false;
+
+		impl_->file_.Seek(0);
+		return impl_->file_.Write(&header, sizeof(header)) == (i64)sizeof(header);
+	}
+} // namespace Resource
@@ -0,0 +1,306 @@
+#include "resource/compressed_data.h"
+
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/misc.h"
+#include "core/vector.h"
+#include "job/manager.h"
+#include "job/parallel.h"
+
+#include <cstring>
+#include <limits>
+
+namespace Resource
+{
+	static_assert(sizeof(CompressedDataHeader) == 32, "CompressedDataHeader size is part of the file format.");
+
+	namespace
+	{
+		/// Largest span of blocks read at once when streaming. Two are in flight: one read, one decompressed.
+		const i64 STREAM_WINDOW_SIZE = 4 * 1024 * 1024;
+
+		/// Header and block table, validated against each other so blocks can be decompressed unchecked.
+		struct BlockTable
+		{
+			CompressedDataHeader header_;
+			/// Stored size of each block, as written.
+			Core::Vector<u32> blocks_;
+			/// Offset of each block from the start of block data, plus the total size at the end.
+			Core::Vector<i64> offsets_;
+			i64 maxStoredSize_ = 0;
+		};
+
+		bool IsValidHeader(const CompressedDataHeader& header)
+		{
+			if(header.magic_ != CompressedDataHeader::MAGIC || header.version_ != CompressedDataHeader::VERSION)
+				return false;
+			if(header.codec_ != Core::CompressionCodec::NONE && header.codec_ != Core::CompressionCodec::LZ4)
+				return false;
+			if(header.blockSize_ == 0 || header.blockSize_ >= COMPRESSED_BLOCK_RAW || header.uncompressedSize_ < 0)
+				return false;
+			const i64 numBlocks = (header.uncompressedSize_ + header.blockSize_ - 1) / header.blockSize_;
+			return numBlocks == header.numBlocks_ && numBlocks <= std::numeric_limits<i32>::max();
+		}
+
+		/// @return Uncompressed size of block @a blockIdx.
+		i64 GetBlockSize(const CompressedDataHeader& header, i32 blockIdx)
+		{
+			const i64 offset = (i64)blockIdx * header.blockSize_;
+			return Core::Min((i64)header.blockSize_, header.uncompressedSize_ - offset);
+		}
+
+		/// Read header and block table at the file's read position, leaving it at the first block.
+		bool ReadBlockTable(Core::File& file, BlockTable& table)
+		{
+			CompressedDataHeader& header = table.header_;
+			if(file.Read(&header, sizeof(header)) != (i64)sizeof(header) || !IsValidHeader(header))
+				return false;
+
+			// Check the table fits in the file before allocating it.
+			const i32 numBlocks = (i32)header.numBlocks_;
+			const i64 tableBytes = (i64)numBlocks * sizeof(u32);
+			if(tableBytes > (file.Size() - file.Tell()))
+				return false;
+			table.blocks_.resize(numBlocks);
+			if(numBlocks > 0 && file.Read(table.blocks_.data(), tableBytes) != tableBytes)
+				return false;
+
+			const i64 bound = Core::CompressionBound(header.codec_, header.blockSize_);
+			table.offsets_.resize(numBlocks + 1);
+			table.offsets_[0] = 0;
+			for(i32 blockIdx = 0; blockIdx < numBlocks; ++blockIdx)
+			{
+				const u32 block = table.blocks_[blockIdx];
+				const i64 storedSize = block & ~COMPRESSED_BLOCK_RAW;
+				if((block & COMPRESSED_BLOCK_RAW) ? storedSize != GetBlockSize(header, blockIdx)
+				                                  : (storedSize == 0 || storedSize > bound))
+					return false;
+				table.offsets_[blockIdx + 1] = table.offsets_[blockIdx] + storedSize;
+				table.maxStoredSize_ = Core::Max(table.maxStoredSize_, storedSize);
+			}
+			return true;
+		}
+
+		/// Blocks being decompressed from a buffer, shared by decompression jobs.
+		struct DecompressJobData
+		{
+			const BlockTable* table_ = nullptr;
+			u8* dest_ = nullptr;
+			/// Block data, starting from block firstBlock_.
+			const u8* src_ = nullptr;
+			i32 firstBlock_ = 0;
+			volatile i32 failed_ = 0;
+		};
+
+		void DecompressBlockJob(i32 blockIdx, void* data)
+		{
+			auto* jobData = static_cast<DecompressJobData*>(data);
+			const BlockTable& table = *jobData->table_;
+			const CompressedDataHeader& header = table.header_;
+			const u8* src = jobData->src_ + (table.offsets_[blockIdx] - table.offsets_[jobData->firstBlock_]);
+			u8* dest = jobData->dest_ + (i64)blockIdx * header.blockSize_;
+			const i64 blockSize = GetBlockSize(header, blockIdx);
+
+			const u32 block = table.blocks_[blockIdx];
+			if(block & COMPRESSED_BLOCK_RAW)
+				memcpy(dest, src, (size_t)blockSize);
+			else if(Core::Decompress(header.codec_, dest, blockSize, src, block) != blockSize)
+				Core::AtomicExchg(&jobData->failed_, 1);
+		}
+
+		/// @return One past the last block of the window starting at @a begin. Always at least one block.
+		i32 GetWindowEnd(const BlockTable& table, i32 begin)
+		{
+			i32 end = begin + 1;
+			while(end < table.blocks_.size() && (table.offsets_[end + 1] - table.offsets_[begin]) <= STREAM_WINDOW_SIZE)
+				++end;
+			return end;
+		}
+
+		bool ReadWindow(const Core::File& file, i64 dataOffset, const BlockTable& table, i32 begin, i32 end, u8* dest)
+		{
+			const i64 bytes = table.offsets_[end] - table.offsets_[begin];
+			return file.ReadAt(dataOffset + table.offsets_[begin], dest, bytes) == bytes;
+		}
+
+		/// Read windows of blocks into alternating buffers, reading the next while the last is decompressed.
+		bool StreamBlocks(const Core::File& file, i64 dataOffset, const BlockTable& table, u8* dest)
+		{
+			const i32 numBlocks = table.blocks_.size();
+			const bool useJobs = Job::Manager::IsInitialized();
+			Core::Vector<u8> buffers[2];
+			for(auto& buffer : buffers)
+				buffer.resize_uninitialized((i32)Core::Max(STREAM_WINDOW_SIZE, table.maxStoredSize_));
+
+			DecompressJobData jobData;
+			jobData.table_ = &table;
+			jobData.dest_ = dest;
+			Core::Vector<Job::JobDesc> jobDescs;
+			Job::Counter* counter = nullptr;
+
+			i32 begin = 0;
+			i32 end = GetWindowEnd(table, begin);
+			if(!ReadWindow(file, dataOffset, table, begin, end, buffers[0].data()))
+				return false;
+			for(i32 window = 0; begin < numBlocks; ++window)
+			{
+				jobData.src_ = buffers[window & 1].data();
+				jobData.firstBlock_ = begin;
+				if(useJobs)
+				{
+					jobDescs.clear();
+					for(i32 blockIdx = begin; blockIdx < end; ++blockIdx)
+					{
+						Job::JobDesc jobDesc;
+						jobDesc.func_ = DecompressBlockJob;
+						jobDesc.param_ = blockIdx;
+						jobDesc.data_ = &jobData;
+						jobDesc.name_ = "ReadCompressedData";
+						jobDescs.push_back(jobDesc);
+					}
+					Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+				}
+				else
+				{
+					for(i32 blockIdx = begin; blockIdx < end; ++blockIdx)
+						DecompressBlockJob(blockIdx, &jobData);
+				}
+
+				const i32 nextBegin = end;
+				const i32 nextEnd = nextBegin < numBlocks ? GetWindowEnd(table, nextBegin) : nextBegin;
+				u8* nextBuffer = buffers[(window + 1) & 1].data();
+				const bool readNext =
+				    nextBegin == numBlocks || ReadWindow(file, dataOffset, table, nextBegin, nextEnd, nextBuffer);
+				if(useJobs)
+					Job::Manager::WaitForCounter(counter, 0);
+				if(!readNext || jobData.failed_)
+					return false;
+
+				begin = nextBegin;
+				end = nextEnd;
+			}
+			return true;
+		}
+	} // namespace
+
+	bool WriteCompressedData(
+	    Core::File& file, const void* data, i64 size, Core::CompressionCodec codec, i32 level, i32 blockSize)
+	{
+		DBG_ASSERT(size >= 0);
+		DBG_ASSERT(blockSize > 0 && (u32)blockSize < COMPRESSED_BLOCK_RAW);
+
+		CompressedDataHeader header;
+		header.codec_ = codec;
+		header.blockSize_ = (u32)blockSize;
+		header.uncompressedSize_ = size;
+		const i64 numBlocks = (size + blockSize - 1) / blockSize;
+		header.numBlocks_ = (u32)numBlocks;
+
+		// Each block is compressed into its own slot, so they can all be compressed at once.
+		const i64 bound = Core::CompressionBound(codec, blockSize);
+		if(numBlocks * bound > std::numeric_limits<i32>::max())
+		{
+			DBG_LOG("Data too large to block compress (%lld bytes).\n", size);
+			return false;
+		}
+		Core::Vector<u32> blocks;
+		blocks.resize((i32)numBlocks);
+		Core::Vector<u8> compressed;
+		compressed.resize_uninitialized((i32)(numBlocks * bound));
+
+		const u8* src = static_cast<const u8*>(data);
+		Job::ParallelFor(0, (i32)numBlocks, 1, [&](i32 begin, i32 end) {
+			for(i32 blockIdx = begin; blockIdx < end; ++blockIdx)
+			{
+				const i64 uncompressedSize = GetBlockSize(header, blockIdx);
+				const i64 compressedSize = Core::Compress(codec, compressed.data() + blockIdx * bound, bound,
+				    src + (i64)blockIdx * blockSize, uncompressedSize, level);
+				if(compressedSize > 0 && compressedSize < uncompressedSize)
+					blocks[blockIdx] = (u32)compressedSize;
+				else
+					blocks[blockIdx] = (u32)uncompressedSize | COMPRESSED_BLOCK_RAW;
+			}
+		});
+
+		if(file.Write(&header, sizeof(header)) != (i64)sizeof(header))
+			return false;
+		const i64 tableBytes = numBlocks * sizeof(u32);
+		if(numBlocks > 0 && file.Write(blocks.data(), tableBytes) != tableBytes)
+			return false;
+		for(i32 blockIdx = 0; blockIdx < blocks.size(); ++blockIdx)
+		{
+			// Raw blocks are written from the source, rather than whatever didn't fit in their slot.
+			const u32 block = blocks[blockIdx];
+			const i64 storedSize = block & ~COMPRESSED_BLOCK_RAW;
+			const u8* blockData = (block & COMPRESSED_BLOCK_RAW) ? src + (i64)blockIdx * blockSize
+			                                                     : compressed.data() + blockIdx * bound;
+			if(file.Write(blockData, storedSize) != storedSize)
+				return false;
+		}
+		return true;
+	}
+
+	i64 GetUncompressedSize(const Core::File& file)
+	{
+		CompressedDataHeader header;
+		const i64 offset = file.Tell();
+		if((file.Size() - offset) < (i64)sizeof(header))
+			return -1;
+		if(file.ReadAt(offset, &header, sizeof(header)) != (i64)sizeof(header) || !IsValidHeader(header))
+			return -1;
+		return header.uncompressedSize_;
+	}
+
+	bool ReadCompressedData(Core::File& file, void* dest, i64 destSize)
+	{
+		DBG_ASSERT(dest || destSize == 0);
+
+		BlockTable table;
+		if(!ReadBlockTable(file, table))
+		{
+			DBG_LOG("Invalid compressed data header.\n");
+			return false;
+		}
+		if(table.header_.uncompressedSize_ != destSize)
+		{
+			DBG_LOG("Compressed data is %lld bytes, expected %lld.\n", table.header_.uncompressedSize_, destSize);
+			return false;
+		}
+
+		const i64 dataOffset = file.Tell();
+		const i64 dataSize = table.offsets_.back();
+		const i32 numBlocks = table.blocks_.size();
+		if(numBlocks == 0)
+			return true;
+
+		// Map if it won't fault pages in a few at a time, otherwise stream. Mapping a truncated file fails.
+		const bool useMap = file.GetDescriptor() < 0 || Core::ContainsAllFlags(file.GetFlags(), Core::FileFlags::MMAP);
+		const u8* mappedData = useMap ? static_cast<const u8*>(file.Map(dataOffset, dataSize)) : nullptr;
+		bool success = true;
+		if(mappedData)
+		{
+			DecompressJobData jobData;
+			jobData.table_ = &table;
+			jobData.dest_ = static_cast<u8*>(dest);
+			jobData.src_ = mappedData;
+			Job::ParallelFor(0, numBlocks, 1, [&jobData](i32 begin, i32 end) {
+				for(i32 blockIdx = begin; blockIdx < end; ++blockIdx)
+					DecompressBlockJob(blockIdx, &jobData);
+			});
+			file.Unmap(mappedData);
+			success = jobData.failed_ == 0;
+		}
+		else
+		{
+			success = StreamBlocks(file, dataOffset, table, static_cast<u8*>(dest));
+		}
+
+		if(!success)
+		{
+			DBG_LOG("Compressed data is corrupt or truncated.\n");
+			return false;
+		}
+		return file.Seek(dataOffset + dataSize);
+	}
+} // namespace Resource
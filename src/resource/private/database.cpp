@@ -2,6 +2,7 @@
 
 #include "core/file.h"
 #include "core/map.h"
+#include "core/memory_tracker.h"
 #include "core/misc.h"
 #include "core/set.h"
 #include "core/uuid.h"
@@ -13,7 +14,8 @@ namespace Resource
 {
 	struct DatabaseImpl
 	{
-		using DependencySet = Core::Set<Core::UUID>;
+		using ResourceAllocator = Core::TaggedAllocator<Core::MemoryTag::RESOURCE>;
+		using DependencySet = Core::Set<Core::UUID, Core::Hasher<Core::UUID>, ResourceAllocator>;
 
 		/**
 		 * A single resource entry.
@@ -21,7 +23,7 @@ namespace Resource
 		struct Entry
 		{
 			/// Resource name.
-			Core::Vector<char> name_;
+			Core::Vector<char, ResourceAllocator> name_;
 			/// Resource data.
 			void* data_ = nullptr;
 
@@ -31,7 +33,7 @@ namespace Resource
 			DependencySet dependents_;
 		};
 
-		Core::Map<Core::UUID, Entry> entries_;
+		Core::Map<Core::UUID, Entry, Core::Hasher<Core::UUID>, ResourceAllocator> entries_;
 
 		/**
 		 * Recurse dependencies and call the specified function for each.
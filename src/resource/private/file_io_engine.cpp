@@ -0,0 +1,447 @@
+#include "resource/private/file_io_engine.h"
+
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/misc.h"
+#include "core/mpsc_queue.h"
+#include "core/profiler.h"
+#include "core/vector.h"
+
+#if PLATFORM_LINUX && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define IO_URING_ENABLED 1
+#endif
+#endif
+
+#if IO_URING_ENABLED
+#include <linux/io_uring.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace Resource
+{
+	namespace
+	{
+		/// Read request, freed when its last chunk completes.
+		struct ReadState
+		{
+			Core::File* file_ = nullptr;
+			i64 offset_ = 0;
+			i64 size_ = 0;
+			u8* dest_ = nullptr;
+			AsyncResult* result_ = nullptr;
+			volatile i32 chunksRemaining_ = 0;
+			volatile i32 failed_ = 0;
+		};
+
+		struct ReadChunk
+		{
+			ReadState* state_ = nullptr;
+			i64 offset_ = 0;
+			i64 size_ = 0;
+			u8* dest_ = nullptr;
+		};
+
+#if IO_URING_ENABLED
+		int IOUringSetup(u32 entries, io_uring_params* params)
+		{
+			return (int)::syscall(__NR_io_uring_setup, entries, params);
+		}
+
+		int IOUringEnter(int ringFd, u32 toSubmit, u32 minComplete, u32 flags)
+		{
+			return (int)::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0);
+		}
+
+		/**
+		 * Minimal io_uring, without liburing.
+		 * Only used from one thread, so the only synchronization needed is with the kernel.
+		 */
+		class IOUring
+		{
+		public:
+			~IOUring()
+			{
+				if(sqes_)
+					::munmap(sqes_, sqesSize_);
+				if(cqRing_ && cqRing_ != sqRing_)
+					::munmap(cqRing_, cqRingSize_);
+				if(sqRing_)
+					::munmap(sqRing_, sqRingSize_);
+				if(ringFd_ != -1)
+					::close(ringFd_);
+			}
+
+			bool Initialize(u32 entries)
+			{
+				io_uring_params params;
+				memset(&params, 0, sizeof(params));
+				ringFd_ = IOUringSetup(entries, &params);
+				if(ringFd_ < 0)
+				{
+					ringFd_ = -1;
+					return false;
+				}
+
+				sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(u32);
+				cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+				const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+				if(singleMap)
+					sqRingSize_ = cqRingSize_ = Core::Max(sqRingSize_, cqRingSize_);
+
+				sqRing_ = MapRing(sqRingSize_, IORING_OFF_SQ_RING);
+				cqRing_ = singleMap ? sqRing_ : MapRing(cqRingSize_, IORING_OFF_CQ_RING);
+				sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+				sqes_ = reinterpret_cast<io_uring_sqe*>(MapRing(sqesSize_, IORING_OFF_SQES));
+				if(!sqRing_ || !cqRing_ || !sqes_)
+					return false;
+
+				sqHead_ = (volatile i32*)(sqRing_ + params.sq_off.head);
+				sqTail_ = (volatile i32*)(sqRing_ + params.sq_off.tail);
+				sqMask_ = *(u32*)(sqRing_ + params.sq_off.ring_mask);
+				sqArray_ = (u32*)(sqRing_ + params.sq_off.array);
+				cqHead_ = (volatile i32*)(cqRing_ + params.cq_off.head);
+				cqTail_ = (volatile i32*)(cqRing_ + params.cq_off.tail);
+				cqMask_ = *(u32*)(cqRing_ + params.cq_off.ring_mask);
+				cqes_ = (io_uring_cqe*)(cqRing_ + params.cq_off.cqes);
+				return true;
+			}
+
+			/// Queue read into @a iov, to be submitted with the next Enter.
+			void PushRead(i32 fd, const iovec* iov, i64 offset, u64 userData)
+			{
+				const u32 tail = (u32)*sqTail_;
+				const u32 idx = tail & sqMask_;
+				io_uring_sqe* sqe = &sqes_[idx];
+				memset(sqe, 0, sizeof(*sqe));
+				sqe->opcode = IORING_OP_READV;
+				sqe->fd = fd;
+				sqe->off = (u64)offset;
+				sqe->addr = (u64)(uintptr_t)iov;
+				sqe->len = 1;
+				sqe->user_data = userData;
+				sqArray_[idx] = idx;
+				Core::AtomicStoreRel(sqTail_, (i32)(tail + 1));
+				++numToSubmit_;
+			}
+
+			/// Submit queued reads and wait for at least @a minComplete to complete.
+			bool Enter(u32 minComplete)
+			{
+				for(;;)
+				{
+					const int result = IOUringEnter(ringFd_, numToSubmit_, minComplete, IORING_ENTER_GETEVENTS);
+					if(result >= 0)
+					{
+						numToSubmit_ -= Core::Min((u32)result, numToSubmit_);
+						if(numToSubmit_ == 0)
+							return true;
+						continue;
+					}
+					if(errno != EINTR && errno != EAGAIN)
+						return false;
+				}
+			}
+
+			/**
+			 * Withdraw reads the kernel hasn't consumed yet, calling @a func(userData) for each.
+			 * Safe as the kernel only reads the submission tail during Enter.
+			 */
+			template<typename FUNC>
+			void CancelUnsubmitted(FUNC&& func)
+			{
+				const u32 head = (u32)Core::AtomicLoadAcq(sqHead_);
+				const u32 tail = (u32)*sqTail_;
+				for(u32 i = head; i != tail; ++i)
+					func(sqes_[sqArray_[i & sqMask_]].user_data);
+				Core::AtomicStoreRel(sqTail_, (i32)head);
+				numToSubmit_ = 0;
+			}
+
+			/// Call @a func(userData, result) for each completion.
+			template<typename FUNC>
+			void ReapCompletions(FUNC&& func)
+			{
+				u32 head = (u32)*cqHead_;
+				const u32 tail = (u32)Core::AtomicLoadAcq(cqTail_);
+				for(; head != tail; ++head)
+				{
+					const io_uring_cqe& cqe = cqes_[head & cqMask_];
+					func(cqe.user_data, cqe.res);
+				}
+				Core::AtomicStoreRel(cqHead_, (i32)head);
+			}
+
+		private:
+			u8* MapRing(size_t size, u64 offset)
+			{
+				void* mem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, offset);
+				return mem != MAP_FAILED ? static_cast<u8*>(mem) : nullptr;
+			}
+
+			int ringFd_ = -1;
+			u8* sqRing_ = nullptr;
+			u8* cqRing_ = nullptr;
+			io_uring_sqe* sqes_ = nullptr;
+			size_t sqRingSize_ = 0;
+			size_t cqRingSize_ = 0;
+			size_t sqesSize_ = 0;
+			volatile i32* sqHead_ = nullptr;
+			volatile i32* sqTail_ = nullptr;
+			u32 sqMask_ = 0;
+			u32* sqArray_ = nullptr;
+			volatile i32* cqHead_ = nullptr;
+			volatile i32* cqTail_ = nullptr;
+			u32 cqMask_ = 0;
+			io_uring_cqe* cqes_ = nullptr;
+			u32 numToSubmit_ = 0;
+		};
+#endif
+	} // namespace
+
+	struct FileIOEngineImpl
+	{
+		/// Requests not yet fully split into chunks.
+		Core::MPSCQueue<ReadState*> requests_;
+		/// Number of requests in requests_. Incremented before Enqueue, so may be briefly ahead of Dequeue.
+		volatile i32 numQueued_ = 0;
+		/// Request currently being split into chunks, by whichever thread is calling NextChunk.
+		ReadState* current_ = nullptr;
+		i64 currentOffset_ = 0;
+		volatile i32 exiting_ = 0;
+
+		/// io_uring submission thread, if io_uring is available.
+		bool useIOUring_ = false;
+		Core::Event submitEvent_;
+		Core::Thread submitThread_;
+#if IO_URING_ENABLED
+		IOUring ring_;
+#endif
+
+		/// Thread pool fallback. One semaphore count per chunk.
+		Core::Semaphore workSemaphore_;
+		Core::Mutex chunkMutex_;
+		Core::Vector<Core::Thread> workerThreads_;
+
+		/// Get next chunk to read, from current request or the next one queued.
+		bool NextChunk(ReadChunk& outChunk)
+		{
+			if(current_ == nullptr)
+			{
+				if(!requests_.Dequeue(current_))
+					return false;
+				Core::AtomicDec(&numQueued_);
+				currentOffset_ = 0;
+				if(current_->result_)
+				{
+					auto* result = current_->result_;
+					auto oldResult = (Result)Core::AtomicExchg((volatile i32*)&result->result_, (i32)Result::RUNNING);
+					DBG_ASSERT(oldResult == Result::PENDING);
+				}
+			}
+
+			outChunk.state_ = current_;
+			outChunk.offset_ = current_->offset_ + currentOffset_;
+			outChunk.size_ = Core::Min(FileIOEngine::CHUNK_SIZE, current_->size_ - currentOffset_);
+			outChunk.dest_ = current_->dest_ + currentOffset_;
+			currentOffset_ += outChunk.size_;
+			if(currentOffset_ == current_->size_)
+				current_ = nullptr;
+			return true;
+		}
+
+		/// Finish a chunk, reading whatever the OS didn't synchronously.
+		static void CompleteChunk(const ReadChunk& chunk, i64 bytesRead)
+		{
+			ReadState* state = chunk.state_;
+			bytesRead = Core::Max(bytesRead, (i64)0);
+			if(bytesRead < chunk.size_)
+				bytesRead +=
+				    state->file_->ReadAt(chunk.offset_ + bytesRead, chunk.dest_ + bytesRead, chunk.size_ - bytesRead);
+
+			if(bytesRead < chunk.size_)
+				Core::AtomicStoreRel(&state->failed_, 1);
+			if(state->result_)
+				Core::AtomicAddRel(&state->result_->workRemaining_, -bytesRead);
+
+			if(Core::AtomicDec(&state->chunksRemaining_) == 0)
+			{
+				if(state->result_)
+				{
+					const Result result = Core::AtomicLoadAcq(&state->failed_) ? Result::FAILURE : Result::SUCCESS;
+					Core::AtomicExchg((volatile i32*)&state->result_->result_, (i32)result);
+				}
+				delete state;
+			}
+		}
+
+		FileIOEngineImpl()
+		    : submitEvent_(false, false, "Resource File IO Submit Event")
+		    , workSemaphore_(0, 0x7fffffff, "Resource File IO Work Semaphore")
+		{
+		}
+
+#if IO_URING_ENABLED
+		static int SubmitThread(void* userData)
+		{
+			auto* impl = reinterpret_cast<FileIOEngineImpl*>(userData);
+
+			ReadChunk inFlight[FileIOEngine::QUEUE_DEPTH];
+			iovec iovs[FileIOEngine::QUEUE_DEPTH];
+			Core::Vector<i32> freeSlots;
+			for(i32 i = FileIOEngine::QUEUE_DEPTH - 1; i >= 0; --i)
+				freeSlots.push_back(i);
+			// Set if io_uring_enter fails. Reads already submitted are still reaped, everything else is read
+			// synchronously on this thread.
+			bool ringFailed = false;
+
+			for(;;)
+			{
+				// Fill free slots, so as many reads as possible are outstanding.
+				ReadChunk chunk;
+				while(freeSlots.size() > 0 && impl->NextChunk(chunk))
+				{
+					const i32 fd = chunk.state_->file_->GetDescriptor();
+					if(fd == -1 || ringFailed)
+					{
+						CompleteChunk(chunk, 0);
+						continue;
+					}
+					const i32 slot = freeSlots.back();
+					freeSlots.pop_back();
+					inFlight[slot] = chunk;
+					iovs[slot].iov_base = chunk.dest_;
+					iovs[slot].iov_len = (size_t)chunk.size_;
+					impl->ring_.PushRead(fd, &iovs[slot], chunk.offset_, (u64)slot);
+				}
+
+				if(freeSlots.size() < FileIOEngine::QUEUE_DEPTH)
+				{
+					// Submit, then wait for and complete at least one read.
+					PROFILE_SCOPE("Resource::FileIOEngine::Wait");
+					if(ringFailed)
+					{
+						Core::YieldCPU();
+					}
+					else if(!impl->ring_.Enter(1))
+					{
+						DBG_LOG("io_uring_enter failed (errno %i), falling back to synchronous reads.\n", errno);
+						ringFailed = true;
+						impl->ring_.CancelUnsubmitted([&](u64 userData) {
+							const i32 slot = (i32)userData;
+							CompleteChunk(inFlight[slot], 0);
+							freeSlots.push_back(slot);
+						});
+					}
+					impl->ring_.ReapCompletions([&](u64 userData, i32 result) {
+						const i32 slot = (i32)userData;
+						CompleteChunk(inFlight[slot], result);
+						freeSlots.push_back(slot);
+					});
+				}
+				else if(Core::AtomicLoadAcq(&impl->numQueued_) == 0)
+				{
+					if(Core::AtomicLoadAcq(&impl->exiting_))
+						return 0;
+					impl->submitEvent_.Wait();
+				}
+			}
+		}
+#endif
+
+		static int WorkerThread(void* userData)
+		{
+			auto* impl = reinterpret_cast<FileIOEngineImpl*>(userData);
+			for(;;)
+			{
+				impl->workSemaphore_.Wait();
+
+				// Each count is a chunk, or a request to exit once there are none left.
+				ReadChunk chunk;
+				for(;;)
+				{
+					bool gotChunk = false;
+					{
+						Core::ScopedMutex lock(impl->chunkMutex_);
+						gotChunk = impl->NextChunk(chunk);
+					}
+					if(gotChunk)
+						break;
+					if(Core::AtomicLoadAcq(&impl->exiting_) && Core::AtomicLoadAcq(&impl->numQueued_) == 0)
+						return 0;
+					Core::YieldCPU();
+				}
+
+				PROFILE_SCOPE("Resource::FileIOEngine::Read");
+				CompleteChunk(chunk, chunk.state_->file_->ReadAt(chunk.offset_, chunk.dest_, chunk.size_));
+			}
+		}
+	};
+
+	FileIOEngine::FileIOEngine(bool allowIOUring)
+	{
+		impl_ = new FileIOEngineImpl();
+#if IO_URING_ENABLED
+		impl_->useIOUring_ = allowIOUring && impl_->ring_.Initialize(QUEUE_DEPTH);
+		if(impl_->useIOUring_)
+		{
+			impl_->submitThread_ =
+			    Core::Thread(FileIOEngineImpl::SubmitThread, impl_, 65536, "Resource File IO Submit Thread");
+			return;
+		}
+#else
+		(void)allowIOUring;
+#endif
+		for(i32 i = 0; i < NUM_FALLBACK_THREADS; ++i)
+			impl_->workerThreads_.emplace_back(FileIOEngineImpl::WorkerThread, impl_, 65536, "Resource File IO Thread");
+	}
+
+	FileIOEngine::~FileIOEngine()
+	{
+		Core::AtomicStoreRel(&impl_->exiting_, 1);
+		if(impl_->useIOUring_)
+		{
+			impl_->submitEvent_.Signal();
+			impl_->submitThread_.Join();
+		}
+		else
+		{
+			impl_->workSemaphore_.Signal(impl_->workerThreads_.size());
+			for(auto& thread : impl_->workerThreads_)
+				thread.Join();
+		}
+		delete impl_;
+	}
+
+	void FileIOEngine::Read(Core::File& file, i64 offset, i64 size, void* dest, AsyncResult* result)
+	{
+		DBG_ASSERT(Core::ContainsAllFlags(file.GetFlags(), Core::FileFlags::READ));
+		DBG_ASSERT(offset >= 0);
+		DBG_ASSERT(size > 0);
+		DBG_ASSERT(!Core::AtomicLoadAcq(&impl_->exiting_));
+
+		const i32 numChunks = (i32)((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+		auto* state = new ReadState();
+		state->file_ = &file;
+		state->offset_ = offset;
+		state->size_ = size;
+		state->dest_ = static_cast<u8*>(dest);
+		state->result_ = result;
+		state->chunksRemaining_ = numChunks;
+
+		Core::AtomicInc(&impl_->numQueued_);
+		impl_->requests_.Enqueue(state);
+		if(impl_->useIOUring_)
+			impl_->submitEvent_.Signal();
+		else
+			impl_->workSemaphore_.Signal(numChunks);
+	}
+
+	bool FileIOEngine::IsUsingIOUring() const { return impl_->useIOUring_; }
+} // namespace Resource
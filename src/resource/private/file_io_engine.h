@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/types.h"
+#include "resource/dll.h"
+#include "resource/types.h"
+
+namespace Core
+{
+	class File;
+} // namespace Core
+
+namespace Resource
+{
+	/**
+	 * Asynchronous file reader that keeps many reads in flight at once, across any number of files.
+	 * Reads are split into CHUNK_SIZE chunks, up to QUEUE_DEPTH of which are outstanding. On Linux they're
+	 * submitted in batches with io_uring from a single thread. Elsewhere, or if io_uring is unavailable, a
+	 * pool of threads reads them with Core::File::ReadAt.
+	 * AsyncResult::workRemaining_ is decremented as each chunk completes, and result_ is set once all have.
+	 */
+	class RESOURCE_DLL FileIOEngine final
+	{
+	public:
+		static const i64 CHUNK_SIZE = 1024 * 1024;
+		static const i32 QUEUE_DEPTH = 64;
+		static const i32 NUM_FALLBACK_THREADS = 4;
+
+		/**
+		 * @param allowIOUring Use io_uring if available. Otherwise always use the thread pool.
+		 */
+		FileIOEngine(bool allowIOUring = true);
+		~FileIOEngine();
+
+		/**
+		 * Queue read. Pending reads are completed before destruction.
+		 * @param file File to read from. Must remain valid until read completes.
+		 * @param offset Offset to read from.
+		 * @param size Size to read.
+		 * @param dest Destination address.
+		 * @param result Async result, or nullptr.
+		 * @pre @a file is valid for reading.
+		 * @pre offset >= 0.
+		 * @pre size > 0.
+		 * @pre @a result is PENDING, with workRemaining_ including @a size.
+		 */
+		void Read(Core::File& file, i64 offset, i64 size, void* dest, AsyncResult* result);
+
+		/**
+		 * @return Reads are submitted with io_uring.
+		 */
+		bool IsUsingIOUring() const;
+
+	private:
+		FileIOEngine(const FileIOEngine&) = delete;
+		FileIOEngine& operator=(const FileIOEngine&) = delete;
+
+		struct FileIOEngineImpl* impl_ = nullptr;
+	};
+} // namespace Resource
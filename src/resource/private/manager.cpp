@@ -1,50 +1,65 @@
 #pragma once
 
 #include "resource/manager.h"
+#include "resource/archive.h"
 #include "resource/converter.h"
 #include "resource/factory.h"
+#include "resource/private/file_io_engine.h"
 
 #include "core/array.h"
 #include "core/concurrency.h"
 #include "core/file.h"
 #include "core/library.h"
 #include "core/map.h"
+#include "core/memory_tracker.h"
 #include "core/misc.h"
-#include "core/mpmc_bounded_queue.h"
+#include "core/mpsc_queue.h"
+#include "core/profiler.h"
 #include "core/string.h"
+#include "core/string_id.h"
 #include "core/uuid.h"
 
 #include "job/manager.h"
 #include "plugin/manager.h"
 #include "serialization/serializer.h"
 
-#include <algorithm>
 #include <utility>
 
 namespace Resource
 {
+	using ResourceAllocator = Core::TaggedAllocator<Core::MemoryTag::RESOURCE>;
+
 	struct ResourceEntry
 	{
 		void* resource_ = nullptr;
-		Core::UUID name_;
+		Core::StringId name_;
 		Core::UUID type_;
 		volatile i32 loaded_ = 0;
 		volatile i32 refCount_ = 0;
 	};
 
-	using ResourceList = Core::Vector<ResourceEntry*>;
+	using ResourceList = Core::Vector<ResourceEntry*, ResourceAllocator>;
+	using ResourceNameKey = Core::Pair<Core::StringId, Core::UUID>;
+	using ResourceKey = Core::Pair<void*, Core::UUID>;
 }
 
 namespace Core
 {
 	u32 Hash(u32 input, const Core::Pair<Core::UUID, Core::UUID>& pair)
 	{
-		return HashCRC32(input, &pair, sizeof(pair));
+		return HashCRC32C(input, &pair, sizeof(pair));
 	}
 
 	u32 Hash(u32 input, Resource::ResourceEntry* resourceEntry)
 	{
-		return HashCRC32(input, &resourceEntry, sizeof(resourceEntry));
+		return HashCRC32C(input, &resourceEntry, sizeof(resourceEntry));
+	}
+
+	u32 Hash(u32 input, const Resource::ResourceNameKey& key) { return Hash(Hash(input, key.first), key.second); }
+
+	u32 Hash(u32 input, const Resource::ResourceKey& key)
+	{
+		return Hash(HashCRC32C(input, &key.first, sizeof(key.first)), key.second);
 	}
 } // namespace Core
 
@@ -186,6 +201,7 @@ namespace Resource
 
 		Result DoRead()
 		{
+			PROFILE_SCOPE("Resource::DoRead");
 			DBG_ASSERT(file_);
 			DBG_ASSERT((offset_ + size_) <= file_->Size());
 
@@ -195,15 +211,17 @@ namespace Resource
 				DBG_ASSERT(oldResult == Result::PENDING);
 			}
 
-			file_->Seek(offset_);
-
-			// Read file in chunks.
+			// Read file in chunks, at explicit offsets so reads don't depend on or move the file's position.
 			char* dest = (char*)addr_;
+			i64 offset = offset_;
 			i64 sizeRemaining = size_;
 			while(sizeRemaining > 0)
 			{
 				i64 readSize = Core::Min(READ_CHUNK_SIZE, sizeRemaining);
-				i64 bytesRead = file_->Read(dest, readSize);
+				if(sizeRemaining > readSize)
+					file_->Prefetch(offset + readSize, Core::Min(READ_CHUNK_SIZE, sizeRemaining - readSize));
+				i64 bytesRead = file_->ReadAt(offset, dest, readSize);
+				offset += readSize;
 				sizeRemaining -= readSize;
 				dest += readSize;
 				if(result_)
@@ -228,6 +246,7 @@ namespace Resource
 
 		Result DoWrite()
 		{
+			PROFILE_SCOPE("Resource::DoWrite");
 			DBG_ASSERT(file_);
 			DBG_ASSERT(offset_ == 0);
 
@@ -269,21 +288,17 @@ namespace Resource
 
 	struct ManagerImpl
 	{
-		static const i32 MAX_READ_JOBS = 128;
-		static const i32 MAX_WRITE_JOBS = 128;
-
 		/// Plugins.
-		Core::Vector<ConverterPlugin> converterPlugins_;
+		Core::Vector<ConverterPlugin, ResourceAllocator> converterPlugins_;
 
-		/// Read job queue.
-		Core::MPMCBoundedQueue<FileIOJob> readJobs_;
-		/// Signalled when read job is waiting.
-		Core::Event readJobEvent_;
-		/// Thread to use for blocking reads.
-		Core::Thread readThread_;
+		/// Async reads, many in flight at once.
+		FileIOEngine readEngine_;
 
-		/// Write job queue.
-		Core::MPMCBoundedQueue<FileIOJob> writeJobs_;
+		/// Mounted archives, in order of mounting.
+		Core::Vector<Archive*, ResourceAllocator> archives_;
+
+		/// Write job queue. Enqueued from any thread, dequeued by writeThread_.
+		Core::MPSCQueue<FileIOJob> writeJobs_;
 		/// Signalled when write job is waiting.
 		Core::Event writeJobEvent_;
 		/// Thread to use for blocking reads.
@@ -291,7 +306,10 @@ namespace Resource
 
 		/// Resources.
 		volatile i32 pendingResourceJobs_ = 0;
-		ResourceList resourceList_;
+		/// Live entries by name, for requests.
+		Core::Map<ResourceNameKey, ResourceEntry*, Core::Hasher<ResourceNameKey>, ResourceAllocator> entriesByName_;
+		/// Live entries by resource, for release and ready checks. Added once the resource is created.
+		Core::Map<ResourceKey, ResourceEntry*, Core::Hasher<ResourceKey>, ResourceAllocator> entriesByResource_;
 		ResourceList releasedResourceList_;
 		Core::Mutex resourceMutex_;
 
@@ -306,65 +324,66 @@ namespace Resource
 			if(Core::AtomicDec(&entry->refCount_) == 0)
 			{
 				releasedResourceList_.push_back(entry);
-				auto it = std::find_if(resourceList_.begin(), resourceList_.end(),
-				    [entry](ResourceEntry* listEntry) { return entry == listEntry; });
-				DBG_ASSERT(it != resourceList_.end());
-				resourceList_.erase(it);
+				const bool erased = entriesByName_.erase(ResourceNameKey(entry->name_, entry->type_));
+				DBG_ASSERT(erased);
+				(void)erased;
+				if(entry->resource_)
+					entriesByResource_.erase(ResourceKey(entry->resource_, entry->type_));
 				return true;
 			}
 			return false;
 		}
 
-		ResourceEntry* AcquireResourceEntry(const Core::UUID& name, const Core::UUID& type)
+		ResourceEntry* AcquireResourceEntry(const Core::StringId& name, const Core::UUID& type)
 		{
 			Core::ScopedMutex lock(resourceMutex_);
 			ResourceEntry* entry = nullptr;
-			auto it =
-			    std::find_if(resourceList_.begin(), resourceList_.end(), [&name, &type](ResourceEntry* listEntry) {
-				    return listEntry->name_ == name && listEntry->type_ == type;
-				});
-			if(it == resourceList_.end())
+			const ResourceNameKey key(name, type);
+			auto it = entriesByName_.find(key);
+			if(it == entriesByName_.end())
 			{
 				entry = new ResourceEntry();
 				entry->name_ = name;
 				entry->type_ = type;
-				resourceList_.push_back(entry);
+				entriesByName_.insert(key, entry);
 			}
 			else
 			{
-				entry = *it;
+				entry = it->second;
 			}
 			DBG_ASSERT(entry);
 			Core::AtomicInc(&entry->refCount_);
 			return entry;
 		}
 
+		/// Index @a entry by its resource, once created.
+		void AddResourceEntry(ResourceEntry* entry)
+		{
+			DBG_ASSERT(entry->resource_);
+			Core::ScopedMutex lock(resourceMutex_);
+			entriesByResource_.insert(ResourceKey(entry->resource_, entry->type_), entry);
+		}
+
 		/// @return true if this was the last reference.
 		bool ReleaseResourceEntry(void* resource, const Core::UUID& type)
 		{
 			Core::ScopedMutex lock(resourceMutex_);
-			auto it =
-			    std::find_if(resourceList_.begin(), resourceList_.end(), [resource, &type](ResourceEntry* listEntry) {
-				    return listEntry->resource_ == resource && listEntry->type_ == type;
-				});
-			DBG_ASSERT(it != resourceList_.end());
-			return ReleaseResourceEntry(*it);
+			auto it = entriesByResource_.find(ResourceKey(resource, type));
+			DBG_ASSERT(it != entriesByResource_.end());
+			return ReleaseResourceEntry(it->second);
 		}
 
 		/// @return if resource is ready.
 		bool IsResourceReady(void* resource, const Core::UUID& type)
 		{
 			Core::ScopedMutex lock(resourceMutex_);
-			auto it =
-			    std::find_if(resourceList_.begin(), resourceList_.end(), [resource, &type](ResourceEntry* listEntry) {
-				    return listEntry->resource_ == resource && listEntry->type_ == type;
-				});
-			DBG_ASSERT(it != resourceList_.end());
-			return (*it)->loaded_ != 0;
+			auto it = entriesByResource_.find(ResourceKey(resource, type));
+			DBG_ASSERT(it != entriesByResource_.end());
+			return it->second->loaded_ != 0;
 		}
 
 		/// Factories.
-		using Factories = Core::Map<Core::UUID, IFactory*>;
+		using Factories = Core::Map<Core::UUID, IFactory*, Core::Hasher<Core::UUID>, ResourceAllocator>;
 		Factories factories_;
 		Core::Mutex factoriesMutex_;
 
@@ -382,9 +401,24 @@ namespace Resource
 			return it->second;
 		}
 
+		/// @return Entry for resource in the most recently mounted archive containing it, or nullptr.
+		const ArchiveEntry* FindArchiveEntry(const Core::UUID& uuid, const Core::UUID& type, const Archive*& outArchive)
+		{
+			for(i32 idx = archives_.size() - 1; idx >= 0; --idx)
+			{
+				const ArchiveEntry* entry = archives_[idx]->FindEntry(uuid);
+				if(entry && entry->type_ == type)
+				{
+					outArchive = archives_[idx];
+					return entry;
+				}
+			}
+			return nullptr;
+		}
 
 		void ProcessReleasedResources()
 		{
+			PROFILE_SCOPE("Resource::ProcessReleasedResources");
 			ResourceList releasedResourceList;
 			{
 				Core::ScopedMutex lock(resourceMutex_);
@@ -407,11 +441,7 @@ namespace Resource
 		}
 
 		ManagerImpl()
-		    : readJobs_(MAX_READ_JOBS)
-		    , readJobEvent_(false, false, "Resource Manager Read Event")
-		    , readThread_(ReadIOThread, this, 65536, "Resource Manager Read Thread")
-		    , writeJobs_(MAX_WRITE_JOBS)
-		    , writeJobEvent_(false, false, "Resource Manager Write Event")
+		    : writeJobEvent_(false, false, "Resource Manager Write Event")
 		    , writeThread_(WriteIOThread, this, 65536, "Resource Manager Write Thread")
 		{
 			// Get converter plugins.
@@ -430,36 +460,15 @@ namespace Resource
 
 			ProcessReleasedResources();
 
-			// TODO: Mark jobs as cancelled.
-			while(readJobs_.Enqueue(FileIOJob()) == false)
-				Job::Manager::YieldCPU();
-			readJobEvent_.Signal();
-			readThread_.Join();
+			for(auto* archive : archives_)
+				delete archive;
 
-			while(writeJobs_.Enqueue(FileIOJob()) == false)
-				Job::Manager::YieldCPU();
+			// TODO: Mark jobs as cancelled.
+			writeJobs_.Enqueue(FileIOJob());
 			writeJobEvent_.Signal();
 			writeThread_.Join();
 		}
 
-		static int ReadIOThread(void* userData)
-		{
-			auto* impl = reinterpret_cast<ManagerImpl*>(userData);
-
-			FileIOJob ioJob;
-			for(;;)
-			{
-				if(impl->readJobs_.Dequeue(ioJob))
-				{
-					if(ioJob.file_ != nullptr)
-						ioJob.DoRead();
-					else
-						return 0;
-				}
-				impl->readJobEvent_.Wait();
-			}
-		}
-
 		static int WriteIOThread(void* userData)
 		{
 			auto* impl = reinterpret_cast<ManagerImpl*>(userData);
@@ -467,7 +476,8 @@ namespace Resource
 			FileIOJob ioJob;
 			for(;;)
 			{
-				if(impl->writeJobs_.Dequeue(ioJob))
+				// Drain, as several jobs may have been queued for one wake up.
+				while(impl->writeJobs_.Dequeue(ioJob))
 				{
 					if(ioJob.file_ != nullptr)
 						ioJob.DoWrite();
@@ -492,8 +502,24 @@ namespace Resource
 		{
 		}
 
+		ResourceLoadJob(ManagerImpl* impl, IFactory* factory, ResourceEntry* entry, Core::UUID type, const char* name,
+		    const Archive* archive, const ArchiveEntry* archiveEntry)
+		    : impl_(impl)
+		    , factory_(factory)
+		    , entry_(entry)
+		    , type_(type)
+		    , name_(name)
+		    , archive_(archive)
+		    , archiveEntry_(archiveEntry)
+		{
+		}
+
 		void RunJob()
 		{
+			PROFILE_SCOPE("Resource::LoadResource");
+			// Open archive entries here, so any decompression happens on job threads.
+			if(archiveEntry_)
+				file_ = archive_->OpenEntry(*archiveEntry_, archiveBuffer_);
 			FactoryContext factoryContext;
 			success_ = factory_->LoadResource(factoryContext, &entry_->resource_, type_, name_.c_str(), file_);
 			if(success_)
@@ -508,6 +534,9 @@ namespace Resource
 		Core::UUID type_;
 		Core::String name_;
 		Core::File file_;
+		const Archive* archive_ = nullptr;
+		const ArchiveEntry* archiveEntry_ = nullptr;
+		Core::Vector<u8> archiveBuffer_;
 		bool success_ = false;
 	};
 
@@ -526,6 +555,7 @@ namespace Resource
 
 		void RunJob()
 		{
+			PROFILE_SCOPE("Resource::ConvertResource");
 			success_ = Manager::ConvertResource(name_.data(), convertedPath_.data(), type_);
 			Core::AtomicDec(&impl_->pendingResourceJobs_);
 		}
@@ -555,6 +585,20 @@ namespace Resource
 
 	bool Manager::IsInitialized() { return !!impl_; }
 
+	bool Manager::MountArchive(const char* path)
+	{
+		DBG_ASSERT(IsInitialized());
+		auto* archive = new Archive(path);
+		if(!*archive)
+		{
+			DBG_LOG("Unable to mount archive \"%s\"\n", path);
+			delete archive;
+			return false;
+		}
+		impl_->archives_.push_back(archive);
+		return true;
+	}
+
 	bool Manager::RequestResource(void*& outResource, const char* name, const Core::UUID& type)
 	{
 		DBG_ASSERT(IsInitialized());
@@ -570,22 +614,11 @@ namespace Resource
 			return false;
 		}
 
-		// Build converted filename.
-		Core::Array<char, Core::MAX_PATH_LENGTH> convertedFileName;
-		Core::Array<char, Core::MAX_PATH_LENGTH> convertedPath;
-		sprintf_s(convertedFileName.data(), convertedFileName.size(), "%s.%s.converted", fileName.data(), ext.data());
-		sprintf_s(convertedPath.data(), convertedPath.size(), "converter_output");
-
-		Core::FileCreateDir(convertedPath.data());
-
-		Core::FileAppendPath(convertedPath.data(), convertedPath.size(), path.data());
-		Core::FileAppendPath(convertedPath.data(), convertedPath.size(), convertedFileName.data());
-
 		// Get factory for resource.
 		if(auto factory = impl_->GetFactory(type))
 		{
 			// Acquire resource, create if required.
-			ResourceEntry* entry = impl_->AcquireResourceEntry(name, type);
+			ResourceEntry* entry = impl_->AcquireResourceEntry(Core::StringId(name), type);
 			if(entry->resource_ == nullptr)
 			{
 				FactoryContext factoryContext;
@@ -593,9 +626,34 @@ namespace Resource
 				// First create resource.
 				if(!factory->CreateResource(factoryContext, &entry->resource_, type))
 					return false;
+				impl_->AddResourceEntry(entry);
 
-				// Setup job to create.
+				// Acquire entry for load job.
+				impl_->AcquireResourceEntry(entry);
+
+				// Load from a mounted archive if it has the resource, without touching the file system.
+				ResourceLoadJob* loadJobData = nullptr;
+				const Archive* archive = nullptr;
+				if(const ArchiveEntry* archiveEntry = impl_->FindArchiveEntry(Core::UUID(name), type, archive))
+				{
+					loadJobData =
+					    new ResourceLoadJob(impl_, factory, entry, type, fileName.data(), archive, archiveEntry);
+				}
+				// Otherwise from converted file.
+				else
 				{
+					// Build converted filename.
+					Core::Array<char, Core::MAX_PATH_LENGTH> convertedFileName;
+					Core::Array<char, Core::MAX_PATH_LENGTH> convertedPath;
+					sprintf_s(convertedFileName.data(), convertedFileName.size(), "%s.%s.converted", fileName.data(),
+					    ext.data());
+					sprintf_s(convertedPath.data(), convertedPath.size(), "converter_output");
+
+					Core::FileCreateDir(convertedPath.data());
+
+					Core::FileAppendPath(convertedPath.data(), convertedPath.size(), path.data());
+					Core::FileAppendPath(convertedPath.data(), convertedPath.size(), convertedFileName.data());
+
 					// If converted file doesn't exist, convert now.
 					// TODO: This should be done async.
 					if(!Core::FileExists(convertedPath.data()))
@@ -621,27 +679,24 @@ namespace Resource
 						delete jobData;
 					}
 
-					// Do load.
-					{
-
-						// Acquire entry for job.
-						impl_->AcquireResourceEntry(entry);
-
-						auto* jobData = new ResourceLoadJob(
-						    impl_, factory, entry, type, fileName.data(), Core::File(convertedPath.data(), Core::FileFlags::READ));
-						Job::JobDesc jobDesc;
-						jobDesc.func_ = [](i32 inParam, void* inData) {
-							auto* data = reinterpret_cast<ResourceLoadJob*>(inData);
-							data->RunJob();
-							delete data;
-						};
-						jobDesc.param_ = 0;
-						jobDesc.data_ = jobData;
-						jobDesc.name_ = "ResourceLoadJob";
+					loadJobData = new ResourceLoadJob(impl_, factory, entry, type, fileName.data(),
+					    Core::File(convertedPath.data(), Core::FileFlags::READ | Core::FileFlags::MMAP));
+				}
 
-						Core::AtomicInc(&impl_->pendingResourceJobs_);
-						Job::Manager::RunJobs(&jobDesc, 1, nullptr);
-					}
+				// Do load.
+				{
+					Job::JobDesc jobDesc;
+					jobDesc.func_ = [](i32 inParam, void* inData) {
+						auto* data = reinterpret_cast<ResourceLoadJob*>(inData);
+						data->RunJob();
+						delete data;
+					};
+					jobDesc.param_ = 0;
+					jobDesc.data_ = loadJobData;
+					jobDesc.name_ = "ResourceLoadJob";
+
+					Core::AtomicInc(&impl_->pendingResourceJobs_);
+					Job::Manager::RunJobs(&jobDesc, 1, nullptr);
 				}
 			}
 
@@ -742,21 +797,18 @@ namespace Resource
 			DBG_ASSERT(oldResult == Result::INITIAL);
 		}
 
-		FileIOJob job;
-		job.file_ = &file;
-		job.offset_ = offset;
-		job.size_ = size;
-		job.addr_ = dest;
-		job.result_ = result;
-
 		if(result)
 		{
 			Core::AtomicAddAcq(&result->workRemaining_, size);
-			impl_->readJobs_.Enqueue(job);
-			impl_->readJobEvent_.Signal();
+			impl_->readEngine_.Read(file, offset, size, dest, result);
 		}
 		else
 		{
+			FileIOJob job;
+			job.file_ = &file;
+			job.offset_ = offset;
+			job.size_ = size;
+			job.addr_ = dest;
 			outResult = job.DoRead();
 		}
 		return outResult;
@@ -0,0 +1,202 @@
+#include "catch.hpp"
+
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/timer.h"
+#include "core/uuid.h"
+#include "core/vector.h"
+#include "resource/archive.h"
+
+#include <cstring>
+
+namespace
+{
+	const char* testArchiveName = "archive_test.pak";
+	const Core::UUID testType("TestResource");
+
+	/// Every other entry is a repeating pattern, which compresses, the rest don't.
+	Core::Vector<u8> MakeEntryData(i32 idx)
+	{
+		Core::Vector<u8> data;
+		data.resize(1 + (idx * 997) % 20000);
+		for(i32 i = 0; i < data.size(); ++i)
+			data[i] = (idx & 1) ? (u8)((i % 16) + idx) : (u8)((i * 2654435761U + idx) >> 13);
+		return data;
+	}
+
+	void GetEntryName(char* outName, i32 maxName, i32 idx) { sprintf_s(outName, maxName, "entries/entry_%i.dat", idx); }
+} // namespace
+
+TEST_CASE("archive-tests")
+{
+	const i32 NUM_ENTRIES = 1000;
+	char name[64];
+
+	{
+		Resource::ArchiveWriter writer(testArchiveName);
+		REQUIRE(writer);
+		for(i32 i = 0; i < NUM_ENTRIES; ++i)
+		{
+			GetEntryName(name, sizeof(name), i);
+			const Core::Vector<u8> data = MakeEntryData(i);
+			const auto codec = (i % 3) ? Core::CompressionCodec::LZ4 : Core::CompressionCodec::NONE;
+			REQUIRE(writer.AddEntry(Core::UUID(name), testType, data.data(), data.size(), codec));
+		}
+
+		// UUIDs are unique.
+		GetEntryName(name, sizeof(name), 0);
+		const u8 data = 0;
+		REQUIRE(!writer.AddEntry(Core::UUID(name), testType, &data, sizeof(data)));
+		REQUIRE(writer.Finalize());
+	}
+
+	{
+		Resource::Archive archive(testArchiveName);
+		REQUIRE(archive);
+		REQUIRE(archive.GetNumEntries() == NUM_ENTRIES);
+
+		for(i32 i = 0; i < NUM_ENTRIES; ++i)
+		{
+			GetEntryName(name, sizeof(name), i);
+			const Resource::ArchiveEntry* entry = archive.FindEntry(Core::UUID(name));
+			REQUIRE(entry);
+			REQUIRE(entry->type_ == testType);
+
+			// Compressed only if asked to and it made the entry smaller.
+			const Core::Vector<u8> data = MakeEntryData(i);
+			REQUIRE(entry->uncompressedSize_ == data.size());
+			if(entry->codec_ != Core::CompressionCodec::NONE)
+				REQUIRE(entry->size_ < data.size());
+			if((i % 3) && (i & 1) && data.size() > 256)
+				REQUIRE(entry->codec_ == Core::CompressionCodec::LZ4);
+
+			Core::Vector<u8> buffer;
+			Core::File file = archive.OpenEntry(*entry, buffer);
+			REQUIRE(file);
+			REQUIRE(file.Size() == data.size());
+			Core::Vector<u8> readData;
+			readData.resize(data.size());
+			REQUIRE(file.Read(readData.data(), readData.size()) == data.size());
+			REQUIRE(memcmp(readData.data(), data.data(), data.size()) == 0);
+		}
+
+		REQUIRE(archive.FindEntry(Core::UUID("entries/missing.dat")) == nullptr);
+	}
+
+	Core::FileRemove(testArchiveName);
+}
+
+TEST_CASE("archive-tests-invalid")
+{
+	REQUIRE(!Resource::Archive("archive_missing.pak"));
+
+	// Empty archive is valid.
+	{
+		Resource::ArchiveWriter writer(testArchiveName);
+	}
+	{
+		Resource::Archive archive(testArchiveName);
+		REQUIRE(archive);
+		REQUIRE(archive.GetNumEntries() == 0);
+		REQUIRE(archive.FindEntry(testType) == nullptr);
+	}
+
+	// Not an archive.
+	{
+		Core::FileRemove(testArchiveName);
+		Core::File file(testArchiveName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		const char text[] = "Not an archive, but long enough to contain a header.";
+		REQUIRE(file.Write(text, sizeof(text)) == sizeof(text));
+	}
+	REQUIRE(!Resource::Archive(testArchiveName));
+
+	// Truncated archive, missing its table of contents.
+	{
+		Resource::ArchiveWriter writer(testArchiveName);
+		const Core::Vector<u8> data = MakeEntryData(1);
+		REQUIRE(writer.AddEntry(testType, testType, data.data(), data.size()));
+		REQUIRE(writer.Finalize());
+	}
+	{
+		Core::Vector<u8> data;
+		{
+			Core::File file(testArchiveName, Core::FileFlags::READ);
+			data.resize((i32)file.Size() - 1);
+			REQUIRE(file.Read(data.data(), data.size()) == data.size());
+		}
+		Core::FileRemove(testArchiveName);
+		Core::File file(testArchiveName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(file.Write(data.data(), data.size()) == data.size());
+	}
+	REQUIRE(!Resource::Archive(testArchiveName));
+
+	Core::FileRemove(testArchiveName);
+}
+
+TEST_CASE("archive-benchmark", "[.benchmark]")
+{
+	// Many small converted assets, as loose files and packed in an archive.
+	const i32 NUM_ASSETS = 10000;
+	const i32 ASSET_SIZE = 4096;
+	char name[64];
+
+	Core::Vector<u8> data;
+	data.resize(ASSET_SIZE);
+	for(i32 i = 0; i < ASSET_SIZE; ++i)
+		data[i] = (u8)(i * 13);
+
+	Core::FileCreateDir("entries");
+	{
+		Resource::ArchiveWriter writer(testArchiveName);
+		for(i32 i = 0; i < NUM_ASSETS; ++i)
+		{
+			GetEntryName(name, sizeof(name), i);
+			Core::File file(name, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+			REQUIRE(file.Write(data.data(), data.size()) == data.size());
+			REQUIRE(writer.AddEntry(Core::UUID(name), testType, data.data(), data.size()));
+		}
+	}
+
+	Core::Log("\"archive-benchmark\" (%i assets, %i KB each)\n", NUM_ASSETS, ASSET_SIZE / 1024);
+	Core::Vector<u8> readData;
+	readData.resize(ASSET_SIZE);
+	Core::Timer timer;
+
+	// As Resource::Manager loads converted files: check it exists, then open and read.
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ASSETS; ++i)
+	{
+		GetEntryName(name, sizeof(name), i);
+		REQUIRE(Core::FileExists(name));
+		Core::File file(name, Core::FileFlags::READ | Core::FileFlags::MMAP);
+		REQUIRE(file.Read(readData.data(), readData.size()) == ASSET_SIZE);
+	}
+	const f64 looseTime = timer.GetTime();
+
+	// Including opening the archive.
+	timer.Mark();
+	{
+		Resource::Archive archive(testArchiveName);
+		Core::Vector<u8> buffer;
+		for(i32 i = 0; i < NUM_ASSETS; ++i)
+		{
+			GetEntryName(name, sizeof(name), i);
+			const Resource::ArchiveEntry* entry = archive.FindEntry(Core::UUID(name));
+			REQUIRE(entry);
+			Core::File file = archive.OpenEntry(*entry, buffer);
+			REQUIRE(file.Read(readData.data(), readData.size()) == ASSET_SIZE);
+		}
+	}
+	const f64 archiveTime = timer.GetTime();
+
+	Core::Log("\tLoose files: %f ms (%f us/asset)\n", looseTime * 1000.0, looseTime * 1000000.0 / NUM_ASSETS);
+	Core::Log("\tArchive: %f ms (%f us/asset)\n", archiveTime * 1000.0, archiveTime * 1000000.0 / NUM_ASSETS);
+
+	for(i32 i = 0; i < NUM_ASSETS; ++i)
+	{
+		GetEntryName(name, sizeof(name), i);
+		Core::FileRemove(name);
+	}
+	Core::FileRemoveDir("entries");
+	Core::FileRemove(testArchiveName);
+}
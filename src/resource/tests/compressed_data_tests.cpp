@@ -0,0 +1,307 @@
+#include "catch.hpp"
+
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "job/manager.h"
+#include "resource/compressed_data.h"
+
+#include <cstring>
+
+namespace
+{
+	const char* testFileName = "compressed_data_test.dat";
+	const u32 testTrailer = 0x12345678;
+
+	/// Laid out like a BC1 texture: 8 byte blocks of two 565 endpoints then 2 bit indices. Mixes flat regions,
+	/// gradients and noisy detail, so it compresses roughly as well as real textures.
+	Core::Vector<u8> MakeTextureData(i32 size, u32 seed)
+	{
+		Core::Vector<u8> data;
+		data.resize(size);
+		u32 noise = seed * 2654435761U + 1;
+		for(i32 i = 0; i < size; i += 8)
+		{
+			const i32 block = i / 8;
+			const i32 region = (block / 256) % 4;
+			noise = noise * 1664525U + 1013904223U;
+			u32 endpoints = 0;
+			u32 indices = 0;
+			if(region == 0)
+			{
+				endpoints = 0x18e318e3;
+			}
+			else if(region == 1)
+			{
+				endpoints = (u32)(block / 16) * 0x00210021;
+				indices = 0x1b1b1b1b;
+			}
+			else
+			{
+				endpoints = ((u32)(block / 4) * 0x00010841) ^ (noise & 0x00030003);
+				indices = noise * 2654435761U;
+			}
+			for(i32 j = 0; j < 8 && (i + j) < size; ++j)
+				data[i + j] = (u8)((j < 4 ? endpoints >> (j * 8) : indices >> ((j - 4) * 8)) & 0xff);
+		}
+		return data;
+	}
+
+	/// Write data, followed by a trailer to check reads stop at the end of the data.
+	void WriteTestFile(const Core::Vector<u8>& data, Core::CompressionCodec codec, i32 level, i32 blockSize)
+	{
+		Core::FileRemove(testFileName);
+		Core::File file(testFileName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(file);
+		REQUIRE(Resource::WriteCompressedData(file, data.data(), data.size(), codec, level, blockSize));
+		REQUIRE(file.Write(&testTrailer, sizeof(testTrailer)) == sizeof(testTrailer));
+	}
+
+	void TestReadFile(Core::File& file, const Core::Vector<u8>& data)
+	{
+		REQUIRE(file);
+		REQUIRE(Resource::GetUncompressedSize(file) == data.size());
+		REQUIRE(file.Tell() == 0);
+
+		Core::Vector<u8> readData;
+		readData.resize(data.size() + 1);
+		REQUIRE(Resource::ReadCompressedData(file, readData.data(), data.size()));
+		if(data.size() > 0)
+			REQUIRE(memcmp(readData.data(), data.data(), data.size()) == 0);
+
+		u32 trailer = 0;
+		REQUIRE(file.Read(&trailer, sizeof(trailer)) == sizeof(trailer));
+		REQUIRE(trailer == testTrailer);
+	}
+
+	void TestRoundTrip(const Core::Vector<u8>& data, Core::CompressionCodec codec, i32 level, i32 blockSize)
+	{
+		WriteTestFile(data, codec, level, blockSize);
+
+		// Mapped.
+		{
+			Core::File file(testFileName, Core::FileFlags::READ | Core::FileFlags::MMAP);
+			TestReadFile(file, data);
+		}
+
+		// Streamed.
+		{
+			Core::File file(testFileName, Core::FileFlags::READ);
+			TestReadFile(file, data);
+		}
+
+		// From memory, i.e. an archive entry.
+		{
+			Core::Vector<u8> fileData;
+			{
+				Core::File file(testFileName, Core::FileFlags::READ);
+				fileData.resize((i32)file.Size());
+				REQUIRE(file.Read(fileData.data(), fileData.size()) == fileData.size());
+			}
+			Core::File file(fileData.data(), fileData.size());
+			TestReadFile(file, data);
+		}
+	}
+
+	void RunRoundTripTests()
+	{
+		const i32 BLOCK_SIZE = 4096;
+		for(auto codec : {Core::CompressionCodec::NONE, Core::CompressionCodec::LZ4})
+		{
+			for(i32 size : {0, 1, BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE * 3 + 5})
+				TestRoundTrip(MakeTextureData(size, size), codec, Core::COMPRESSION_LEVEL_DEFAULT, BLOCK_SIZE);
+
+			// Spans several stream windows.
+			TestRoundTrip(MakeTextureData(20 * 1024 * 1024, 1), codec, Core::COMPRESSION_LEVEL_FAST,
+			    Resource::COMPRESSED_DATA_BLOCK_SIZE);
+		}
+	}
+} // namespace
+
+TEST_CASE("compressed-data-tests")
+{
+	RunRoundTripTests();
+	Core::FileRemove(testFileName);
+}
+
+TEST_CASE("compressed-data-tests-jobs")
+{
+	Job::Manager::Scoped jobManager(4, 256, 32 * 1024);
+	RunRoundTripTests();
+	Core::FileRemove(testFileName);
+}
+
+TEST_CASE("compressed-data-tests-end-of-file")
+{
+	// Converters write nothing after the data, so reads must be able to end exactly at the end of the file.
+	const Core::Vector<u8> data = MakeTextureData(64 * 1024 + 5, 3);
+	Core::FileRemove(testFileName);
+	{
+		Core::File file(testFileName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(Resource::WriteCompressedData(file, data.data(), data.size(), Core::CompressionCodec::LZ4,
+		    Core::COMPRESSION_LEVEL_DEFAULT, 4096));
+	}
+
+	Core::Vector<u8> fileData;
+	{
+		Core::File file(testFileName, Core::FileFlags::READ);
+		fileData.resize((i32)file.Size());
+		REQUIRE(file.Read(fileData.data(), fileData.size()) == fileData.size());
+	}
+
+	Core::Vector<u8> readData;
+	readData.resize(data.size());
+	for(auto flags : {Core::FileFlags::READ, Core::FileFlags::READ | Core::FileFlags::MMAP})
+	{
+		Core::File file(testFileName, flags);
+		REQUIRE(Resource::ReadCompressedData(file, readData.data(), readData.size()));
+		REQUIRE(memcmp(readData.data(), data.data(), data.size()) == 0);
+		REQUIRE(file.Tell() == fileData.size());
+	}
+	{
+		Core::File file(fileData.data(), fileData.size());
+		REQUIRE(Resource::ReadCompressedData(file, readData.data(), readData.size()));
+		REQUIRE(memcmp(readData.data(), data.data(), data.size()) == 0);
+		REQUIRE(file.Tell() == fileData.size());
+	}
+
+	Core::FileRemove(testFileName);
+}
+
+TEST_CASE("compressed-data-tests-invalid")
+{
+	const Core::Vector<u8> data = MakeTextureData(64 * 1024, 0);
+	Core::Vector<u8> readData;
+	readData.resize(data.size());
+
+	// Not compressed data.
+	{
+		Core::File file(data.data(), data.size());
+		REQUIRE(Resource::GetUncompressedSize(file) == -1);
+		REQUIRE(!Resource::ReadCompressedData(file, readData.data(), readData.size()));
+	}
+
+	// Wrong size.
+	WriteTestFile(data, Core::CompressionCodec::LZ4, Core::COMPRESSION_LEVEL_DEFAULT, 4096);
+	{
+		Core::File file(testFileName, Core::FileFlags::READ);
+		REQUIRE(!Resource::ReadCompressedData(file, readData.data(), readData.size() - 1));
+	}
+
+	Core::Vector<u8> fileData;
+	{
+		Core::File file(testFileName, Core::FileFlags::READ);
+		fileData.resize((i32)file.Size());
+		REQUIRE(file.Read(fileData.data(), fileData.size()) == fileData.size());
+	}
+
+	// Truncated, both mapped and streamed.
+	{
+		Core::FileRemove(testFileName);
+		Core::File file(testFileName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(file.Write(fileData.data(), fileData.size() - 100) == fileData.size() - 100);
+	}
+	for(auto flags : {Core::FileFlags::READ, Core::FileFlags::READ | Core::FileFlags::MMAP})
+	{
+		Core::File file(testFileName, flags);
+		REQUIRE(Resource::GetUncompressedSize(file) == data.size());
+		REQUIRE(!Resource::ReadCompressedData(file, readData.data(), readData.size()));
+	}
+
+	// Block sizes that don't match the header.
+	{
+		Core::Vector<u8> damaged = fileData;
+		const u32 block = Resource::COMPRESSED_BLOCK_RAW | 1;
+		memcpy(damaged.data() + sizeof(Resource::CompressedDataHeader), &block, sizeof(block));
+		Core::File file(damaged.data(), damaged.size());
+		REQUIRE(!Resource::ReadCompressedData(file, readData.data(), readData.size()));
+	}
+
+	// Damaged block data never writes outside of the destination.
+	{
+		Core::Vector<u8> damaged = fileData;
+		const i32 dataOffset = sizeof(Resource::CompressedDataHeader) + 16 * sizeof(u32);
+		for(i32 i = dataOffset; i < damaged.size(); i += 61)
+			damaged[i] ^= 0xa5;
+		Core::File file(damaged.data(), damaged.size());
+		Resource::ReadCompressedData(file, readData.data(), readData.size());
+	}
+
+	Core::FileRemove(testFileName);
+}
+
+TEST_CASE("compressed-data-benchmark", "[.benchmark]")
+{
+	// A large converted texture, loaded as Graphics::Factory does.
+	const i32 DATA_SIZE = 64 * 1024 * 1024;
+	const Core::Vector<u8> data = MakeTextureData(DATA_SIZE, 0);
+	Core::Vector<u8> readData;
+	readData.resize(DATA_SIZE);
+	const f64 sizeMB = DATA_SIZE / (1024.0 * 1024.0);
+
+	struct Config
+	{
+		Core::CompressionCodec codec_;
+		i32 level_;
+	};
+	const Config configs[] = {
+	    {Core::CompressionCodec::NONE, 0},
+	    {Core::CompressionCodec::LZ4, Core::COMPRESSION_LEVEL_FAST},
+	    {Core::CompressionCodec::LZ4, 3},
+	    {Core::CompressionCodec::LZ4, Core::COMPRESSION_LEVEL_DEFAULT},
+	    {Core::CompressionCodec::LZ4, Core::COMPRESSION_LEVEL_MAX},
+	};
+
+	Core::Log("\"compressed-data-benchmark\" (%i MB, BC1-like data)\n", DATA_SIZE / (1024 * 1024));
+	for(const Config& config : configs)
+	{
+		Core::Timer timer;
+		f64 writeTime = 0.0;
+		f64 mappedTime = 0.0;
+		f64 streamedTime = 0.0;
+		{
+			Job::Manager::Scoped jobManager(8, 256, 32 * 1024);
+
+			timer.Mark();
+			WriteTestFile(data, config.codec_, config.level_, Resource::COMPRESSED_DATA_BLOCK_SIZE);
+			writeTime = timer.GetTime();
+
+			timer.Mark();
+			{
+				Core::File file(testFileName, Core::FileFlags::READ | Core::FileFlags::MMAP);
+				REQUIRE(Resource::ReadCompressedData(file, readData.data(), readData.size()));
+			}
+			mappedTime = timer.GetTime();
+
+			timer.Mark();
+			{
+				Core::File file(testFileName, Core::FileFlags::READ);
+				REQUIRE(Resource::ReadCompressedData(file, readData.data(), readData.size()));
+			}
+			streamedTime = timer.GetTime();
+		}
+
+		// Without jobs, for CPU cost.
+		timer.Mark();
+		{
+			Core::File file(testFileName, Core::FileFlags::READ | Core::FileFlags::MMAP);
+			REQUIRE(Resource::ReadCompressedData(file, readData.data(), readData.size()));
+		}
+		const f64 cpuTime = timer.GetTime();
+		REQUIRE(memcmp(readData.data(), data.data(), DATA_SIZE) == 0);
+
+		i64 fileSize = 0;
+		{
+			Core::File file(testFileName, Core::FileFlags::READ);
+			fileSize = file.Size();
+		}
+		Core::Log("\t%s level %i: %.2f MB on disk (ratio %f), write %f MB/s, load mapped %f MB/s, "
+		          "streamed %f MB/s, 1 thread %f MB/s\n",
+		    config.codec_ == Core::CompressionCodec::NONE ? "NONE" : "LZ4", config.level_,
+		    fileSize / (1024.0 * 1024.0), (f64)fileSize / DATA_SIZE, sizeMB / writeTime, sizeMB / mappedTime,
+		    sizeMB / streamedTime, sizeMB / cpuTime);
+	}
+
+	Core::FileRemove(testFileName);
+}
@@ -0,0 +1,207 @@
+#include "catch.hpp"
+
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/misc.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "resource/private/file_io_engine.h"
+
+namespace
+{
+	const char* testFileNames[] = {
+	    "file_io_engine_test_0.dat", "file_io_engine_test_1.dat", "file_io_engine_test_2.dat", "file_io_engine_test_3.dat"};
+
+	void WriteTestFile(const char* fileName, i32 size, u8 seed)
+	{
+		Core::Vector<u8> data;
+		data.resize(size);
+		for(i32 i = 0; i < size; ++i)
+			data[i] = (u8)(i * 13 + seed);
+		Core::File file(fileName, Core::FileFlags::CREATE | Core::FileFlags::WRITE);
+		REQUIRE(file.Write(data.data(), data.size()) == data.size());
+	}
+
+	bool CheckTestData(const u8* data, i64 offset, i64 size, u8 seed)
+	{
+		for(i64 i = 0; i < size; ++i)
+			if(data[i] != (u8)((offset + i) * 13 + seed))
+				return false;
+		return true;
+	}
+
+	void WaitForResult(const Resource::AsyncResult& result)
+	{
+		while(!result.IsComplete())
+			Core::SwitchThread();
+	}
+
+	/// Start @a result as Resource::Manager::ReadFileData does.
+	void StartResult(Resource::AsyncResult& result, i64 size)
+	{
+		result.result_ = Resource::Result::PENDING;
+		result.workRemaining_ = size;
+	}
+} // namespace
+
+TEST_CASE("file-io-engine-tests")
+{
+	const i32 FILE_SIZE = 3 * 1024 * 1024 + 17;
+	const i32 NUM_FILES = sizeof(testFileNames) / sizeof(testFileNames[0]);
+	for(i32 i = 0; i < NUM_FILES; ++i)
+		WriteTestFile(testFileNames[i], FILE_SIZE, (u8)i);
+
+	for(bool allowIOUring : {true, false})
+	{
+		Resource::FileIOEngine engine(allowIOUring);
+		Core::Log("\"file-io-engine-tests\" io_uring: %s\n", engine.IsUsingIOUring() ? "yes" : "no");
+
+		Core::File files[NUM_FILES];
+		for(i32 i = 0; i < NUM_FILES; ++i)
+		{
+			files[i] = Core::File(testFileNames[i], Core::FileFlags::READ);
+			REQUIRE(files[i]);
+		}
+
+		// Whole files, plus small reads spread across them, all in flight together.
+		{
+			const i32 NUM_SMALL_READS = 256;
+			const i64 SMALL_READ_SIZE = 1000;
+			Core::Vector<Core::Vector<u8>> buffers;
+			Resource::AsyncResult results[NUM_FILES + NUM_SMALL_READS];
+			for(i32 i = 0; i < NUM_FILES + NUM_SMALL_READS; ++i)
+			{
+				const bool whole = i < NUM_FILES;
+				const i64 offset = whole ? 0 : ((i64)i * 12345) % (FILE_SIZE - SMALL_READ_SIZE);
+				const i64 size = whole ? FILE_SIZE : SMALL_READ_SIZE;
+				buffers.emplace_back();
+				buffers.back().resize((i32)size);
+				StartResult(results[i], size);
+				engine.Read(files[i % NUM_FILES], offset, size, buffers.back().data(), &results[i]);
+			}
+
+			for(i32 i = 0; i < NUM_FILES + NUM_SMALL_READS; ++i)
+			{
+				const bool whole = i < NUM_FILES;
+				const i64 offset = whole ? 0 : ((i64)i * 12345) % (FILE_SIZE - SMALL_READ_SIZE);
+				WaitForResult(results[i]);
+				REQUIRE(results[i].result_ == Resource::Result::SUCCESS);
+				REQUIRE(results[i].workRemaining_ == 0);
+				REQUIRE(CheckTestData(buffers[i].data(), offset, buffers[i].size(), (u8)(i % NUM_FILES)));
+			}
+		}
+
+		// Read past end of file fails, but reads what it can.
+		{
+			Core::Vector<u8> buffer;
+			buffer.resize(FILE_SIZE + 4096);
+			Resource::AsyncResult result;
+			StartResult(result, buffer.size());
+			engine.Read(files[0], 0, buffer.size(), buffer.data(), &result);
+			WaitForResult(result);
+			REQUIRE(result.result_ == Resource::Result::FAILURE);
+			REQUIRE(result.workRemaining_ == 4096);
+			REQUIRE(CheckTestData(buffer.data(), 0, FILE_SIZE, 0));
+		}
+
+		// Memory files have no descriptor, so are read synchronously.
+		{
+			Core::Vector<u8> data;
+			data.resize(FILE_SIZE);
+			for(i32 i = 0; i < FILE_SIZE; ++i)
+				data[i] = (u8)(i * 13 + 7);
+			Core::File memFile(data.data(), data.size());
+
+			Core::Vector<u8> buffer;
+			buffer.resize(FILE_SIZE);
+			Resource::AsyncResult result;
+			StartResult(result, buffer.size());
+			engine.Read(memFile, 0, buffer.size(), buffer.data(), &result);
+			WaitForResult(result);
+			REQUIRE(result.result_ == Resource::Result::SUCCESS);
+			REQUIRE(CheckTestData(buffer.data(), 0, FILE_SIZE, 7));
+		}
+
+		// Pending reads complete before destruction.
+		{
+			Core::Vector<u8> buffer;
+			buffer.resize(FILE_SIZE);
+			Resource::AsyncResult result;
+			{
+				Resource::FileIOEngine otherEngine(allowIOUring);
+				StartResult(result, buffer.size());
+				otherEngine.Read(files[1], 0, buffer.size(), buffer.data(), &result);
+			}
+			REQUIRE(result.result_ == Resource::Result::SUCCESS);
+			REQUIRE(CheckTestData(buffer.data(), 0, FILE_SIZE, 1));
+		}
+	}
+
+	for(const char* fileName : testFileNames)
+		Core::FileRemove(fileName);
+}
+
+TEST_CASE("file-io-engine-benchmark", "[.benchmark]")
+{
+	// Many small assets, read bypassing the OS cache so each read waits on the device.
+	const i32 NUM_ASSETS = 2000;
+	const i32 ASSET_SIZE = 256 * 1024;
+	const i32 NUM_FILES = sizeof(testFileNames) / sizeof(testFileNames[0]);
+	const i32 ASSETS_PER_FILE = NUM_ASSETS / NUM_FILES;
+	for(i32 i = 0; i < NUM_FILES; ++i)
+		WriteTestFile(testFileNames[i], ASSETS_PER_FILE * ASSET_SIZE, (u8)i);
+
+	const i64 totalSize = (i64)NUM_ASSETS * ASSET_SIZE;
+	u8* bufferMem = new u8[totalSize + Core::FILE_DIRECT_ALIGNMENT];
+	u8* buffer = (u8*)Core::PotRoundUp((uintptr_t)bufferMem, Core::FILE_DIRECT_ALIGNMENT);
+
+	Core::File files[NUM_FILES];
+	for(i32 i = 0; i < NUM_FILES; ++i)
+		files[i] = Core::File(testFileNames[i], Core::FileFlags::READ | Core::FileFlags::DIRECT);
+
+	Core::Log("\"file-io-engine-benchmark\" (%i assets, %i KB each)\n", NUM_ASSETS, ASSET_SIZE / 1024);
+	auto LogTime = [&](const char* name, f64 time) {
+		Core::Log("\t%s: %f ms (%f MB/s)\n", name, time * 1000.0, (totalSize / (1024.0 * 1024.0)) / time);
+	};
+
+	// One read at a time, as a single blocking read thread does.
+	Core::Timer timer;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ASSETS; ++i)
+	{
+		const i64 offset = (i64)(i / NUM_FILES) * ASSET_SIZE;
+		REQUIRE(files[i % NUM_FILES].ReadAt(offset, buffer + (i64)i * ASSET_SIZE, ASSET_SIZE) == ASSET_SIZE);
+	}
+	LogTime("Blocking", timer.GetTime());
+
+	for(bool allowIOUring : {true, false})
+	{
+		Resource::FileIOEngine engine(allowIOUring);
+		auto* results = new Resource::AsyncResult[NUM_ASSETS];
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ASSETS; ++i)
+		{
+			const i64 offset = (i64)(i / NUM_FILES) * ASSET_SIZE;
+			StartResult(results[i], ASSET_SIZE);
+			engine.Read(files[i % NUM_FILES], offset, ASSET_SIZE, buffer + (i64)i * ASSET_SIZE, &results[i]);
+		}
+		for(i32 i = 0; i < NUM_ASSETS; ++i)
+		{
+			WaitForResult(results[i]);
+			REQUIRE(results[i].result_ == Resource::Result::SUCCESS);
+		}
+		LogTime(engine.IsUsingIOUring() ? "FileIOEngine (io_uring)" : "FileIOEngine (threads)", timer.GetTime());
+		delete[] results;
+	}
+
+	for(i32 i = 0; i < NUM_ASSETS; ++i)
+	{
+		const i64 offset = (i64)(i / NUM_FILES) * ASSET_SIZE;
+		REQUIRE(CheckTestData(buffer + (i64)i * ASSET_SIZE, offset, ASSET_SIZE, (u8)(i % NUM_FILES)));
+	}
+
+	delete[] bufferMem;
+	for(const char* fileName : testFileNames)
+		Core::FileRemove(fileName);
+}
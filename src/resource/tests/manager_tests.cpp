@@ -7,6 +7,7 @@
 #include "core/vector.h"
 #include "job/manager.h"
 #include "plugin/manager.h"
+#include "resource/archive.h"
 #include "resource/converter.h"
 #include "resource/factory.h"
 #include "resource/manager.h"
@@ -203,3 +204,38 @@ TEST_CASE("resource-tests-request-multiple")
 
 	REQUIRE(Resource::Manager::UnregisterFactory(factory));
 }
+
+TEST_CASE("resource-tests-request-archive")
+{
+	Job::Manager::Scoped jobManager(1, 256, 32 * 1024);
+	Plugin::Manager::Scoped pluginManager;
+	Resource::Manager::Scoped manager;
+
+	// Register factory.
+	auto* factory = new TestFactory();
+	REQUIRE(Resource::Manager::RegisterFactory(TestResource::GetTypeUUID(), factory));
+
+	{
+		Resource::ArchiveWriter writer("archive.test.pak");
+		REQUIRE(writer);
+		TestResourceData data = {};
+		strcpy_s(data.internalData_, sizeof(data.internalData_), "archived");
+		REQUIRE(writer.AddEntry(Core::UUID("archive.test"), TestResource::GetTypeUUID(), &data, sizeof(data),
+		    Core::CompressionCodec::LZ4));
+	}
+
+	REQUIRE(!Resource::Manager::MountArchive("missing.test.pak"));
+	REQUIRE(Resource::Manager::MountArchive("archive.test.pak"));
+
+	// Loaded from archive, with no converted file.
+	TestResource* testResource = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(testResource, "archive.test"));
+	REQUIRE(testResource);
+	Resource::Manager::WaitForResource(testResource);
+	REQUIRE(!Core::FileExists("converter_output/archive.test.converted"));
+
+	REQUIRE(Resource::Manager::ReleaseResource(testResource));
+	REQUIRE(!testResource);
+
+	REQUIRE(Resource::Manager::UnregisterFactory(factory));
+}
@@ -2,6 +2,7 @@
 #include "core/array.h"
 #include "core/debug.h"
 #include "core/file.h"
+#include "core/memory_tracker.h"
 #include "core/misc.h"
 #include "core/uuid.h"
 #include "core/vector.h"
@@ -250,6 +251,8 @@ namespace
 
 namespace Serialization
 {
+	using SerializationAllocator = Core::TaggedAllocator<Core::MemoryTag::SERIALIZATION>;
+
 	struct SerializerImpl
 	{
 		virtual ~SerializerImpl() {}
@@ -268,7 +271,7 @@ namespace Serialization
 	{
 		Core::File& outFile_;
 		Json::Value rootValue_;
-		Core::Vector<Json::Value*> objectStack_;
+		Core::Vector<Json::Value*, SerializationAllocator> objectStack_;
 
 		SerializerImplWriteJson(Core::File& outFile)
 		    : outFile_(outFile)
@@ -318,7 +321,7 @@ namespace Serialization
 		{
 			i32 bytesRequired = ((size * 4) / 3) + 4;
 			DBG_ASSERT(bytesRequired >= 0);
-			Core::Vector<char> outString;
+			Core::Vector<char, SerializationAllocator> outString;
 			outString.resize(bytesRequired + 1, 0);
 			base64_encodestate encodeState;
 			base64_init_encodestate(&encodeState);
@@ -348,13 +351,13 @@ namespace Serialization
 	{
 		Core::File& inFile_;
 		Json::Value rootValue_;
-		Core::Vector<Json::Value*> objectStack_;
+		Core::Vector<Json::Value*, SerializationAllocator> objectStack_;
 
 		SerializerImplReadJson(Core::File& inFile)
 		    : inFile_(inFile)
 		{
 			Json::Reader reader;
-			Core::Vector<char> inBuffer;
+			Core::Vector<char, SerializationAllocator> inBuffer;
 			inBuffer.resize((i32)inFile.Size());
 			inFile.Read(inBuffer.data(), inBuffer.size());
 			reader.parse(inBuffer.data(), inBuffer.data() + inBuffer.size(), rootValue_, false);